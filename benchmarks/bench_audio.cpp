@@ -0,0 +1,272 @@
+#include <benchmark/benchmark.h>
+#include "core/audio/AudioFileSource.h"
+#include "core/audio/LoudnessMeter.h"
+#include "core/audio/TrackOverview.h"
+#include "core/audio/VisualizationBuffer.h"
+#include "core/audio/VisualizationDynamics.h"
+#include "bench_util.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+// AudioEngine::processAndStore: one device callback worth of frames.
+static void BM_VisualizationStore(benchmark::State& state) {
+    VisualizationBuffer buffer(1024);
+    const size_t frames = static_cast<size_t>(state.range(0));
+    std::vector<short> pcm = bench::syntheticPcm(frames);
+    for (auto _ : state) {
+        buffer.store(pcm.data(), frames);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_VisualizationStore)->Arg(256)->Arg(512)->Arg(1024);
+
+// AudioEngine::getPCM: the renderer's per-frame copy for projectM.
+static void BM_VisualizationLatest(benchmark::State& state) {
+    VisualizationBuffer buffer(1024);
+    std::vector<short> pcm = bench::syntheticPcm(1024);
+    buffer.store(pcm.data(), 1024);
+    const size_t frames = static_cast<size_t>(state.range(0));
+    std::vector<short> out(frames * 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.latest(out.data(), frames));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * frames);
+}
+BENCHMARK(BM_VisualizationLatest)->Arg(512)->Arg(1024);
+
+// Visualization dynamics in the audio callback: one device period of
+// frames, wideband (0) or split into two bands (1).
+static void BM_VisualizationDynamics(benchmark::State& state) {
+    const size_t frames = static_cast<size_t>(state.range(0));
+    const std::vector<short> pcm = bench::syntheticPcm(frames);
+    std::vector<short> out(pcm.size());
+    VisualizationDynamics::Settings settings;
+    settings.splitBands = state.range(1) != 0;
+    VisualizationDynamics dynamics(settings, 44100);
+    for (auto _ : state) {
+        dynamics.process(pcm.data(), out.data(), frames);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(frames));
+}
+BENCHMARK(BM_VisualizationDynamics)->Args({512, 0})->Args({512, 1})->Args({1024, 0});
+
+namespace {
+    const int DECODE_SECONDS = 30;
+    const char* const FORMAT_NAMES[] = {"wav", "flac", "mp3"};
+
+    void put(std::string& out, uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            out.push_back(static_cast<char>(value >> (8 * i)));
+        }
+    }
+
+    uint8_t crc8(const std::string& data, size_t from) {
+        uint8_t crc = 0;
+        for (size_t i = from; i < data.size(); ++i) {
+            crc ^= static_cast<uint8_t>(data[i]);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = static_cast<uint8_t>(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    uint16_t crc16(const std::string& data, size_t from) {
+        uint16_t crc = 0;
+        for (size_t i = from; i < data.size(); ++i) {
+            crc ^= static_cast<uint16_t>(static_cast<uint8_t>(data[i]) << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = static_cast<uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x8005 : crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    // Stereo 16-bit 44.1 kHz FLAC with verbatim subframes. miniaudio can
+    // decode FLAC but not encode it; this keeps the fixture self-contained.
+    std::string encodeFlac(const std::vector<short>& pcm) {
+        const size_t frames = pcm.size() / 2;
+        const size_t block = 4096;
+        std::string out = "fLaC";
+        put(out, 0x80, 1);
+        put(out, 34, 3);
+        put(out, block, 2);
+        put(out, block, 2);
+        put(out, 0, 6);
+        // Sample rate (20 bits), channels - 1 (3), bits - 1 (5), total samples (36).
+        put(out, (uint64_t(44100) << 44) | (uint64_t(1) << 41) | (uint64_t(15) << 36) | frames, 8);
+        out.append(16, '\0');
+
+        for (size_t first = 0, number = 0; first < frames; first += block, ++number) {
+            const size_t count = std::min(block, frames - first);
+            const size_t start = out.size();
+            // Fixed blocking, 16-bit block size at the end, 44.1 kHz, L/R, 16 bits.
+            put(out, 0xFFF8, 2);
+            put(out, 0x79, 1);
+            put(out, 0x18, 1);
+            if (number < 0x80) {
+                put(out, number, 1);
+            } else {
+                put(out, 0xC0 | (number >> 6), 1);
+                put(out, 0x80 | (number & 0x3F), 1);
+            }
+            put(out, count - 1, 2);
+            put(out, crc8(out, start), 1);
+            for (int channel = 0; channel < 2; ++channel) {
+                put(out, 0x02, 1);
+                for (size_t i = 0; i < count; ++i) {
+                    put(out, static_cast<uint16_t>(pcm[(first + i) * 2 + channel]), 2);
+                }
+            }
+            put(out, crc16(out, start), 2);
+        }
+        return out;
+    }
+
+    // Writes the fixtures once per run; MP3 comes from AURORA_BENCH_MP3
+    // since nothing here can encode it.
+    std::string decodeFixture(int format) {
+        static std::string paths[3];
+        if (!paths[format].empty()) {
+            return paths[format];
+        }
+        if (format == 2) {
+            const char* mp3 = std::getenv("AURORA_BENCH_MP3");
+            return paths[format] = mp3 ? mp3 : "";
+        }
+
+        const std::vector<short> pcm = bench::syntheticPcm(44100 * DECODE_SECONDS);
+        const std::string path = (std::filesystem::temp_directory_path() / "aurora_bench_decode.").string() +
+                                 FORMAT_NAMES[format];
+        if (format == 0) {
+            ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_s16, 2, 44100);
+            ma_encoder encoder;
+            if (ma_encoder_init_file(path.c_str(), &config, &encoder) != MA_SUCCESS) {
+                return "";
+            }
+            ma_encoder_write_pcm_frames(&encoder, pcm.data(), pcm.size() / 2, nullptr);
+            ma_encoder_uninit(&encoder);
+        } else {
+            std::ofstream(path, std::ios::binary) << encodeFlac(pcm);
+        }
+        // Flushed, so the cold runs can drop the pages.
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        ::fsync(fd);
+        ::close(fd);
+        return paths[format] = path;
+    }
+
+    void dropPageCache(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+    }
+}
+
+// Whole-file decode to s16 stereo, as AudioEngine::decodeFile does for
+// analysis: buffered stdio (0) against the mapped AudioFileSource (1), with
+// a warm page cache (0) or the file's pages dropped before each pass (1).
+// Cold numbers depend on the file system honouring POSIX_FADV_DONTNEED.
+static void BM_DecodeFile(benchmark::State& state) {
+    const int format = static_cast<int>(state.range(0));
+    const bool mapped = state.range(1) != 0;
+    const bool cold = state.range(2) != 0;
+    const std::string path = decodeFixture(format);
+    if (path.empty()) {
+        state.SkipWithError(format == 2 ? "set AURORA_BENCH_MP3 to an MP3 file" : "could not write the fixture");
+        return;
+    }
+    state.SetLabel(std::string(FORMAT_NAMES[format]) + (mapped ? " mapped" : " buffered") + (cold ? " cold" : " warm"));
+
+    ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 2, 0);
+    std::vector<short> chunk(4096 * 2);
+    uint64_t frames = 0;
+    for (auto _ : state) {
+        if (cold) {
+            state.PauseTiming();
+            dropPageCache(path);
+            state.ResumeTiming();
+        }
+        ma_decoder decoder;
+        AudioFileSource source;
+        const ma_result result = mapped ? source.initDecoder(path, &config, &decoder)
+                                        : ma_decoder_init_file(path.c_str(), &config, &decoder);
+        if (result != MA_SUCCESS) {
+            state.SkipWithError("could not decode the fixture");
+            return;
+        }
+        ma_uint64 framesRead = 0;
+        do {
+            ma_decoder_read_pcm_frames(&decoder, chunk.data(), 4096, &framesRead);
+            frames += framesRead;
+        } while (framesRead == 4096);
+        ma_decoder_uninit(&decoder);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(frames));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+BENCHMARK(BM_DecodeFile)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Overview pyramid construction: one minute of PCM, as fed by the decoder.
+static void BM_OverviewAppend(benchmark::State& state) {
+    const std::vector<short> pcm = bench::syntheticPcm(44100 * 60);
+    TrackOverview overview;
+    for (auto _ : state) {
+        overview.reset(44100);
+        for (size_t first = 0; first < pcm.size() / 2; first += 16384) {
+            overview.append(pcm.data() + first * 2, std::min<size_t>(16384, pcm.size() / 2 - first));
+        }
+        overview.finish();
+        benchmark::DoNotOptimize(overview.frameCount());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pcm.size() / 2));
+}
+BENCHMARK(BM_OverviewAppend)->Unit(benchmark::kMillisecond);
+
+// K-weighting and gating alone: one minute of PCM.
+static void BM_LoudnessMeter(benchmark::State& state) {
+    const std::vector<short> pcm = bench::syntheticPcm(44100 * 60);
+    for (auto _ : state) {
+        LoudnessMeter meter(44100);
+        meter.addFrames(pcm.data(), pcm.size() / 2);
+        benchmark::DoNotOptimize(meter.integrated());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pcm.size() / 2));
+}
+BENCHMARK(BM_LoudnessMeter)->Unit(benchmark::kMillisecond);
+
+// One 1920-column timeline redraw of a one-hour track, waveform and
+// spectrogram, showing the whole track (0), a minute (1) or a second (2).
+static void BM_OverviewQuery(benchmark::State& state) {
+    static const TrackOverview overview = [] {
+        const std::vector<short> minute = bench::syntheticPcm(44100 * 60);
+        TrackOverview built;
+        built.reset(44100);
+        for (int i = 0; i < 60; ++i) {
+            built.append(minute.data(), minute.size() / 2);
+        }
+        built.finish();
+        return built;
+    }();
+    const uint64_t spans[] = {overview.frameCount(), 44100 * 60, 44100};
+    const uint64_t span = spans[state.range(0)];
+    const uint64_t start = (overview.frameCount() - span) / 2;
+    std::vector<WaveformBin> bins(1920);
+    std::vector<uint8_t> bands(1920 * TrackOverview::SPECTRUM_BANDS);
+    for (auto _ : state) {
+        overview.waveform(start, start + span, bins.data(), bins.size());
+        overview.spectrogram(start, start + span, bands.data(), bins.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_OverviewQuery)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
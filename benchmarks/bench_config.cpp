@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include "core/Config.h"
+#include "core/ConfigStore.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QTemporaryDir>
+
+namespace {
+    QString writeSampleConfig(const QTemporaryDir& dir) {
+        const QString path = dir.filePath("config.ini");
+        QSettings settings(path, QSettings::IniFormat);
+        settings.setValue("Font/size", 32);
+        settings.setValue("Render/visualizer_scale", 0.75);
+        settings.setValue("Title/color_r", 0.1);
+        settings.sync();
+        return path;
+    }
+}
+
+// What every accessor used to cost: a QSettings lookup and QVariant conversion.
+static void BM_ConfigQSettingsValue(benchmark::State& state) {
+    QTemporaryDir dir;
+    QSettings settings(writeSampleConfig(dir), QSettings::IniFormat);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.value("Render/visualizer_scale", 1.0).toFloat());
+    }
+}
+BENCHMARK(BM_ConfigQSettingsValue);
+
+// Accessor on the published snapshot, as read by the render loop.
+static void BM_ConfigSnapshotAccess(benchmark::State& state) {
+    QTemporaryDir dir;
+    ConfigStore store(writeSampleConfig(dir));
+    Config config;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(config.visualizerRenderScale());
+    }
+}
+BENCHMARK(BM_ConfigSnapshotAccess);
+
+// Full parse, paid once at startup and on each hot reload.
+static void BM_ConfigParse(benchmark::State& state) {
+    QTemporaryDir dir;
+    const QString path = writeSampleConfig(dir);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ConfigSnapshot::fromFile(path));
+    }
+}
+BENCHMARK(BM_ConfigParse);
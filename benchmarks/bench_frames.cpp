@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+#include "core/presets/PresetAtlas.h"
+#include "core/presets/PresetFeatureTable.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+    std::vector<unsigned char> syntheticFrame(int width, int height, int seed) {
+        std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+        uint32_t state = static_cast<uint32_t>(seed) * 2654435761u + 1u;
+        for (size_t i = 0; i < frame.size(); i += 4) {
+            state = state * 1664525u + 1013904223u;
+            frame[i] = static_cast<unsigned char>(state >> 24);
+            frame[i + 1] = static_cast<unsigned char>((i / 4) % width);
+            frame[i + 2] = static_cast<unsigned char>((i / 4) / width);
+            frame[i + 3] = 255;
+        }
+        return frame;
+    }
+}
+
+// Frame to thumbnail conversion done for every captured atlas frame.
+static void BM_FrameDownsample(benchmark::State& state) {
+    const int width = static_cast<int>(state.range(0));
+    const int height = static_cast<int>(state.range(1));
+    std::vector<unsigned char> frame = syntheticFrame(width, height, 1);
+    PresetAtlas::Layout layout;
+    std::vector<unsigned char> thumb(static_cast<size_t>(layout.thumbWidth) * layout.thumbHeight * 4);
+    for (auto _ : state) {
+        PresetAtlas::downsample(frame.data(), width, height, thumb.data(),
+                                layout.thumbWidth, layout.thumbHeight, layout.thumbWidth * 4);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_FrameDownsample)->Args({640, 360})->Args({1280, 720});
+
+// Per-preset feature extraction from the captured strip.
+static void BM_FrameFeatures(benchmark::State& state) {
+    const int width = 640;
+    const int height = 360;
+    std::vector<std::vector<unsigned char>> frames;
+    for (int i = 0; i < 8; ++i) {
+        frames.push_back(syntheticFrame(width, height, i));
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PresetFeatureTable::analyzeFrames(frames, width, height));
+    }
+    state.SetBytesProcessed(state.iterations() * frames.size() * frames[0].size());
+}
+BENCHMARK(BM_FrameFeatures);
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include "core/Logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    Logger::Settings benchSettings() {
+        Logger::Settings settings;
+        settings.console = false;
+        settings.repeatLimit = 0;
+        settings.threadBufferCapacity = 4096;
+        settings.flushIntervalMs = 5;
+        return settings;
+    }
+
+    Logger& sharedLogger() {
+        static Logger logger(benchSettings());
+        static bool started = (logger.start(), true);
+        (void)started;
+        return logger;
+    }
+}
+
+// Cost of a successful write(); the ring is drained outside the timed region.
+static void BM_LogWrite(benchmark::State& state) {
+    Logger logger(benchSettings());
+    const int batch = 1024;
+    for (auto _ : state) {
+        for (int i = 0; i < batch; ++i) {
+            benchmark::DoNotOptimize(logger.write(LogLevel::Info, LogCategory::Audio, "buffer underrun in data callback"));
+        }
+        state.PauseTiming();
+        logger.flush();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_LogWrite);
+
+// Sustained throughput with the flusher running; "dropped" is the share of
+// messages that did not fit because the flusher could not keep up.
+static void BM_LogWriteThreads(benchmark::State& state) {
+    Logger& logger = sharedLogger();
+    const uint64_t droppedBefore = logger.droppedCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(logger.write(LogLevel::Info, LogCategory::Audio, "buffer underrun in data callback"));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        logger.flush();
+        state.counters["dropped"] = benchmark::Counter(
+            static_cast<double>(logger.droppedCount() - droppedBefore) / (state.iterations() * state.threads()));
+    }
+}
+BENCHMARK(BM_LogWriteThreads)->ThreadRange(1, 8)->UseRealTime();
+
+// The path an audio callback takes when the flusher has fallen behind:
+// nothing may block, the message is simply counted.
+static void BM_LogWriteFullBuffer(benchmark::State& state) {
+    Logger::Settings settings = benchSettings();
+    settings.threadBufferCapacity = 16;
+    Logger logger(settings);
+    for (int i = 0; i < 16; ++i) {
+        logger.write(LogLevel::Info, LogCategory::Audio, "fill");
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(logger.write(LogLevel::Info, LogCategory::Audio, "dropped"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LogWriteFullBuffer);
+
+// Worst single write() seen while another thread floods the same logger,
+// i.e. the latency a real-time thread has to budget for.
+static void BM_LogWriteWorstCase(benchmark::State& state) {
+    Logger& logger = sharedLogger();
+    double worstNs = 0.0;
+    for (auto _ : state) {
+        auto begin = std::chrono::steady_clock::now();
+        logger.write(LogLevel::Warning, LogCategory::Audio, "xrun");
+        auto end = std::chrono::steady_clock::now();
+        worstNs = std::max(worstNs, std::chrono::duration<double, std::nano>(end - begin).count());
+    }
+    state.counters["worst_ns"] = benchmark::Counter(worstNs, benchmark::Counter::kAvgThreads);
+}
+BENCHMARK(BM_LogWriteWorstCase)->Threads(4)->UseRealTime();
+
+// Drain cost per message, including formatting-free history insertion.
+static void BM_LogDrain(benchmark::State& state) {
+    Logger::Settings settings = benchSettings();
+    settings.threadBufferCapacity = 1024;
+    Logger logger(settings);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < 1024; ++i) {
+            logger.write(LogLevel::Info, LogCategory::Console, "shader compile error");
+        }
+        state.ResumeTiming();
+        logger.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_LogDrain);
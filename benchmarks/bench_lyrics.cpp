@@ -0,0 +1,197 @@
+#include <benchmark/benchmark.h>
+#include "core/lyrics/LyricAligner.h"
+#include "core/lyrics/LyricImport.h"
+#include "core/lyrics/LyricTimeline.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // A long song: 400 lines of about 3 s with short gaps.
+    LyricTimeline benchTimeline() {
+        std::vector<LyricLine> lines;
+        double start = 2.0;
+        for (int i = 0; i < 400; ++i) {
+            LyricLine line;
+            line.text = "line " + std::to_string(i);
+            line.startTime = start;
+            line.endTime = start + 2.5 + (i % 3) * 0.5;
+            lines.push_back(line);
+            start = line.endTime + 0.25;
+        }
+        LyricTimeline timeline;
+        timeline.build(lines);
+        return timeline;
+    }
+
+    std::string timestamp(double seconds, bool hours, char separator) {
+        char text[32];
+        const int whole = static_cast<int>(seconds);
+        const int millis = static_cast<int>((seconds - whole) * 1000.0);
+        if (hours) {
+            std::snprintf(text, sizeof(text), "%02d:%02d:%02d%c%03d", whole / 3600, whole / 60 % 60, whole % 60, separator, millis);
+        } else {
+            std::snprintf(text, sizeof(text), "%02d:%02d%c%02d", whole / 60, whole % 60, separator, millis / 10);
+        }
+        return text;
+    }
+
+    // The same 400-line song with eight timed words per line in each format.
+    std::string benchLyrics(LyricFormat format) {
+        std::string out = format == LyricFormat::WebVtt ? "WEBVTT\n\n" : format == LyricFormat::Json ? "[" : "";
+        double start = 2.0;
+        for (int i = 0; i < 400; ++i) {
+            const double end = start + 2.5;
+            std::string text;
+            std::string json;
+            for (int w = 0; w < 8; ++w) {
+                const double wordStart = start + w * 0.3;
+                const std::string word = "word" + std::to_string(w);
+                if (format == LyricFormat::Lrc || format == LyricFormat::WebVtt) {
+                    text += "<" + timestamp(wordStart, format == LyricFormat::WebVtt, '.') + ">" + word + " ";
+                } else {
+                    text += word + " ";
+                }
+                json += std::string(w ? ", " : "") + "{\"text\": \"" + word + "\", \"start_time\": " +
+                        std::to_string(wordStart) + ", \"end_time\": " + std::to_string(wordStart + 0.3) + "}";
+            }
+            switch (format) {
+            case LyricFormat::Lrc:
+                out += "[" + timestamp(start, false, '.') + "]" + text + "\n";
+                break;
+            case LyricFormat::Srt:
+            case LyricFormat::WebVtt:
+                out += std::to_string(i + 1) + "\n" + timestamp(start, true, format == LyricFormat::Srt ? ',' : '.') +
+                       " --> " + timestamp(end, true, format == LyricFormat::Srt ? ',' : '.') + "\n" + text + "\n\n";
+                break;
+            case LyricFormat::Json:
+                out += std::string(i ? ", " : "") + "{\"text\": \"" + text + "\", \"start_time\": " +
+                       std::to_string(start) + ", \"end_time\": " + std::to_string(end) + ", \"words\": [" + json + "]}";
+                break;
+            case LyricFormat::Unknown:
+                break;
+            }
+            start = end + 0.25;
+        }
+        if (format == LyricFormat::Json) {
+            out += "]";
+        }
+        return out;
+    }
+
+    // About three minutes at 44.1 kHz: six sections of eight sung lines,
+    // each line eight centred tone bursts, over a wide noise bed.
+    struct AlignSong {
+        std::vector<short> pcm;
+        std::string text;
+    };
+
+    AlignSong alignSong() {
+        const int rate = 44100;
+        AlignSong song;
+        uint32_t noise = 1;
+        double t = 0.0;
+        auto add = [&](double seconds, bool sung) {
+            for (int i = 0; i < static_cast<int>(seconds * rate); ++i, t += 1.0 / rate) {
+                noise = noise * 1664525u + 1013904223u;
+                const float side = ((noise >> 16) / 32768.0f - 1.0f) * 3000.0f;
+                const float vocal = sung ? 8000.0f * static_cast<float>(std::sin(2.0 * M_PI * 440.0 * t)) : 0.0f;
+                song.pcm.push_back(static_cast<short>(vocal + side));
+                song.pcm.push_back(static_cast<short>(vocal - side));
+            }
+        };
+        for (int s = 0; s < 6; ++s) {
+            song.text += "[Section " + std::to_string(s) + "]\n";
+            add(4.0, false);
+            for (int l = 0; l < 8; ++l) {
+                for (int w = 0; w < 8; ++w) {
+                    add(0.2, true);
+                    add(0.1, false);
+                    song.text += w ? " la" : "la";
+                }
+                song.text += "\n";
+                add(0.6, false);
+            }
+        }
+        return song;
+    }
+
+    void parseLyrics(benchmark::State& state, LyricFormat format) {
+        const std::string content = benchLyrics(format);
+        for (auto _ : state) {
+            std::vector<LyricLine> lines;
+            LyricImport::parse(content, format, lines);
+            benchmark::DoNotOptimize(lines.data());
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * content.size()));
+    }
+}
+
+// Frame-by-frame playback, as the lyric timer and exports query.
+static void BM_LyricCursorPlayback(benchmark::State& state) {
+    const LyricTimeline timeline = benchTimeline();
+    const double end = timeline.line(timeline.size() - 1).endTime;
+    LyricTimeline::Cursor cursor(&timeline);
+    double time = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cursor.seek(time));
+        time += 1.0 / 60.0;
+        if (time > end) {
+            time = 0.0;
+        }
+    }
+}
+BENCHMARK(BM_LyricCursorPlayback);
+
+// Random access, as when seeking or rendering segments in parallel.
+static void BM_LyricLookupRandom(benchmark::State& state) {
+    const LyricTimeline timeline = benchTimeline();
+    const double end = timeline.line(timeline.size() - 1).endTime;
+    double time = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(timeline.lineAt(time));
+        time = std::fmod(time + 97.31, end);
+    }
+}
+BENCHMARK(BM_LyricLookupRandom);
+
+// The linear scan the timeline replaces, for comparison.
+static void BM_LyricLookupLinearScan(benchmark::State& state) {
+    const LyricTimeline timeline = benchTimeline();
+    const double end = timeline.line(timeline.size() - 1).endTime;
+    double time = 0.0;
+    for (auto _ : state) {
+        int found = -1;
+        for (size_t i = 0; i < timeline.size(); ++i) {
+            if (timeline.line(i).startTime <= time && time < timeline.line(i).endTime) {
+                found = static_cast<int>(i);
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        time = std::fmod(time + 97.31, end);
+    }
+}
+BENCHMARK(BM_LyricLookupLinearScan);
+
+// Whole-file import throughput per format.
+static void BM_ParseLrc(benchmark::State& state) { parseLyrics(state, LyricFormat::Lrc); }
+BENCHMARK(BM_ParseLrc);
+
+static void BM_ParseSrt(benchmark::State& state) { parseLyrics(state, LyricFormat::Srt); }
+BENCHMARK(BM_ParseSrt);
+
+static void BM_ParseWebVtt(benchmark::State& state) { parseLyrics(state, LyricFormat::WebVtt); }
+BENCHMARK(BM_ParseWebVtt);
+
+static void BM_ParseJson(benchmark::State& state) { parseLyrics(state, LyricFormat::Json); }
+BENCHMARK(BM_ParseJson);
+
+static void BM_AlignLyrics(benchmark::State& state) {
+    static const AlignSong song = alignSong();
+    LyricAligner::Options options;
+    options.threads = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        auto lines = LyricAligner::align(song.text, song.pcm.data(), song.pcm.size() / 2, 44100, options);
+        benchmark::DoNotOptimize(lines.data());
+    }
+}
+BENCHMARK(BM_AlignLyrics)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
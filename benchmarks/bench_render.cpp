@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+#include "core/Config.h"
+#include "bench_util.h"
+#include <libprojectM/projectM.hpp>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLVersionFunctionsFactory>
+#include <memory>
+
+// Macro benchmarks: N projectM frames into an offscreen FBO at fixed
+// resolutions, optionally reading every frame back as video export does.
+// Needs a GL 3.3 driver; QT_QPA_PLATFORM=offscreen with Mesa llvmpipe works.
+
+namespace {
+    const int FRAMES_PER_ITERATION = 60;
+    const int FPS = 60;
+
+    void ensureApplication() {
+        static int argc = 1;
+        static char name[] = "AuroraBench";
+        static char* argv[] = {name, nullptr};
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        static QGuiApplication app(argc, argv);
+    }
+
+    struct OffscreenTarget {
+        QOffscreenSurface surface;
+        QOpenGLContext context;
+        QOpenGLFunctions_3_3_Core* gl = nullptr;
+        GLuint fbo = 0;
+        GLuint texture = 0;
+
+        bool create(int width, int height) {
+            QSurfaceFormat format;
+            format.setVersion(3, 3);
+            format.setProfile(QSurfaceFormat::CoreProfile);
+            surface.setFormat(format);
+            surface.create();
+            context.setFormat(format);
+            if (!context.create() || !context.makeCurrent(&surface)) {
+                return false;
+            }
+            gl = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(&context);
+            if (!gl || !gl->initializeOpenGLFunctions()) {
+                return false;
+            }
+            gl->glGenTextures(1, &texture);
+            gl->glBindTexture(GL_TEXTURE_2D, texture);
+            gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            gl->glGenFramebuffers(1, &fbo);
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+            return gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        }
+
+        ~OffscreenTarget() {
+            if (gl) {
+                gl->glDeleteFramebuffers(1, &fbo);
+                gl->glDeleteTextures(1, &texture);
+            }
+            context.doneCurrent();
+        }
+    };
+
+    void renderFrames(benchmark::State& state, bool readback) {
+        ensureApplication();
+        const int width = static_cast<int>(state.range(0));
+        const int height = static_cast<int>(state.range(1));
+        OffscreenTarget target;
+        if (!target.create(width, height)) {
+            state.SkipWithError("No OpenGL 3.3 core context available");
+            return;
+        }
+
+        projectM::Settings settings;
+        settings.meshX = 32;
+        settings.meshY = 24;
+        settings.fps = FPS;
+        settings.textureSize = 512;
+        settings.windowWidth = width;
+        settings.windowHeight = height;
+        settings.presetURL = Config().presetDirectory().toStdString();
+        settings.smoothPresetDuration = 0;
+        settings.presetDuration = 1000000;
+        settings.shuffleEnabled = false;
+        auto pm = std::make_unique<projectM>(settings);
+        pm->setPresetLock(true);
+        if (pm->getPlaylistSize() > 0) {
+            pm->selectPreset(0, true);
+        }
+
+        const size_t pcmPerFrame = 44100 / FPS;
+        std::vector<short> pcm = bench::syntheticPcm(pcmPerFrame * FRAMES_PER_ITERATION);
+        std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+
+        for (auto _ : state) {
+            for (int f = 0; f < FRAMES_PER_ITERATION; ++f) {
+                pm->pcm()->addPCM16Data(&pcm[f * pcmPerFrame * 2], static_cast<short>(pcmPerFrame));
+                target.gl->glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+                target.gl->glViewport(0, 0, width, height);
+                pm->renderFrame();
+                if (readback) {
+                    target.gl->glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame.data());
+                }
+            }
+            target.gl->glFinish();
+        }
+        // Seconds per frame; shown as e.g. "16.2m" by the console reporter.
+        state.counters["frame_time"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * FRAMES_PER_ITERATION),
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+}
+
+static void BM_RenderFrames(benchmark::State& state) {
+    renderFrames(state, false);
+}
+BENCHMARK(BM_RenderFrames)->Args({1280, 720})->Args({1920, 1080})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_RenderFramesReadback(benchmark::State& state) {
+    renderFrames(state, true);
+}
+BENCHMARK(BM_RenderFramesReadback)->Args({1280, 720})->Args({1920, 1080})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+#include "core/animation/KeyframeAnimation.h"
+#include "core/animation/TitleAnimation.h"
+#include "core/text/FontMetrics.h"
+#include "core/text/LineBreaker.h"
+#include "bench_util.h"
+
+// TextRenderer::getTextBounds, which runs for every text draw.
+static void BM_TextBoundsTitle(benchmark::State& state) {
+    FontMetrics metrics = bench::syntheticFont();
+    const std::string title = bench::sampleTitle();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.measure(title, 1.0f));
+    }
+    state.SetBytesProcessed(state.iterations() * title.size());
+}
+BENCHMARK(BM_TextBoundsTitle);
+
+static void BM_TextBoundsLyrics(benchmark::State& state) {
+    FontMetrics metrics = bench::syntheticFont();
+    std::string lyrics = bench::sampleLyrics();
+    for (size_t i = 60; i < lyrics.size(); i += 60) {
+        lyrics[lyrics.find(' ', i)] = '\n';
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.measure(lyrics, 0.75f));
+    }
+    state.SetBytesProcessed(state.iterations() * lyrics.size());
+}
+BENCHMARK(BM_TextBoundsLyrics);
+
+// SongTitleAnimator evaluation per frame; scattered times, as when scrubbing.
+static void BM_TitleAnimationEvaluate(benchmark::State& state) {
+    const FontMetrics metrics = bench::syntheticFont();
+    const TextBounds bounds = metrics.measure(bench::sampleTitle(), 1.0f);
+    const TitleAnimation::Settings settings;
+    double time = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TitleAnimation::evaluate(time, 240.0, settings, bounds, 1920.0f, 1080.0f));
+        time = std::fmod(time + 7.3, 240.0);
+    }
+}
+BENCHMARK(BM_TitleAnimationEvaluate);
+
+// Keyframed overlay animation: 32 elements with every property animated,
+// evaluated from the baked table and, for comparison, from the keyframes.
+static KeyframeAnimation benchOverlayAnimation() {
+    KeyframeAnimation animation;
+    for (int e = 0; e < 32; ++e) {
+        for (int p = 0; p < KeyframeAnimation::PROPERTY_COUNT; ++p) {
+            for (int k = 0; k < 16; ++k) {
+                animation.addKeyframe("element" + std::to_string(e), static_cast<AnimationProperty>(p),
+                                      {k * 4.0f, std::sin(static_cast<float>(e + p + k)), Easing::EaseInOut});
+            }
+        }
+    }
+    animation.bake();
+    return animation;
+}
+
+static void BM_OverlayAnimationBaked(benchmark::State& state) {
+    const KeyframeAnimation animation = benchOverlayAnimation();
+    std::vector<OverlayPose> poses;
+    double time = 0.0;
+    for (auto _ : state) {
+        animation.evaluate(time, poses);
+        benchmark::DoNotOptimize(poses.data());
+        time = std::fmod(time + 1.0 / 60.0, animation.duration());
+    }
+    state.SetItemsProcessed(state.iterations() * animation.elementCount());
+}
+BENCHMARK(BM_OverlayAnimationBaked);
+
+static void BM_OverlayAnimationKeyframes(benchmark::State& state) {
+    const KeyframeAnimation animation = benchOverlayAnimation();
+    double time = 0.0;
+    for (auto _ : state) {
+        for (size_t e = 0; e < animation.elementCount(); ++e) {
+            for (int p = 0; p < KeyframeAnimation::PROPERTY_COUNT; ++p) {
+                benchmark::DoNotOptimize(animation.interpolate(e, static_cast<AnimationProperty>(p), time));
+            }
+        }
+        time = std::fmod(time + 1.0 / 60.0, animation.duration());
+    }
+    state.SetItemsProcessed(state.iterations() * animation.elementCount());
+}
+BENCHMARK(BM_OverlayAnimationKeyframes);
+
+// Balanced line breaking of a ~300 character lyric, uncached (target < 50 us)
+// and through the cache as the renderer calls it every frame.
+static void BM_LineBreakLyrics(benchmark::State& state) {
+    const FontMetrics metrics = bench::syntheticFont();
+    const std::string lyrics = bench::sampleLyrics();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LineBreaker::breakLines(lyrics, metrics, 0.75f, 900.0f));
+    }
+    state.SetBytesProcessed(state.iterations() * lyrics.size());
+}
+BENCHMARK(BM_LineBreakLyrics);
+
+static void BM_LineBreakTitle(benchmark::State& state) {
+    const FontMetrics metrics = bench::syntheticFont();
+    const std::string title = bench::sampleTitle();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LineBreaker::breakLines(title, metrics, 1.0f, 700.0f));
+    }
+}
+BENCHMARK(BM_LineBreakTitle);
+
+static void BM_LineBreakCached(benchmark::State& state) {
+    const FontMetrics metrics = bench::syntheticFont();
+    const std::string lyrics = bench::sampleLyrics();
+    LineBreaker breaker;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(breaker.wrap(lyrics, metrics, 0.75f, 900.0f));
+    }
+}
+BENCHMARK(BM_LineBreakCached);
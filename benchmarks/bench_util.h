@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/text/FontMetrics.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic inputs shared by the benchmarks, so runs are comparable
+// across machines without fonts or media files.
+namespace bench {
+
+    // Interleaved stereo s16: two detuned tones plus a little noise.
+    inline std::vector<short> syntheticPcm(size_t frames, int sampleRate = 44100) {
+        std::vector<short> pcm(frames * 2);
+        uint32_t noise = 12345;
+        for (size_t i = 0; i < frames; ++i) {
+            const double t = static_cast<double>(i) / sampleRate;
+            noise = noise * 1664525u + 1013904223u;
+            const double n = (static_cast<int>(noise >> 16) - 32768) / 32768.0;
+            pcm[i * 2] = static_cast<short>(12000.0 * std::sin(2.0 * M_PI * 110.0 * t) + 1000.0 * n);
+            pcm[i * 2 + 1] = static_cast<short>(12000.0 * std::sin(2.0 * M_PI * 110.5 * t) + 1000.0 * n);
+        }
+        return pcm;
+    }
+
+    // Roughly DejaVu Sans at 48 px: proportional advances, descenders on a few letters.
+    inline FontMetrics syntheticFont() {
+        FontMetrics metrics;
+        metrics.setLineHeight(56.0f);
+        for (int c = 32; c < 127; ++c) {
+            GlyphMetrics glyph;
+            const bool narrow = c == 'i' || c == 'l' || c == 'j' || c == '.' || c == ',' || c == '\'';
+            const bool wide = c == 'm' || c == 'w' || c == 'M' || c == 'W';
+            glyph.advance = c == ' ' ? 15.0f : narrow ? 13.0f : wide ? 42.0f : 29.0f;
+            glyph.width = c == ' ' ? 0.0f : glyph.advance - 4.0f;
+            glyph.height = (c >= 'A' && c <= 'Z') ? 35.0f : 26.0f;
+            glyph.bearingX = 2.0f;
+            glyph.bearingY = (c == 'g' || c == 'p' || c == 'q' || c == 'y') ? 26.0f - 10.0f : glyph.height;
+            metrics.setGlyph(static_cast<unsigned char>(c), glyph);
+        }
+        return metrics;
+    }
+
+    inline std::string sampleTitle() {
+        return "Midnight Carousel (Extended Club Mix) feat. The Northern Lights";
+    }
+
+    // About 300 characters of lyric text.
+    inline std::string sampleLyrics() {
+        return "We were running through the static with our headlights turned down low, "
+               "every signal in the city singing songs we used to know, and the river "
+               "kept on turning like a record in the rain, so I held on to the echo "
+               "till it called me home again, till the morning broke the silence and "
+               "the neon let us go";
+    }
+}
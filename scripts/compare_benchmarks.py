@@ -0,0 +1,71 @@
+import sys
+import json
+import argparse
+
+# Compares two Google Benchmark JSON files (AuroraBench --benchmark_out=...)
+# and exits non-zero when any benchmark got slower than the threshold allows.
+# With repetitions, the median aggregate is compared; otherwise the single run.
+
+
+def load_times(path):
+    with open(path) as f:
+        data = json.load(f)
+
+    times = {}
+    medians = {}
+    for entry in data.get("benchmarks", []):
+        if entry.get("error_occurred"):
+            continue
+        name = entry.get("run_name", entry["name"])
+        time = entry.get("real_time")
+        if time is None:
+            continue
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[name] = time
+        else:
+            times.setdefault(name, time)
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gate AuroraBench results against a baseline.")
+    parser.add_argument("baseline", help="Baseline JSON from AuroraBench")
+    parser.add_argument("current", help="Current JSON from AuroraBench")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="Allowed relative slowdown before failing (default: 0.10)")
+    parser.add_argument("--filter", default="", help="Only compare benchmarks whose name contains this")
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline)
+    current = load_times(args.current)
+
+    regressions = []
+    print(f"{'benchmark':60} {'baseline':>12} {'current':>12} {'change':>8}")
+    for name in sorted(current):
+        if args.filter not in name:
+            continue
+        if name not in baseline:
+            print(f"{name:60} {'-':>12} {current[name]:12.1f}      new")
+            continue
+        before = baseline[name]
+        after = current[name]
+        change = (after - before) / before if before > 0 else 0.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+        print(f"{name:60} {before:12.1f} {after:12.1f} {change:+7.1%}{marker}")
+
+    for name in sorted(set(baseline) - set(current)):
+        if args.filter in name:
+            print(f"{name:60} {baseline[name]:12.1f} {'-':>12}  missing")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed by more than {args.threshold:.0%}.", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
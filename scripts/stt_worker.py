@@ -0,0 +1,156 @@
+import sys
+import json
+import time
+import queue
+import argparse
+import threading
+
+# Resident STT worker for aurora-visualizer (see src/core/stt/SttProtocol.h).
+# Reads framed requests on stdin, keeps the model loaded between files and
+# streams timed segments back on stdout as they are recognized. Frames are
+# "<payload length> <payload>\n" with the length in bytes; diagnostics go to
+# stderr only.
+#
+#   python3 stt_worker.py [--model small] [--mock]
+#
+# With --mock it produces placeholder segments, which is what development
+# builds use. Without --mock, a missing faster-whisper is reported as an
+# error frame for job 0 and the worker exits.
+
+ENGINE_VERSION = "1"
+
+
+class Channel:
+    def __init__(self, reader, writer):
+        self.reader = reader
+        self.writer = writer
+        self.lock = threading.Lock()
+
+    def read(self):
+        header = b""
+        while True:
+            c = self.reader.read(1)
+            if not c:
+                return None
+            if c == b" ":
+                break
+            if not c.isdigit() or len(header) > 10:
+                # Not a frame; drop the rest of the line.
+                self.reader.readline()
+                header = b""
+                continue
+            header += c
+        length = int(header)
+        payload = self.reader.read(length)
+        if len(payload) < length or self.reader.read(1) != b"\n":
+            return None
+        return payload.decode("utf-8", errors="replace")
+
+    def send(self, command, job=0, body=None):
+        payload = f"{command} {job}" if body is None else f"{command} {job} {body}"
+        data = payload.encode("utf-8")
+        with self.lock:
+            self.writer.write(str(len(data)).encode("ascii") + b" " + data + b"\n")
+            self.writer.flush()
+
+
+class MockEngine:
+    name = "mock"
+
+    def segments(self, path, cancelled):
+        # A few evenly spaced lines with word timings, produced at a steady
+        # pace so streaming is visible.
+        words = ["streamed", "lyrics", "from", "the", "mock", "worker"]
+        for index in range(8):
+            if cancelled():
+                return
+            start = 1.0 + index * 3.0
+            timed = [{"text": w, "start_time": round(start + k * 0.4, 3), "end_time": round(start + (k + 1) * 0.4, 3)}
+                     for k, w in enumerate(words)]
+            yield {"text": " ".join(words), "start_time": start, "end_time": start + 2.5, "words": timed}
+            time.sleep(0.05)
+
+
+class WhisperEngine:
+    def __init__(self, model_name):
+        from faster_whisper import WhisperModel
+        self.model = WhisperModel(model_name)
+        self.name = f"faster-whisper/{model_name}"
+
+    def segments(self, path, cancelled):
+        results, _ = self.model.transcribe(path, word_timestamps=True)
+        for segment in results:
+            if cancelled():
+                return
+            words = [{"text": w.word.strip(), "start_time": w.start, "end_time": w.end} for w in (segment.words or [])]
+            yield {"text": segment.text.strip(), "start_time": segment.start, "end_time": segment.end, "words": words}
+
+
+def make_engine(args):
+    if args.mock:
+        return MockEngine()
+    return WhisperEngine(args.model)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Resident speech-to-text worker.")
+    parser.add_argument("--model", default="small")
+    parser.add_argument("--mock", action="store_true")
+    args = parser.parse_args()
+
+    channel = Channel(sys.stdin.buffer, sys.stdout.buffer)
+    try:
+        engine = make_engine(args)
+    except Exception as error:
+        # Placeholder lines would be shown and cached as a real transcript.
+        print(f"faster-whisper unavailable: {error}", file=sys.stderr)
+        channel.send("error", 0, f"speech engine unavailable: {error}".replace("\n", " "))
+        sys.exit(1)
+    channel.send("ready", 0, f"{engine.name} v{ENGINE_VERSION}")
+
+    jobs = queue.Queue()
+    cancelled = set()
+
+    def transcribe_loop():
+        while True:
+            item = jobs.get()
+            if item is None:
+                return
+            job, path = item
+            if job in cancelled:
+                continue
+            print(f"Transcribing {path}", file=sys.stderr)
+            try:
+                for segment in engine.segments(path, lambda: job in cancelled):
+                    channel.send("segments", job, json.dumps([segment], ensure_ascii=False))
+                if job not in cancelled:
+                    channel.send("done", job)
+            except BrokenPipeError:
+                return
+            except Exception as error:
+                channel.send("error", job, str(error).replace("\n", " "))
+
+    worker = threading.Thread(target=transcribe_loop, daemon=True)
+    worker.start()
+
+    while True:
+        payload = channel.read()
+        if payload is None:
+            break
+        command, _, rest = payload.partition(" ")
+        job_text, _, body = rest.partition(" ")
+        if command == "quit":
+            break
+        if not job_text.isdigit():
+            continue
+        if command == "transcribe":
+            jobs.put((int(job_text), body))
+        elif command == "cancel":
+            cancelled.add(int(job_text))
+
+    jobs.put(None)
+    worker.join(timeout=5)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D screenTexture;
+uniform vec2 texelSize;
+uniform float sharpness;
+
+// Bilinear upscale followed by a small unsharp mask to recover edges lost
+// when the layer was rendered below window resolution.
+void main()
+{
+    vec4 center = texture(screenTexture, TexCoord);
+    vec4 neighbours = texture(screenTexture, TexCoord + vec2(texelSize.x, 0.0))
+                    + texture(screenTexture, TexCoord - vec2(texelSize.x, 0.0))
+                    + texture(screenTexture, TexCoord + vec2(0.0, texelSize.y))
+                    + texture(screenTexture, TexCoord - vec2(0.0, texelSize.y));
+    FragColor = clamp(center + sharpness * (4.0 * center - neighbours), 0.0, 1.0);
+}
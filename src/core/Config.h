@@ -7,55 +7,245 @@
 #include <QDir>
 #include <QCoreApplication>
 
-class Config
+// Every setting parsed once into typed fields. Snapshots are never modified
+// after publication; a reload builds a new one (see ConfigStore).
+struct ConfigSnapshot
 {
-public:
-    Config()
+    QString filePath;
+
+    bool audioDecodeToMemory = false;
+    bool audioSharedDecode = false;
+    float audioLoudnessTarget = -14.0f;
+    float audioMaxGainDb = 12.0f;
+    bool audioNormalizePlayback = true;
+    bool audioNormalizeVisualization = true;
+
+    bool dynamicsEnabled = true;
+    float dynamicsTargetDb = -18.0f;
+    float dynamicsMaxGainDb = 18.0f;
+    float dynamicsAgcSeconds = 3.0f;
+    float dynamicsThresholdDb = -6.0f;
+    float dynamicsRatio = 4.0f;
+    float dynamicsAttackMs = 5.0f;
+    float dynamicsReleaseMs = 200.0f;
+    float dynamicsLookaheadMs = 5.0f;
+    bool dynamicsSplitBands = false;
+    float dynamicsCrossoverHz = 200.0f;
+
+    QString fontPath = "/usr/share/fonts/TTF/DejaVuSans.ttf";
+    int fontSize = 48;
+    bool shuffleEnabled = false;
+    bool sectionPresetSwitching = true;
+    QString presetDirectory = "/usr/share/projectM/presets";
+    QString presetAtlasDirectory;
+    QString presetFeaturesPath;
+
+    int titleLineLengthTarget = 20;
+    int lyricsLineLengthTarget = 40;
+    QColor lyricsHighlightColor = QColor(255, 217, 77);
+    QString sttWorkerCommand = "python3 scripts/stt_worker.py";
+    QString sttCacheDirectory;
+    int sttCacheSizeMb = 64;
+    QColor titleColor = QColor::fromRgbF(1.0f, 1.0f, 1.0f, 1.0f);
+
+    QString timelineCacheDirectory;
+    int timelineCacheSizeMb = 256;
+
+    QString sunoDownloadDirectory;
+    QString sunoAudioUrl = "https://cdn1.suno.ai/{id}.mp3";
+    int sunoMaxDownloads = 3;
+
+    bool presetTransitionsEnabled = true;
+    QString presetTransitionStyle = "crossfade";
+    float presetTransitionDuration = 2.0f;
+    bool presetTransitionBeatSync = true;
+
+    float visualizerRenderScale = 1.0f;
+    bool dynamicResolutionEnabled = false;
+    float dynamicResolutionTargetFps = 60.0f;
+    float dynamicResolutionMinScale = 0.5f;
+    float upscaleSharpness = 0.25f;
+    bool showStatsOverlay = false;
+
+    int videoFps = 30;
+
+    float animationFadeDuration = 3.0f;
+    float animationBounceDuration = 10.0f;
+    float animationTargetAlpha = 0.4f;
+    QString overlayAnimationPath;
+
+    QString logFilePath;
+
+    static QString locateFile()
     {
         QString userConfigPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
         QString userConfigFile = userConfigPath + "/aurora-visualizer/config.ini";
         QString localConfigFile = QCoreApplication::applicationDirPath() + "/config.ini";
 
         if (QFile::exists(userConfigFile)) {
-            m_settings = new QSettings(userConfigFile, QSettings::IniFormat);
+            return userConfigFile;
         } else if (QFile::exists(localConfigFile)) {
-            m_settings = new QSettings(localConfigFile, QSettings::IniFormat);
-        } else {
-            // Fallback to a dummy QSettings object if no config file is found
-            m_settings = new QSettings("dummy", QSettings::IniFormat);
+            return localConfigFile;
         }
+        return QString();
     }
 
-    ~Config()
+    static ConfigSnapshot fromFile(const QString& path)
     {
-        delete m_settings;
-    }
+        ConfigSnapshot c;
+        QString configDir = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/aurora-visualizer";
+        c.presetAtlasDirectory = configDir + "/preset_atlas";
+        c.presetFeaturesPath = configDir + "/preset_features.tsv";
+        c.sttCacheDirectory = configDir + "/lyric_cache";
+        c.sunoDownloadDirectory = configDir + "/suno_downloads";
+        c.timelineCacheDirectory = configDir + "/overview_cache";
+        c.filePath = path;
+        if (path.isEmpty() || !QFile::exists(path)) {
+            return c;
+        }
 
-    QString fontPath() const { return value("Font/path", "/usr/share/fonts/TTF/DejaVuSans.ttf").toString(); }
-    int fontSize() const { return value("Font/size", 48).toInt(); }
-    bool shuffleEnabled() const { return value("Visualizer/shuffle", false).toBool(); }
+        QSettings s(path, QSettings::IniFormat);
+        c.audioDecodeToMemory = s.value("Audio/decode_to_memory", c.audioDecodeToMemory).toBool();
+        c.audioSharedDecode = s.value("Audio/shared_decode", c.audioSharedDecode).toBool();
+        c.audioLoudnessTarget = s.value("Audio/loudness_target", c.audioLoudnessTarget).toFloat();
+        c.audioMaxGainDb = s.value("Audio/max_gain_db", c.audioMaxGainDb).toFloat();
+        c.audioNormalizePlayback = s.value("Audio/normalize_playback", c.audioNormalizePlayback).toBool();
+        c.audioNormalizeVisualization =
+            s.value("Audio/normalize_visualization", c.audioNormalizeVisualization).toBool();
 
-    int titleLineLengthTarget() const { return value("Title/line_length_target", 20).toInt(); }
-    int lyricsLineLengthTarget() const { return value("Lyrics/line_length_target", 40).toInt(); }
-    QColor titleColor() const
-    {
-        return QColor::fromRgbF(
-            value("Title/color_r", 1.0).toFloat(),
-            value("Title/color_g", 1.0).toFloat(),
-            value("Title/color_b", 1.0).toFloat(),
-            value("Title/opacity", 1.0).toFloat()
+        c.dynamicsEnabled = s.value("Dynamics/enabled", c.dynamicsEnabled).toBool();
+        c.dynamicsTargetDb = s.value("Dynamics/target_db", c.dynamicsTargetDb).toFloat();
+        c.dynamicsMaxGainDb = s.value("Dynamics/max_gain_db", c.dynamicsMaxGainDb).toFloat();
+        c.dynamicsAgcSeconds = s.value("Dynamics/agc_time", c.dynamicsAgcSeconds).toFloat();
+        c.dynamicsThresholdDb = s.value("Dynamics/threshold_db", c.dynamicsThresholdDb).toFloat();
+        c.dynamicsRatio = s.value("Dynamics/ratio", c.dynamicsRatio).toFloat();
+        c.dynamicsAttackMs = s.value("Dynamics/attack_ms", c.dynamicsAttackMs).toFloat();
+        c.dynamicsReleaseMs = s.value("Dynamics/release_ms", c.dynamicsReleaseMs).toFloat();
+        c.dynamicsLookaheadMs = s.value("Dynamics/lookahead_ms", c.dynamicsLookaheadMs).toFloat();
+        c.dynamicsSplitBands = s.value("Dynamics/split_bands", c.dynamicsSplitBands).toBool();
+        c.dynamicsCrossoverHz = s.value("Dynamics/crossover_hz", c.dynamicsCrossoverHz).toFloat();
+
+        c.fontPath = s.value("Font/path", c.fontPath).toString();
+        c.fontSize = s.value("Font/size", c.fontSize).toInt();
+        c.shuffleEnabled = s.value("Visualizer/shuffle", c.shuffleEnabled).toBool();
+        c.sectionPresetSwitching = s.value("Visualizer/section_switching", c.sectionPresetSwitching).toBool();
+        c.presetDirectory = s.value("Visualizer/preset_path", c.presetDirectory).toString();
+        c.presetAtlasDirectory = s.value("Visualizer/preset_atlas", c.presetAtlasDirectory).toString();
+        c.presetFeaturesPath = s.value("Visualizer/preset_features", c.presetFeaturesPath).toString();
+
+        c.titleLineLengthTarget = s.value("Title/line_length_target", c.titleLineLengthTarget).toInt();
+        c.lyricsLineLengthTarget = s.value("Lyrics/line_length_target", c.lyricsLineLengthTarget).toInt();
+        c.lyricsHighlightColor = QColor(s.value("Lyrics/highlight_color", c.lyricsHighlightColor.name()).toString());
+        c.sttWorkerCommand = s.value("Lyrics/stt_command", c.sttWorkerCommand).toString();
+        c.sttCacheDirectory = s.value("Lyrics/cache_dir", c.sttCacheDirectory).toString();
+        c.sttCacheSizeMb = s.value("Lyrics/cache_size_mb", c.sttCacheSizeMb).toInt();
+        c.titleColor = QColor::fromRgbF(
+            s.value("Title/color_r", 1.0).toFloat(),
+            s.value("Title/color_g", 1.0).toFloat(),
+            s.value("Title/color_b", 1.0).toFloat(),
+            s.value("Title/opacity", 1.0).toFloat()
         );
-    }
 
-    float animationFadeDuration() const { return value("Animation/fade_duration", 3.0f).toFloat(); }
-    float animationBounceDuration() const { return value("Animation/bounce_duration", 10.0f).toFloat(); }
-    float animationTargetAlpha() const { return value("Animation/target_alpha", 0.4f).toFloat(); }
+        c.timelineCacheDirectory = s.value("Timeline/cache_dir", c.timelineCacheDirectory).toString();
+        c.timelineCacheSizeMb = s.value("Timeline/cache_size_mb", c.timelineCacheSizeMb).toInt();
 
-private:
-    QVariant value(const QString& key, const QVariant& defaultValue) const
-    {
-        return m_settings->value(key, defaultValue);
+        c.sunoDownloadDirectory = s.value("Suno/download_dir", c.sunoDownloadDirectory).toString();
+        c.sunoAudioUrl = s.value("Suno/audio_url", c.sunoAudioUrl).toString();
+        c.sunoMaxDownloads = s.value("Suno/max_downloads", c.sunoMaxDownloads).toInt();
+
+        c.presetTransitionsEnabled = s.value("Transition/enabled", c.presetTransitionsEnabled).toBool();
+        c.presetTransitionStyle = s.value("Transition/style", c.presetTransitionStyle).toString();
+        c.presetTransitionDuration = s.value("Transition/duration", c.presetTransitionDuration).toFloat();
+        c.presetTransitionBeatSync = s.value("Transition/beat_sync", c.presetTransitionBeatSync).toBool();
+
+        c.visualizerRenderScale = s.value("Render/visualizer_scale", c.visualizerRenderScale).toFloat();
+        c.dynamicResolutionEnabled = s.value("Render/dynamic_resolution", c.dynamicResolutionEnabled).toBool();
+        c.dynamicResolutionTargetFps = s.value("Render/target_fps", c.dynamicResolutionTargetFps).toFloat();
+        c.dynamicResolutionMinScale = s.value("Render/min_scale", c.dynamicResolutionMinScale).toFloat();
+        c.upscaleSharpness = s.value("Render/sharpness", c.upscaleSharpness).toFloat();
+        c.showStatsOverlay = s.value("Render/show_stats", c.showStatsOverlay).toBool();
+
+        c.videoFps = s.value("Video/fps", c.videoFps).toInt();
+
+        c.animationFadeDuration = s.value("Animation/fade_duration", c.animationFadeDuration).toFloat();
+        c.animationBounceDuration = s.value("Animation/bounce_duration", c.animationBounceDuration).toFloat();
+        c.animationTargetAlpha = s.value("Animation/target_alpha", c.animationTargetAlpha).toFloat();
+        c.overlayAnimationPath = s.value("Animation/overlay_file", c.overlayAnimationPath).toString();
+
+        c.logFilePath = s.value("Log/file", c.logFilePath).toString();
+        return c;
     }
+};
+
+// Read-only view of the current ConfigSnapshot. Holding a Config is free and
+// every accessor is a single atomic pointer load, so hot paths never touch
+// QSettings. Code that reads several values that must agree should take
+// snapshot() once instead.
+class Config
+{
+public:
+    static const ConfigSnapshot& snapshot();
+
+    bool audioDecodeToMemory() const { return snapshot().audioDecodeToMemory; }
+    bool audioSharedDecode() const { return snapshot().audioSharedDecode; }
+    float audioLoudnessTarget() const { return snapshot().audioLoudnessTarget; }
+    float audioMaxGainDb() const { return snapshot().audioMaxGainDb; }
+    bool audioNormalizePlayback() const { return snapshot().audioNormalizePlayback; }
+    bool audioNormalizeVisualization() const { return snapshot().audioNormalizeVisualization; }
+
+    bool dynamicsEnabled() const { return snapshot().dynamicsEnabled; }
+    float dynamicsTargetDb() const { return snapshot().dynamicsTargetDb; }
+    float dynamicsMaxGainDb() const { return snapshot().dynamicsMaxGainDb; }
+    float dynamicsAgcSeconds() const { return snapshot().dynamicsAgcSeconds; }
+    float dynamicsThresholdDb() const { return snapshot().dynamicsThresholdDb; }
+    float dynamicsRatio() const { return snapshot().dynamicsRatio; }
+    float dynamicsAttackMs() const { return snapshot().dynamicsAttackMs; }
+    float dynamicsReleaseMs() const { return snapshot().dynamicsReleaseMs; }
+    float dynamicsLookaheadMs() const { return snapshot().dynamicsLookaheadMs; }
+    bool dynamicsSplitBands() const { return snapshot().dynamicsSplitBands; }
+    float dynamicsCrossoverHz() const { return snapshot().dynamicsCrossoverHz; }
+
+    QString fontPath() const { return snapshot().fontPath; }
+    int fontSize() const { return snapshot().fontSize; }
+    bool shuffleEnabled() const { return snapshot().shuffleEnabled; }
+    bool sectionPresetSwitching() const { return snapshot().sectionPresetSwitching; }
+    QString presetDirectory() const { return snapshot().presetDirectory; }
+    QString presetAtlasDirectory() const { return snapshot().presetAtlasDirectory; }
+    QString presetFeaturesPath() const { return snapshot().presetFeaturesPath; }
+
+    int titleLineLengthTarget() const { return snapshot().titleLineLengthTarget; }
+    int lyricsLineLengthTarget() const { return snapshot().lyricsLineLengthTarget; }
+    QColor lyricsHighlightColor() const { return snapshot().lyricsHighlightColor; }
+    QString sttWorkerCommand() const { return snapshot().sttWorkerCommand; }
+    QString sttCacheDirectory() const { return snapshot().sttCacheDirectory; }
+    int sttCacheSizeMb() const { return snapshot().sttCacheSizeMb; }
+    QColor titleColor() const { return snapshot().titleColor; }
+
+    QString timelineCacheDirectory() const { return snapshot().timelineCacheDirectory; }
+    int timelineCacheSizeMb() const { return snapshot().timelineCacheSizeMb; }
+
+    QString sunoDownloadDirectory() const { return snapshot().sunoDownloadDirectory; }
+    QString sunoAudioUrl() const { return snapshot().sunoAudioUrl; }
+    int sunoMaxDownloads() const { return snapshot().sunoMaxDownloads; }
+
+    bool presetTransitionsEnabled() const { return snapshot().presetTransitionsEnabled; }
+    QString presetTransitionStyle() const { return snapshot().presetTransitionStyle; }
+    float presetTransitionDuration() const { return snapshot().presetTransitionDuration; }
+    bool presetTransitionBeatSync() const { return snapshot().presetTransitionBeatSync; }
+
+    float visualizerRenderScale() const { return snapshot().visualizerRenderScale; }
+    bool dynamicResolutionEnabled() const { return snapshot().dynamicResolutionEnabled; }
+    float dynamicResolutionTargetFps() const { return snapshot().dynamicResolutionTargetFps; }
+    float dynamicResolutionMinScale() const { return snapshot().dynamicResolutionMinScale; }
+    float upscaleSharpness() const { return snapshot().upscaleSharpness; }
+    bool showStatsOverlay() const { return snapshot().showStatsOverlay; }
+
+    int videoFps() const { return snapshot().videoFps; }
+
+    float animationFadeDuration() const { return snapshot().animationFadeDuration; }
+    float animationBounceDuration() const { return snapshot().animationBounceDuration; }
+    float animationTargetAlpha() const { return snapshot().animationTargetAlpha; }
+    QString overlayAnimationPath() const { return snapshot().overlayAnimationPath; }
 
-    QSettings* m_settings;
+    QString logFilePath() const { return snapshot().logFilePath; }
 };
@@ -0,0 +1,86 @@
+#include "ConfigStore.h"
+#include <QFileInfo>
+#include "Logger.h"
+
+namespace {
+// Used before a ConfigStore exists (and after it is gone), e.g. in tools that
+// never create one. Built on first use so QStandardPaths is available.
+const ConfigSnapshot& defaultSnapshot()
+{
+    static const ConfigSnapshot snapshot = ConfigSnapshot::fromFile(QString());
+    return snapshot;
+}
+}
+
+ConfigStore* ConfigStore::s_instance = nullptr;
+std::atomic<const ConfigSnapshot*> ConfigStore::s_current{nullptr};
+
+const ConfigSnapshot& Config::snapshot()
+{
+    const ConfigSnapshot* current = ConfigStore::current();
+    return current ? *current : defaultSnapshot();
+}
+
+ConfigStore::ConfigStore(const QString& path, QObject* parent)
+    : QObject(parent), m_path(path)
+{
+    publish(ConfigSnapshot::fromFile(m_path));
+    m_lastModified = QFileInfo(m_path).lastModified();
+    s_instance = this;
+
+    // Editors usually save by writing a new file and renaming it over the old
+    // one, which drops the inotify watch; coalesce the burst of events and
+    // re-arm the watch on reload.
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(100);
+    connect(&m_debounce, &QTimer::timeout, this, &ConfigStore::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &ConfigStore::fileChanged);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &ConfigStore::fileChanged);
+    if (!m_path.isEmpty()) {
+        m_watcher.addPath(m_path);
+        m_watcher.addPath(QFileInfo(m_path).absolutePath());
+    }
+}
+
+ConfigStore::~ConfigStore()
+{
+    if (s_instance == this) {
+        s_instance = nullptr;
+        s_current.store(nullptr, std::memory_order_release);
+    }
+}
+
+void ConfigStore::fileChanged()
+{
+    m_debounce.start();
+}
+
+void ConfigStore::reload()
+{
+    if (m_path.isEmpty()) {
+        return;
+    }
+    if (!m_watcher.files().contains(m_path) && QFileInfo::exists(m_path)) {
+        m_watcher.addPath(m_path);
+    }
+    QFileInfo info(m_path);
+    if (!info.exists()) {
+        // Mid-rename; the directory watch will fire again once it is back.
+        return;
+    }
+    // The directory watch also fires for unrelated files next to config.ini.
+    if (info.lastModified() == m_lastModified) {
+        return;
+    }
+    m_lastModified = info.lastModified();
+    publish(ConfigSnapshot::fromFile(m_path));
+    logInfo(LogCategory::Config, "Reloaded configuration from " + m_path.toStdString());
+    emit changed();
+}
+
+void ConfigStore::publish(ConfigSnapshot snapshot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapshots.push_back(std::make_unique<const ConfigSnapshot>(std::move(snapshot)));
+    s_current.store(m_snapshots.back().get(), std::memory_order_release);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Config.h"
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDateTime>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Owns the published ConfigSnapshot. The file is parsed once at startup and
+// again only when it changes on disk; each reload builds a fresh snapshot and
+// swaps it in with a single atomic store. Readers (Config::snapshot()) do a
+// plain acquire load and never lock. Retired snapshots stay alive until the
+// store is destroyed, so a reference taken mid-frame can never dangle; they
+// are small and reloads are rare, so the memory is not worth reclaiming.
+class ConfigStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConfigStore(const QString& path = ConfigSnapshot::locateFile(), QObject* parent = nullptr);
+    ~ConfigStore() override;
+
+    static ConfigStore* instance() { return s_instance; }
+    static const ConfigSnapshot* current() { return s_current.load(std::memory_order_acquire); }
+
+    QString filePath() const { return m_path; }
+
+public slots:
+    void reload();
+
+signals:
+    void changed();
+
+private slots:
+    void fileChanged();
+
+private:
+    void publish(ConfigSnapshot snapshot);
+
+    static ConfigStore* s_instance;
+    static std::atomic<const ConfigSnapshot*> s_current;
+
+    QString m_path;
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    QDateTime m_lastModified;
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<const ConfigSnapshot>> m_snapshots;
+};
@@ -0,0 +1,83 @@
+#include "DynamicResolutionController.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float AVERAGE_WEIGHT = 0.2f;
+}
+
+DynamicResolutionController::DynamicResolutionController()
+    : DynamicResolutionController(Settings())
+{
+}
+
+DynamicResolutionController::DynamicResolutionController(const Settings& settings)
+    : m_settings(settings), m_scale(settings.maxScale)
+{
+}
+
+void DynamicResolutionController::setSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_scale = m_enabled ? quantize(m_scale) : m_settings.maxScale;
+}
+
+void DynamicResolutionController::setEnabled(bool enabled)
+{
+    if (enabled != m_enabled) {
+        m_enabled = enabled;
+        reset();
+    }
+}
+
+void DynamicResolutionController::reset()
+{
+    m_scale = m_settings.maxScale;
+    m_averageMs = 0.0f;
+    m_overBudgetFrames = 0;
+    m_underBudgetFrames = 0;
+    m_cooldown = 0;
+}
+
+float DynamicResolutionController::quantize(float scale) const
+{
+    float steps = std::round(scale / m_settings.step);
+    return std::min(m_settings.maxScale, std::max(m_settings.minScale, steps * m_settings.step));
+}
+
+bool DynamicResolutionController::update(float gpuFrameMs)
+{
+    if (!m_enabled || gpuFrameMs <= 0.0f) {
+        return false;
+    }
+
+    m_averageMs = m_averageMs > 0.0f ? m_averageMs + AVERAGE_WEIGHT * (gpuFrameMs - m_averageMs) : gpuFrameMs;
+    if (m_cooldown > 0) {
+        --m_cooldown;
+        return false;
+    }
+
+    const float budget = budgetMs();
+    m_overBudgetFrames = m_averageMs > budget * m_settings.downThreshold ? m_overBudgetFrames + 1 : 0;
+    m_underBudgetFrames = m_averageMs < budget * m_settings.upThreshold ? m_underBudgetFrames + 1 : 0;
+
+    float next = m_scale;
+    if (m_overBudgetFrames >= m_settings.framesBeforeDown) {
+        // Cost is roughly proportional to pixel count, i.e. scale squared.
+        float ideal = m_scale * std::sqrt(budget * m_settings.downThreshold / m_averageMs);
+        next = quantize(std::min(ideal, m_scale - m_settings.step));
+    } else if (m_underBudgetFrames >= m_settings.framesBeforeUp) {
+        next = quantize(m_scale + m_settings.step);
+    }
+
+    if (next == m_scale) {
+        return false;
+    }
+    m_scale = next;
+    m_overBudgetFrames = 0;
+    m_underBudgetFrames = 0;
+    m_cooldown = m_settings.cooldownFrames;
+    // Timings measured at the old resolution no longer apply.
+    m_averageMs = 0.0f;
+    return true;
+}
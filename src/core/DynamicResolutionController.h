@@ -0,0 +1,51 @@
+#pragma once
+
+// Chooses the internal render scale of the visualizer from measured GPU frame
+// times. Scale drops quickly when frames run over budget and recovers slowly
+// once there is clear headroom; a cooldown after each change lets the new
+// resolution show up in the (delayed) timings before deciding again.
+class DynamicResolutionController
+{
+public:
+    struct Settings {
+        float targetFps = 60.0f;
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        float step = 0.05f;
+        // Frame time, relative to the budget, above which we scale down and
+        // below which we may scale up.
+        float downThreshold = 0.95f;
+        float upThreshold = 0.7f;
+        int framesBeforeDown = 8;
+        int framesBeforeUp = 90;
+        int cooldownFrames = 30;
+    };
+
+    DynamicResolutionController();
+    explicit DynamicResolutionController(const Settings& settings);
+
+    // Takes new targets without starting over: the current scale is kept,
+    // clamped to the new range.
+    void setSettings(const Settings& settings);
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    // Feeds one GPU frame time; returns true when scale() changed.
+    bool update(float gpuFrameMs);
+
+    float scale() const { return m_scale; }
+    float averageFrameMs() const { return m_averageMs; }
+    float budgetMs() const { return 1000.0f / m_settings.targetFps; }
+    void reset();
+
+private:
+    float quantize(float scale) const;
+
+    Settings m_settings;
+    bool m_enabled = true;
+    float m_scale;
+    float m_averageMs = 0.0f;
+    int m_overBudgetFrames = 0;
+    int m_underBudgetFrames = 0;
+    int m_cooldown = 0;
+};
@@ -0,0 +1,141 @@
+#include "FrameCompare.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace {
+    const char* FILE_HEADER = "# aurora golden frames v1";
+    const int SSIM_WINDOW = 8;
+    const double SSIM_C1 = (0.01 * 255.0) * (0.01 * 255.0);
+    const double SSIM_C2 = (0.03 * 255.0) * (0.03 * 255.0);
+
+    double luma(const unsigned char* px) {
+        return 0.2126 * px[0] + 0.7152 * px[1] + 0.0722 * px[2];
+    }
+
+    double windowSsim(const unsigned char* a, const unsigned char* b, int width, int x0, int y0, int w, int h) {
+        double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+        for (int y = y0; y < y0 + h; ++y) {
+            for (int x = x0; x < x0 + w; ++x) {
+                const size_t i = (static_cast<size_t>(y) * width + x) * 4;
+                const double la = luma(a + i);
+                const double lb = luma(b + i);
+                sumA += la;
+                sumB += lb;
+                sumAA += la * la;
+                sumBB += lb * lb;
+                sumAB += la * lb;
+            }
+        }
+        const double n = static_cast<double>(w) * h;
+        const double meanA = sumA / n;
+        const double meanB = sumB / n;
+        const double varA = sumAA / n - meanA * meanA;
+        const double varB = sumBB / n - meanB * meanB;
+        const double covariance = sumAB / n - meanA * meanB;
+        return ((2.0 * meanA * meanB + SSIM_C1) * (2.0 * covariance + SSIM_C2))
+             / ((meanA * meanA + meanB * meanB + SSIM_C1) * (varA + varB + SSIM_C2));
+    }
+}
+
+uint64_t FrameCompare::hash(const unsigned char* rgba, int width, int height)
+{
+    uint64_t h = 14695981039346656037ull;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixels; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            h ^= rgba[i * 4 + c];
+            h *= 1099511628211ull;
+        }
+    }
+    h ^= static_cast<uint64_t>(width) << 32 | static_cast<uint32_t>(height);
+    return h * 1099511628211ull;
+}
+
+FrameDifference FrameCompare::compare(const unsigned char* a, const unsigned char* b, int width, int height)
+{
+    FrameDifference result;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    double squaredError = 0.0;
+    size_t changed = 0;
+    for (size_t i = 0; i < pixels; ++i) {
+        int pixelMax = 0;
+        for (int c = 0; c < 3; ++c) {
+            const int d = std::abs(static_cast<int>(a[i * 4 + c]) - static_cast<int>(b[i * 4 + c]));
+            squaredError += static_cast<double>(d) * d;
+            pixelMax = std::max(pixelMax, d);
+        }
+        result.maxChannelError = std::max(result.maxChannelError, pixelMax);
+        changed += pixelMax > CHANGED_THRESHOLD ? 1 : 0;
+    }
+    const double mse = pixels > 0 ? squaredError / (pixels * 3.0) : 0.0;
+    result.psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    result.changedFraction = pixels > 0 ? static_cast<double>(changed) / pixels : 0.0;
+
+    double ssimSum = 0.0;
+    int windows = 0;
+    for (int y = 0; y < height; y += SSIM_WINDOW) {
+        for (int x = 0; x < width; x += SSIM_WINDOW) {
+            ssimSum += windowSsim(a, b, width, x, y, std::min(SSIM_WINDOW, width - x), std::min(SSIM_WINDOW, height - y));
+            ++windows;
+        }
+    }
+    result.ssim = windows > 0 ? ssimSum / windows : 1.0;
+    return result;
+}
+
+std::vector<unsigned char> FrameCompare::diffImage(const unsigned char* a, const unsigned char* b,
+                                                   int width, int height, int gain)
+{
+    const size_t pixels = static_cast<size_t>(width) * height;
+    std::vector<unsigned char> out(pixels * 4);
+    for (size_t i = 0; i < pixels; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const int d = std::abs(static_cast<int>(a[i * 4 + c]) - static_cast<int>(b[i * 4 + c]));
+            out[i * 4 + c] = static_cast<unsigned char>(std::min(255, d * gain));
+        }
+        out[i * 4 + 3] = 255;
+    }
+    return out;
+}
+
+bool FrameCompare::saveManifest(const std::string& filePath, const std::vector<GoldenFrame>& frames)
+{
+    std::ofstream out(filePath);
+    if (!out) {
+        logError(LogCategory::Render, "Failed to write golden manifest: " + filePath);
+        return false;
+    }
+    out << FILE_HEADER << "\n";
+    for (const GoldenFrame& frame : frames) {
+        out << frame.frame << "\t" << std::hex << frame.hash << std::dec << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool FrameCompare::loadManifest(const std::string& filePath, std::vector<GoldenFrame>& frames)
+{
+    std::ifstream in(filePath);
+    if (!in) {
+        return false;
+    }
+    frames.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        GoldenFrame frame;
+        if (!(fields >> frame.frame >> std::hex >> frame.hash)) {
+            logWarning(LogCategory::Render, "Skipping malformed golden manifest line: " + line);
+            continue;
+        }
+        frames.push_back(frame);
+    }
+    return true;
+}
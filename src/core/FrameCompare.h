@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FrameDifference {
+    // Infinite when the frames are identical.
+    double psnr = 0.0;
+    // Mean SSIM of luma over 8x8 windows; 1 means structurally identical.
+    double ssim = 0.0;
+    int maxChannelError = 0;
+    // Share of pixels with any channel off by more than CHANGED_THRESHOLD.
+    double changedFraction = 0.0;
+};
+
+struct GoldenFrame {
+    int frame = 0;
+    uint64_t hash = 0;
+};
+
+// Helpers for golden-frame regression tests on RGBA8 frames. Alpha is
+// ignored throughout, since drivers disagree on what ends up in it.
+class FrameCompare
+{
+public:
+    static const int CHANGED_THRESHOLD = 8;
+
+    static uint64_t hash(const unsigned char* rgba, int width, int height);
+    static FrameDifference compare(const unsigned char* a, const unsigned char* b, int width, int height);
+    // Absolute difference scaled by `gain`, opaque, for inspecting failures.
+    static std::vector<unsigned char> diffImage(const unsigned char* a, const unsigned char* b,
+                                                int width, int height, int gain = 8);
+
+    static std::string manifestFileName() { return "golden.tsv"; }
+    static bool saveManifest(const std::string& filePath, const std::vector<GoldenFrame>& frames);
+    static bool loadManifest(const std::string& filePath, std::vector<GoldenFrame>& frames);
+};
@@ -1,11 +1,13 @@
 #include "LogCatcher.h"
 
-LogCatcher::LogCatcher() {
+LogCatcher::LogCatcher() : m_capture(Logger::instance(), LogCategory::Console) {
+    m_cursor = Logger::instance().mark();
+
     m_cout_rdbuf = std::cout.rdbuf();
-    std::cout.rdbuf(m_ss.rdbuf());
+    std::cout.rdbuf(&m_capture);
 
     m_cerr_rdbuf = std::cerr.rdbuf();
-    std::cerr.rdbuf(m_ss.rdbuf());
+    std::cerr.rdbuf(&m_capture);
 }
 
 LogCatcher::~LogCatcher() {
@@ -14,13 +16,24 @@ LogCatcher::~LogCatcher() {
 }
 
 std::string LogCatcher::getAndClear() {
-    std::string content = m_ss.str();
-    m_ss.str("");
-    m_ss.clear();
+    const uint64_t next = Logger::instance().mark();
+    std::string content;
+    for (const LogRecord& record : Logger::instance().recordsSince(m_cursor)) {
+        if (record.sequence < next && record.category == LogCategory::Console) {
+            content += record.text;
+            content += '\n';
+        }
+    }
+    m_cursor = next;
     return content;
 }
 
 bool LogCatcher::checkForErrors() {
-    std::string log = getAndClear();
-    return log.find("void") != std::string::npos || log.find("shader") != std::string::npos;
+    const uint64_t next = Logger::instance().mark();
+    bool errors = false;
+    for (const LogRecord& record : Logger::instance().recordsSince(m_cursor, LogLevel::Error)) {
+        errors = errors || (record.sequence < next && record.category == LogCategory::Console);
+    }
+    m_cursor = next;
+    return errors;
 }
@@ -1,19 +1,24 @@
 #pragma once
 
+#include "Logger.h"
 #include <iostream>
-#include <sstream>
 #include <string>
 
+// Routes std::cout/std::cerr into the Logger for its lifetime, so output
+// from projectM is bounded, rate-limited and can be inspected per preset.
 class LogCatcher {
 public:
     LogCatcher();
     ~LogCatcher();
 
+    // Console output captured since the previous call.
     std::string getAndClear();
+    // True if console output since the previous call contained errors.
     bool checkForErrors();
 
 private:
-    std::stringstream m_ss;
+    LogStreamCapture m_capture;
     std::streambuf* m_cout_rdbuf;
     std::streambuf* m_cerr_rdbuf;
+    uint64_t m_cursor;
 };
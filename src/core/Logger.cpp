@@ -0,0 +1,472 @@
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+namespace {
+    std::atomic<uint64_t> nextLoggerId{1};
+
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Digits are skipped so that messages differing only in line numbers,
+    // addresses or counters count as repeats.
+    // projectM repeats the same shader error with varying line numbers, so
+    // digits are ignored in captured console lines; other messages (song
+    // ids, sizes) only repeat when identical.
+    uint64_t repeatKey(LogCategory category, const std::string& text) {
+        uint64_t hash = 14695981039346656037ull ^ static_cast<uint64_t>(category);
+        const bool ignoreDigits = category == LogCategory::Console;
+        for (char c : text) {
+            if (ignoreDigits && c >= '0' && c <= '9') {
+                continue;
+            }
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string formatRecord(const LogRecord& record) {
+        std::time_t seconds = static_cast<std::time_t>(record.timestampNs / 1000000000);
+        int millis = static_cast<int>((record.timestampNs / 1000000) % 1000);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%03d %-7s %-7s ",
+                      local.tm_hour, local.tm_min, local.tm_sec, millis,
+                      logLevelName(record.level), logCategoryName(record.category));
+        return prefix + record.text + "\n";
+    }
+}
+
+const char* logLevelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return "debug";
+    case LogLevel::Info: return "info";
+    case LogLevel::Warning: return "warning";
+    case LogLevel::Error: return "error";
+    }
+    return "";
+}
+
+const char* logCategoryName(LogCategory category)
+{
+    switch (category) {
+    case LogCategory::General: return "general";
+    case LogCategory::Audio: return "audio";
+    case LogCategory::Render: return "render";
+    case LogCategory::Text: return "text";
+    case LogCategory::Presets: return "presets";
+    case LogCategory::Config: return "config";
+    case LogCategory::Console: return "console";
+    }
+    return "";
+}
+
+Logger::Logger() : Logger(Settings()) {}
+
+Logger::Logger(const Settings& settings)
+    : m_settings(settings), m_id(nextLoggerId.fetch_add(1))
+{
+    m_settings.threadBufferCapacity = roundUpToPowerOfTwo(std::max<size_t>(2, m_settings.threadBufferCapacity));
+    if (!m_settings.filePath.empty()) {
+        openFile(m_settings.filePath);
+    }
+}
+
+Logger::~Logger()
+{
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        drain();
+        summarizeRepeats(nowNs(), true);
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_registryMutex);
+    for (const auto& buffer : m_buffers) {
+        buffer->orphaned.store(true, std::memory_order_release);
+    }
+}
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    static bool started = (logger.start(), true);
+    (void)started;
+    return logger;
+}
+
+void Logger::start()
+{
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_thread = std::thread(&Logger::run, this);
+}
+
+void Logger::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (!m_running) {
+            return;
+        }
+        m_running = false;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+bool Logger::openFile(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    if (filePath.empty()) {
+        return true;
+    }
+    m_file = std::fopen(filePath.c_str(), "a");
+    return m_file != nullptr;
+}
+
+void Logger::run()
+{
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (m_running) {
+        // Writers never signal; polling keeps write() free of syscalls.
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_settings.flushIntervalMs));
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+Logger::ThreadBuffer* Logger::threadBuffer()
+{
+    struct Entry {
+        uint64_t loggerId;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    struct ThreadState {
+        std::vector<Entry> entries;
+        ~ThreadState() {
+            for (Entry& entry : entries) {
+                entry.buffer->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local ThreadState state;
+
+    for (Entry& entry : state.entries) {
+        if (entry.loggerId == m_id) {
+            return entry.buffer.get();
+        }
+    }
+
+    state.entries.erase(std::remove_if(state.entries.begin(), state.entries.end(), [](const Entry& entry) {
+        return entry.buffer->orphaned.load(std::memory_order_acquire);
+    }), state.entries.end());
+
+    std::shared_ptr<ThreadBuffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        // Drained rings of exited threads are handed to new threads, so
+        // short-lived worker threads do not grow the registry.
+        for (const auto& candidate : m_buffers) {
+            bool retired = true;
+            if (candidate->head.load(std::memory_order_acquire) == candidate->tail.load(std::memory_order_acquire)
+                && candidate->retired.compare_exchange_strong(retired, false, std::memory_order_acq_rel)) {
+                buffer = candidate;
+                break;
+            }
+        }
+        if (!buffer) {
+            buffer = std::make_shared<ThreadBuffer>(m_settings.threadBufferCapacity);
+            m_buffers.push_back(buffer);
+        }
+    }
+    state.entries.push_back({m_id, buffer});
+    return buffer.get();
+}
+
+bool Logger::write(LogLevel level, LogCategory category, std::string_view text) noexcept
+{
+    if (level < m_settings.minLevel) {
+        return false;
+    }
+    ThreadBuffer* buffer = nullptr;
+    try {
+        buffer = threadBuffer();
+    } catch (...) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const size_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) > buffer->mask) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Slot& slot = buffer->slots[head & buffer->mask];
+    slot.timestampNs = nowNs();
+    slot.level = level;
+    slot.category = category;
+    slot.length = static_cast<uint16_t>(std::min(text.size(), MAX_MESSAGE_LENGTH));
+    std::memcpy(slot.text, text.data(), slot.length);
+    buffer->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void Logger::flush()
+{
+    std::lock_guard<std::mutex> lock(m_drainMutex);
+    drain();
+}
+
+void Logger::drain()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_registryMutex);
+        m_drainList = m_buffers;
+    }
+
+    m_batch.clear();
+    uint64_t dropped = 0;
+    for (const auto& buffer : m_drainList) {
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        const size_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Slot& slot = buffer->slots[tail & buffer->mask];
+            LogRecord record;
+            record.timestampNs = slot.timestampNs;
+            record.level = slot.level;
+            record.category = slot.category;
+            record.text.assign(slot.text, slot.length);
+            m_batch.push_back(std::move(record));
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+        dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    // Each ring is already in order; interleave the threads by time.
+    std::stable_sort(m_batch.begin(), m_batch.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+
+    const int64_t now = nowNs();
+    summarizeRepeats(now, false);
+    for (LogRecord& record : m_batch) {
+        // Repeats only stay off the console and file; errors are still kept
+        // in the history that preset health checks query.
+        const bool limited = rateLimited(record);
+        if (!limited || record.level >= LogLevel::Error) {
+            emit(std::move(record), !limited);
+        }
+    }
+    m_batch.clear();
+
+    if (dropped > 0) {
+        m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+        LogRecord record;
+        record.timestampNs = now;
+        record.level = LogLevel::Warning;
+        record.category = LogCategory::General;
+        record.text = "Dropped " + std::to_string(dropped) + " log messages (buffer full)";
+        emit(std::move(record));
+    }
+    if (m_file) {
+        std::fflush(m_file);
+    }
+}
+
+bool Logger::rateLimited(const LogRecord& record)
+{
+    if (m_settings.repeatLimit <= 0) {
+        return false;
+    }
+    Repeat& repeat = m_repeats[repeatKey(record.category, record.text)];
+    if (repeat.count == 0) {
+        repeat.windowStartNs = record.timestampNs;
+        repeat.level = record.level;
+        repeat.category = record.category;
+        repeat.text = record.text;
+    }
+    if (++repeat.count <= m_settings.repeatLimit) {
+        return false;
+    }
+    ++repeat.suppressed;
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Logger::summarizeRepeats(int64_t now, bool all)
+{
+    const int64_t windowNs = static_cast<int64_t>(m_settings.repeatWindowSeconds * 1.0e9);
+    for (auto it = m_repeats.begin(); it != m_repeats.end();) {
+        const Repeat& repeat = it->second;
+        if (!all && now - repeat.windowStartNs < windowNs) {
+            ++it;
+            continue;
+        }
+        if (repeat.suppressed > 0) {
+            LogRecord record;
+            record.timestampNs = now;
+            record.level = repeat.level;
+            record.category = repeat.category;
+            record.text = repeat.text + " (repeated " + std::to_string(repeat.suppressed) + " more times)";
+            emit(std::move(record));
+        }
+        it = m_repeats.erase(it);
+    }
+}
+
+void Logger::emit(LogRecord record, bool toSinks)
+{
+    const bool toConsole = toSinks && m_settings.console && record.level >= m_settings.consoleLevel;
+    const bool toFile = toSinks && m_file;
+    if (toConsole || toFile) {
+        const std::string line = formatRecord(record);
+        if (toConsole) {
+            // Not std::cerr: LogCatcher may have redirected it back into us.
+            std::fputs(line.c_str(), stderr);
+        }
+        if (toFile) {
+            std::fputs(line.c_str(), m_file);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    record.sequence = m_nextSequence++;
+    m_history.push_back(std::move(record));
+    while (m_history.size() > m_settings.historyCapacity) {
+        m_history.pop_front();
+    }
+}
+
+uint64_t Logger::mark()
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    return m_nextSequence;
+}
+
+size_t Logger::countSince(uint64_t sequence, LogLevel minLevel, LogCategory category)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    size_t count = 0;
+    for (auto it = m_history.rbegin(); it != m_history.rend() && it->sequence >= sequence; ++it) {
+        if (it->level >= minLevel && it->category == category) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::vector<LogRecord> Logger::recordsSince(uint64_t sequence, LogLevel minLevel)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_historyMutex);
+    std::vector<LogRecord> records;
+    for (const LogRecord& record : m_history) {
+        if (record.sequence >= sequence && record.level >= minLevel) {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+LogStreamCapture::LogStreamCapture(Logger& logger, LogCategory category)
+    : m_logger(logger), m_category(category)
+{
+}
+
+LogStreamCapture::~LogStreamCapture()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    flushLine();
+}
+
+LogLevel LogStreamCapture::classify(std::string_view line)
+{
+    std::string lower(line);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    // projectM reports broken presets by printing the failing shader source.
+    for (const char* marker : {"error", "fail", "shader", "void"}) {
+        if (lower.find(marker) != std::string::npos) {
+            return LogLevel::Error;
+        }
+    }
+    if (lower.find("warn") != std::string::npos) {
+        return LogLevel::Warning;
+    }
+    return LogLevel::Info;
+}
+
+LogStreamCapture::int_type LogStreamCapture::overflow(int_type ch)
+{
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ch == '\n') {
+        flushLine();
+    } else {
+        m_line.push_back(static_cast<char>(ch));
+        if (m_line.size() >= Logger::MAX_MESSAGE_LENGTH) {
+            flushLine();
+        }
+    }
+    return ch;
+}
+
+std::streamsize LogStreamCapture::xsputn(const char* data, std::streamsize count)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::streamsize i = 0; i < count; ++i) {
+        if (data[i] == '\n') {
+            flushLine();
+        } else {
+            m_line.push_back(data[i]);
+            if (m_line.size() >= Logger::MAX_MESSAGE_LENGTH) {
+                flushLine();
+            }
+        }
+    }
+    return count;
+}
+
+int LogStreamCapture::sync()
+{
+    return 0;
+}
+
+void LogStreamCapture::flushLine()
+{
+    if (!m_line.empty()) {
+        m_logger.write(classify(m_line), m_category, m_line);
+        m_line.clear();
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+enum class LogCategory : uint8_t {
+    General,
+    Audio,
+    Render,
+    Text,
+    Presets,
+    Config,
+    // Lines captured from std::cout/std::cerr, i.e. mostly projectM.
+    Console
+};
+
+const char* logLevelName(LogLevel level);
+const char* logCategoryName(LogCategory category);
+
+struct LogRecord {
+    uint64_t sequence = 0;
+    int64_t timestampNs = 0;
+    LogLevel level = LogLevel::Info;
+    LogCategory category = LogCategory::General;
+    std::string text;
+};
+
+// Asynchronous logger. Every writing thread gets its own fixed-size
+// single-producer ring, so write() never locks or allocates (apart from the
+// first call on a new thread) and is safe from the audio callback; when a
+// ring is full the message is dropped and counted. A background thread
+// drains the rings, collapses bursts of identical messages, writes to the
+// console and/or a file and keeps a bounded history for queries.
+class Logger
+{
+public:
+    struct Settings {
+        size_t threadBufferCapacity = 1024;
+        size_t historyCapacity = 1024;
+        int flushIntervalMs = 50;
+        bool console = true;
+        LogLevel consoleLevel = LogLevel::Info;
+        std::string filePath;
+        LogLevel minLevel = LogLevel::Debug;
+        // Identical messages (digits ignored in Console lines) beyond
+        // repeatLimit within repeatWindowSeconds are kept off the console
+        // and file and summarized once the window ends. Suppressed errors
+        // still go into the history.
+        int repeatLimit = 3;
+        double repeatWindowSeconds = 10.0;
+    };
+
+    // Longer messages are truncated.
+    static constexpr size_t MAX_MESSAGE_LENGTH = 240;
+
+    Logger();
+    explicit Logger(const Settings& settings);
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Process-wide logger with the flusher already running.
+    static Logger& instance();
+
+    void start();
+    void stop();
+    // Appends to filePath in addition to the console; empty closes the file.
+    bool openFile(const std::string& filePath);
+
+    bool write(LogLevel level, LogCategory category, std::string_view text) noexcept;
+
+    // Drains all rings on the calling thread; queries call this themselves.
+    void flush();
+
+    // Sequence number the next drained record will get. Pass it to the
+    // queries below to look only at messages logged after this point.
+    uint64_t mark();
+    size_t countSince(uint64_t sequence, LogLevel minLevel, LogCategory category);
+    std::vector<LogRecord> recordsSince(uint64_t sequence, LogLevel minLevel = LogLevel::Debug);
+
+    uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t suppressedCount() const { return m_suppressed.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        int64_t timestampNs;
+        LogLevel level;
+        LogCategory category;
+        uint16_t length;
+        char text[MAX_MESSAGE_LENGTH];
+    };
+
+    struct ThreadBuffer {
+        explicit ThreadBuffer(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+        std::vector<Slot> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        // Set when the owning thread exits; the ring may then be reused.
+        std::atomic<bool> retired{false};
+        // Set when the Logger is destroyed before the thread.
+        std::atomic<bool> orphaned{false};
+    };
+
+    struct Repeat {
+        int64_t windowStartNs = 0;
+        int count = 0;
+        int suppressed = 0;
+        LogLevel level = LogLevel::Info;
+        LogCategory category = LogCategory::General;
+        std::string text;
+    };
+
+    ThreadBuffer* threadBuffer();
+    void run();
+    void drain();
+    bool rateLimited(const LogRecord& record);
+    void summarizeRepeats(int64_t now, bool all);
+    void emit(LogRecord record, bool toSinks = true);
+
+    Settings m_settings;
+    const uint64_t m_id;
+
+    std::mutex m_registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+    std::mutex m_drainMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_drainList;
+    std::vector<LogRecord> m_batch;
+    std::unordered_map<uint64_t, Repeat> m_repeats;
+    std::FILE* m_file = nullptr;
+
+    std::mutex m_historyMutex;
+    std::deque<LogRecord> m_history;
+    uint64_t m_nextSequence = 1;
+
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_suppressed{0};
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_running = false;
+    std::thread m_thread;
+};
+
+// Line-buffering streambuf that turns std::cout/std::cerr output into log
+// records. projectM reports shader problems this way; lines that look like
+// errors are logged as LogLevel::Error so preset health can be queried.
+class LogStreamCapture : public std::streambuf
+{
+public:
+    LogStreamCapture(Logger& logger, LogCategory category);
+    ~LogStreamCapture() override;
+
+    static LogLevel classify(std::string_view line);
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+
+private:
+    void flushLine();
+
+    Logger& m_logger;
+    LogCategory m_category;
+    std::mutex m_mutex;
+    std::string m_line;
+};
+
+inline void logDebug(LogCategory category, std::string_view text) { Logger::instance().write(LogLevel::Debug, category, text); }
+inline void logInfo(LogCategory category, std::string_view text) { Logger::instance().write(LogLevel::Info, category, text); }
+inline void logWarning(LogCategory category, std::string_view text) { Logger::instance().write(LogLevel::Warning, category, text); }
+inline void logError(LogCategory category, std::string_view text) { Logger::instance().write(LogLevel::Error, category, text); }
@@ -0,0 +1,85 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_open(std::exchange(other.m_open, false))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_open = std::exchange(other.m_open, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& filePath, Access access)
+{
+    close();
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size > 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        m_data = data;
+        if (access == Access::Sequential) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            madvise(m_data, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+    m_open = true;
+    return true;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const
+{
+    if (!m_data || offset >= m_size) {
+        return;
+    }
+    // madvise wants a page-aligned start.
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = offset - offset % pageSize;
+    const size_t end = std::min(m_size, offset + length);
+    madvise(static_cast<char*>(m_data) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::close()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. Parsers and decoders work on
+// view() directly instead of copying the file into a buffer first. Empty
+// files open successfully with an empty view.
+class MappedFile
+{
+public:
+    enum class Access {
+        Normal,
+        // Read front to back once, e.g. by a decoder: the kernel reads
+        // ahead aggressively and drops pages behind the reader early.
+        Sequential
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filePath, Access access = Access::Normal) { open(filePath, access); }
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Fails for anything but a regular file (pipes, sockets, devices).
+    bool open(const std::string& filePath, Access access = Access::Normal);
+    void close();
+    // Starts reading [offset, offset + length) into the page cache in the
+    // background, so the pages are resident by the time they are touched.
+    void prefetch(size_t offset, size_t length) const;
+
+    bool isOpen() const { return m_open; }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(m_data); }
+    size_t size() const { return m_size; }
+    std::string_view view() const { return std::string_view(static_cast<const char*>(m_data), m_size); }
+
+private:
+    void* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_open = false;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental SHA-256 (FIPS 180-4), for verifying downloads.
+class Sha256
+{
+public:
+    Sha256();
+
+    void update(const void* data, size_t size);
+    // Lowercase hex of the digest; the object must not be updated afterwards.
+    std::string hexDigest();
+
+    // Empty if the file cannot be read.
+    static std::string ofFile(const std::string& filePath);
+
+private:
+    void compress(const uint8_t* block);
+
+    uint32_t m_state[8];
+    uint8_t m_buffer[64];
+    size_t m_buffered = 0;
+    uint64_t m_length = 0;
+};
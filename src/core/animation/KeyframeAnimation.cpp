@@ -0,0 +1,310 @@
+#include "KeyframeAnimation.h"
+#include "core/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+namespace {
+    const float DEFAULT_VALUES[KeyframeAnimation::PROPERTY_COUNT] = {0.5f, 0.5f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+    // Keyframes later than this (a day) are rejected when parsing.
+    const float MAX_KEYFRAME_TIME = 24.0f * 60.0f * 60.0f;
+    // Largest baked table, in floats (64 MB); longer animations interpolate.
+    const double MAX_BAKED_SAMPLES = 16.0 * 1024 * 1024;
+
+    static_assert(sizeof(OverlayPose) == KeyframeAnimation::PROPERTY_COUNT * sizeof(float),
+                  "OverlayPose must mirror one baked element row");
+    static_assert(std::is_trivially_copyable<OverlayPose>::value, "OverlayPose is copied from baked rows");
+
+    struct PropertyName {
+        const char* name;
+        AnimationProperty property;
+    };
+
+    const PropertyName PROPERTY_NAMES[] = {
+        {"x", AnimationProperty::X},
+        {"y", AnimationProperty::Y},
+        {"scale", AnimationProperty::Scale},
+        {"alpha", AnimationProperty::Alpha},
+        {"red", AnimationProperty::Red},
+        {"green", AnimationProperty::Green},
+        {"blue", AnimationProperty::Blue},
+    };
+
+    struct EasingName {
+        const char* name;
+        Easing easing;
+    };
+
+    const EasingName EASING_NAMES[] = {
+        {"linear", Easing::Linear},
+        {"step", Easing::Step},
+        {"ease-in", Easing::EaseIn},
+        {"ease-out", Easing::EaseOut},
+        {"ease-in-out", Easing::EaseInOut},
+    };
+}
+
+void OverlayPose::penPosition(const TextBounds& bounds, float finalScale, float screenWidth, float screenHeight,
+                              float& penX, float& penY) const
+{
+    penX = x * screenWidth - (bounds.x + bounds.width / 2.0f) * finalScale;
+    penY = y * screenHeight - (bounds.y + bounds.height / 2.0f) * finalScale;
+}
+
+float KeyframeAnimation::ease(Easing easing, float t)
+{
+    switch (easing) {
+    case Easing::Linear:
+        return t;
+    case Easing::Step:
+        return t < 1.0f ? 0.0f : 1.0f;
+    case Easing::EaseIn:
+        return t * t * t;
+    case Easing::EaseOut: {
+        const float u = 1.0f - t;
+        return 1.0f - u * u * u;
+    }
+    case Easing::EaseInOut:
+        return t < 0.5f ? 4.0f * t * t * t : 1.0f - std::pow(-2.0f * t + 2.0f, 3.0f) / 2.0f;
+    }
+    return t;
+}
+
+bool KeyframeAnimation::parseProperty(std::string_view name, AnimationProperty& property)
+{
+    for (const PropertyName& entry : PROPERTY_NAMES) {
+        if (name == entry.name) {
+            property = entry.property;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool KeyframeAnimation::parseEasing(std::string_view name, Easing& easing)
+{
+    for (const EasingName& entry : EASING_NAMES) {
+        if (name == entry.name) {
+            easing = entry.easing;
+            return true;
+        }
+    }
+    return false;
+}
+
+void KeyframeAnimation::clear()
+{
+    m_elements.clear();
+    m_tracks.clear();
+    m_duration = 0.0f;
+    m_skippedLines = 0;
+    m_rows = 0;
+    m_rowWidth = 0;
+    m_samples.clear();
+}
+
+int KeyframeAnimation::elementIndex(const std::string& element) const
+{
+    auto it = std::find(m_elements.begin(), m_elements.end(), element);
+    return it != m_elements.end() ? static_cast<int>(it - m_elements.begin()) : -1;
+}
+
+void KeyframeAnimation::addKeyframe(const std::string& element, AnimationProperty property, const Keyframe& keyframe)
+{
+    int index = elementIndex(element);
+    if (index < 0) {
+        index = static_cast<int>(m_elements.size());
+        m_elements.push_back(element);
+        m_tracks.resize(m_tracks.size() + PROPERTY_COUNT);
+    }
+
+    std::vector<Keyframe>& keyframes = m_tracks[index * PROPERTY_COUNT + static_cast<int>(property)].keyframes;
+    auto position = std::upper_bound(keyframes.begin(), keyframes.end(), keyframe.time,
+                                     [](float time, const Keyframe& k) { return time < k.time; });
+    keyframes.insert(position, keyframe);
+    m_duration = std::max(m_duration, keyframe.time);
+    // The baked table is stale until bake() runs again.
+    m_rows = 0;
+}
+
+bool KeyframeAnimation::load(const std::string& filePath)
+{
+    std::ifstream in(filePath);
+    if (!in) {
+        logWarning(LogCategory::Text, "Failed to open overlay animation: " + filePath);
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    clear();
+    if (!parse(contents.str())) {
+        logWarning(LogCategory::Text, "No keyframes in overlay animation: " + filePath);
+        return false;
+    }
+    bake();
+    return true;
+}
+
+bool KeyframeAnimation::parse(std::string_view text)
+{
+    size_t added = 0;
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = text.size();
+        }
+        std::string line(text.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream fields(line);
+        std::string element, propertyName;
+        if (!(fields >> element)) {
+            continue;
+        }
+
+        Keyframe keyframe;
+        float values[3] = {0.0f, 0.0f, 0.0f};
+        const bool color = (fields >> propertyName) && propertyName == "color";
+        AnimationProperty property = AnimationProperty::X;
+        bool valid = (color || parseProperty(propertyName, property)) && (fields >> keyframe.time >> values[0]);
+        if (valid && color) {
+            valid = static_cast<bool>(fields >> values[1] >> values[2]);
+        }
+        std::string easingName;
+        if (valid && (fields >> easingName)) {
+            valid = parseEasing(easingName, keyframe.easing);
+        }
+        if (!valid || !std::isfinite(keyframe.time) || keyframe.time < 0.0f || keyframe.time > MAX_KEYFRAME_TIME) {
+            logWarning(LogCategory::Text, "Skipping malformed overlay animation line: " + line);
+            ++m_skippedLines;
+            continue;
+        }
+
+        if (color) {
+            const AnimationProperty channels[3] = {AnimationProperty::Red, AnimationProperty::Green, AnimationProperty::Blue};
+            for (int i = 0; i < 3; ++i) {
+                keyframe.value = values[i];
+                addKeyframe(element, channels[i], keyframe);
+            }
+        } else {
+            keyframe.value = values[0];
+            addKeyframe(element, property, keyframe);
+        }
+        ++added;
+    }
+    return added > 0;
+}
+
+float KeyframeAnimation::interpolate(size_t element, AnimationProperty property, double time) const
+{
+    const int propertyIndex = static_cast<int>(property);
+    const std::vector<Keyframe>& keyframes = m_tracks[element * PROPERTY_COUNT + propertyIndex].keyframes;
+    if (keyframes.empty()) {
+        return DEFAULT_VALUES[propertyIndex];
+    }
+    if (time <= keyframes.front().time) {
+        return keyframes.front().value;
+    }
+    if (time >= keyframes.back().time) {
+        return keyframes.back().value;
+    }
+
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time,
+                                 [](double t, const Keyframe& k) { return t < k.time; });
+    const Keyframe& from = *(next - 1);
+    const float t = static_cast<float>((time - from.time) / (next->time - from.time));
+    return from.value + (next->value - from.value) * ease(from.easing, t);
+}
+
+void KeyframeAnimation::bake(int sampleRate)
+{
+    m_sampleRate = std::max(1, sampleRate);
+    m_rowWidth = m_elements.size() * PROPERTY_COUNT;
+    // One row past the last keyframe so the final segment interpolates fully.
+    const double rows = std::ceil(static_cast<double>(m_duration) * m_sampleRate) + 1.0;
+    if (rows * m_rowWidth > MAX_BAKED_SAMPLES) {
+        logWarning(LogCategory::Text, "Overlay animation too long to bake; interpolating keyframes instead");
+        m_rows = 0;
+        m_samples.clear();
+        m_samples.shrink_to_fit();
+        return;
+    }
+    m_rows = static_cast<size_t>(rows);
+    m_samples.assign(m_rows * m_rowWidth, 0.0f);
+
+    for (size_t row = 0; row < m_rows; ++row) {
+        const double time = static_cast<double>(row) / m_sampleRate;
+        float* out = &m_samples[row * m_rowWidth];
+        for (size_t element = 0; element < m_elements.size(); ++element) {
+            for (int p = 0; p < PROPERTY_COUNT; ++p) {
+                out[element * PROPERTY_COUNT + p] = interpolate(element, static_cast<AnimationProperty>(p), time);
+            }
+        }
+    }
+}
+
+void KeyframeAnimation::locate(double time, size_t& row, float& fraction) const
+{
+    const double position = std::min(std::max(0.0, time * m_sampleRate), static_cast<double>(m_rows - 1));
+    row = static_cast<size_t>(position);
+    fraction = static_cast<float>(position - row);
+    if (row + 1 >= m_rows) {
+        row = m_rows - 1;
+        fraction = 0.0f;
+    }
+}
+
+void KeyframeAnimation::evaluate(double time, std::vector<OverlayPose>& poses) const
+{
+    poses.resize(m_elements.size());
+    if (m_rows == 0) {
+        for (size_t element = 0; element < m_elements.size(); ++element) {
+            poses[element] = pose(element, time);
+        }
+        return;
+    }
+
+    size_t row;
+    float fraction;
+    locate(time, row, fraction);
+    const float* a = &m_samples[row * m_rowWidth];
+    const float* b = row + 1 < m_rows ? a + m_rowWidth : a;
+    float values[PROPERTY_COUNT];
+    for (size_t element = 0; element < m_elements.size(); ++element) {
+        const size_t base = element * PROPERTY_COUNT;
+        for (int p = 0; p < PROPERTY_COUNT; ++p) {
+            values[p] = a[base + p] + (b[base + p] - a[base + p]) * fraction;
+        }
+        std::memcpy(&poses[element], values, sizeof(values));
+    }
+}
+
+OverlayPose KeyframeAnimation::pose(size_t element, double time) const
+{
+    float values[PROPERTY_COUNT];
+    if (m_rows == 0) {
+        for (int p = 0; p < PROPERTY_COUNT; ++p) {
+            values[p] = interpolate(element, static_cast<AnimationProperty>(p), time);
+        }
+    } else {
+        size_t row;
+        float fraction;
+        locate(time, row, fraction);
+        const float* a = &m_samples[row * m_rowWidth + element * PROPERTY_COUNT];
+        const float* b = row + 1 < m_rows ? a + m_rowWidth : a;
+        for (int p = 0; p < PROPERTY_COUNT; ++p) {
+            values[p] = a[p] + (b[p] - a[p]) * fraction;
+        }
+    }
+    OverlayPose result;
+    std::memcpy(&result, values, sizeof(values));
+    return result;
+}
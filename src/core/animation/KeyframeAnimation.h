@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/text/FontMetrics.h"
+
+enum class Easing : uint8_t {
+    Linear,
+    // Holds the keyframe's value until the next keyframe.
+    Step,
+    EaseIn,
+    EaseOut,
+    EaseInOut
+};
+
+enum class AnimationProperty : uint8_t {
+    X,
+    Y,
+    Scale,
+    Alpha,
+    Red,
+    Green,
+    Blue
+};
+
+// Animated state of one overlay element. x and y place the centre of the
+// text box as a fraction of the screen (y grows upwards); scale multiplies
+// the element's base scale.
+struct OverlayPose {
+    float x = 0.5f;
+    float y = 0.5f;
+    float scale = 1.0f;
+    float alpha = 1.0f;
+    float red = 1.0f;
+    float green = 1.0f;
+    float blue = 1.0f;
+
+    // Pen position for TextRenderer::renderText given the text's bounds at
+    // scale 1 and the element's final scale.
+    void penPosition(const TextBounds& bounds, float finalScale, float screenWidth, float screenHeight,
+                     float& penX, float& penY) const;
+};
+
+// Declarative overlay animation: per element ("title", "artist", "url",
+// "lyrics", ...), keyframe tracks for position, scale, alpha and colour.
+// bake() samples every track once into a single time-major table, so
+// evaluating all elements at a time is a lerp between two contiguous rows
+// regardless of keyframe count or easing.
+//
+// File format, one keyframe per line, '#' starts a comment:
+//   <element> <property> <time> <value> [easing]
+//   <element> color <time> <r> <g> <b> [easing]
+// with property one of x, y, scale, alpha, red, green, blue and easing one
+// of linear (default), step, ease-in, ease-out, ease-in-out. The easing
+// shapes the segment that starts at that keyframe.
+class KeyframeAnimation
+{
+public:
+    static const int PROPERTY_COUNT = 7;
+    static const int DEFAULT_SAMPLE_RATE = 120;
+
+    struct Keyframe {
+        float time = 0.0f;
+        float value = 0.0f;
+        Easing easing = Easing::Linear;
+    };
+
+    void clear();
+    bool load(const std::string& filePath);
+    // Parses the file format above; malformed lines, including keyframes
+    // more than a day in, are skipped and counted.
+    bool parse(std::string_view text);
+    int skippedLines() const { return m_skippedLines; }
+
+    void addKeyframe(const std::string& element, AnimationProperty property, const Keyframe& keyframe);
+    // Samples all tracks at `sampleRate` per second; until then, or if the
+    // table would be too large, evaluation falls back to interpolate().
+    // Step easing switches within one sample.
+    void bake(int sampleRate = DEFAULT_SAMPLE_RATE);
+
+    bool empty() const { return m_elements.empty(); }
+    size_t elementCount() const { return m_elements.size(); }
+    int elementIndex(const std::string& element) const;
+    const std::string& elementName(size_t index) const { return m_elements[index]; }
+    // Time of the last keyframe; values hold after it.
+    float duration() const { return m_duration; }
+
+    // Evaluates every element at `time`; `poses` is resized to elementCount().
+    void evaluate(double time, std::vector<OverlayPose>& poses) const;
+    OverlayPose pose(size_t element, double time) const;
+
+    // Exact keyframe interpolation, without the baked table.
+    float interpolate(size_t element, AnimationProperty property, double time) const;
+
+    static float ease(Easing easing, float t);
+    static bool parseProperty(std::string_view name, AnimationProperty& property);
+    static bool parseEasing(std::string_view name, Easing& easing);
+
+private:
+    struct Track {
+        std::vector<Keyframe> keyframes;
+    };
+
+    void locate(double time, size_t& row, float& fraction) const;
+
+    std::vector<std::string> m_elements;
+    // PROPERTY_COUNT tracks per element.
+    std::vector<Track> m_tracks;
+    float m_duration = 0.0f;
+    int m_skippedLines = 0;
+
+    int m_sampleRate = DEFAULT_SAMPLE_RATE;
+    size_t m_rows = 0;
+    size_t m_rowWidth = 0;
+    // m_rows rows of m_rowWidth floats: element-major, PROPERTY_COUNT each,
+    // in OverlayPose field order.
+    std::vector<float> m_samples;
+};
@@ -0,0 +1,125 @@
+#include "TitleAnimation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float PI = 3.14159265358979f;
+
+    struct Placement {
+        float minX, minY, rangeX, rangeY;
+        float centerX, centerY;
+    };
+
+    // Pen positions that keep the scaled bounds on screen.
+    Placement place(const TextBounds& bounds, float scale, float screenWidth, float screenHeight)
+    {
+        Placement p;
+        const float width = bounds.width * scale;
+        const float height = bounds.height * scale;
+        p.minX = -bounds.x * scale;
+        p.minY = -bounds.y * scale;
+        p.rangeX = std::max(0.0f, screenWidth - width);
+        p.rangeY = std::max(0.0f, screenHeight - height);
+        p.centerX = p.minX + (screenWidth - width) / 2.0f;
+        p.centerY = p.minY + (screenHeight - height) / 2.0f;
+        return p;
+    }
+
+    float mix(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+}
+
+float TitleAnimation::easeInOutCubic(float t)
+{
+    return t < 0.5f ? 4.0f * t * t * t : 1.0f - std::pow(-2.0f * t + 2.0f, 3.0f) / 2.0f;
+}
+
+float TitleAnimation::reflect(double distance, float length)
+{
+    if (length <= 0.0f) {
+        return 0.0f;
+    }
+    const double period = 2.0 * length;
+    double m = std::fmod(distance, period);
+    if (m < 0.0) {
+        m += period;
+    }
+    return static_cast<float>(m <= length ? m : period - m);
+}
+
+TitleAnimation::Frame TitleAnimation::evaluate(double songTime, double songDuration, const Settings& settings,
+                                               const TextBounds& bounds, float screenWidth, float screenHeight)
+{
+    Frame frame;
+    if (songTime < 0.0) {
+        return frame;
+    }
+
+    const bool ending = songDuration > 0.0;
+    // Very short songs compress the fades so every phase still fits.
+    double fade = std::max(0.0, static_cast<double>(settings.fadeDuration));
+    if (ending) {
+        fade = std::min(fade, songDuration / 4.0);
+    }
+    const double transparentStart = fade + settings.bounceDuration;
+    const double opaqueStart = ending ? songDuration - 2.0 * fade : 0.0;
+    const double returnStart = ending ? songDuration - fade : 0.0;
+
+    const Placement start = place(bounds, settings.startScale, screenWidth, screenHeight);
+    const Placement bounce = place(bounds, settings.bounceScale, screenWidth, screenHeight);
+
+    // Alpha of the middle of the song, before the ending takes over.
+    auto middleAlpha = [&](double t) {
+        if (t < transparentStart) {
+            return 1.0f;
+        }
+        const float u = fade > 0.0 ? static_cast<float>(std::min(1.0, (t - transparentStart) / fade)) : 1.0f;
+        return mix(1.0f, settings.targetAlpha, easeInOutCubic(u));
+    };
+
+    // Bouncing starts from the centre once the fade in is done.
+    auto bouncePosition = [&](double t, float& x, float& y) {
+        const double distance = std::max(0.0, t - fade) * settings.bounceSpeed * screenHeight;
+        const float angle = settings.bounceAngle * PI / 180.0f;
+        x = bounce.minX + reflect((bounce.centerX - bounce.minX) + distance * std::cos(angle), bounce.rangeX);
+        y = bounce.minY + reflect((bounce.centerY - bounce.minY) + distance * std::sin(angle), bounce.rangeY);
+    };
+
+    if (songTime < fade) {
+        const float u = easeInOutCubic(static_cast<float>(songTime / fade));
+        frame.phase = Phase::FadeIn;
+        frame.scale = mix(settings.startScale, settings.bounceScale, u);
+        const Placement current = place(bounds, frame.scale, screenWidth, screenHeight);
+        frame.x = current.centerX;
+        frame.y = current.centerY;
+        frame.alpha = u;
+        return frame;
+    }
+
+    if (ending && songTime >= returnStart) {
+        const float u = fade > 0.0 ? easeInOutCubic(static_cast<float>(std::min(1.0, (songTime - returnStart) / fade))) : 1.0f;
+        float fromX, fromY;
+        bouncePosition(returnStart, fromX, fromY);
+        frame.phase = Phase::ReturnToCenter;
+        frame.scale = mix(settings.bounceScale, settings.startScale, u);
+        frame.x = mix(fromX, start.centerX, u);
+        frame.y = mix(fromY, start.centerY, u);
+        frame.alpha = 1.0f;
+        return frame;
+    }
+
+    frame.scale = settings.bounceScale;
+    bouncePosition(songTime, frame.x, frame.y);
+
+    if (ending && songTime >= opaqueStart) {
+        const float u = easeInOutCubic(static_cast<float>((songTime - opaqueStart) / fade));
+        frame.phase = Phase::FadeToOpaque;
+        frame.alpha = mix(middleAlpha(opaqueStart), 1.0f, u);
+    } else {
+        frame.phase = songTime < transparentStart ? Phase::Bouncing : Phase::FadeToTransparent;
+        frame.alpha = middleAlpha(songTime);
+    }
+    return frame;
+}
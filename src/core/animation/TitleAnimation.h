@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/text/FontMetrics.h"
+
+// Song title animation as a pure function of song time: fade in at the
+// centre, bounce off the screen edges while fading to a target alpha, then
+// return to the centre fully opaque as the song ends. Nothing is integrated
+// frame to frame, so any time can be evaluated in O(1), in any order and on
+// any thread, and exports are reproducible.
+class TitleAnimation
+{
+public:
+    struct Settings {
+        float fadeDuration = 3.0f;
+        // Time at full opacity after the fade in, before fading to targetAlpha.
+        float bounceDuration = 10.0f;
+        float targetAlpha = 0.4f;
+        float startScale = 1.0f;
+        float bounceScale = 0.6f;
+        // Screen heights per second.
+        float bounceSpeed = 0.15f;
+        // Launch direction in degrees, counter-clockwise from +x.
+        float bounceAngle = 37.0f;
+    };
+
+    enum class Phase {
+        Hidden,
+        FadeIn,
+        Bouncing,
+        FadeToTransparent,
+        FadeToOpaque,
+        ReturnToCenter
+    };
+
+    struct Frame {
+        Phase phase = Phase::Hidden;
+        // Pen position for TextRenderer::renderText (baseline of the first
+        // line, origin bottom left).
+        float x = 0.0f;
+        float y = 0.0f;
+        float scale = 1.0f;
+        float alpha = 0.0f;
+    };
+
+    // `bounds` are the text's bounds at scale 1 as given by
+    // FontMetrics::measure. A songDuration <= 0 means unknown: the title
+    // keeps bouncing and never returns to the centre.
+    static Frame evaluate(double songTime, double songDuration, const Settings& settings,
+                          const TextBounds& bounds, float screenWidth, float screenHeight);
+
+    static float easeInOutCubic(float t);
+    // Position of a point moving at constant speed inside [0, length] and
+    // reflecting off both ends, `distance` after leaving 0 towards +.
+    static float reflect(double distance, float length);
+};
@@ -1,8 +1,13 @@
 #define MA_IMPLEMENTATION
 #include "AudioEngine.h"
+#include "ChunkStream.h"
+#include "core/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
-#include <iostream>
-#include <mutex>
 
 #ifdef MA_ASSERT
 #undef MA_ASSERT
@@ -12,8 +17,45 @@
         throw std::runtime_error("miniaudio assertion failed: " #expr); \
     }
 
-AudioEngine::AudioEngine() {
-    m_vizBuffer.resize(VIZ_BUFFER_FRAMES * 2);
+namespace {
+    // Decoding only runs while this much lies ahead of the decoder, so the
+    // audio thread, which never waits for the network, rarely runs dry.
+    const uint64_t STREAM_LOOKAHEAD_BYTES = 32 * 1024;
+    // Backstop for reads outside the audio callback, e.g. while probing.
+    const std::chrono::milliseconds STREAM_READ_TIMEOUT(5000);
+    // Slice of the wait for a shared track to finish decoding.
+    const std::chrono::milliseconds SHARED_TRACK_WAIT(250);
+    // Seeks in a stream still downloading skip forward this many frames at
+    // a time, at most SEEK_STEPS_PER_CALLBACK times per callback.
+    const ma_uint64 SEEK_STEP_FRAMES = 4096;
+    const int SEEK_STEPS_PER_CALLBACK = 16;
+    // Visualization frames are scaled through a stack buffer this size.
+    const size_t VIZ_CHUNK_FRAMES = 256;
+
+    // Scales interleaved stereo from `in` to `out` (which may alias),
+    // moving linearly from `gain` to `target` across the frames and
+    // saturating; `gain` ends at `target`.
+    void applyGain(const short* in, short* out, size_t frames, float& gain, float target) {
+        if (gain == 1.0f && target == 1.0f) {
+            if (in != out) {
+                std::memcpy(out, in, frames * 2 * sizeof(short));
+            }
+            return;
+        }
+        const float step = frames > 0 ? (target - gain) / static_cast<float>(frames) : 0.0f;
+        for (size_t i = 0; i < frames; ++i) {
+            const float g = gain + step * static_cast<float>(i + 1);
+            for (size_t c = i * 2; c < i * 2 + 2; ++c) {
+                out[c] = static_cast<short>(std::clamp(std::lround(in[c] * g), -32768L, 32767L));
+            }
+        }
+        if (frames > 0) {
+            gain = target;
+        }
+    }
+}
+
+AudioEngine::AudioEngine() : m_vizBuffer(VIZ_BUFFER_FRAMES) {
 }
 
 AudioEngine::~AudioEngine() {
@@ -24,6 +66,9 @@ int AudioEngine::getSampleRate() const {
     if (!m_isInitialized) {
         return 44100;
     }
+    if (m_track) {
+        return m_track->sampleRate();
+    }
     return m_decoder.outputSampleRate;
 }
 
@@ -32,6 +77,13 @@ float AudioEngine::getSongDuration()
     if (!m_isInitialized) {
         return 0.0f;
     }
+    if (m_track) {
+        return static_cast<float>(m_track->frameCount()) / m_track->sampleRate();
+    }
+    // Measuring a partial MP3 would read (and wait for) the whole download.
+    if (m_stream && !m_stream->isFinished()) {
+        return 0.0f;
+    }
     ma_uint64 length_in_pcm_frames;
     ma_result result = ma_decoder_get_length_in_pcm_frames(&m_decoder, &length_in_pcm_frames);
     if (result != MA_SUCCESS) {
@@ -45,6 +97,13 @@ float AudioEngine::getCurrentPosition()
     if (!m_isInitialized) {
         return 0.0f;
     }
+    if (m_track) {
+        return static_cast<float>(m_trackFrame.load()) / m_track->sampleRate();
+    }
+    const int64_t pendingSeek = m_pendingSeekFrame.load();
+    if (pendingSeek >= 0) {
+        return static_cast<float>(pendingSeek) / m_decoder.outputSampleRate;
+    }
     ma_uint64 cursor_in_pcm_frames;
     ma_result result = ma_decoder_get_cursor_in_pcm_frames(&m_decoder, &cursor_in_pcm_frames);
     if (result != MA_SUCCESS) {
@@ -56,46 +115,197 @@ float AudioEngine::getCurrentPosition()
 void AudioEngine::closeFile() {
     if (m_isInitialized) {
         ma_device_uninit(&m_device);
-        ma_decoder_uninit(&m_decoder);
+        releaseSource();
         m_isInitialized = false;
     }
+    m_pendingSeekFrame = -1;
+}
+
+void AudioEngine::releaseSource() {
+    if (!m_track) {
+        ma_decoder_uninit(&m_decoder);
+    }
+    m_track.reset();
+    m_trackFrame = 0;
+    m_fileSource.close();
+    m_stream.reset();
+    m_restartDecoder = false;
+}
+
+void AudioEngine::setDecodeToMemory(bool enabled, DecodedTrack::Storage storage) {
+    m_decodeToMemory = enabled;
+    m_decodeStorage = storage;
 }
 
 bool AudioEngine::loadFile(const std::string& filePath) {
     closeFile();
 
-    ma_result result = ma_decoder_init_file(filePath.c_str(), nullptr, &m_decoder);
+    if (m_decodeToMemory) {
+        DecodedTrack::Options options;
+        options.storage = m_decodeStorage;
+        if (std::shared_ptr<DecodedTrack> track = DecodedTrack::decode(filePath, options)) {
+            return loadTrack(std::move(track));
+        }
+    }
+
+    // The callback, the gains and the visualization tap work in stereo s16
+    // whatever the file holds.
+    ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 2, 0);
+    ma_result result = m_fileSource.initDecoder(filePath, &config, &m_decoder);
+    if (result != MA_SUCCESS) {
+        logError(LogCategory::Audio, "Failed to open audio file: " + filePath);
+        return false;
+    }
+    return openDevice(m_decoder.outputFormat, m_decoder.outputChannels, m_decoder.outputSampleRate);
+}
+
+bool AudioEngine::loadTrack(std::shared_ptr<DecodedTrack> track) {
+    closeFile();
+    if (!track || track->sample() != DecodedTrack::Sample::S16 || track->channels() != 2) {
+        logError(LogCategory::Audio, "Decoded tracks must be stereo s16 for playback");
+        return false;
+    }
+
+    m_track = std::move(track);
+    m_trackFrame = 0;
+    return openDevice(ma_format_s16, static_cast<ma_uint32>(m_track->channels()),
+                      static_cast<ma_uint32>(m_track->sampleRate()));
+}
+
+bool AudioEngine::loadStream(std::shared_ptr<ChunkStream> stream) {
+    closeFile();
+
+    m_stream = std::move(stream);
+    m_streamPosition = 0;
+    ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 2, 0);
+    ma_result result = ma_decoder_init(readStream, seekStream, this, &config, &m_decoder);
     if (result != MA_SUCCESS) {
-        std::cerr << "Failed to open audio file: " << filePath << std::endl;
+        m_stream.reset();
+        logError(LogCategory::Audio, "Failed to decode the start of the download");
         return false;
     }
+    return openDevice(m_decoder.outputFormat, m_decoder.outputChannels, m_decoder.outputSampleRate);
+}
+
+bool AudioEngine::streamFailed() const {
+    return m_stream && m_stream->hasFailed();
+}
+
+void AudioEngine::seek(float seconds) {
+    if (!m_isInitialized) return;
+    if (m_track) {
+        const double frame = std::max(0.0f, seconds) * static_cast<double>(m_track->sampleRate());
+        m_trackFrame = std::min(static_cast<uint64_t>(frame), m_track->frameCount());
+        return;
+    }
+    m_pendingSeekFrame = static_cast<int64_t>(std::max(0.0f, seconds) * m_decoder.outputSampleRate);
+}
 
+bool AudioEngine::openDevice(ma_format format, ma_uint32 channels, ma_uint32 sampleRate) {
     ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
-    deviceConfig.playback.format   = m_decoder.outputFormat;
-    deviceConfig.playback.channels = m_decoder.outputChannels;
-    deviceConfig.sampleRate        = m_decoder.outputSampleRate;
+    deviceConfig.playback.format   = format;
+    deviceConfig.playback.channels = channels;
+    deviceConfig.sampleRate        = sampleRate;
     deviceConfig.dataCallback      = data_callback;
     deviceConfig.pUserData         = this;
 
-    result = ma_device_init(nullptr, &deviceConfig, &m_device);
+    ma_result result = ma_device_init(nullptr, &deviceConfig, &m_device);
     if (result != MA_SUCCESS) {
-        ma_decoder_uninit(&m_decoder);
-        std::cerr << "Failed to open playback device." << std::endl;
+        releaseSource();
+        logError(LogCategory::Audio, "Failed to open playback device.");
         return false;
     }
+    // Reconfigured for the new rate, and from silence, on the first callback.
+    m_dynamicsChanged = true;
 
     m_isInitialized = true;
     return true;
 }
 
+bool AudioEngine::decodeFile(const std::string& filePath, std::vector<short>& pcm, int& sampleRate) {
+    ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 2, 0);
+    ma_decoder decoder;
+    AudioFileSource source;
+    if (source.initDecoder(filePath, &config, &decoder) != MA_SUCCESS) {
+        logError(LogCategory::Audio, "Failed to open audio file for analysis: " + filePath);
+        return false;
+    }
+
+    sampleRate = static_cast<int>(decoder.outputSampleRate);
+    pcm.clear();
+    ma_uint64 totalFrames = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&decoder, &totalFrames) == MA_SUCCESS && totalFrames > 0) {
+        pcm.reserve(static_cast<size_t>(totalFrames) * 2);
+    }
+
+    const ma_uint64 chunkFrames = 4096;
+    std::vector<short> chunk(chunkFrames * 2);
+    ma_uint64 framesRead = 0;
+    do {
+        ma_decoder_read_pcm_frames(&decoder, chunk.data(), chunkFrames, &framesRead);
+        pcm.insert(pcm.end(), chunk.begin(), chunk.begin() + static_cast<size_t>(framesRead) * 2);
+    } while (framesRead == chunkFrames);
+
+    ma_decoder_uninit(&decoder);
+    return true;
+}
+
+bool AudioEngine::withWholeTrack(const std::string& filePath, const std::shared_ptr<DecodedTrack>& shared,
+                                 const std::function<void(const short*, size_t, int)>& use) {
+    if (shared && shared->sample() == DecodedTrack::Sample::S16 && shared->channels() == 2) {
+        while (!shared->waitComplete(SHARED_TRACK_WAIT)) {
+        }
+        if (!shared->hasFailed()) {
+            use(static_cast<const short*>(shared->data()), static_cast<size_t>(shared->frameCount()),
+                shared->sampleRate());
+            return true;
+        }
+    }
+
+    std::vector<short> pcm;
+    int sampleRate = 0;
+    if (!decodeFile(filePath, pcm, sampleRate)) {
+        return false;
+    }
+    use(pcm.data(), pcm.size() / 2, sampleRate);
+    return true;
+}
+
 void AudioEngine::data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
     auto* engine = static_cast<AudioEngine*>(pDevice->pUserData);
     MA_ASSERT(engine != nullptr);
 
     ma_uint64 framesRead = 0;
-    ma_decoder_read_pcm_frames(&engine->m_decoder, pOutput, frameCount, &framesRead);
+    if (engine->m_track) {
+        // Frames the decoder has not reached yet stay silent (miniaudio
+        // hands the callback a zeroed buffer). A seek made meanwhile wins.
+        uint64_t frame = engine->m_trackFrame.load();
+        framesRead = engine->m_track->read(frame, pOutput, frameCount);
+        engine->m_trackFrame.compare_exchange_strong(frame, frame + framesRead);
+    } else {
+        engine->m_inCallback = true;
+        if (engine->readyToDecode()) {
+            ma_decoder_read_pcm_frames(&engine->m_decoder, pOutput, frameCount, &framesRead);
+            if (framesRead < frameCount && engine->m_stream && !engine->m_stream->isFinished() &&
+                !engine->m_stream->hasFailed()) {
+                // The decoder ran into the end of what has arrived and now
+                // takes the file for over; restart it and skip back to here.
+                ma_uint64 cursor = 0;
+                ma_decoder_get_cursor_in_pcm_frames(&engine->m_decoder, &cursor);
+                int64_t none = -1;
+                engine->m_pendingSeekFrame.compare_exchange_strong(none, static_cast<int64_t>(cursor));
+                engine->m_restartDecoder = true;
+            }
+        } else {
+            // Waiting for the download: play silence and leave the cursor alone.
+            std::memset(pOutput, 0, static_cast<size_t>(frameCount) * ma_get_bytes_per_frame(pDevice->playback.format, pDevice->playback.channels));
+        }
+        engine->m_inCallback = false;
+    }
 
     engine->processAndStore(static_cast<const short*>(pOutput), framesRead);
+    applyGain(static_cast<const short*>(pOutput), static_cast<short*>(pOutput), framesRead, engine->m_playbackGain,
+              engine->m_playbackGainTarget.load());
 
     if (framesRead < frameCount) {
         // End of file
@@ -104,34 +314,118 @@ void AudioEngine::data_callback(ma_device* pDevice, void* pOutput, const void* p
     (void)pInput;
 }
 
-void AudioEngine::processAndStore(const short* pcmData, ma_uint32 frameCount) {
-    std::lock_guard<std::mutex> lock(m_vizBufferMutex);
-    size_t writePos = m_vizBufferWritePos.load();
-    const size_t channels = 2;
+bool AudioEngine::readyToDecode() {
+    const int64_t target = m_pendingSeekFrame.load();
+    if (!m_stream || m_stream->isFinished()) {
+        if (target >= 0) {
+            if (m_restartDecoder) {
+                ma_decoder_seek_to_pcm_frame(&m_decoder, 0);
+                m_restartDecoder = false;
+            }
+            ma_decoder_seek_to_pcm_frame(&m_decoder, static_cast<ma_uint64>(target));
+            // A newer seek that arrived meanwhile stays pending.
+            int64_t applied = target;
+            m_pendingSeekFrame.compare_exchange_strong(applied, -1);
+        }
+        return true;
+    }
+    if (m_stream->hasFailed()) {
+        return false;
+    }
+    if (target >= 0) {
+        // Where a frame lies in the file is unknown until the decoder has
+        // been there, so seek by decoding forward in slices, checking the
+        // lookahead before each one; backwards means starting over.
+        ma_uint64 cursor = 0;
+        ma_decoder_get_cursor_in_pcm_frames(&m_decoder, &cursor);
+        if (m_restartDecoder || static_cast<ma_uint64>(target) < cursor) {
+            ma_decoder_seek_to_pcm_frame(&m_decoder, 0);
+            m_restartDecoder = false;
+            cursor = 0;
+        }
+        for (int step = 0; step < SEEK_STEPS_PER_CALLBACK && cursor < static_cast<ma_uint64>(target); ++step) {
+            if (m_stream->size() < m_streamPosition + STREAM_LOOKAHEAD_BYTES) {
+                return false;
+            }
+            ma_uint64 skipped = 0;
+            ma_decoder_read_pcm_frames(&m_decoder, nullptr,
+                                       std::min(SEEK_STEP_FRAMES, static_cast<ma_uint64>(target) - cursor), &skipped);
+            if (skipped == 0) {
+                m_restartDecoder = true;
+                return false;
+            }
+            cursor += skipped;
+        }
+        if (cursor < static_cast<ma_uint64>(target)) {
+            return false;
+        }
+        int64_t applied = target;
+        m_pendingSeekFrame.compare_exchange_strong(applied, -1);
+    }
+    return m_stream->size() >= m_streamPosition + STREAM_LOOKAHEAD_BYTES;
+}
 
-    for (ma_uint32 i = 0; i < frameCount; ++i) {
-        m_vizBuffer[writePos * channels] = pcmData[i * channels];
-        m_vizBuffer[writePos * channels + 1] = pcmData[i * channels + 1];
-        writePos = (writePos + 1) % VIZ_BUFFER_FRAMES;
+ma_result AudioEngine::readStream(ma_decoder* pDecoder, void* pBufferOut, size_t bytesToRead, size_t* pBytesRead) {
+    auto* engine = static_cast<AudioEngine*>(pDecoder->pUserData);
+    // The audio thread takes what is there; a short read is fine, and
+    // readyToDecode keeps an empty one rare.
+    const size_t read = engine->m_stream->read(engine->m_streamPosition, static_cast<char*>(pBufferOut), bytesToRead,
+                                               engine->m_inCallback ? std::chrono::milliseconds(0)
+                                                                    : STREAM_READ_TIMEOUT);
+    engine->m_streamPosition += read;
+    *pBytesRead = read;
+    return read == 0 && bytesToRead > 0 ? MA_AT_END : MA_SUCCESS;
+}
+
+ma_result AudioEngine::seekStream(ma_decoder* pDecoder, ma_int64 byteOffset, ma_seek_origin origin) {
+    auto* engine = static_cast<AudioEngine*>(pDecoder->pUserData);
+    ma_int64 base = 0;
+    if (origin == ma_seek_origin_current) {
+        base = static_cast<ma_int64>(engine->m_streamPosition);
+    } else if (origin == ma_seek_origin_end) {
+        // Decoders do not seek from the end, and the end is not known yet.
+        return MA_NOT_IMPLEMENTED;
+    }
+    if (base + byteOffset < 0) {
+        return MA_INVALID_ARGS;
     }
-    m_vizBufferWritePos.store(writePos);
+    engine->m_streamPosition = static_cast<uint64_t>(base + byteOffset);
+    return MA_SUCCESS;
 }
 
-size_t AudioEngine::getPCM(short* pcmBuffer, size_t framesToRead) {
-    if (!m_isInitialized) return 0;
+void AudioEngine::setLoudnessGain(float playbackDb, float visualizationDb) {
+    m_playbackGainTarget = std::pow(10.0f, playbackDb / 20.0f);
+    m_vizGainTarget = std::pow(10.0f, visualizationDb / 20.0f);
+}
 
-    std::lock_guard<std::mutex> lock(m_vizBufferMutex);
-    const size_t channels = 2;
-    const size_t bufferSizeFrames = m_vizBuffer.size() / channels;
-    size_t writePos = m_vizBufferWritePos.load();
+void AudioEngine::setVisualizationDynamics(const VisualizationDynamics::Settings& settings) {
+    std::lock_guard<std::mutex> lock(m_dynamicsMutex);
+    m_dynamicsSettings = settings;
+    m_dynamicsChanged = true;
+}
 
-    for (size_t i = 0; i < framesToRead; ++i) {
-        size_t readPos = (writePos - 1 - i + bufferSizeFrames) % bufferSizeFrames;
-        pcmBuffer[(framesToRead - 1 - i) * channels] = m_vizBuffer[readPos * channels];
-        pcmBuffer[(framesToRead - 1 - i) * channels + 1] = m_vizBuffer[readPos * channels + 1];
+void AudioEngine::processAndStore(const short* pcmData, ma_uint32 frameCount) {
+    if (m_dynamicsChanged.load()) {
+        // Never wait on the GUI thread here; a busy lock retries next callback.
+        std::unique_lock<std::mutex> lock(m_dynamicsMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            m_dynamics.configure(m_dynamicsSettings, static_cast<int>(m_device.sampleRate));
+            m_dynamicsChanged = false;
+        }
     }
+    const float target = m_vizGainTarget.load();
+    short scaled[VIZ_CHUNK_FRAMES * 2];
+    for (size_t first = 0; first < frameCount; first += VIZ_CHUNK_FRAMES) {
+        const size_t frames = std::min<size_t>(VIZ_CHUNK_FRAMES, frameCount - first);
+        applyGain(pcmData + first * 2, scaled, frames, m_vizGain, target);
+        m_dynamics.process(scaled, scaled, frames);
+        m_vizBuffer.store(scaled, frames);
+    }
+}
 
-    return framesToRead;
+size_t AudioEngine::getPCM(short* pcmBuffer, size_t framesToRead) {
+    if (!m_isInitialized) return 0;
+    return m_vizBuffer.latest(pcmBuffer, framesToRead);
 }
 
 bool AudioEngine::isPlaying() {
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
-#include <mutex>
-#include <atomic>
 #include "miniaudio.h"
+#include "AudioFileSource.h"
+#include "DecodedTrack.h"
+#include "VisualizationBuffer.h"
+#include "VisualizationDynamics.h"
+
+class ChunkStream;
 
 class AudioEngine {
 public:
@@ -12,6 +20,33 @@ public:
     ~AudioEngine();
 
     bool loadFile(const std::string& filePath);
+    // While enabled, loadFile decodes the whole track into memory in the
+    // background and plays from there, so seeks are instant and exact.
+    // Files whose length is unknown up front still stream.
+    void setDecodeToMemory(bool enabled, DecodedTrack::Storage storage = DecodedTrack::Storage::Heap);
+    // Plays an interleaved stereo s16 track, possibly still decoding;
+    // frames the decoder has not reached yet play as silence.
+    bool loadTrack(std::shared_ptr<DecodedTrack> track);
+    // The decoded copy being played, if any, for other consumers to share.
+    std::shared_ptr<DecodedTrack> track() const { return m_track; }
+    // Plays a file that is still downloading. Call once the first few
+    // hundred KB have arrived; when playback catches up with the download,
+    // or a seek lands past it, the device plays silence until the data is
+    // there instead of blocking.
+    bool loadStream(std::shared_ptr<ChunkStream> stream);
+    // Whether the download being played broke off; playback is silent from
+    // then on, so the caller should close it.
+    bool streamFailed() const;
+    // Applied by the audio thread on its next callback.
+    void seek(float seconds);
+    // Per-track loudness normalization, applied in the audio callback and
+    // ramped over a few milliseconds so a change never clicks. The
+    // visualization tap has its own gain, so projectM sees comparable
+    // levels whether or not playback is normalized.
+    void setLoudnessGain(float playbackDb, float visualizationDb);
+    // AGC and compression of the visualization copy only; picked up by the
+    // audio thread on its next callback.
+    void setVisualizationDynamics(const VisualizationDynamics::Settings& settings);
     void closeFile();
     size_t getPCM(short* buffer, size_t frames);
     float getSongDuration();
@@ -21,16 +56,59 @@ public:
     void pause();
     int getSampleRate() const;
 
+    // Decodes a whole file to interleaved stereo s16 for offline analysis.
+    static bool decodeFile(const std::string& filePath, std::vector<short>& pcm, int& sampleRate);
+    // Calls `use(pcm, frames, sampleRate)` with the whole file as interleaved
+    // stereo s16. `shared` (usually track() of the engine playing it) is used
+    // once it has finished decoding, so a song is decoded only once; without
+    // it the file is decoded as decodeFile() does. Blocks; false, without
+    // calling `use`, if the file cannot be decoded.
+    static bool withWholeTrack(const std::string& filePath, const std::shared_ptr<DecodedTrack>& shared,
+                               const std::function<void(const short*, size_t, int)>& use);
+
 private:
     static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
+    static ma_result readStream(ma_decoder* pDecoder, void* pBufferOut, size_t bytesToRead, size_t* pBytesRead);
+    static ma_result seekStream(ma_decoder* pDecoder, ma_int64 byteOffset, ma_seek_origin origin);
+    bool openDevice(ma_format format, ma_uint32 channels, ma_uint32 sampleRate);
+    void releaseSource();
+    // Applies a pending seek and reports whether the decoder can run without
+    // waiting on the stream.
+    bool readyToDecode();
     void processAndStore(const short* pcmData, ma_uint32 frameCount);
 
     ma_decoder m_decoder;
     ma_device m_device;
     bool m_isInitialized = false;
+    AudioFileSource m_fileSource;
+
+    std::shared_ptr<ChunkStream> m_stream;
+    // Byte offset of the decoder in m_stream; only touched by decoder calls.
+    uint64_t m_streamPosition = 0;
+    std::atomic<int64_t> m_pendingSeekFrame{-1};
+    // Audio thread state: reads from the callback never wait, and a decoder
+    // that ran out of data must start over to forget it hit the end.
+    bool m_inCallback = false;
+    bool m_restartDecoder = false;
+
+    bool m_decodeToMemory = false;
+    DecodedTrack::Storage m_decodeStorage = DecodedTrack::Storage::Heap;
+    // Replaces m_decoder while set.
+    std::shared_ptr<DecodedTrack> m_track;
+    std::atomic<uint64_t> m_trackFrame{0};
+
+    std::atomic<float> m_playbackGainTarget{1.0f};
+    std::atomic<float> m_vizGainTarget{1.0f};
+    // Linear gains reached so far; only touched by the audio thread.
+    float m_playbackGain = 1.0f;
+    float m_vizGain = 1.0f;
+
+    std::mutex m_dynamicsMutex;
+    VisualizationDynamics::Settings m_dynamicsSettings;
+    std::atomic<bool> m_dynamicsChanged{true};
+    // Only touched by the audio thread, or while no device is running.
+    VisualizationDynamics m_dynamics;
 
     static const size_t VIZ_BUFFER_FRAMES = 1024;
-    std::vector<short> m_vizBuffer;
-    std::atomic<size_t> m_vizBufferWritePos{0};
-    std::mutex m_vizBufferMutex;
+    VisualizationBuffer m_vizBuffer;
 };
@@ -0,0 +1,70 @@
+#include "AudioFileSource.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Hinted ahead of the decoder; refreshed when half of it is used up.
+    const size_t PREFETCH_BYTES = 4 * 1024 * 1024;
+}
+
+ma_result AudioFileSource::initDecoder(const std::string& filePath, const ma_decoder_config* config, ma_decoder* decoder)
+{
+    close();
+    if (!m_file.open(filePath, MappedFile::Access::Sequential)) {
+        return ma_decoder_init_file(filePath.c_str(), config, decoder);
+    }
+    prefetchAhead();
+    const ma_result result = ma_decoder_init(read, seek, this, config, decoder);
+    if (result != MA_SUCCESS) {
+        close();
+    }
+    return result;
+}
+
+void AudioFileSource::close()
+{
+    m_file.close();
+    m_position = 0;
+    m_prefetchedTo = 0;
+}
+
+void AudioFileSource::prefetchAhead()
+{
+    if (m_position + PREFETCH_BYTES / 2 < m_prefetchedTo) {
+        return;
+    }
+    const size_t from = std::max(m_position, m_prefetchedTo);
+    m_file.prefetch(from, m_position + PREFETCH_BYTES - from);
+    m_prefetchedTo = m_position + PREFETCH_BYTES;
+}
+
+ma_result AudioFileSource::read(ma_decoder* decoder, void* out, size_t bytes, size_t* bytesRead)
+{
+    auto* source = static_cast<AudioFileSource*>(decoder->pUserData);
+    const size_t size = source->m_file.size();
+    const size_t count = source->m_position < size ? std::min(bytes, size - source->m_position) : 0;
+    std::memcpy(out, source->m_file.data() + source->m_position, count);
+    source->m_position += count;
+    source->prefetchAhead();
+    *bytesRead = count;
+    return count == 0 && bytes > 0 ? MA_AT_END : MA_SUCCESS;
+}
+
+ma_result AudioFileSource::seek(ma_decoder* decoder, ma_int64 offset, ma_seek_origin origin)
+{
+    auto* source = static_cast<AudioFileSource*>(decoder->pUserData);
+    ma_int64 base = 0;
+    if (origin == ma_seek_origin_current) {
+        base = static_cast<ma_int64>(source->m_position);
+    } else if (origin == ma_seek_origin_end) {
+        base = static_cast<ma_int64>(source->m_file.size());
+    }
+    if (base + offset < 0) {
+        return MA_INVALID_ARGS;
+    }
+    source->m_position = static_cast<size_t>(base + offset);
+    // A jump lands outside the window; start a new one there.
+    source->m_prefetchedTo = 0;
+    source->prefetchAhead();
+    return MA_SUCCESS;
+}
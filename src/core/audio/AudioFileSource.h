@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "miniaudio.h"
+#include "core/MappedFile.h"
+
+// Byte source for a miniaudio decoder that reads a file through a
+// read-only mapping instead of buffered stdio, so decoding a file costs
+// page faults served by kernel readahead rather than a read() syscall per
+// buffer; the decoder copies straight out of the page cache. Pipes and
+// other files that cannot be mapped fall back to ma_decoder_init_file.
+//
+// The source must outlive the decoder it initialised.
+class AudioFileSource
+{
+public:
+    AudioFileSource() = default;
+    AudioFileSource(const AudioFileSource&) = delete;
+    AudioFileSource& operator=(const AudioFileSource&) = delete;
+
+    // `config` may be null for the file's native format.
+    ma_result initDecoder(const std::string& filePath, const ma_decoder_config* config, ma_decoder* decoder);
+    void close();
+
+    bool isMapped() const { return m_file.isOpen(); }
+
+private:
+    static ma_result read(ma_decoder* decoder, void* out, size_t bytes, size_t* bytesRead);
+    static ma_result seek(ma_decoder* decoder, ma_int64 offset, ma_seek_origin origin);
+    // Keeps the prefetch window ahead of the read position.
+    void prefetchAhead();
+
+    MappedFile m_file;
+    size_t m_position = 0;
+    size_t m_prefetchedTo = 0;
+};
@@ -0,0 +1,85 @@
+#include "ChunkStream.h"
+#include <algorithm>
+#include <cstring>
+
+void ChunkStream::append(const char* data, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished || m_failed) {
+            return;
+        }
+        while (size > 0) {
+            const size_t used = static_cast<size_t>(m_size % BLOCK_BYTES);
+            if (used == 0 && m_size / BLOCK_BYTES == m_blocks.size()) {
+                m_blocks.push_back(std::make_unique<char[]>(BLOCK_BYTES));
+            }
+            const size_t take = std::min(size, BLOCK_BYTES - used);
+            std::memcpy(m_blocks.back().get() + used, data, take);
+            m_size += take;
+            data += take;
+            size -= take;
+        }
+    }
+    m_grown.notify_all();
+}
+
+void ChunkStream::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = true;
+    }
+    m_grown.notify_all();
+}
+
+void ChunkStream::fail()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failed = true;
+    }
+    m_grown.notify_all();
+}
+
+uint64_t ChunkStream::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+bool ChunkStream::isFinished() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_finished;
+}
+
+bool ChunkStream::hasFailed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failed;
+}
+
+bool ChunkStream::waitFor(uint64_t bytes, std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_grown.wait_for(lock, timeout, [&]() { return m_size >= bytes || m_finished || m_failed; });
+}
+
+size_t ChunkStream::read(uint64_t offset, char* out, size_t size, std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_grown.wait_for(lock, timeout, [&]() { return m_size >= offset + size || m_finished || m_failed; });
+    if (offset >= m_size) {
+        return 0;
+    }
+    const size_t count = static_cast<size_t>(std::min<uint64_t>(size, m_size - offset));
+    for (size_t copied = 0; copied < count;) {
+        const uint64_t position = offset + copied;
+        const size_t inBlock = static_cast<size_t>(position % BLOCK_BYTES);
+        const size_t take = std::min(count - copied, BLOCK_BYTES - inBlock);
+        std::memcpy(out + copied, m_blocks[static_cast<size_t>(position / BLOCK_BYTES)].get() + inBlock, take);
+        copied += take;
+    }
+    return count;
+}
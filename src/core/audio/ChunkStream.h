@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A file that is still arriving: the downloader appends chunks while the
+// decoder reads behind it. Reads past the downloaded range wait (up to a
+// timeout) for the bytes to arrive instead of failing. Data is kept in
+// fixed-size blocks, so appending never moves what readers are using and an
+// offset maps to its block directly.
+class ChunkStream
+{
+public:
+    static const size_t BLOCK_BYTES = 64 * 1024;
+
+    void append(const char* data, size_t size);
+    // No more data will come; readers see the end of the stream.
+    void finish();
+    // The transfer was abandoned; waiting readers give up at once.
+    void fail();
+
+    uint64_t size() const;
+    bool isFinished() const;
+    bool hasFailed() const;
+
+    // Waits until at least `bytes` have arrived or the stream ended; false
+    // if neither happened within `timeout`.
+    bool waitFor(uint64_t bytes, std::chrono::milliseconds timeout) const;
+    // Copies up to `size` bytes from `offset`, waiting for them as above.
+    // Returns fewer only at the end of the stream or on timeout.
+    size_t read(uint64_t offset, char* out, size_t size, std::chrono::milliseconds timeout) const;
+
+private:
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_grown;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    uint64_t m_size = 0;
+    bool m_finished = false;
+    bool m_failed = false;
+};
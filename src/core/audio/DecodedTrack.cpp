@@ -0,0 +1,174 @@
+#include "DecodedTrack.h"
+#include "AudioFileSource.h"
+#include "core/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char TRACK_MAGIC[8] = {'A', 'U', 'R', 'P', 'C', 'M', '1', '\0'};
+    // Frames per decoder call; decodedFrames() advances in these steps.
+    const uint64_t DECODE_CHUNK_FRAMES = 16384;
+    const std::chrono::milliseconds WAIT_SLICE(2);
+}
+
+struct DecodedTrack::Job {
+    AudioFileSource source;
+    ma_decoder decoder;
+};
+
+DecodedTrack::~DecodedTrack()
+{
+    m_cancelled = true;
+    if (m_decoder.joinable()) {
+        m_decoder.join();
+    }
+    if (m_header) {
+        munmap(m_header, m_mappedBytes);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+size_t DecodedTrack::bytesPerFrame() const
+{
+    return static_cast<size_t>(channels()) * (sample() == Sample::S16 ? sizeof(int16_t) : sizeof(float));
+}
+
+bool DecodedTrack::map(size_t bytes, bool shared)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (shared) {
+        m_fd = memfd_create("aurora-track", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (m_fd < 0 || ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+            return false;
+        }
+        // Attached readers map the whole size; it must never change under them.
+        fcntl(m_fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+        flags = MAP_SHARED;
+    }
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, m_fd, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    m_mappedBytes = bytes;
+    m_header = new (memory) Header();
+    m_data = static_cast<char*>(memory) + HEADER_BYTES;
+    return true;
+}
+
+std::shared_ptr<DecodedTrack> DecodedTrack::decode(const std::string& filePath, const Options& options)
+{
+    const ma_format format = options.sample == Sample::S16 ? ma_format_s16 : ma_format_f32;
+    ma_decoder_config config = ma_decoder_config_init(format, static_cast<ma_uint32>(options.channels),
+                                                      static_cast<ma_uint32>(options.sampleRate));
+    auto job = std::make_unique<Job>();
+    if (job->source.initDecoder(filePath, &config, &job->decoder) != MA_SUCCESS) {
+        logError(LogCategory::Audio, "Failed to open audio file for decoding: " + filePath);
+        return nullptr;
+    }
+    ma_uint64 frames = 0;
+    if (ma_decoder_get_length_in_pcm_frames(&job->decoder, &frames) != MA_SUCCESS || frames == 0) {
+        logWarning(LogCategory::Audio, "Length of " + filePath + " is unknown; not decoding it to memory");
+        ma_decoder_uninit(&job->decoder);
+        return nullptr;
+    }
+
+    std::shared_ptr<DecodedTrack> track(new DecodedTrack());
+    const size_t frameBytes = static_cast<size_t>(options.channels) * ma_get_bytes_per_sample(format);
+    if (!track->map(HEADER_BYTES + static_cast<size_t>(frames) * frameBytes, options.storage == Storage::Shared)) {
+        logError(LogCategory::Audio, "Failed to allocate memory for decoding " + filePath);
+        ma_decoder_uninit(&job->decoder);
+        return nullptr;
+    }
+    Header* header = track->m_header;
+    std::memcpy(header->magic, TRACK_MAGIC, sizeof(TRACK_MAGIC));
+    header->sampleRate = job->decoder.outputSampleRate;
+    header->channels = static_cast<uint16_t>(options.channels);
+    header->sample = static_cast<uint16_t>(options.sample);
+    header->frameCount.store(frames, std::memory_order_release);
+
+    track->m_decoder = std::thread(&DecodedTrack::run, track.get(), std::move(job));
+    return track;
+}
+
+void DecodedTrack::run(std::unique_ptr<Job> job)
+{
+    const uint64_t capacity = frameCount();
+    const size_t frameBytes = bytesPerFrame();
+    uint64_t decoded = 0;
+    ma_result result = MA_SUCCESS;
+    while (decoded < capacity && !m_cancelled) {
+        const uint64_t want = std::min(DECODE_CHUNK_FRAMES, capacity - decoded);
+        ma_uint64 got = 0;
+        result = ma_decoder_read_pcm_frames(&job->decoder, static_cast<char*>(m_data) + decoded * frameBytes, want, &got);
+        decoded += got;
+        m_header->decodedFrames.store(decoded, std::memory_order_release);
+        if (got < want) {
+            break;
+        }
+    }
+    ma_decoder_uninit(&job->decoder);
+
+    if (m_cancelled || (result != MA_SUCCESS && result != MA_AT_END && decoded == 0)) {
+        m_header->state.store(FAILED, std::memory_order_release);
+        return;
+    }
+    // The length was an estimate the stream fell short of.
+    m_header->frameCount.store(decoded, std::memory_order_release);
+    m_header->state.store(COMPLETE, std::memory_order_release);
+}
+
+std::shared_ptr<DecodedTrack> DecodedTrack::attach(int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_BYTES) {
+        return nullptr;
+    }
+    const size_t bytes = static_cast<size_t>(info.st_size);
+    void* memory = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::shared_ptr<DecodedTrack> track(new DecodedTrack());
+    track->m_header = static_cast<Header*>(memory);
+    track->m_data = static_cast<char*>(memory) + HEADER_BYTES;
+    track->m_mappedBytes = bytes;
+    const Header* header = track->m_header;
+    if (std::memcmp(header->magic, TRACK_MAGIC, sizeof(TRACK_MAGIC)) != 0 || header->channels == 0 ||
+        header->sample > static_cast<uint16_t>(Sample::F32) ||
+        HEADER_BYTES + track->frameCount() * track->bytesPerFrame() > bytes) {
+        return nullptr;
+    }
+    return track;
+}
+
+bool DecodedTrack::waitComplete(std::chrono::milliseconds timeout) const
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (m_header->state.load(std::memory_order_acquire) == DECODING) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(WAIT_SLICE);
+    }
+    return true;
+}
+
+uint64_t DecodedTrack::read(uint64_t frame, void* out, uint64_t frames) const
+{
+    const uint64_t available = decodedFrames();
+    if (frame >= available) {
+        return 0;
+    }
+    const uint64_t count = std::min(frames, available - frame);
+    const size_t frameBytes = bytesPerFrame();
+    std::memcpy(out, static_cast<const char*>(m_data) + frame * frameBytes, count * frameBytes);
+    return count;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+// A whole track decoded once into PCM, for sample-accurate random access:
+// frames have a fixed size, so frame N lives at N * bytesPerFrame() and the
+// buffer is its own seek table. Decoding runs on a background thread and
+// readers may use every frame below decodedFrames() while it does.
+//
+// Shared storage puts the buffer in a memfd, so other processes (export
+// workers) can attach() to the same decoded copy, even mid-decode.
+class DecodedTrack
+{
+public:
+    enum class Sample { S16, F32 };
+    enum class Storage { Heap, Shared };
+
+    struct Options {
+        Sample sample = Sample::S16;
+        Storage storage = Storage::Heap;
+        int channels = 2;
+        // 0 keeps the file's rate.
+        int sampleRate = 0;
+    };
+
+    ~DecodedTrack();
+    DecodedTrack(const DecodedTrack&) = delete;
+    DecodedTrack& operator=(const DecodedTrack&) = delete;
+
+    // Null when the file cannot be decoded or its length is unknown up front.
+    static std::shared_ptr<DecodedTrack> decode(const std::string& filePath, const Options& options);
+    // Read-only view of a Shared track from another DecodedTrack's fd().
+    // The descriptor is not taken over.
+    static std::shared_ptr<DecodedTrack> attach(int fd);
+
+    int sampleRate() const { return static_cast<int>(m_header->sampleRate); }
+    int channels() const { return m_header->channels; }
+    Sample sample() const { return static_cast<Sample>(m_header->sample); }
+    size_t bytesPerFrame() const;
+
+    // Exact once complete; until then the decoder's estimate.
+    uint64_t frameCount() const { return m_header->frameCount.load(std::memory_order_acquire); }
+    uint64_t decodedFrames() const { return m_header->decodedFrames.load(std::memory_order_acquire); }
+    bool isComplete() const { return m_header->state.load(std::memory_order_acquire) == COMPLETE; }
+    bool hasFailed() const { return m_header->state.load(std::memory_order_acquire) == FAILED; }
+    // False if the decode is still running after `timeout`.
+    bool waitComplete(std::chrono::milliseconds timeout) const;
+
+    // Copies up to `frames` frames from `frame`; fewer at the end of the
+    // track or where the decoder has not got to yet.
+    uint64_t read(uint64_t frame, void* out, uint64_t frames) const;
+    // Frame 0; valid up to decodedFrames().
+    const void* data() const { return m_data; }
+    // -1 for Heap storage.
+    int fd() const { return m_fd; }
+
+private:
+    enum : uint32_t { DECODING, COMPLETE, FAILED };
+
+    struct Header {
+        char magic[8];
+        uint32_t sampleRate;
+        uint16_t channels;
+        uint16_t sample;
+        std::atomic<uint64_t> frameCount;
+        std::atomic<uint64_t> decodedFrames;
+        std::atomic<uint32_t> state;
+    };
+    static const size_t HEADER_BYTES = 64;
+    static_assert(sizeof(Header) <= HEADER_BYTES, "header overlaps the PCM");
+
+    // An open decoder and the file it reads; neither may move once open.
+    struct Job;
+
+    DecodedTrack() = default;
+    bool map(size_t bytes, bool shared);
+    void run(std::unique_ptr<Job> job);
+
+    Header* m_header = nullptr;
+    void* m_data = nullptr;
+    size_t m_mappedBytes = 0;
+    int m_fd = -1;
+    std::thread m_decoder;
+    std::atomic<bool> m_cancelled{false};
+};
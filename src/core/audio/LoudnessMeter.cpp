@@ -0,0 +1,201 @@
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const size_t STEPS_PER_BLOCK = 4;
+    const size_t STEPS_SHORT_TERM = 30;
+    const double ABSOLUTE_GATE_LUFS = -70.0;
+    const double RELATIVE_GATE_LU = -10.0;
+    // Filter state this small only decays further into denormals.
+    const double STATE_FLOOR = 1e-30;
+
+    double toLufs(double meanSquare)
+    {
+        return meanSquare > 0.0 ? -0.691 + 10.0 * std::log10(meanSquare)
+                                : -std::numeric_limits<double>::infinity();
+    }
+
+    double fromLufs(double lufs)
+    {
+        return std::pow(10.0, (lufs + 0.691) / 10.0);
+    }
+}
+
+LoudnessMeter::LoudnessMeter(int sampleRate)
+    : m_stepFrames(std::max<size_t>(1, static_cast<size_t>(std::lround(sampleRate / 10.0)))),
+      m_recentSteps(STEPS_SHORT_TERM, 0.0)
+{
+    // BS.1770 stage 1 (head-related high shelf) and stage 2 (RLB high
+    // pass), derived for any rate from their analogue prototypes.
+    const double rate = static_cast<double>(sampleRate);
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                   2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        m_highPass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    }
+}
+
+void LoudnessMeter::addFrames(const short* interleavedStereo, size_t frameCount)
+{
+    const double scale = 1.0 / 32768.0;
+    while (frameCount > 0) {
+        const size_t run = std::min(frameCount, m_stepFrames - m_stepFilled);
+        const Biquad& s = m_shelf;
+        const Biquad& h = m_highPass;
+#if defined(__SSE2__)
+        // Left and right share each register; the filters run once per frame.
+        const __m128d sb0 = _mm_set1_pd(s.b0), sb1 = _mm_set1_pd(s.b1), sb2 = _mm_set1_pd(s.b2);
+        const __m128d sa1 = _mm_set1_pd(s.a1), sa2 = _mm_set1_pd(s.a2);
+        const __m128d hb0 = _mm_set1_pd(h.b0), hb1 = _mm_set1_pd(h.b1), hb2 = _mm_set1_pd(h.b2);
+        const __m128d ha1 = _mm_set1_pd(h.a1), ha2 = _mm_set1_pd(h.a2);
+        const __m128d scaleV = _mm_set1_pd(scale);
+        __m128d s1 = _mm_loadu_pd(m_state[0][0]), s2 = _mm_loadu_pd(m_state[0][1]);
+        __m128d h1 = _mm_loadu_pd(m_state[1][0]), h2 = _mm_loadu_pd(m_state[1][1]);
+        __m128d squares = _mm_setzero_pd();
+        for (size_t i = 0; i < run; ++i) {
+            const __m128d x = _mm_mul_pd(_mm_set_pd(interleavedStereo[i * 2 + 1], interleavedStereo[i * 2]), scaleV);
+            const __m128d y = _mm_add_pd(_mm_mul_pd(sb0, x), s1);
+            s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sb1, x), _mm_mul_pd(sa1, y)), s2);
+            s2 = _mm_sub_pd(_mm_mul_pd(sb2, x), _mm_mul_pd(sa2, y));
+            const __m128d z = _mm_add_pd(_mm_mul_pd(hb0, y), h1);
+            h1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hb1, y), _mm_mul_pd(ha1, z)), h2);
+            h2 = _mm_sub_pd(_mm_mul_pd(hb2, y), _mm_mul_pd(ha2, z));
+            squares = _mm_add_pd(squares, _mm_mul_pd(z, z));
+        }
+        _mm_storeu_pd(m_state[0][0], s1);
+        _mm_storeu_pd(m_state[0][1], s2);
+        _mm_storeu_pd(m_state[1][0], h1);
+        _mm_storeu_pd(m_state[1][1], h2);
+        double lanes[2];
+        _mm_storeu_pd(lanes, squares);
+        m_stepSquares += lanes[0] + lanes[1];
+#else
+        for (int channel = 0; channel < 2; ++channel) {
+            double s1 = m_state[0][0][channel], s2 = m_state[0][1][channel];
+            double h1 = m_state[1][0][channel], h2 = m_state[1][1][channel];
+            for (size_t i = 0; i < run; ++i) {
+                const double x = interleavedStereo[i * 2 + channel] * scale;
+                const double y = s.b0 * x + s1;
+                s1 = s.b1 * x - s.a1 * y + s2;
+                s2 = s.b2 * x - s.a2 * y;
+                const double z = h.b0 * y + h1;
+                h1 = h.b1 * y - h.a1 * z + h2;
+                h2 = h.b2 * y - h.a2 * z;
+                m_stepSquares += z * z;
+            }
+            m_state[0][0][channel] = s1;
+            m_state[0][1][channel] = s2;
+            m_state[1][0][channel] = h1;
+            m_state[1][1][channel] = h2;
+        }
+#endif
+        interleavedStereo += run * 2;
+        frameCount -= run;
+        m_stepFilled += run;
+        if (m_stepFilled == m_stepFrames) {
+            finishStep();
+        }
+    }
+}
+
+void LoudnessMeter::finishStep()
+{
+    m_recentSteps[m_stepCount % STEPS_SHORT_TERM] = m_stepSquares / static_cast<double>(m_stepFrames);
+    ++m_stepCount;
+    m_stepSquares = 0.0;
+    m_stepFilled = 0;
+    if (m_stepCount >= STEPS_PER_BLOCK) {
+        double sum = 0.0;
+        for (size_t i = 1; i <= STEPS_PER_BLOCK; ++i) {
+            sum += m_recentSteps[(m_stepCount - i) % STEPS_SHORT_TERM];
+        }
+        m_blocks.push_back(sum / STEPS_PER_BLOCK);
+    }
+    for (auto& stage : m_state) {
+        for (auto& delay : stage) {
+            for (double& value : delay) {
+                if (std::fabs(value) < STATE_FLOOR) {
+                    value = 0.0;
+                }
+            }
+        }
+    }
+}
+
+double LoudnessMeter::windowLoudness(size_t steps) const
+{
+    if (m_stepCount < steps) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    double sum = 0.0;
+    for (size_t i = 1; i <= steps; ++i) {
+        sum += m_recentSteps[(m_stepCount - i) % STEPS_SHORT_TERM];
+    }
+    return toLufs(sum / static_cast<double>(steps));
+}
+
+double LoudnessMeter::momentary() const
+{
+    return windowLoudness(STEPS_PER_BLOCK);
+}
+
+double LoudnessMeter::shortTerm() const
+{
+    return windowLoudness(STEPS_SHORT_TERM);
+}
+
+double LoudnessMeter::integrated() const
+{
+    const double absoluteGate = fromLufs(ABSOLUTE_GATE_LUFS);
+    double sum = 0.0;
+    size_t count = 0;
+    for (double block : m_blocks) {
+        if (block > absoluteGate) {
+            sum += block;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    const double relativeGate = std::max(absoluteGate, sum / count * std::pow(10.0, RELATIVE_GATE_LU / 10.0));
+    sum = 0.0;
+    count = 0;
+    for (double block : m_blocks) {
+        if (block > relativeGate) {
+            sum += block;
+            ++count;
+        }
+    }
+    return count > 0 ? toLufs(sum / count) : -std::numeric_limits<double>::infinity();
+}
+
+double LoudnessMeter::normalizationGainDb(double loudness, double target, double peak, double maxBoostDb)
+{
+    if (!std::isfinite(loudness)) {
+        return 0.0;
+    }
+    double gain = std::min(target - loudness, maxBoostDb);
+    if (peak > 0.0) {
+        gain = std::min(gain, -20.0 * std::log10(peak));
+    }
+    return gain;
+}
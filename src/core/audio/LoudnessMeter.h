@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ITU-R BS.1770 / EBU R128 loudness of interleaved stereo s16: K-weighting
+// (high shelf and high pass biquads, both channels filtered together in
+// one SIMD register), 400 ms momentary and 3 s short-term windows, and
+// gated integrated loudness (absolute gate -70 LUFS, relative gate -10 LU).
+// Results are in LUFS; silence reads as -infinity.
+class LoudnessMeter
+{
+public:
+    explicit LoudnessMeter(int sampleRate);
+
+    void addFrames(const short* interleavedStereo, size_t frameCount);
+
+    double integrated() const;
+    // Over the most recent 400 ms and 3 s of complete 100 ms steps.
+    double momentary() const;
+    double shortTerm() const;
+
+    // Gain in dB that moves `loudness` to `target`, at most `maxBoostDb`,
+    // and never so much that a sample peak of `peak` (full scale 1.0)
+    // would clip. 0 for unmeasured (silent) tracks.
+    static double normalizationGainDb(double loudness, double target, double peak, double maxBoostDb);
+
+private:
+    struct Biquad {
+        double b0, b1, b2, a1, a2;
+    };
+
+    double windowLoudness(size_t steps) const;
+    void finishStep();
+
+    Biquad m_shelf;
+    Biquad m_highPass;
+    // Transposed direct form II state, [stage][delay][channel].
+    double m_state[2][2][2] = {};
+    size_t m_stepFrames;
+    size_t m_stepFilled = 0;
+    double m_stepSquares = 0.0;
+    // Mean square of each 100 ms step, summed over channels; the last 30
+    // are kept in a ring for the sliding windows.
+    std::vector<double> m_recentSteps;
+    size_t m_stepCount = 0;
+    // Mean square of each complete 400 ms block (75% overlap).
+    std::vector<double> m_blocks;
+};
@@ -0,0 +1,161 @@
+#include "TrackAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const size_t HOP_FRAMES = 1024;
+    const float MIN_BPM = 60.0f;
+    const float MAX_BPM = 180.0f;
+    // Sections shorter than this are merged into their neighbour.
+    const float MIN_SECTION_SECONDS = 8.0f;
+    const float NOVELTY_WINDOW_SECONDS = 4.0f;
+    const float NOVELTY_THRESHOLD_DB = 3.0f;
+    // Log-Gaussian tempo prior; resolves octave ambiguity in the autocorrelation.
+    const float PRIOR_BPM = 120.0f;
+    const float PRIOR_OCTAVES = 1.0f;
+}
+
+int TrackAnalysis::sectionAt(float time) const {
+    if (sections.empty()) {
+        return -1;
+    }
+    auto it = std::upper_bound(sections.begin(), sections.end(), time,
+        [](float t, const TrackSection& s) { return t < s.startTime; });
+    if (it == sections.begin()) {
+        return 0;
+    }
+    return static_cast<int>(std::distance(sections.begin(), it)) - 1;
+}
+
+TrackAnalysis TrackAnalyzer::analyze(const short* interleavedStereo, size_t frameCount, int sampleRate) {
+    TrackAnalysis analysis;
+    if (!interleavedStereo || frameCount == 0 || sampleRate <= 0) {
+        return analysis;
+    }
+    analysis.duration = static_cast<float>(frameCount) / sampleRate;
+
+    const size_t hopCount = (frameCount + HOP_FRAMES - 1) / HOP_FRAMES;
+    const float hopsPerSecond = static_cast<float>(sampleRate) / HOP_FRAMES;
+    std::vector<float> power(hopCount, 0.0f);
+    std::vector<float> logEnergy(hopCount, 0.0f);
+    std::vector<float> onsets(hopCount, 0.0f);
+
+    for (size_t h = 0; h < hopCount; ++h) {
+        const size_t begin = h * HOP_FRAMES;
+        const size_t end = std::min(begin + HOP_FRAMES, frameCount);
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            float mono = (interleavedStereo[i * 2] + interleavedStereo[i * 2 + 1]) * (0.5f / 32768.0f);
+            sum += mono * mono;
+        }
+        power[h] = static_cast<float>(sum / (end - begin));
+        logEnergy[h] = 10.0f * std::log10(power[h] + 1e-10f);
+        if (h > 0) {
+            onsets[h] = std::max(0.0f, logEnergy[h] - logEnergy[h - 1]);
+        }
+    }
+
+    analysis.tempo = estimateTempo(onsets, hopsPerSecond);
+
+    std::vector<size_t> boundaries = findBoundaries(logEnergy, hopsPerSecond);
+    boundaries.insert(boundaries.begin(), 0);
+    boundaries.push_back(hopCount);
+
+    std::vector<float> sectionPower;
+    for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+        double sum = 0.0;
+        for (size_t h = boundaries[i]; h < boundaries[i + 1]; ++h) {
+            sum += power[h];
+        }
+        TrackSection section;
+        section.startTime = boundaries[i] / hopsPerSecond;
+        section.endTime = std::min(analysis.duration, boundaries[i + 1] / hopsPerSecond);
+        analysis.sections.push_back(section);
+        sectionPower.push_back(static_cast<float>(sum / std::max<size_t>(1, boundaries[i + 1] - boundaries[i])));
+    }
+
+    float maxPower = *std::max_element(sectionPower.begin(), sectionPower.end());
+    for (size_t i = 0; i < analysis.sections.size(); ++i) {
+        analysis.sections[i].energy = maxPower > 0.0f ? std::sqrt(sectionPower[i] / maxPower) : 0.0f;
+    }
+    return analysis;
+}
+
+float TrackAnalyzer::estimateTempo(const std::vector<float>& onsets, float hopsPerSecond) {
+    const size_t minLag = static_cast<size_t>(hopsPerSecond * 60.0f / MAX_BPM);
+    const size_t maxLag = static_cast<size_t>(hopsPerSecond * 60.0f / MIN_BPM);
+    if (minLag == 0 || onsets.size() <= maxLag * 2) {
+        return 0.0f;
+    }
+
+    // Beat periods rarely land on whole hops, so spread each onset over its
+    // neighbours before correlating.
+    std::vector<float> smoothed(onsets.size(), 0.0f);
+    for (size_t i = 1; i + 1 < onsets.size(); ++i) {
+        smoothed[i] = 0.25f * onsets[i - 1] + 0.5f * onsets[i] + 0.25f * onsets[i + 1];
+    }
+
+    float mean = 0.0f;
+    for (float o : smoothed) mean += o;
+    mean /= smoothed.size();
+
+    size_t bestLag = 0;
+    double bestScore = 0.0;
+    for (size_t lag = minLag; lag <= maxLag; ++lag) {
+        double score = 0.0;
+        for (size_t i = lag; i < smoothed.size(); ++i) {
+            score += (smoothed[i] - mean) * (smoothed[i - lag] - mean);
+        }
+        score /= (smoothed.size() - lag);
+        float octaves = std::log2(60.0f * hopsPerSecond / lag / PRIOR_BPM) / PRIOR_OCTAVES;
+        score *= std::exp(-0.5f * octaves * octaves);
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+    return bestLag > 0 ? 60.0f * hopsPerSecond / bestLag : 0.0f;
+}
+
+std::vector<size_t> TrackAnalyzer::findBoundaries(const std::vector<float>& logEnergy, float hopsPerSecond) {
+    std::vector<size_t> boundaries;
+    const size_t window = static_cast<size_t>(NOVELTY_WINDOW_SECONDS * hopsPerSecond);
+    const size_t minSpacing = static_cast<size_t>(MIN_SECTION_SECONDS * hopsPerSecond);
+    const size_t n = logEnergy.size();
+    if (window == 0 || n < window * 2) {
+        return boundaries;
+    }
+
+    std::vector<double> prefix(n + 1, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i + 1] = prefix[i] + logEnergy[i];
+    }
+
+    // Novelty is the level difference between the windows either side of a hop.
+    std::vector<float> novelty(n, 0.0f);
+    for (size_t h = window; h + window <= n; ++h) {
+        double before = (prefix[h] - prefix[h - window]) / window;
+        double after = (prefix[h + window] - prefix[h]) / window;
+        novelty[h] = static_cast<float>(std::fabs(after - before));
+    }
+
+    size_t last = 0;
+    for (size_t h = window; h + window <= n; ++h) {
+        if (novelty[h] < NOVELTY_THRESHOLD_DB || h < last + minSpacing || h + minSpacing > n) {
+            continue;
+        }
+        const size_t lo = h - window;
+        const size_t hi = std::min(n, h + window);
+        bool isPeak = true;
+        for (size_t k = lo; k < hi && isPeak; ++k) {
+            if (novelty[k] > novelty[h] || (novelty[k] == novelty[h] && k < h)) {
+                isPeak = false;
+            }
+        }
+        if (isPeak) {
+            boundaries.push_back(h);
+            last = h;
+        }
+    }
+    return boundaries;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct TrackSection {
+    float startTime = 0.0f;
+    float endTime = 0.0f;
+    // Mean loudness of the section relative to the loudest section, in [0, 1].
+    float energy = 0.0f;
+};
+
+struct TrackAnalysis {
+    float duration = 0.0f;
+    float tempo = 0.0f;
+    std::vector<TrackSection> sections;
+
+    bool isValid() const { return !sections.empty(); }
+    int sectionAt(float time) const;
+};
+
+// Offline analysis of a fully decoded track: tempo from onset autocorrelation
+// and section boundaries from peaks in an energy novelty curve.
+class TrackAnalyzer {
+public:
+    static TrackAnalysis analyze(const short* interleavedStereo, size_t frameCount, int sampleRate);
+
+private:
+    static float estimateTempo(const std::vector<float>& onsets, float hopsPerSecond);
+    static std::vector<size_t> findBoundaries(const std::vector<float>& logEnergy, float hopsPerSecond);
+};
@@ -0,0 +1,548 @@
+#include "TrackOverview.h"
+#include "AudioFileSource.h"
+#include "core/Logger.h"
+#include "core/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[4] = {'A', 'O', 'V', '3'};
+    const char* ENTRY_EXTENSION = ".aov";
+    const size_t FFT_SIZE = TrackOverview::SPECTRUM_FRAMES / 2;
+    const double LOWEST_BAND_HZ = 40.0;
+    const float FLOOR_DB = -90.0f;
+    const size_t DECODE_CHUNK_FRAMES = 16384;
+
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void put(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Min, max and sum of squares of L+R over `frames` frames. Mid samples
+    // are kept doubled here and halved once per bin.
+    WaveformBin reduceBin(const short* interleavedStereo, size_t frames)
+    {
+        float low = 65536.0f;
+        float high = -65536.0f;
+        float squares = 0.0f;
+        size_t i = 0;
+#if defined(__SSE2__)
+        // Four frames per step: madd with ones sums each L/R pair to 32 bits.
+        const __m128i ones = _mm_set1_epi16(1);
+        __m128 lowV = _mm_set1_ps(low);
+        __m128 highV = _mm_set1_ps(high);
+        __m128 squaresV = _mm_setzero_ps();
+        for (; i + 4 <= frames; i += 4) {
+            const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleavedStereo + i * 2));
+            const __m128 mid = _mm_cvtepi32_ps(_mm_madd_epi16(samples, ones));
+            lowV = _mm_min_ps(lowV, mid);
+            highV = _mm_max_ps(highV, mid);
+            squaresV = _mm_add_ps(squaresV, _mm_mul_ps(mid, mid));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, lowV);
+        low = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+        _mm_storeu_ps(lanes, highV);
+        high = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+        _mm_storeu_ps(lanes, squaresV);
+        squares = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+        for (const short* frame = interleavedStereo + i * 2; i < frames; ++i, frame += 2) {
+            const float mid = static_cast<float>(frame[0] + frame[1]);
+            low = std::min(low, mid);
+            high = std::max(high, mid);
+            squares += mid * mid;
+        }
+
+        WaveformBin bin;
+        if (frames > 0) {
+            bin.min = static_cast<int16_t>(std::floor(low * 0.5f));
+            bin.max = static_cast<int16_t>(std::ceil(high * 0.5f));
+            bin.meanSquare = squares / (4.0f * 32768.0f * 32768.0f * static_cast<float>(frames));
+        }
+        return bin;
+    }
+
+    WaveformBin mergeBins(const WaveformBin* bins, size_t count)
+    {
+        WaveformBin merged = bins[0];
+        for (size_t i = 1; i < count; ++i) {
+            merged.min = std::min(merged.min, bins[i].min);
+            merged.max = std::max(merged.max, bins[i].max);
+            merged.meanSquare += bins[i].meanSquare;
+        }
+        merged.meanSquare /= static_cast<float>(count);
+        return merged;
+    }
+
+    // Band-wise maximum, so short transients survive zooming out.
+    void mergeColumns(const uint8_t* columns, size_t count, uint8_t* out)
+    {
+        std::memcpy(out, columns, TrackOverview::SPECTRUM_BANDS);
+        for (size_t i = 1; i < count; ++i) {
+            for (int band = 0; band < TrackOverview::SPECTRUM_BANDS; ++band) {
+                out[band] = std::max(out[band], columns[i * TrackOverview::SPECTRUM_BANDS + band]);
+            }
+        }
+    }
+
+    // Radix-2 FFT of FFT_SIZE points with a Hann window folded into the
+    // input scaling.
+    struct Fft {
+        std::vector<std::complex<float>> twiddles;
+        std::vector<uint32_t> reversed;
+        std::vector<float> window;
+
+        Fft() : twiddles(FFT_SIZE / 2), reversed(FFT_SIZE), window(FFT_SIZE)
+        {
+            int bits = 0;
+            while ((size_t(1) << bits) < FFT_SIZE) {
+                ++bits;
+            }
+            for (size_t i = 0; i < FFT_SIZE; ++i) {
+                uint32_t r = 0;
+                for (int b = 0; b < bits; ++b) {
+                    r |= ((i >> b) & 1u) << (bits - 1 - b);
+                }
+                reversed[i] = r;
+                window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * M_PI * i / FFT_SIZE));
+            }
+            for (size_t i = 0; i < FFT_SIZE / 2; ++i) {
+                twiddles[i] = std::polar(1.0f, static_cast<float>(-2.0 * M_PI * i / FFT_SIZE));
+            }
+        }
+
+        void forward(std::complex<float>* data) const
+        {
+            for (size_t i = 0; i < FFT_SIZE; ++i) {
+                if (i < reversed[i]) {
+                    std::swap(data[i], data[reversed[i]]);
+                }
+            }
+            for (size_t length = 2; length <= FFT_SIZE; length <<= 1) {
+                const size_t half = length / 2;
+                const size_t stride = FFT_SIZE / length;
+                for (size_t start = 0; start < FFT_SIZE; start += length) {
+                    for (size_t k = 0; k < half; ++k) {
+                        const std::complex<float> odd = data[start + k + half] * twiddles[k * stride];
+                        data[start + k + half] = data[start + k] - odd;
+                        data[start + k] += odd;
+                    }
+                }
+            }
+        }
+    };
+
+    const Fft& fft()
+    {
+        static const Fft instance;
+        return instance;
+    }
+
+    std::string entryPath(const std::string& directory, const std::string& filePath)
+    {
+        std::error_code error;
+        const uint64_t size = fs::file_size(filePath, error);
+        const auto modified = fs::last_write_time(filePath, error).time_since_epoch().count();
+        uint64_t key = fnv1a(filePath.data(), filePath.size());
+        key = fnv1a(&size, sizeof(size), key);
+        key = fnv1a(&modified, sizeof(modified), key);
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return directory + "/" + name + ENTRY_EXTENSION;
+    }
+}
+
+void TrackOverview::reset(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    m_frameCount = 0;
+    m_meter = LoudnessMeter(sampleRate);
+    m_loudness = -std::numeric_limits<double>::infinity();
+    m_samplePeak = 0;
+    m_waveform.clear();
+    m_spectrum.clear();
+    m_pending.clear();
+
+    // Log-spaced bands from LOWEST_BAND_HZ to the Nyquist of the half-rate
+    // analysis signal, each at least one FFT bin wide.
+    m_bands.resize(SPECTRUM_BANDS);
+    const double binHz = sampleRate / 2.0 / FFT_SIZE;
+    const double ratio = (sampleRate / 4.0) / LOWEST_BAND_HZ;
+    const int lastBin = static_cast<int>(FFT_SIZE / 2) - 1;
+    for (int band = 0; band < SPECTRUM_BANDS; ++band) {
+        const double low = LOWEST_BAND_HZ * std::pow(ratio, static_cast<double>(band) / SPECTRUM_BANDS);
+        const double high = LOWEST_BAND_HZ * std::pow(ratio, static_cast<double>(band + 1) / SPECTRUM_BANDS);
+        const int first = std::clamp(static_cast<int>(std::lround(low / binHz)), 1, lastBin);
+        const int last = std::clamp(static_cast<int>(std::lround(high / binHz)) - 1, first, lastBin);
+        m_bands[band] = {first, last};
+    }
+}
+
+void TrackOverview::append(const short* interleavedStereo, size_t frameCount)
+{
+    m_frameCount += frameCount;
+    m_meter.addFrames(interleavedStereo, frameCount);
+    for (size_t i = 0; i < frameCount * 2; ++i) {
+        m_samplePeak = std::max(m_samplePeak, std::abs(static_cast<int>(interleavedStereo[i])));
+    }
+    while (frameCount > 0) {
+        const short* block = interleavedStereo;
+        size_t take = SPECTRUM_FRAMES;
+        if (!m_pending.empty() || frameCount < SPECTRUM_FRAMES) {
+            take = std::min(frameCount, SPECTRUM_FRAMES - m_pending.size() / 2);
+            m_pending.insert(m_pending.end(), interleavedStereo, interleavedStereo + take * 2);
+            block = m_pending.size() / 2 == SPECTRUM_FRAMES ? m_pending.data() : nullptr;
+        }
+        if (block) {
+            for (size_t bin = 0; bin < SPECTRUM_FRAMES / BASE_FRAMES; ++bin) {
+                pushWaveform(0, reduceBin(block + bin * BASE_FRAMES * 2, BASE_FRAMES));
+            }
+            addSpectrumColumn(block, SPECTRUM_FRAMES);
+            m_pending.clear();
+        }
+        interleavedStereo += take * 2;
+        frameCount -= take;
+    }
+}
+
+void TrackOverview::finish()
+{
+    const size_t frames = m_pending.size() / 2;
+    for (size_t first = 0; first < frames; first += BASE_FRAMES) {
+        pushWaveform(0, reduceBin(m_pending.data() + first * 2, std::min<size_t>(BASE_FRAMES, frames - first)));
+    }
+    if (frames > 0) {
+        addSpectrumColumn(m_pending.data(), frames);
+    }
+    m_pending.clear();
+    flushLevels();
+    m_loudness = m_meter.integrated();
+}
+
+void TrackOverview::addSpectrumColumn(const short* interleavedStereo, size_t frameCount)
+{
+    const Fft& transform = fft();
+    // Pairs of frames averaged to mono at half rate; a short final column
+    // is zero padded.
+    std::complex<float> data[FFT_SIZE];
+    for (size_t i = 0; i < FFT_SIZE; ++i) {
+        float sum = 0.0f;
+        if (i * 2 + 1 < frameCount) {
+            const short* frame = interleavedStereo + i * 4;
+            sum = static_cast<float>(frame[0] + frame[1] + frame[2] + frame[3]);
+        }
+        data[i] = sum * (transform.window[i] / (4.0f * 32768.0f));
+    }
+    transform.forward(data);
+
+    // A full-scale sine peaks at FFT_SIZE / 4 through the Hann window.
+    const float reference = (FFT_SIZE / 4.0f) * (FFT_SIZE / 4.0f);
+    uint8_t column[SPECTRUM_BANDS];
+    for (int band = 0; band < SPECTRUM_BANDS; ++band) {
+        float power = 0.0f;
+        for (int bin = m_bands[band].first; bin <= m_bands[band].second; ++bin) {
+            power = std::max(power, std::norm(data[bin]));
+        }
+        const float db = 10.0f * std::log10(std::max(power / reference, 1e-12f));
+        column[band] = static_cast<uint8_t>(std::clamp((db - FLOOR_DB) / -FLOOR_DB, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    pushSpectrum(0, column);
+}
+
+void TrackOverview::pushWaveform(size_t level, const WaveformBin& bin)
+{
+    if (m_waveform.size() <= level) {
+        m_waveform.resize(level + 1);
+    }
+    std::vector<WaveformBin>& bins = m_waveform[level];
+    bins.push_back(bin);
+    if (bins.size() % LEVEL_FACTOR == 0) {
+        pushWaveform(level + 1, mergeBins(bins.data() + bins.size() - LEVEL_FACTOR, LEVEL_FACTOR));
+    }
+}
+
+void TrackOverview::pushSpectrum(size_t level, const uint8_t* column)
+{
+    if (m_spectrum.size() <= level) {
+        m_spectrum.resize(level + 1);
+    }
+    std::vector<uint8_t>& columns = m_spectrum[level];
+    columns.insert(columns.end(), column, column + SPECTRUM_BANDS);
+    const size_t count = columns.size() / SPECTRUM_BANDS;
+    if (count % LEVEL_FACTOR == 0) {
+        uint8_t merged[SPECTRUM_BANDS];
+        mergeColumns(columns.data() + (count - LEVEL_FACTOR) * SPECTRUM_BANDS, LEVEL_FACTOR, merged);
+        pushSpectrum(level + 1, merged);
+    }
+}
+
+void TrackOverview::flushLevels()
+{
+    // Complete groups were promoted as they filled; carry each level's
+    // partial group up until a level holds a single entry.
+    for (size_t level = 0; level < m_waveform.size() && m_waveform[level].size() > 1; ++level) {
+        const std::vector<WaveformBin>& bins = m_waveform[level];
+        if (const size_t partial = bins.size() % LEVEL_FACTOR) {
+            pushWaveform(level + 1, mergeBins(bins.data() + bins.size() - partial, partial));
+        }
+    }
+    for (size_t level = 0; level < m_spectrum.size() && m_spectrum[level].size() > SPECTRUM_BANDS; ++level) {
+        const std::vector<uint8_t>& columns = m_spectrum[level];
+        const size_t count = columns.size() / SPECTRUM_BANDS;
+        if (const size_t partial = count % LEVEL_FACTOR) {
+            uint8_t merged[SPECTRUM_BANDS];
+            mergeColumns(columns.data() + (count - partial) * SPECTRUM_BANDS, partial, merged);
+            pushSpectrum(level + 1, merged);
+        }
+    }
+}
+
+void TrackOverview::waveform(uint64_t startFrame, uint64_t endFrame, WaveformBin* out, size_t columns) const
+{
+    std::fill(out, out + columns, WaveformBin());
+    if (empty() || columns == 0 || endFrame <= startFrame) {
+        return;
+    }
+    const uint64_t span = endFrame - startFrame;
+    size_t level = 0;
+    uint64_t binFrames = BASE_FRAMES;
+    while (level + 1 < m_waveform.size() && binFrames * LEVEL_FACTOR * LEVEL_FACTOR <= span / columns) {
+        ++level;
+        binFrames *= LEVEL_FACTOR;
+    }
+    const std::vector<WaveformBin>& bins = m_waveform[level];
+    for (size_t column = 0; column < columns; ++column) {
+        const uint64_t from = startFrame + span * column / columns;
+        const uint64_t to = startFrame + span * (column + 1) / columns;
+        const uint64_t first = from / binFrames;
+        if (first >= bins.size()) {
+            break;
+        }
+        const uint64_t last = std::min<uint64_t>(to > from ? (to - 1) / binFrames : first, bins.size() - 1);
+        out[column] = mergeBins(bins.data() + first, static_cast<size_t>(last - first + 1));
+    }
+}
+
+void TrackOverview::spectrogram(uint64_t startFrame, uint64_t endFrame, uint8_t* out, size_t columns) const
+{
+    std::fill(out, out + columns * SPECTRUM_BANDS, uint8_t(0));
+    if (m_spectrum.empty() || columns == 0 || endFrame <= startFrame) {
+        return;
+    }
+    const uint64_t span = endFrame - startFrame;
+    size_t level = 0;
+    uint64_t columnFrames = SPECTRUM_FRAMES;
+    while (level + 1 < m_spectrum.size() && columnFrames * LEVEL_FACTOR * LEVEL_FACTOR <= span / columns) {
+        ++level;
+        columnFrames *= LEVEL_FACTOR;
+    }
+    const std::vector<uint8_t>& stored = m_spectrum[level];
+    const uint64_t count = stored.size() / SPECTRUM_BANDS;
+    for (size_t column = 0; column < columns; ++column) {
+        const uint64_t from = startFrame + span * column / columns;
+        const uint64_t to = startFrame + span * (column + 1) / columns;
+        const uint64_t first = from / columnFrames;
+        if (first >= count) {
+            break;
+        }
+        const uint64_t last = std::min<uint64_t>(to > from ? (to - 1) / columnFrames : first, count - 1);
+        mergeColumns(stored.data() + first * SPECTRUM_BANDS, static_cast<size_t>(last - first + 1),
+                     out + column * SPECTRUM_BANDS);
+    }
+}
+
+bool TrackOverview::build(const std::string& filePath, TrackOverview& overview, const std::atomic<bool>* cancel)
+{
+    ma_decoder_config config = ma_decoder_config_init(ma_format_s16, 2, 0);
+    ma_decoder decoder;
+    AudioFileSource source;
+    if (source.initDecoder(filePath, &config, &decoder) != MA_SUCCESS) {
+        logError(LogCategory::Audio, "Failed to open audio file for its overview: " + filePath);
+        return false;
+    }
+    overview.reset(static_cast<int>(decoder.outputSampleRate));
+    std::vector<short> chunk(DECODE_CHUNK_FRAMES * 2);
+    ma_uint64 framesRead = 0;
+    do {
+        if (cancel && *cancel) {
+            ma_decoder_uninit(&decoder);
+            return false;
+        }
+        ma_decoder_read_pcm_frames(&decoder, chunk.data(), DECODE_CHUNK_FRAMES, &framesRead);
+        overview.append(chunk.data(), static_cast<size_t>(framesRead));
+    } while (framesRead == DECODE_CHUNK_FRAMES);
+    ma_decoder_uninit(&decoder);
+    overview.finish();
+    return true;
+}
+
+bool TrackOverview::build(const short* interleavedStereo, size_t frameCount, int sampleRate, TrackOverview& overview,
+                          const std::atomic<bool>* cancel)
+{
+    overview.reset(sampleRate);
+    for (size_t first = 0; first < frameCount; first += DECODE_CHUNK_FRAMES) {
+        if (cancel && *cancel) {
+            return false;
+        }
+        overview.append(interleavedStereo + first * 2, std::min(DECODE_CHUNK_FRAMES, frameCount - first));
+    }
+    overview.finish();
+    return true;
+}
+
+void TrackOverview::encode(std::string& out) const
+{
+    const std::vector<WaveformBin> noBins;
+    const std::vector<uint8_t> noColumns;
+    const std::vector<WaveformBin>& bins = m_waveform.empty() ? noBins : m_waveform[0];
+    const std::vector<uint8_t>& columns = m_spectrum.empty() ? noColumns : m_spectrum[0];
+
+    out.assign(MAGIC, sizeof(MAGIC));
+    put(out, static_cast<uint32_t>(m_sampleRate));
+    put(out, m_frameCount);
+    put(out, m_loudness);
+    put(out, static_cast<uint32_t>(m_samplePeak));
+    put(out, static_cast<uint64_t>(bins.size()));
+    put(out, static_cast<uint64_t>(columns.size() / SPECTRUM_BANDS));
+    for (const WaveformBin& bin : bins) {
+        put(out, bin.min);
+        put(out, bin.max);
+        put(out, bin.meanSquare);
+    }
+    out.append(reinterpret_cast<const char*>(columns.data()), columns.size());
+    put(out, fnv1a(out.data(), out.size()));
+}
+
+bool TrackOverview::decode(std::string_view data)
+{
+    const size_t headerBytes = sizeof(MAGIC) + 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t) + sizeof(double);
+    if (data.size() < headerBytes + sizeof(uint64_t) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    uint64_t checksum;
+    std::memcpy(&checksum, data.data() + data.size() - sizeof(checksum), sizeof(checksum));
+    data.remove_suffix(sizeof(checksum));
+    if (fnv1a(data.data(), data.size()) != checksum) {
+        return false;
+    }
+
+    uint32_t sampleRate, samplePeak;
+    uint64_t frameCount, binCount, columnCount;
+    double loudness;
+    const char* cursor = data.data() + sizeof(MAGIC);
+    std::memcpy(&sampleRate, cursor, sizeof(sampleRate));
+    std::memcpy(&frameCount, cursor + 4, sizeof(frameCount));
+    std::memcpy(&loudness, cursor + 12, sizeof(loudness));
+    std::memcpy(&samplePeak, cursor + 20, sizeof(samplePeak));
+    std::memcpy(&binCount, cursor + 24, sizeof(binCount));
+    std::memcpy(&columnCount, cursor + 32, sizeof(columnCount));
+    cursor += headerBytes - sizeof(MAGIC);
+    const size_t binBytes = 2 * sizeof(int16_t) + sizeof(float);
+    if (sampleRate == 0 || samplePeak > 32768 || binCount > data.size() / binBytes || columnCount > data.size() / SPECTRUM_BANDS ||
+        data.size() != headerBytes + binCount * binBytes + columnCount * SPECTRUM_BANDS) {
+        return false;
+    }
+
+    reset(static_cast<int>(sampleRate));
+    m_frameCount = frameCount;
+    m_loudness = loudness;
+    m_samplePeak = static_cast<int>(samplePeak);
+    for (uint64_t i = 0; i < binCount; ++i, cursor += binBytes) {
+        WaveformBin bin;
+        std::memcpy(&bin.min, cursor, sizeof(bin.min));
+        std::memcpy(&bin.max, cursor + 2, sizeof(bin.max));
+        std::memcpy(&bin.meanSquare, cursor + 4, sizeof(bin.meanSquare));
+        pushWaveform(0, bin);
+    }
+    for (uint64_t i = 0; i < columnCount; ++i, cursor += SPECTRUM_BANDS) {
+        pushSpectrum(0, reinterpret_cast<const uint8_t*>(cursor));
+    }
+    flushLevels();
+    return true;
+}
+
+bool TrackOverview::loadCached(const std::string& directory, const std::string& filePath, TrackOverview& overview)
+{
+    const std::string path = entryPath(directory, filePath);
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!overview.decode(file.view())) {
+        logWarning(LogCategory::Audio, "Discarding corrupt overview cache entry: " + path);
+        file.close();
+        std::error_code error;
+        fs::remove(path, error);
+        return false;
+    }
+    // Modification time doubles as last use for eviction.
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return true;
+}
+
+bool TrackOverview::storeCached(const std::string& directory, const std::string& filePath,
+                                const TrackOverview& overview, uint64_t maxBytes)
+{
+    std::error_code error;
+    fs::create_directories(directory, error);
+    std::string data;
+    overview.encode(data);
+    const std::string path = entryPath(directory, filePath);
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            logWarning(LogCategory::Audio, "Failed to write overview cache entry: " + tempPath);
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, error);
+    if (error) {
+        fs::remove(tempPath, error);
+        return false;
+    }
+
+    std::vector<std::pair<fs::file_time_type, fs::path>> entries;
+    uint64_t total = 0;
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error)) {
+        if (entry.path().extension() == ENTRY_EXTENSION) {
+            total += entry.file_size(error);
+            entries.emplace_back(entry.last_write_time(error), entry.path());
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const auto& entry : entries) {
+        if (total <= maxBytes) {
+            break;
+        }
+        if (entry.second == path) {
+            continue;
+        }
+        total -= fs::file_size(entry.second, error);
+        fs::remove(entry.second, error);
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "LoudnessMeter.h"
+
+// Min/max/RMS of the mid channel over a run of frames, in full-scale units.
+struct WaveformBin {
+    int16_t min = 0;
+    int16_t max = 0;
+    float meanSquare = 0.0f;
+};
+
+// Multi-resolution summary of a track for timeline drawing: a waveform
+// pyramid (min/max/RMS bins of 256 frames, each level merging four bins of
+// the one below) and a log-frequency spectrogram pyramid built the same
+// way. Both are filled incrementally as PCM is appended, so a track never
+// has to be held decoded in full, and any zoom level is answered from the
+// coarsest level with at least four entries per output column, so a
+// column bleeds at most a quarter of its width into its neighbours.
+// The same pass measures the track's integrated loudness.
+class TrackOverview
+{
+public:
+    static const uint32_t BASE_FRAMES = 256;
+    static const uint32_t LEVEL_FACTOR = 4;
+    // Frames per spectrogram column at level 0, analysed at half rate.
+    static const uint32_t SPECTRUM_FRAMES = 2048;
+    static const int SPECTRUM_BANDS = 64;
+
+    void reset(int sampleRate);
+    void append(const short* interleavedStereo, size_t frameCount);
+    // Flushes partial bins; call once after the last append.
+    void finish();
+
+    int sampleRate() const { return m_sampleRate; }
+    uint64_t frameCount() const { return m_frameCount; }
+    bool empty() const { return m_waveform.empty() || m_waveform[0].empty(); }
+    // Integrated loudness in LUFS (-infinity if silent), known after finish().
+    double loudness() const { return m_loudness; }
+    // Highest sample magnitude of either channel, full scale 1.0.
+    double peak() const { return m_samplePeak / 32768.0; }
+    size_t waveformLevels() const { return m_waveform.size(); }
+    const std::vector<WaveformBin>& waveformLevel(size_t level) const { return m_waveform[level]; }
+
+    // Splits [startFrame, endFrame) into `columns` equal spans and fills
+    // one bin (or SPECTRUM_BANDS band levels, 0-255 over -90..0 dBFS,
+    // lowest band first) per span. Spans past the end come back silent.
+    void waveform(uint64_t startFrame, uint64_t endFrame, WaveformBin* out, size_t columns) const;
+    void spectrogram(uint64_t startFrame, uint64_t endFrame, uint8_t* out, size_t columns) const;
+
+    // Decodes the file chunk by chunk into `overview`.
+    static bool build(const std::string& filePath, TrackOverview& overview, const std::atomic<bool>* cancel = nullptr);
+    // The same from a track that is already decoded.
+    static bool build(const short* interleavedStereo, size_t frameCount, int sampleRate, TrackOverview& overview,
+                      const std::atomic<bool>* cancel = nullptr);
+
+    // Only the finest levels are stored; the rest are rebuilt on decode.
+    void encode(std::string& out) const;
+    bool decode(std::string_view data);
+
+    // Disk cache addressed by file path, size and modification time, so a
+    // hit never decodes anything. Entries past `maxBytes` are evicted
+    // least recently used first.
+    static bool loadCached(const std::string& directory, const std::string& filePath, TrackOverview& overview);
+    static bool storeCached(const std::string& directory, const std::string& filePath, const TrackOverview& overview,
+                            uint64_t maxBytes);
+
+private:
+    void addSpectrumColumn(const short* interleavedStereo, size_t frameCount);
+    void pushWaveform(size_t level, const WaveformBin& bin);
+    void pushSpectrum(size_t level, const uint8_t* column);
+    void flushLevels();
+
+    int m_sampleRate = 0;
+    uint64_t m_frameCount = 0;
+    LoudnessMeter m_meter{44100};
+    double m_loudness = 0.0;
+    // Largest |sample| seen in either channel; the waveform bins are mid only.
+    int m_samplePeak = 0;
+    std::vector<std::vector<WaveformBin>> m_waveform;
+    // SPECTRUM_BANDS bytes per column.
+    std::vector<std::vector<uint8_t>> m_spectrum;
+    // First and last FFT bin of each band.
+    std::vector<std::pair<int, int>> m_bands;
+    // Frames not yet making up a whole spectrogram column.
+    std::vector<short> m_pending;
+};
@@ -0,0 +1,32 @@
+#include "VisualizationBuffer.h"
+
+VisualizationBuffer::VisualizationBuffer(size_t frames)
+    : m_buffer(frames * CHANNELS), m_frames(frames)
+{
+}
+
+void VisualizationBuffer::store(const short* pcm, size_t frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t writePos = m_writePos.load();
+
+    for (size_t i = 0; i < frames; ++i) {
+        m_buffer[writePos * CHANNELS] = pcm[i * CHANNELS];
+        m_buffer[writePos * CHANNELS + 1] = pcm[i * CHANNELS + 1];
+        writePos = (writePos + 1) % m_frames;
+    }
+    m_writePos.store(writePos);
+}
+
+size_t VisualizationBuffer::latest(short* out, size_t frames)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t writePos = m_writePos.load();
+
+    for (size_t i = 0; i < frames; ++i) {
+        size_t readPos = (writePos - 1 - i + m_frames) % m_frames;
+        out[(frames - 1 - i) * CHANNELS] = m_buffer[readPos * CHANNELS];
+        out[(frames - 1 - i) * CHANNELS + 1] = m_buffer[readPos * CHANNELS + 1];
+    }
+    return frames;
+}
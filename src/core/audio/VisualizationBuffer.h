@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Ring of the most recent interleaved stereo s16 frames sent to the output
+// device. The audio callback stores into it and the renderer copies the
+// newest frames out for projectM.
+class VisualizationBuffer
+{
+public:
+    static const size_t CHANNELS = 2;
+
+    explicit VisualizationBuffer(size_t frames);
+
+    void store(const short* pcm, size_t frames);
+    // Copies the newest `frames` frames into `out`, oldest first.
+    size_t latest(short* out, size_t frames);
+
+    size_t capacity() const { return m_frames; }
+
+private:
+    std::vector<short> m_buffer;
+    size_t m_frames;
+    std::atomic<size_t> m_writePos{0};
+    std::mutex m_mutex;
+};
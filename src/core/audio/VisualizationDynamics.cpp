@@ -0,0 +1,218 @@
+#include "VisualizationDynamics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Enough for the longest look-ahead at 192 kHz plus a block.
+    const size_t DELAY_FRAMES = 4096;
+    const float MAX_LOOKAHEAD_MS = 20.0f;
+    const float MAX_GAIN = 1000.0f;
+    // Envelopes and filter state this small only decay further into denormals.
+    const float STATE_FLOOR = 1e-20f;
+
+    float coefficient(size_t frames, float seconds, int sampleRate)
+    {
+        return 1.0f - std::exp(-static_cast<float>(frames) / std::max(1e-4f, seconds * sampleRate));
+    }
+
+    float flushed(float value)
+    {
+        return std::fabs(value) < STATE_FLOOR ? 0.0f : value;
+    }
+
+    // Peak magnitude and sum of squares of `count` samples.
+    void measure(const float* samples, size_t count, float& peak, float& squares)
+    {
+        size_t i = 0;
+        peak = 0.0f;
+        squares = 0.0f;
+#if defined(__SSE2__)
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 peaks = _mm_setzero_ps();
+        __m128 sums = _mm_setzero_ps();
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm_loadu_ps(samples + i);
+            peaks = _mm_max_ps(peaks, _mm_andnot_ps(signMask, x));
+            sums = _mm_add_ps(sums, _mm_mul_ps(x, x));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, peaks);
+        peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+        _mm_storeu_ps(lanes, sums);
+        squares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; i < count; ++i) {
+            peak = std::max(peak, std::fabs(samples[i]));
+            squares += samples[i] * samples[i];
+        }
+    }
+
+    void copyToRing(float* ring, size_t frame, const float* in, size_t frames)
+    {
+        const size_t first = std::min(frames, DELAY_FRAMES - frame);
+        std::memcpy(ring + frame * 2, in, first * 2 * sizeof(float));
+        std::memcpy(ring, in + first * 2, (frames - first) * 2 * sizeof(float));
+    }
+
+    void copyFromRing(const float* ring, size_t frame, float* out, size_t frames)
+    {
+        const size_t first = std::min(frames, DELAY_FRAMES - frame);
+        std::memcpy(out, ring + frame * 2, first * 2 * sizeof(float));
+        std::memcpy(out + first * 2, ring, (frames - first) * 2 * sizeof(float));
+    }
+}
+
+VisualizationDynamics::VisualizationDynamics()
+    : VisualizationDynamics(Settings(), 44100)
+{
+}
+
+VisualizationDynamics::VisualizationDynamics(const Settings& settings, int sampleRate)
+{
+    for (auto& delay : m_delay) {
+        delay.assign(DELAY_FRAMES * 2, 0.0f);
+    }
+    configure(settings, sampleRate);
+}
+
+void VisualizationDynamics::configure(const Settings& settings, int sampleRate)
+{
+    m_settings = settings;
+    m_settings.ratio = std::max(0.1f, settings.ratio);
+    m_settings.maxGainDb = std::max(0.0f, settings.maxGainDb);
+    sampleRate = std::max(1, sampleRate);
+    m_bands = settings.splitBands ? 2 : 1;
+    const float lookaheadMs = std::clamp(settings.lookaheadMs, 0.0f, MAX_LOOKAHEAD_MS);
+    m_lookaheadFrames = std::min(DELAY_FRAMES - BLOCK_FRAMES,
+                                 static_cast<size_t>(std::lround(lookaheadMs * sampleRate / 1000.0f)));
+    m_crossover = 1.0f - std::exp(-2.0f * static_cast<float>(M_PI) * settings.crossoverHz / sampleRate);
+    for (size_t n = 1; n <= BLOCK_FRAMES; ++n) {
+        m_agcCoef[n - 1] = coefficient(n, settings.agcSeconds, sampleRate);
+        m_attackCoef[n - 1] = coefficient(n, settings.attackMs / 1000.0f, sampleRate);
+        m_releaseCoef[n - 1] = coefficient(n, settings.releaseMs / 1000.0f, sampleRate);
+    }
+    reset();
+}
+
+void VisualizationDynamics::reset()
+{
+    std::fill(std::begin(m_low), std::end(m_low), 0.0f);
+    std::fill(std::begin(m_meanSquare), std::end(m_meanSquare), 0.0f);
+    std::fill(std::begin(m_peak), std::end(m_peak), 0.0f);
+    std::fill(std::begin(m_gain), std::end(m_gain), 1.0f);
+    for (auto& delay : m_delay) {
+        std::fill(delay.begin(), delay.end(), 0.0f);
+    }
+    m_writeFrame = 0;
+}
+
+float VisualizationDynamics::gainDb(int band) const
+{
+    return 20.0f * std::log10(m_gain[std::clamp(band, 0, MAX_BANDS - 1)]);
+}
+
+void VisualizationDynamics::process(const short* in, short* out, size_t frameCount)
+{
+    if (!m_settings.enabled) {
+        if (in != out) {
+            std::memcpy(out, in, frameCount * 2 * sizeof(short));
+        }
+        return;
+    }
+    while (frameCount > 0) {
+        const size_t frames = std::min(frameCount, BLOCK_FRAMES);
+        processBlock(in, out, frames);
+        in += frames * 2;
+        out += frames * 2;
+        frameCount -= frames;
+    }
+}
+
+float VisualizationDynamics::targetGain(int band) const
+{
+    const float rmsDb = 10.0f * std::log10(m_meanSquare[band] + 1e-12f);
+    const float agcDb = std::clamp(m_settings.targetDb - rmsDb, -m_settings.maxGainDb, m_settings.maxGainDb);
+    const float peakDb = 20.0f * std::log10(m_peak[band] + 1e-6f) + agcDb;
+    const float overDb = std::max(0.0f, peakDb - m_settings.thresholdDb);
+    const float shapeDb = overDb * (1.0f / m_settings.ratio - 1.0f);
+    return std::min(MAX_GAIN, std::pow(10.0f, (agcDb + shapeDb) / 20.0f));
+}
+
+void VisualizationDynamics::processBlock(const short* in, short* out, size_t frames)
+{
+    const size_t samples = frames * 2;
+    float band[MAX_BANDS][BLOCK_FRAMES * 2];
+    if (m_bands == 1) {
+        for (size_t i = 0; i < samples; ++i) {
+            band[0][i] = in[i];
+        }
+    } else {
+        // One-pole low pass; the high band is the remainder, so the bands
+        // sum back to the input.
+        for (size_t i = 0; i < samples; ++i) {
+            float& low = m_low[i & 1];
+            low += m_crossover * (in[i] - low);
+            band[0][i] = low;
+            band[1][i] = in[i] - low;
+        }
+        m_low[0] = flushed(m_low[0]);
+        m_low[1] = flushed(m_low[1]);
+    }
+
+    // Detection sees the newest block; the output comes from the delay line.
+    const size_t k = frames - 1;
+    const size_t readFrame = (m_writeFrame + DELAY_FRAMES - m_lookaheadFrames) & (DELAY_FRAMES - 1);
+    float start[MAX_BANDS];
+    float step[MAX_BANDS];
+    for (int b = 0; b < m_bands; ++b) {
+        float peak = 0.0f;
+        float squares = 0.0f;
+        measure(band[b], samples, peak, squares);
+        peak *= 1.0f / 32768.0f;
+        squares *= 1.0f / (32768.0f * 32768.0f * samples);
+        m_meanSquare[b] = flushed(m_meanSquare[b] + (squares - m_meanSquare[b]) * m_agcCoef[k]);
+        const float coef = peak > m_peak[b] ? m_attackCoef[k] : m_releaseCoef[k];
+        m_peak[b] = flushed(m_peak[b] + (peak - m_peak[b]) * coef);
+
+        start[b] = m_gain[b];
+        m_gain[b] = targetGain(b);
+        step[b] = (m_gain[b] - start[b]) / static_cast<float>(frames);
+
+        copyToRing(m_delay[b].data(), m_writeFrame, band[b], frames);
+        copyFromRing(m_delay[b].data(), readFrame, band[b], frames);
+    }
+    m_writeFrame = (m_writeFrame + frames) & (DELAY_FRAMES - 1);
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Four frames per iteration, each band scaled by its ramped gain and
+    // summed, then rounded and saturated to s16 by the pack.
+    for (; i + 4 <= frames; i += 4) {
+        __m128 first = _mm_setzero_ps();
+        __m128 second = _mm_setzero_ps();
+        for (int b = 0; b < m_bands; ++b) {
+            const float g = start[b] + step[b] * static_cast<float>(i + 1);
+            const float s = step[b];
+            const __m128 gainFirst = _mm_set_ps(g + s, g + s, g, g);
+            const __m128 gainSecond = _mm_set_ps(g + 3 * s, g + 3 * s, g + 2 * s, g + 2 * s);
+            first = _mm_add_ps(first, _mm_mul_ps(_mm_loadu_ps(band[b] + i * 2), gainFirst));
+            second = _mm_add_ps(second, _mm_mul_ps(_mm_loadu_ps(band[b] + i * 2 + 4), gainSecond));
+        }
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(first), _mm_cvtps_epi32(second));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), packed);
+    }
+#endif
+    for (; i < frames; ++i) {
+        for (size_t c = i * 2; c < i * 2 + 2; ++c) {
+            float value = 0.0f;
+            for (int b = 0; b < m_bands; ++b) {
+                value += band[b][c] * (start[b] + step[b] * static_cast<float>(i + 1));
+            }
+            out[c] = static_cast<short>(std::clamp(std::lrint(value), -32768L, 32767L));
+        }
+    }
+}
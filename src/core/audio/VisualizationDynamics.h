@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Gain riding for the visualization copy of the audio, so projectM sees
+// lively levels from quiet intros and brickwalled masters alike. A slow
+// AGC moves the RMS level towards a target, then a fast peak compressor
+// (or, with a ratio below 1, an expander) shapes what is above the
+// threshold. Detection looks ahead of the output by delaying the signal,
+// so gain changes land before the transients that caused them. Optionally
+// the signal is split at a crossover and each band gets its own detector
+// and gain. Works on interleaved stereo s16 in blocks of BLOCK_FRAMES with
+// one gain decision per block, ramped across it.
+class VisualizationDynamics
+{
+public:
+    static constexpr size_t BLOCK_FRAMES = 32;
+
+    struct Settings {
+        bool enabled = true;
+        // AGC: RMS level it aims for, how far it may boost or cut, and how
+        // quickly it follows the music.
+        float targetDb = -18.0f;
+        float maxGainDb = 18.0f;
+        float agcSeconds = 3.0f;
+        // Peak level after the AGC where compression starts.
+        float thresholdDb = -6.0f;
+        float ratio = 4.0f;
+        float attackMs = 5.0f;
+        float releaseMs = 200.0f;
+        // Capped at 20 ms.
+        float lookaheadMs = 5.0f;
+        bool splitBands = false;
+        float crossoverHz = 200.0f;
+    };
+
+    VisualizationDynamics();
+    VisualizationDynamics(const Settings& settings, int sampleRate);
+
+    // Resets the state; never allocates, so the audio thread may call it.
+    void configure(const Settings& settings, int sampleRate);
+    void reset();
+
+    // `in` and `out` may be the same buffer.
+    void process(const short* in, short* out, size_t frameCount);
+
+    // Gain applied to the most recent block, per band (0 is the low band
+    // when split).
+    float gainDb(int band = 0) const;
+    size_t latencyFrames() const { return m_lookaheadFrames; }
+
+private:
+    static const int MAX_BANDS = 2;
+
+    void processBlock(const short* in, short* out, size_t frames);
+    float targetGain(int band) const;
+
+    Settings m_settings;
+    int m_bands = 1;
+    size_t m_lookaheadFrames = 0;
+    float m_crossover = 0.0f;
+    // Envelope coefficients for a block of n frames live at index n - 1.
+    float m_agcCoef[BLOCK_FRAMES];
+    float m_attackCoef[BLOCK_FRAMES];
+    float m_releaseCoef[BLOCK_FRAMES];
+
+    // Crossover low pass state per channel.
+    float m_low[2] = {};
+    // Mean square and peak envelopes, in full-scale units.
+    float m_meanSquare[MAX_BANDS] = {};
+    float m_peak[MAX_BANDS] = {};
+    // Linear gain reached at the end of the last block.
+    float m_gain[MAX_BANDS] = {1.0f, 1.0f};
+    // Look-ahead delay line of band samples, a power of two frames long.
+    std::vector<float> m_delay[MAX_BANDS];
+    size_t m_writeFrame = 0;
+};
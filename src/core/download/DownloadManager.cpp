@@ -0,0 +1,417 @@
+#include "DownloadManager.h"
+#include "core/Logger.h"
+#include "core/Sha256.h"
+#include "core/audio/ChunkStream.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* AUDIO_EXTENSION = ".mp3";
+    const char* PART_EXTENSION = ".part";
+    const char* DIGEST_EXTENSION = ".sha256";
+    // Progress events are coalesced to about one per this many bytes.
+    const uint64_t PROGRESS_STEP_BYTES = 256 * 1024;
+    const size_t MAX_SONG_ID_LENGTH = 64;
+    // Waits are woken by notifications; the timeout is only a backstop
+    // (as in Logger's writer thread).
+    const std::chrono::milliseconds WAIT_SLICE(250);
+
+    bool isSongIdChar(char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+    }
+
+    // Client errors other than timeouts and rate limiting will not go away.
+    bool isPermanent(int status)
+    {
+        return status >= 400 && status < 500 && status != 408 && status != 429;
+    }
+
+    std::string readDigest(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::string digest;
+        in >> digest;
+        return digest;
+    }
+}
+
+DownloadManager::DownloadManager(HttpTransport& transport, Options options)
+    : m_transport(transport),
+      m_options(std::move(options))
+{
+    std::error_code error;
+    fs::create_directories(m_options.directory, error);
+    const int threads = std::max(1, m_options.maxConcurrent);
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&DownloadManager::workerLoop, this);
+    }
+}
+
+DownloadManager::~DownloadManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        for (const auto& job : m_queue) {
+            if (job->preview) {
+                job->preview->fail();
+            }
+        }
+        m_queue.clear();
+        for (const auto& job : m_active) {
+            job->cancelled = true;
+        }
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+std::string DownloadManager::songId(std::string_view urlOrId)
+{
+    while (!urlOrId.empty() && std::isspace(static_cast<unsigned char>(urlOrId.back()))) {
+        urlOrId.remove_suffix(1);
+    }
+    while (!urlOrId.empty() && std::isspace(static_cast<unsigned char>(urlOrId.front()))) {
+        urlOrId.remove_prefix(1);
+    }
+    const size_t song = urlOrId.find("/song/");
+    if (song != std::string_view::npos) {
+        urlOrId.remove_prefix(song + 6);
+        urlOrId = urlOrId.substr(0, urlOrId.find_first_of("/?#"));
+    }
+    // Ids become file names, so nothing but plain characters gets through.
+    if (urlOrId.empty() || urlOrId.size() > MAX_SONG_ID_LENGTH ||
+        !std::all_of(urlOrId.begin(), urlOrId.end(), isSongIdChar)) {
+        return std::string();
+    }
+    return std::string(urlOrId);
+}
+
+uint64_t DownloadManager::enqueue(const std::string& songId, const std::string& expectedSha256,
+                                  std::shared_ptr<ChunkStream> preview)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& job : m_queue) {
+        if (job->songId == songId) {
+            return job->id;
+        }
+    }
+    for (const auto& job : m_active) {
+        if (job->songId == songId && !job->cancelled) {
+            return job->id;
+        }
+    }
+    auto job = std::make_shared<Job>();
+    job->id = m_nextJob++;
+    job->songId = songId;
+    job->expectedSha256 = expectedSha256;
+    job->preview = std::move(preview);
+    m_queue.push_back(job);
+    m_wake.notify_one();
+    return job->id;
+}
+
+void DownloadManager::cancel(uint64_t job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if ((*it)->id == job) {
+            m_events.push_back({Event::Type::Failed, job, (*it)->songId, std::string(), 0, 0, false, "cancelled"});
+            if ((*it)->preview) {
+                (*it)->preview->fail();
+            }
+            m_queue.erase(it);
+            if (m_active.empty() && m_queue.empty()) {
+                m_idle.notify_all();
+            }
+            return;
+        }
+    }
+    for (const auto& active : m_active) {
+        if (active->id == job) {
+            active->cancelled = true;
+        }
+    }
+}
+
+std::vector<DownloadManager::Event> DownloadManager::takeEvents()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Event> events;
+    events.swap(m_events);
+    return events;
+}
+
+size_t DownloadManager::pendingJobs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + m_active.size();
+}
+
+void DownloadManager::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_idle.wait_for(lock, WAIT_SLICE, [this]() { return m_queue.empty() && m_active.empty(); })) {
+    }
+}
+
+std::string DownloadManager::audioPath(const std::string& songId) const
+{
+    return (fs::path(m_options.directory) / (songId + AUDIO_EXTENSION)).string();
+}
+
+std::string DownloadManager::cachedPath(const std::string& songId) const
+{
+    const std::string path = audioPath(songId);
+    std::error_code error;
+    if (!fs::exists(path, error)) {
+        return std::string();
+    }
+    const std::string digest = readDigest(path + DIGEST_EXTENSION);
+    return !digest.empty() && digest == Sha256::ofFile(path) ? path : std::string();
+}
+
+void DownloadManager::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        auto next = m_queue.end();
+        auto ready = [this, &next]() {
+            next = nextRunnable();
+            return m_stopping || next != m_queue.end();
+        };
+        if (!m_wake.wait_for(lock, WAIT_SLICE, ready)) {
+            continue;
+        }
+        if (m_stopping) {
+            return;
+        }
+        std::shared_ptr<Job> job = *next;
+        m_queue.erase(next);
+        m_active.push_back(job);
+
+        lock.unlock();
+        run(*job);
+        lock.lock();
+
+        m_active.erase(std::find(m_active.begin(), m_active.end(), job));
+        if (m_active.empty() && m_queue.empty()) {
+            m_idle.notify_all();
+        }
+        // A job for the same song may have been waiting on this one.
+        m_wake.notify_all();
+    }
+}
+
+std::deque<std::shared_ptr<DownloadManager::Job>>::iterator DownloadManager::nextRunnable()
+{
+    return std::find_if(m_queue.begin(), m_queue.end(), [this](const std::shared_ptr<Job>& queued) {
+        return std::none_of(m_active.begin(), m_active.end(),
+                            [&queued](const std::shared_ptr<Job>& active) { return active->songId == queued->songId; });
+    });
+}
+
+void DownloadManager::run(Job& job)
+{
+    const std::string finalPath = audioPath(job.songId);
+    const std::string cached = cachedPath(job.songId);
+    if (!cached.empty() && (job.expectedSha256.empty() || readDigest(cached + DIGEST_EXTENSION) == job.expectedSha256)) {
+        std::error_code error;
+        const uint64_t size = fs::file_size(cached, error);
+        if (job.preview) {
+            feedPreview(job, cached, size);
+            job.preview->finish();
+        }
+        post({Event::Type::Finished, job.id, job.songId, cached, size, size, true, std::string()});
+        return;
+    }
+
+    const std::string partPath = finalPath + PART_EXTENSION;
+    std::string error;
+    for (int attempt = 1; attempt <= std::max(1, m_options.maxAttempts); ++attempt) {
+        if (attempt > 1) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(m_options.retryDelayMs * (attempt - 1)),
+                            [this, &job]() { return m_stopping || job.cancelled.load(); });
+        }
+        if (job.cancelled) {
+            error = "cancelled";
+            break;
+        }
+
+        bool permanent = false;
+        if (!transfer(job, partPath, error, permanent)) {
+            logWarning(LogCategory::General, "Download of " + job.songId + " failed (attempt " +
+                       std::to_string(attempt) + "): " + error);
+            if (permanent) {
+                break;
+            }
+            continue;
+        }
+
+        const std::string digest = Sha256::ofFile(partPath);
+        if (digest.empty() || (!job.expectedSha256.empty() && digest != job.expectedSha256)) {
+            // The partial file cannot be trusted either; start over.
+            error = "checksum mismatch";
+            logWarning(LogCategory::General, "Download of " + job.songId + ": " + error);
+            std::error_code ignored;
+            fs::remove(partPath, ignored);
+            continue;
+        }
+
+        std::error_code renameError;
+        fs::rename(partPath, finalPath, renameError);
+        if (renameError) {
+            error = renameError.message();
+            break;
+        }
+        std::ofstream(finalPath + DIGEST_EXTENSION) << digest << "\n";
+        std::error_code sizeError;
+        const uint64_t size = fs::file_size(finalPath, sizeError);
+        if (job.preview) {
+            job.preview->finish();
+        }
+        logInfo(LogCategory::General, "Downloaded " + job.songId + " (" + std::to_string(size) + " bytes)");
+        post({Event::Type::Finished, job.id, job.songId, finalPath, size, size, false, std::string()});
+        return;
+    }
+    if (job.preview) {
+        job.preview->fail();
+    }
+    post({Event::Type::Failed, job.id, job.songId, std::string(), 0, 0, false, error});
+}
+
+bool DownloadManager::transfer(Job& job, const std::string& partPath, std::string& error, bool& permanent)
+{
+    std::error_code sizeError;
+    uint64_t offset = fs::exists(partPath, sizeError) ? fs::file_size(partPath, sizeError) : 0;
+    if (sizeError) {
+        offset = 0;
+    }
+
+    std::string url = m_options.urlTemplate;
+    const size_t placeholder = url.find("{id}");
+    if (placeholder != std::string::npos) {
+        url.replace(placeholder, 4, job.songId);
+    }
+
+    HttpResponse response;
+    std::ofstream out;
+    uint64_t written = offset;
+    uint64_t reported = offset;
+    bool opened = false;
+    bool writeFailed = false;
+    // Opens the part file once the status says whether the server resumed.
+    auto open = [&]() {
+        if (opened) {
+            return true;
+        }
+        const bool resumed = response.status == 206 && response.rangeStart == offset;
+        if (!resumed && response.status != 200) {
+            return false;
+        }
+        out.open(partPath, std::ios::binary | (resumed ? std::ios::app : std::ios::trunc));
+        written = resumed ? offset : 0;
+        opened = true;
+        if (resumed && job.preview) {
+            // A new preview of a resumed download starts with what is on disk.
+            feedPreview(job, partPath, offset);
+        }
+        writeFailed = !out;
+        return !writeFailed;
+    };
+
+    const bool complete = m_transport.get({url, offset, &job.cancelled}, response, [&](const char* data, size_t size) {
+        if (job.cancelled || !open()) {
+            return false;
+        }
+        out.write(data, static_cast<std::streamsize>(size));
+        if (!out) {
+            writeFailed = true;
+            return false;
+        }
+        // Bytes the preview already has (a restart from zero) are skipped.
+        if (job.preview) {
+            const uint64_t have = job.preview->size();
+            if (written + size > have && written <= have) {
+                job.preview->append(data + (have - written), static_cast<size_t>(written + size - have));
+            }
+        }
+        written += size;
+        if (written - reported >= PROGRESS_STEP_BYTES) {
+            reported = written;
+            post({Event::Type::Progress, job.id, job.songId, std::string(), written, response.totalSize, false, std::string()});
+        }
+        return true;
+    });
+    out.close();
+
+    if (job.cancelled) {
+        error = "cancelled";
+        return false;
+    }
+    if (writeFailed) {
+        error = "cannot write " + partPath;
+        permanent = true;
+        return false;
+    }
+    if (response.status == 416 && offset > 0) {
+        // Nothing left past our offset: either the part is already whole, or
+        // the file changed on the server and the part is stale.
+        if (response.totalSize == offset) {
+            return true;
+        }
+        std::error_code ignored;
+        fs::remove(partPath, ignored);
+        error = "stale partial download";
+        return false;
+    }
+    if (response.status != 200 && response.status != 206) {
+        error = response.status ? "HTTP " + std::to_string(response.status) : response.error;
+        permanent = isPermanent(response.status);
+        return false;
+    }
+    if (!complete) {
+        error = response.error.empty() ? "transfer interrupted" : response.error;
+        return false;
+    }
+    if (!open()) {
+        // Empty body, or a 206 for a range other than the one asked for.
+        error = "unexpected range";
+        return false;
+    }
+    out.close();
+    if (response.totalSize != 0 && written != response.totalSize) {
+        error = "got " + std::to_string(written) + " of " + std::to_string(response.totalSize) + " bytes";
+        return false;
+    }
+    return true;
+}
+
+void DownloadManager::feedPreview(Job& job, const std::string& path, uint64_t end)
+{
+    std::ifstream in(path, std::ios::binary);
+    uint64_t have = job.preview->size();
+    in.seekg(static_cast<std::streamoff>(have));
+    std::vector<char> chunk(ChunkStream::BLOCK_BYTES);
+    while (in && have < end) {
+        in.read(chunk.data(), static_cast<std::streamsize>(std::min<uint64_t>(chunk.size(), end - have)));
+        const size_t got = static_cast<size_t>(in.gcount());
+        job.preview->append(chunk.data(), got);
+        have += got;
+    }
+}
+
+void DownloadManager::post(Event event)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back(std::move(event));
+}
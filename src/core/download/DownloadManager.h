@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "core/download/HttpTransport.h"
+
+class ChunkStream;
+
+// Downloads Suno songs in the background for batch video creation. Songs are
+// fetched a few at a time from a bounded queue; an interrupted transfer
+// keeps its partial file and resumes with a Range request on the next
+// attempt. A finished download is checked against its size and, when
+// known, its SHA-256 before it is moved into the cache directory, where it
+// is found again by song id (with its digest alongside, so a damaged copy
+// is fetched again instead of being used).
+//
+// Results are collected with takeEvents(), typically from a GUI timer.
+class DownloadManager
+{
+public:
+    struct Options {
+        std::string directory;
+        // "{id}" is replaced by the song id.
+        std::string urlTemplate = "https://cdn1.suno.ai/{id}.mp3";
+        int maxConcurrent = 3;
+        int maxAttempts = 4;
+        // Wait before retry n is n times this.
+        int retryDelayMs = 500;
+    };
+
+    struct Event {
+        enum class Type { Progress, Finished, Failed };
+        Type type;
+        uint64_t job;
+        std::string songId;
+        // Finished: the cached audio file.
+        std::string path;
+        uint64_t bytes = 0;
+        // 0 while the size is unknown.
+        uint64_t totalBytes = 0;
+        // Finished without any network access.
+        bool cached = false;
+        std::string message;
+    };
+
+    DownloadManager(HttpTransport& transport, Options options);
+    // Abandons queued jobs and interrupts running ones; their partial files
+    // are kept and resumed by a later manager.
+    ~DownloadManager();
+
+    DownloadManager(const DownloadManager&) = delete;
+    DownloadManager& operator=(const DownloadManager&) = delete;
+
+    // Accepts a bare song id or a suno.com/song/<id> URL; empty if neither.
+    static std::string songId(std::string_view urlOrId);
+
+    // A song that is already queued or downloading keeps its existing job.
+    // One whose download was cancelled gets a new job, which starts once the
+    // cancelled one has stopped.
+    // `expectedSha256` (lowercase hex) is checked when given. A `preview`
+    // stream receives the bytes as they arrive, for playback before the
+    // download completes; it is finished or failed along with the job.
+    uint64_t enqueue(const std::string& songId, const std::string& expectedSha256 = std::string(),
+                     std::shared_ptr<ChunkStream> preview = nullptr);
+    void cancel(uint64_t job);
+    std::vector<Event> takeEvents();
+    size_t pendingJobs() const;
+    // Blocks until every queued job has finished or failed.
+    void waitIdle();
+
+    // Where a song's audio is cached, and that path if a verified copy is there.
+    std::string audioPath(const std::string& songId) const;
+    std::string cachedPath(const std::string& songId) const;
+
+private:
+    struct Job {
+        uint64_t id;
+        std::string songId;
+        std::string expectedSha256;
+        std::shared_ptr<ChunkStream> preview;
+        std::atomic<bool> cancelled{false};
+    };
+
+    void workerLoop();
+    // The first queued job whose song is not being transferred already (a
+    // re-queued song waits for its cancelled job, which shares the part
+    // file); m_queue.end() if none. Called with m_mutex held.
+    std::deque<std::shared_ptr<Job>>::iterator nextRunnable();
+    void run(Job& job);
+    // One attempt at completing `partPath`; `permanent` is set for failures
+    // that retrying cannot fix.
+    bool transfer(Job& job, const std::string& partPath, std::string& error, bool& permanent);
+    // Brings the preview up to `end` from a file on disk.
+    void feedPreview(Job& job, const std::string& path, uint64_t end);
+    void post(Event event);
+
+    HttpTransport& m_transport;
+    Options m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<std::shared_ptr<Job>> m_queue;
+    std::vector<std::shared_ptr<Job>> m_active;
+    std::vector<Event> m_events;
+    uint64_t m_nextJob = 1;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
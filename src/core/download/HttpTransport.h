@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+struct HttpRequest {
+    std::string url;
+    // Non-zero asks for the bytes from this offset on (a Range request).
+    uint64_t rangeStart = 0;
+    // When set, the transfer is aborted as soon as possible, including
+    // while still waiting for the server to answer.
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+struct HttpResponse {
+    int status = 0;
+    // First byte offset of the body: the Content-Range start for a 206, else 0.
+    uint64_t rangeStart = 0;
+    // Size of the whole resource, 0 if the server did not say.
+    uint64_t totalSize = 0;
+    std::string error;
+};
+
+// The network behind DownloadManager. Implementations must allow calls from
+// several download threads at once; tests substitute an in-process server.
+class HttpTransport
+{
+public:
+    // Return false from the body callback to abort the transfer.
+    using BodyCallback = std::function<bool(const char* data, size_t size)>;
+
+    virtual ~HttpTransport() = default;
+
+    // Performs a GET, filling in `response` before the first body callback.
+    // Returns false if the transfer did not complete (connection lost,
+    // timeout, aborted); `response.error` then says why.
+    virtual bool get(const HttpRequest& request, HttpResponse& response, const BodyCallback& onBody) = 0;
+};
@@ -0,0 +1,493 @@
+#include "LyricAligner.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <thread>
+
+namespace {
+    const float PI = 3.14159265358979f;
+    const double SKIP_PENALTY = 1.0;
+    const float ONSET_WEIGHT = 0.2f;
+    // Expected level between two syllables of a line: singers often dip
+    // between syllables, and this gives word boundaries something to lock to.
+    const float SYLLABLE_DIP = 0.2f;
+    // Vocals sit roughly in this band; most bass and cymbal energy does not.
+    const float VOCAL_LOW_HZ = 200.0f;
+    const float VOCAL_HIGH_HZ = 4000.0f;
+    const int DECIMATED_RATE = 11025;
+
+    enum Step : uint8_t { Diagonal, NextFrame, NextUnit };
+
+    struct Biquad {
+        float b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+        float z1 = 0, z2 = 0;
+
+        // RBJ cookbook filters with Q = 1/sqrt(2).
+        static Biquad make(bool highPass, float cutoff, float sampleRate)
+        {
+            const float w = 2.0f * PI * cutoff / sampleRate;
+            const float alpha = std::sin(w) / (2.0f * 0.70710678f);
+            const float c = std::cos(w);
+            const float a0 = 1.0f + alpha;
+            Biquad f;
+            f.b0 = (highPass ? (1.0f + c) : (1.0f - c)) / 2.0f / a0;
+            f.b1 = (highPass ? -(1.0f + c) : (1.0f - c)) / a0;
+            f.b2 = f.b0;
+            f.a1 = -2.0f * c / a0;
+            f.a2 = (1.0f - alpha) / a0;
+            return f;
+        }
+
+        float process(float x)
+        {
+            const float y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+
+        // Digital silence decays the state into denormals, which are very
+        // slow on x86; snap it to zero instead.
+        void flushDenormals()
+        {
+            if (std::fabs(z1) < 1e-15f && std::fabs(z2) < 1e-15f) {
+                z1 = z2 = 0.0f;
+            }
+        }
+    };
+
+    float percentile(std::vector<float> values, float fraction)
+    {
+        if (values.empty()) {
+            return 0.0f;
+        }
+        const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * (values.size() - 1)));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    bool isWordByte(unsigned char c)
+    {
+        return std::isalnum(c) || c >= 0x80;
+    }
+
+    // Text flattened to lines and words, with global indices.
+    struct Word {
+        std::string text;
+        int syllables;
+    };
+
+    struct Line {
+        std::string text;
+        size_t section;
+        std::vector<Word> words;
+    };
+
+    // One step of expected activity; gaps have line == -1.
+    struct Unit {
+        float level;
+        int line;
+        int word;
+    };
+
+    void appendSection(const std::vector<Line>& lines, size_t section, std::vector<Unit>& units)
+    {
+        for (size_t l = 0; l < lines.size(); ++l) {
+            if (lines[l].section != section) {
+                continue;
+            }
+            bool first = true;
+            for (size_t w = 0; w < lines[l].words.size(); ++w) {
+                for (int s = 0; s < lines[l].words[w].syllables; ++s) {
+                    if (!first) {
+                        units.push_back({SYLLABLE_DIP, -1, -1});
+                    }
+                    units.push_back({1.0f, static_cast<int>(l), static_cast<int>(w)});
+                    first = false;
+                }
+            }
+            units.push_back({0.0f, -1, -1});
+        }
+    }
+
+    // Spans (in frames, relative to the warped window) of every line and word.
+    struct Span {
+        int first = std::numeric_limits<int>::max();
+        int last = -1;
+
+        void add(int firstFrame, int lastFrame)
+        {
+            first = std::min(first, firstFrame);
+            last = std::max(last, lastFrame);
+        }
+        bool valid() const { return last >= 0; }
+    };
+}
+
+std::vector<LyricAligner::Section> LyricAligner::parseSections(std::string_view text)
+{
+    std::vector<Section> sections;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) {
+            line.remove_prefix(1);
+        }
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        // A line that is nothing but [bracketed] cues is a section marker,
+        // e.g. "[Chorus]" or "[Pre-chorus][Building intensity]".
+        // The section takes the name in the first group.
+        std::string outside;
+        std::string name;
+        int depth = 0;
+        int groups = 0;
+        for (char c : line) {
+            if (c == '[') {
+                groups += depth == 0 ? 1 : 0;
+                ++depth;
+            } else if (c == ']') {
+                depth = std::max(0, depth - 1);
+            } else if (depth == 0) {
+                outside += c;
+            } else if (groups == 1) {
+                name += c;
+            }
+        }
+        const bool marker = line.front() == '[' &&
+                            std::none_of(outside.begin(), outside.end(), [](char c) { return isWordByte(c); });
+        if (marker) {
+            sections.push_back({name, {}});
+            continue;
+        }
+        if (sections.empty()) {
+            sections.push_back({std::string(), {}});
+        }
+        sections.back().lines.emplace_back(line);
+    }
+    sections.erase(std::remove_if(sections.begin(), sections.end(), [](const Section& s) { return s.lines.empty(); }),
+                   sections.end());
+    return sections;
+}
+
+int LyricAligner::countSyllables(std::string_view word)
+{
+    auto isVowel = [](unsigned char c) {
+        c = static_cast<unsigned char>(std::tolower(c));
+        // UTF-8 lead byte of Latin-1 letters; in lyrics these are mostly accented vowels.
+        return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y' || c == 0xC3;
+    };
+
+    int groups = 0;
+    bool inVowels = false;
+    bool inDigits = false;
+    bool hasLetters = false;
+    for (unsigned char c : word) {
+        if (std::isdigit(c)) {
+            groups += inDigits ? 0 : 1;
+            inDigits = true;
+            inVowels = false;
+            continue;
+        }
+        inDigits = false;
+        if (!isWordByte(c)) {
+            inVowels = false;
+            continue;
+        }
+        hasLetters = true;
+        if (isVowel(c)) {
+            groups += inVowels ? 0 : 1;
+            inVowels = true;
+        } else if (c < 0x80 || (c & 0xC0) != 0x80) {
+            // Continuation bytes of a multi-byte letter keep the current group.
+            inVowels = false;
+        }
+    }
+
+    // Silent final "e" ("make", "time"), but not "le" ("little").
+    size_t end = word.size();
+    while (end > 0 && !isWordByte(static_cast<unsigned char>(word[end - 1]))) {
+        --end;
+    }
+    if (groups > 1 && end >= 2 && std::tolower(static_cast<unsigned char>(word[end - 1])) == 'e' &&
+        !isVowel(static_cast<unsigned char>(word[end - 2])) &&
+        std::tolower(static_cast<unsigned char>(word[end - 2])) != 'l') {
+        --groups;
+    }
+    return groups > 0 ? groups : (hasLetters ? 1 : 0);
+}
+
+std::vector<float> LyricAligner::vocalActivity(const short* interleavedStereo, size_t frameCount, int sampleRate,
+                                               double hopSeconds)
+{
+    const size_t hop = std::max<size_t>(1, static_cast<size_t>(std::lround(sampleRate * hopSeconds)));
+    const size_t hops = (frameCount + hop - 1) / hop;
+    std::vector<float> level(hops, 0.0f);
+    if (hops == 0) {
+        return level;
+    }
+
+    // Box-average down to about 11 kHz first; the band filters then do a
+    // quarter of the work at CD rates.
+    const size_t decimation = std::max(1, sampleRate / DECIMATED_RATE);
+    const float rate = static_cast<float>(sampleRate) / decimation;
+    const float highCut = std::min(VOCAL_HIGH_HZ, 0.45f * rate);
+    Biquad midHigh = Biquad::make(true, VOCAL_LOW_HZ, rate), midLow = Biquad::make(false, highCut, rate);
+    Biquad sideHigh = Biquad::make(true, VOCAL_LOW_HZ, rate), sideLow = Biquad::make(false, highCut, rate);
+
+    for (size_t h = 0; h < hops; ++h) {
+        const size_t begin = h * hop;
+        const size_t end = std::min(frameCount, begin + hop);
+        float midEnergy = 0.0f, sideEnergy = 0.0f;
+        size_t samples = 0;
+        for (size_t i = begin; i < end; i += decimation, ++samples) {
+            const size_t last = std::min(end, i + decimation);
+            int sum = 0, difference = 0;
+            for (size_t k = i; k < last; ++k) {
+                sum += interleavedStereo[2 * k] + interleavedStereo[2 * k + 1];
+                difference += interleavedStereo[2 * k] - interleavedStereo[2 * k + 1];
+            }
+            const float scale = 0.5f / (32768.0f * static_cast<float>(last - i));
+            const float mid = midLow.process(midHigh.process(sum * scale));
+            const float side = sideLow.process(sideHigh.process(difference * scale));
+            midEnergy += mid * mid;
+            sideEnergy += side * side;
+        }
+        for (Biquad* filter : {&midHigh, &midLow, &sideHigh, &sideLow}) {
+            filter->flushDenormals();
+        }
+        // Centre-panned vocals show up in mid but not side; wide
+        // instruments show up in both.
+        const double vocal = std::max(0.0f, midEnergy - 0.5f * sideEnergy) / static_cast<double>(samples);
+        level[h] = static_cast<float>(std::log10(vocal + 1e-10));
+    }
+
+    std::vector<float> onset(hops, 0.0f);
+    for (size_t h = 1; h < hops; ++h) {
+        onset[h] = std::max(0.0f, level[h] - level[h - 1]);
+    }
+
+    const float low = percentile(level, 0.10f);
+    const float high = percentile(level, 0.95f);
+    const float onsetHigh = std::max(percentile(onset, 0.95f), 1e-6f);
+    const float range = std::max(high - low, 1e-6f);
+    for (size_t h = 0; h < hops; ++h) {
+        const float normalized = std::clamp((level[h] - low) / range, 0.0f, 1.0f);
+        const float strength = std::min(onset[h] / onsetHigh, 1.0f);
+        level[h] = (1.0f - ONSET_WEIGHT) * normalized + ONSET_WEIGHT * strength;
+    }
+    return level;
+}
+
+void LyricAligner::warp(const float* observed, size_t observedCount, const float* expected, size_t expectedCount,
+                        std::vector<int>& firstFrame, std::vector<int>& lastFrame)
+{
+    firstFrame.assign(expectedCount, -1);
+    lastFrame.assign(expectedCount, -1);
+    if (observedCount == 0 || expectedCount == 0) {
+        return;
+    }
+
+    const size_t n = observedCount, m = expectedCount;
+    std::vector<uint8_t> steps(n * m);
+    std::vector<double> previous(m), current(m);
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t* row = &steps[i * m];
+        for (size_t j = 0; j < m; ++j) {
+            const double cost = std::fabs(observed[i] - expected[j]);
+            double best;
+            uint8_t step;
+            if (i == 0 && j == 0) {
+                best = 0.0;
+                step = Diagonal;
+            } else if (i == 0) {
+                best = current[j - 1] + SKIP_PENALTY;
+                step = NextUnit;
+            } else if (j == 0) {
+                best = previous[0];
+                step = NextFrame;
+            } else {
+                best = previous[j - 1];
+                step = Diagonal;
+                if (previous[j] < best) {
+                    best = previous[j];
+                    step = NextFrame;
+                }
+                if (current[j - 1] + SKIP_PENALTY < best) {
+                    best = current[j - 1] + SKIP_PENALTY;
+                    step = NextUnit;
+                }
+            }
+            current[j] = best + cost;
+            row[j] = step;
+        }
+        std::swap(previous, current);
+    }
+
+    size_t i = n - 1, j = m - 1;
+    while (true) {
+        firstFrame[j] = static_cast<int>(i);
+        if (lastFrame[j] < 0) {
+            lastFrame[j] = static_cast<int>(i);
+        }
+        if (i == 0 && j == 0) {
+            break;
+        }
+        switch (steps[i * m + j]) {
+        case Diagonal: --i; --j; break;
+        case NextFrame: --i; break;
+        case NextUnit: --j; break;
+        }
+    }
+}
+
+std::vector<LyricLine> LyricAligner::align(std::string_view text, const short* interleavedStereo, size_t frameCount,
+                                           int sampleRate, const Options& options)
+{
+    const std::vector<Section> sections = parseSections(text);
+    std::vector<Line> lines;
+    for (size_t s = 0; s < sections.size(); ++s) {
+        for (const std::string& lineText : sections[s].lines) {
+            Line line{lineText, s, {}};
+            size_t pos = 0;
+            while (pos < lineText.size()) {
+                const size_t begin = lineText.find_first_not_of(" \t", pos);
+                if (begin == std::string::npos) {
+                    break;
+                }
+                const size_t end = std::min(lineText.find_first_of(" \t", begin), lineText.size());
+                const std::string word = lineText.substr(begin, end - begin);
+                line.words.push_back({word, countSyllables(word)});
+                pos = end;
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+    if (lines.empty() || frameCount == 0 || sampleRate <= 0) {
+        return {};
+    }
+
+    const std::vector<float> activity = vocalActivity(interleavedStereo, frameCount, sampleRate, options.hopSeconds);
+    const size_t factor = std::max<size_t>(1, static_cast<size_t>(std::lround(options.coarseHopSeconds / options.hopSeconds)));
+    std::vector<float> coarse((activity.size() + factor - 1) / factor, 0.0f);
+    for (size_t h = 0; h < activity.size(); ++h) {
+        coarse[h / factor] += activity[h] / factor;
+    }
+
+    // Coarse pass: where does each section start and end?
+    std::vector<Unit> units{{0.0f, -1, -1}};
+    std::vector<size_t> sectionOfUnit{0};
+    for (size_t s = 0; s < sections.size(); ++s) {
+        const size_t before = units.size();
+        appendSection(lines, s, units);
+        units.push_back({0.0f, -1, -1});
+        sectionOfUnit.resize(units.size(), s);
+        std::fill(sectionOfUnit.begin() + before, sectionOfUnit.end(), s);
+    }
+    std::vector<float> expected(units.size());
+    std::transform(units.begin(), units.end(), expected.begin(), [](const Unit& u) { return u.level; });
+    std::vector<int> first, last;
+    warp(coarse.data(), coarse.size(), expected.data(), expected.size(), first, last);
+
+    std::vector<Span> sectionSpans(sections.size());
+    for (size_t j = 0; j < units.size(); ++j) {
+        if (units[j].line >= 0) {
+            sectionSpans[sectionOfUnit[j]].add(first[j], last[j]);
+        }
+    }
+
+    // Fine pass: each section on its own slice of the envelope.
+    std::vector<Span> lineSpans(lines.size());
+    std::vector<std::vector<Span>> wordSpans(lines.size());
+    for (size_t l = 0; l < lines.size(); ++l) {
+        wordSpans[l].resize(lines[l].words.size());
+    }
+
+    const int margin = static_cast<int>(std::lround(options.sectionMargin / options.hopSeconds));
+    auto refine = [&](size_t s) {
+        if (!sectionSpans[s].valid()) {
+            return;
+        }
+        const int begin = std::max(0, static_cast<int>(sectionSpans[s].first * factor) - margin);
+        const int end = std::min(static_cast<int>(activity.size()),
+                                 static_cast<int>((sectionSpans[s].last + 1) * factor) + margin);
+        std::vector<Unit> sectionUnits{{0.0f, -1, -1}};
+        appendSection(lines, s, sectionUnits);
+        std::vector<float> sectionExpected(sectionUnits.size());
+        std::transform(sectionUnits.begin(), sectionUnits.end(), sectionExpected.begin(),
+                       [](const Unit& u) { return u.level; });
+        std::vector<int> unitFirst, unitLast;
+        warp(activity.data() + begin, static_cast<size_t>(end - begin), sectionExpected.data(), sectionExpected.size(),
+             unitFirst, unitLast);
+        // Each line (and word) belongs to exactly one section, so threads
+        // never write the same span.
+        for (size_t j = 0; j < sectionUnits.size(); ++j) {
+            const Unit& unit = sectionUnits[j];
+            if (unit.line >= 0) {
+                lineSpans[unit.line].add(begin + unitFirst[j], begin + unitLast[j]);
+                wordSpans[unit.line][unit.word].add(begin + unitFirst[j], begin + unitLast[j]);
+            }
+        }
+    };
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t threadCount = std::min<size_t>(sections.size(), options.threads > 0 ? options.threads : hardware);
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t s = next++; s < sections.size(); s = next++) {
+            refine(s);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Sections were refined independently; keep the result monotonic.
+    std::vector<LyricLine> result(lines.size());
+    double floor = 0.0;
+    for (size_t l = 0; l < lines.size(); ++l) {
+        LyricLine& out = result[l];
+        out.text = lines[l].text;
+        if (lineSpans[l].valid()) {
+            out.startTime = std::max(floor, lineSpans[l].first * options.hopSeconds);
+            out.endTime = std::max(out.startTime, (lineSpans[l].last + 1) * options.hopSeconds);
+        } else {
+            out.startTime = out.endTime = floor;
+        }
+        floor = out.startTime;
+
+        if (options.wordTimings) {
+            double wordFloor = out.startTime;
+            for (size_t w = 0; w < lines[l].words.size(); ++w) {
+                const Span& span = wordSpans[l][w];
+                LyricWord word;
+                word.text = lines[l].words[w].text;
+                word.startTime = span.valid() ? std::max(wordFloor, span.first * options.hopSeconds) : wordFloor;
+                word.endTime = span.valid() ? std::max(word.startTime, (span.last + 1) * options.hopSeconds) : word.startTime;
+                wordFloor = word.startTime;
+                out.words.push_back(std::move(word));
+            }
+        }
+    }
+    return result;
+}
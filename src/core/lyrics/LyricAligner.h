@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+
+// Forced alignment of known lyric text to a decoded track, without any
+// speech recognition. The text becomes a template of expected vocal
+// activity (one unit per syllable, silent units between lines and
+// sections) and is matched against a vocal-band energy/onset envelope by
+// dynamic time warping. A coarse pass over the whole song places the
+// sections; each section is then refined at full resolution on its own
+// thread.
+class LyricAligner
+{
+public:
+    struct Options {
+        bool wordTimings = true;
+        // 0 uses one thread per core.
+        int threads = 0;
+        double hopSeconds = 0.01;
+        double coarseHopSeconds = 0.05;
+        // Audio searched on each side of a section's coarse placement.
+        double sectionMargin = 1.5;
+    };
+
+    struct Section {
+        std::string name;
+        std::vector<std::string> lines;
+    };
+
+    // Splits text into sections at "[Verse]"-style marker lines; lines
+    // before the first marker form an unnamed section. Blank lines are dropped.
+    static std::vector<Section> parseSections(std::string_view text);
+    // Vowel-group estimate, at least 1 for any word with letters or digits.
+    static int countSyllables(std::string_view word);
+
+    // Per-hop vocal activity in [0, 1]: band-limited energy of the centre
+    // (mid) channel above the side channel, plus onset strength.
+    static std::vector<float> vocalActivity(const short* interleavedStereo, size_t frameCount, int sampleRate,
+                                            double hopSeconds);
+
+    static std::vector<LyricLine> align(std::string_view text, const short* interleavedStereo, size_t frameCount,
+                                        int sampleRate, const Options& options);
+
+    // Monotonic DTW of `observed` against `expected`; for every template
+    // unit, the first and last observation it was matched to.
+    static void warp(const float* observed, size_t observedCount, const float* expected, size_t expectedCount,
+                     std::vector<int>& firstFrame, std::vector<int>& lastFrame);
+};
@@ -0,0 +1,302 @@
+#include "LyricCache.h"
+#include "core/Logger.h"
+#include "core/MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[4] = {'A', 'L', 'C', '1'};
+    const char* ENTRY_EXTENSION = ".lyr";
+    const char* ENGINE_FILE = "engine";
+
+    // Times are stored as whole milliseconds, which is finer than any
+    // lyric source and keeps entries small.
+    uint32_t toMilliseconds(double seconds)
+    {
+        if (!(seconds > 0.0)) {
+            return 0;
+        }
+        return static_cast<uint32_t>(std::min(std::llround(seconds * 1000.0), static_cast<long long>(UINT32_MAX)));
+    }
+
+    uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string hex(uint64_t value)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            out[i] = digits[value & 0xF];
+            value >>= 4;
+        }
+        return out;
+    }
+
+    void putU32(std::string& out, uint32_t value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void putText(std::string& out, const std::string& text)
+    {
+        putU32(out, static_cast<uint32_t>(text.size()));
+        out += text;
+    }
+
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view data) : m_data(data) {}
+
+        bool u32(uint32_t& value)
+        {
+            if (m_data.size() - m_pos < sizeof(value)) {
+                return false;
+            }
+            std::memcpy(&value, m_data.data() + m_pos, sizeof(value));
+            m_pos += sizeof(value);
+            return true;
+        }
+
+        bool text(std::string& out)
+        {
+            uint32_t length;
+            if (!u32(length) || m_data.size() - m_pos < length) {
+                return false;
+            }
+            out.assign(m_data.data() + m_pos, length);
+            m_pos += length;
+            return true;
+        }
+
+        size_t remaining() const { return m_data.size() - m_pos; }
+
+    private:
+        std::string_view m_data;
+        size_t m_pos = 0;
+    };
+}
+
+LyricCache::LyricCache(std::string directory, uint64_t maxBytes)
+    : m_directory(std::move(directory)),
+      m_maxBytes(maxBytes)
+{
+}
+
+std::string LyricCache::audioDigest(const short* samples, size_t sampleCount, int sampleRate)
+{
+    // Two independent 64-bit lanes over 8-byte words: fast enough to hash a
+    // whole decoded song in a few milliseconds, and 128 bits leave no
+    // practical chance of two songs colliding.
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(samples);
+    const size_t size = sampleCount * sizeof(short);
+    uint64_t a = 0x9E3779B97F4A7C15ull ^ size;
+    uint64_t b = 0xC2B2AE3D27D4EB4Full + static_cast<uint64_t>(sampleRate);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        a = (a ^ word) * 0x100000001B3ull;
+        a ^= a >> 29;
+        b = (b + word) * 0xFF51AFD7ED558CCDull;
+        b ^= b >> 32;
+    }
+    a = fnv1a(bytes + i, size - i, a);
+    return hex(a) + hex(b) + "-" + std::to_string(sampleRate);
+}
+
+std::string LyricCache::key(const std::string& audioDigest, const std::string& engine)
+{
+    return audioDigest + "-" + hex(fnv1a(engine.data(), engine.size()));
+}
+
+std::string LyricCache::entryPath(const std::string& key) const
+{
+    return m_directory + "/" + key + ENTRY_EXTENSION;
+}
+
+void LyricCache::encode(const std::vector<LyricLine>& lines, std::string& out)
+{
+    out.assign(MAGIC, sizeof(MAGIC));
+    putU32(out, static_cast<uint32_t>(lines.size()));
+    for (const LyricLine& line : lines) {
+        putU32(out, toMilliseconds(line.startTime));
+        putU32(out, toMilliseconds(line.endTime));
+        putText(out, line.text);
+        putU32(out, static_cast<uint32_t>(line.words.size()));
+        for (const LyricWord& word : line.words) {
+            putU32(out, toMilliseconds(word.startTime));
+            putU32(out, toMilliseconds(word.endTime));
+            putText(out, word.text);
+        }
+    }
+    const uint64_t checksum = fnv1a(out.data(), out.size());
+    out.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+}
+
+bool LyricCache::decode(std::string_view data, std::vector<LyricLine>& lines)
+{
+    lines.clear();
+    if (data.size() < sizeof(MAGIC) + sizeof(uint64_t) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    uint64_t checksum;
+    std::memcpy(&checksum, data.data() + data.size() - sizeof(checksum), sizeof(checksum));
+    data.remove_suffix(sizeof(checksum));
+    if (fnv1a(data.data(), data.size()) != checksum) {
+        return false;
+    }
+
+    Reader reader(data.substr(sizeof(MAGIC)));
+    uint32_t lineCount;
+    if (!reader.u32(lineCount)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < lineCount; ++i) {
+        LyricLine line;
+        uint32_t start, end, wordCount;
+        if (!reader.u32(start) || !reader.u32(end) || !reader.text(line.text) || !reader.u32(wordCount)) {
+            return false;
+        }
+        line.startTime = start / 1000.0;
+        line.endTime = end / 1000.0;
+        for (uint32_t w = 0; w < wordCount; ++w) {
+            LyricWord word;
+            if (!reader.u32(start) || !reader.u32(end) || !reader.text(word.text)) {
+                return false;
+            }
+            word.startTime = start / 1000.0;
+            word.endTime = end / 1000.0;
+            line.words.push_back(std::move(word));
+        }
+        lines.push_back(std::move(line));
+    }
+    return reader.remaining() == 0;
+}
+
+bool LyricCache::load(const std::string& key, std::vector<LyricLine>& lines)
+{
+    const std::string path = entryPath(key);
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!decode(file.view(), lines)) {
+        logWarning(LogCategory::Text, "Discarding corrupt lyric cache entry: " + path);
+        file.close();
+        std::error_code error;
+        fs::remove(path, error);
+        return false;
+    }
+    // Modification time doubles as last use for eviction.
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return true;
+}
+
+bool LyricCache::store(const std::string& key, const std::vector<LyricLine>& lines)
+{
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+
+    std::string data;
+    encode(lines, data);
+    // Written under a temporary name and renamed, so a crash never leaves a
+    // truncated entry behind.
+    const std::string path = entryPath(key);
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            logWarning(LogCategory::Text, "Failed to write lyric cache entry: " + tempPath);
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, error);
+    if (error) {
+        logWarning(LogCategory::Text, "Failed to store lyric cache entry: " + error.message());
+        fs::remove(tempPath, error);
+        return false;
+    }
+    evict();
+    return true;
+}
+
+uint64_t LyricCache::sizeBytes() const
+{
+    uint64_t total = 0;
+    std::error_code error;
+    for (const fs::directory_entry& entry : fs::directory_iterator(m_directory, error)) {
+        if (entry.path().extension() == ENTRY_EXTENSION) {
+            total += entry.file_size(error);
+        }
+    }
+    return total;
+}
+
+uint64_t LyricCache::evict()
+{
+    struct Entry {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type lastUse;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code error;
+    for (const fs::directory_entry& entry : fs::directory_iterator(m_directory, error)) {
+        if (entry.path().extension() != ENTRY_EXTENSION) {
+            continue;
+        }
+        const uint64_t size = entry.file_size(error);
+        entries.push_back({entry.path(), size, entry.last_write_time(error)});
+        total += size;
+    }
+    if (total <= m_maxBytes) {
+        return 0;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+    uint64_t freed = 0;
+    for (const Entry& entry : entries) {
+        if (total - freed <= m_maxBytes) {
+            break;
+        }
+        if (fs::remove(entry.path, error)) {
+            freed += entry.size;
+        }
+    }
+    return freed;
+}
+
+std::string LyricCache::lastEngine() const
+{
+    std::ifstream in(m_directory + "/" + ENGINE_FILE);
+    std::string engine;
+    std::getline(in, engine);
+    return engine;
+}
+
+void LyricCache::setLastEngine(const std::string& engine)
+{
+    if (engine == lastEngine()) {
+        return;
+    }
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+    std::ofstream out(m_directory + "/" + ENGINE_FILE, std::ios::trunc);
+    out << engine << "\n";
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+
+// On-disk cache of timed lyrics produced by speech-to-text or alignment.
+// Entries are addressed by the decoded audio, not the file path, so a
+// re-encoded or renamed copy of a song still hits, and by the engine that
+// produced them, so upgrading the model invalidates old results. Each entry
+// is one small binary file; when the directory grows past its size budget
+// the least recently used entries are removed.
+class LyricCache
+{
+public:
+    LyricCache(std::string directory, uint64_t maxBytes);
+
+    // Identifies decoded interleaved PCM independent of container and tags.
+    static std::string audioDigest(const short* samples, size_t sampleCount, int sampleRate);
+    static std::string key(const std::string& audioDigest, const std::string& engine);
+
+    bool load(const std::string& key, std::vector<LyricLine>& lines);
+    bool store(const std::string& key, const std::vector<LyricLine>& lines);
+    // Removes least recently used entries until the cache fits; returns the
+    // number of bytes freed.
+    uint64_t evict();
+    uint64_t sizeBytes() const;
+
+    // Engine reported by the last STT worker, so lookups can happen before
+    // a worker has been started in this session.
+    std::string lastEngine() const;
+    void setLastEngine(const std::string& engine);
+
+    static void encode(const std::vector<LyricLine>& lines, std::string& out);
+    static bool decode(std::string_view data, std::vector<LyricLine>& lines);
+
+private:
+    std::string entryPath(const std::string& key) const;
+
+    std::string m_directory;
+    uint64_t m_maxBytes;
+};
@@ -0,0 +1,793 @@
+#include "LyricImport.h"
+#include "LyricTimeline.h"
+#include "core/Logger.h"
+#include "core/MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+    const int MAX_JSON_DEPTH = 64;
+    const size_t MAX_TIMESTAMP_DIGITS = 9;
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && isSpace(text[begin])) {
+            ++begin;
+        }
+        while (end > begin && isSpace(text[end - 1])) {
+            --end;
+        }
+        return text.substr(begin, end - begin);
+    }
+
+    std::string_view skipBom(std::string_view content)
+    {
+        if (content.size() >= 3 && content.substr(0, 3) == "\xEF\xBB\xBF") {
+            content.remove_prefix(3);
+        }
+        return content;
+    }
+
+    bool startsWith(std::string_view text, std::string_view prefix)
+    {
+        return text.size() >= prefix.size() && text.substr(0, prefix.size()) == prefix;
+    }
+
+    // Splits on '\n' without copying; a trailing '\r' is dropped.
+    class LineReader
+    {
+    public:
+        explicit LineReader(std::string_view text) : m_text(text) {}
+
+        bool next(std::string_view& line)
+        {
+            if (m_pos >= m_text.size()) {
+                return false;
+            }
+            size_t end = m_text.find('\n', m_pos);
+            if (end == std::string_view::npos) {
+                end = m_text.size();
+            }
+            line = m_text.substr(m_pos, end - m_pos);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            m_pos = end + 1;
+            return true;
+        }
+
+    private:
+        std::string_view m_text;
+        size_t m_pos = 0;
+    };
+
+    struct TimedSegment {
+        size_t begin;
+        double start;
+    };
+
+    bool decodeEntity(std::string_view text, size_t& pos, std::string& out)
+    {
+        static const struct { const char* name; const char* value; } entities[] = {
+            {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&nbsp;", " "}, {"&quot;", "\""}, {"&apos;", "'"},
+        };
+        for (const auto& entity : entities) {
+            if (startsWith(text.substr(pos), entity.name)) {
+                out += entity.value;
+                pos += std::char_traits<char>::length(entity.name);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sets line.text from cue or LRC text. <timestamp> markers become word
+    // timings, other <...> tags (and {...} overrides in SRT) are dropped.
+    // Words are the whitespace-separated tokens of the text; a token gets
+    // the time at which the marked segments reach its first and last byte,
+    // so markers inside words (syllable timing) still line up.
+    void parseTimedText(std::string_view raw, bool entities, LyricLine& line)
+    {
+        std::string text;
+        text.reserve(raw.size());
+        std::vector<TimedSegment> segments;
+        bool timed = false;
+
+        size_t pos = 0;
+        while (pos < raw.size()) {
+            const char c = raw[pos];
+            if (c == '<' || c == '{') {
+                const size_t close = raw.find(c == '<' ? '>' : '}', pos + 1);
+                if (close != std::string_view::npos) {
+                    double time;
+                    if (c == '<' && LyricImport::parseTimestamp(raw.substr(pos + 1, close - pos - 1), time)) {
+                        if (!timed && !text.empty()) {
+                            segments.push_back({0, line.startTime});
+                        }
+                        segments.push_back({text.size(), time});
+                        timed = true;
+                    }
+                    pos = close + 1;
+                    continue;
+                }
+            }
+            if (entities && c == '&' && decodeEntity(raw, pos, text)) {
+                continue;
+            }
+            text += c;
+            ++pos;
+        }
+
+        const std::string_view trimmed = trim(text);
+        line.text = std::string(trimmed);
+        if (!timed) {
+            return;
+        }
+
+        // Time at which the segments reach byte `offset`. Offsets are
+        // queried in increasing order, so the segment index only moves forward.
+        size_t segment = 0;
+        auto timeAt = [&](size_t offset) {
+            while (segment + 1 < segments.size() && segments[segment + 1].begin <= offset) {
+                ++segment;
+            }
+            const TimedSegment& current = segments[segment];
+            if (segment + 1 >= segments.size() || offset <= current.begin) {
+                return current.start;
+            }
+            const TimedSegment& next = segments[segment + 1];
+            const double fraction = static_cast<double>(offset - current.begin) / (next.begin - current.begin);
+            return current.start + (next.start - current.start) * fraction;
+        };
+
+        // A word runs up to the start of the next one, so the gap between
+        // them counts towards it; the last segment has no known end.
+        std::vector<std::pair<size_t, size_t>> tokens;
+        for (size_t i = 0; i < text.size();) {
+            while (i < text.size() && isSpace(text[i])) {
+                ++i;
+            }
+            const size_t begin = i;
+            while (i < text.size() && !isSpace(text[i])) {
+                ++i;
+            }
+            if (i > begin) {
+                tokens.emplace_back(begin, i);
+            }
+        }
+        for (size_t k = 0; k < tokens.size(); ++k) {
+            const size_t endOffset = k + 1 < tokens.size() ? tokens[k + 1].first : text.size();
+            LyricWord word;
+            word.text = text.substr(tokens[k].first, tokens[k].second - tokens[k].first);
+            word.startTime = timeAt(tokens[k].first);
+            word.endTime = endOffset <= segments.back().begin ? timeAt(endOffset) : 0.0;
+            if (word.endTime <= word.startTime) {
+                word.endTime = 0.0;
+            }
+            line.words.push_back(std::move(word));
+        }
+    }
+
+    bool parseCues(std::string_view content, bool webVtt, std::vector<LyricLine>& lines)
+    {
+        const size_t before = lines.size();
+        LineReader reader(skipBom(content));
+        std::string_view raw;
+        bool inCue = false;
+        bool inBlock = false;
+        bool first = true;
+        LyricLine cue;
+        std::string body;
+
+        auto flush = [&]() {
+            if (inCue) {
+                parseTimedText(body, webVtt, cue);
+                if (!cue.text.empty()) {
+                    lines.push_back(std::move(cue));
+                }
+            }
+            inCue = false;
+            cue = LyricLine();
+            body.clear();
+        };
+
+        while (reader.next(raw)) {
+            const std::string_view text = trim(raw);
+            if (first && webVtt && startsWith(text, "WEBVTT")) {
+                first = false;
+                continue;
+            }
+            first = false;
+            if (text.empty()) {
+                flush();
+                inBlock = false;
+                continue;
+            }
+            if (inBlock) {
+                continue;
+            }
+            if (webVtt && !inCue && (startsWith(text, "NOTE") || startsWith(text, "STYLE") || startsWith(text, "REGION"))) {
+                inBlock = true;
+                continue;
+            }
+            const size_t arrow = text.find("-->");
+            if (!inCue && arrow != std::string_view::npos) {
+                std::string_view endPart = trim(text.substr(arrow + 3));
+                // WebVTT cue settings follow the end time.
+                size_t settings = 0;
+                while (settings < endPart.size() && !isSpace(endPart[settings])) {
+                    ++settings;
+                }
+                double start, end;
+                if (LyricImport::parseTimestamp(trim(text.substr(0, arrow)), start) &&
+                    LyricImport::parseTimestamp(endPart.substr(0, settings), end)) {
+                    inCue = true;
+                    cue.startTime = start;
+                    cue.endTime = end;
+                }
+                continue;
+            }
+            if (inCue) {
+                if (!body.empty()) {
+                    body += '\n';
+                }
+                body.append(text.data(), text.size());
+            }
+            // Anything else is a cue number or noise.
+        }
+        flush();
+        return lines.size() > before;
+    }
+
+    // Minimal pull parser for the JSON lyric formats; values that are not
+    // needed are skipped without being materialized.
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(std::string_view text) : m_text(text) {}
+
+        void skipWhitespace()
+        {
+            while (m_pos < m_text.size() && isSpace(m_text[m_pos])) {
+                ++m_pos;
+            }
+        }
+
+        char peek()
+        {
+            skipWhitespace();
+            return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+        }
+
+        bool consume(char c)
+        {
+            if (peek() == c) {
+                ++m_pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool string(std::string& out)
+        {
+            out.clear();
+            if (!consume('"')) {
+                return false;
+            }
+            while (m_pos < m_text.size()) {
+                const char c = m_text[m_pos++];
+                if (c == '"') {
+                    return true;
+                }
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (m_pos >= m_text.size()) {
+                    return false;
+                }
+                const char escape = m_text[m_pos++];
+                switch (escape) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!hex4(code)) {
+                        return false;
+                    }
+                    if (code >= 0xD800 && code < 0xDC00 && m_pos + 1 < m_text.size() &&
+                        m_text[m_pos] == '\\' && m_text[m_pos + 1] == 'u') {
+                        m_pos += 2;
+                        uint32_t low;
+                        if (!hex4(low)) {
+                            return false;
+                        }
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                    }
+                    appendUtf8(code, out);
+                    break;
+                }
+                default: out += escape; break;
+                }
+            }
+            return false;
+        }
+
+        bool number(double& value)
+        {
+            skipWhitespace();
+            const char* begin = m_text.data() + m_pos;
+            const char* end = m_text.data() + m_text.size();
+            auto result = std::from_chars(begin, end, value);
+            if (result.ec != std::errc() || !std::isfinite(value)) {
+                return false;
+            }
+            m_pos += static_cast<size_t>(result.ptr - begin);
+            return true;
+        }
+
+        bool skipValue(int depth = 0)
+        {
+            if (depth > MAX_JSON_DEPTH) {
+                return false;
+            }
+            const char c = peek();
+            if (c == '"') {
+                std::string ignored;
+                return string(ignored);
+            }
+            if (c == '[' || c == '{') {
+                const char close = c == '[' ? ']' : '}';
+                ++m_pos;
+                if (consume(close)) {
+                    return true;
+                }
+                do {
+                    if (c == '{') {
+                        std::string key;
+                        if (!string(key) || !consume(':')) {
+                            return false;
+                        }
+                    }
+                    if (!skipValue(depth + 1)) {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume(close);
+            }
+            for (const char* literal : {"true", "false", "null"}) {
+                if (startsWith(m_text.substr(m_pos), literal)) {
+                    m_pos += std::char_traits<char>::length(literal);
+                    return true;
+                }
+            }
+            double ignored;
+            return number(ignored);
+        }
+
+    private:
+        bool hex4(uint32_t& code)
+        {
+            if (m_pos + 4 > m_text.size()) {
+                return false;
+            }
+            auto result = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + 4, code, 16);
+            if (result.ec != std::errc() || result.ptr != m_text.data() + m_pos + 4) {
+                return false;
+            }
+            m_pos += 4;
+            return true;
+        }
+
+        static void appendUtf8(uint32_t code, std::string& out)
+        {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        std::string_view m_text;
+        size_t m_pos = 0;
+    };
+
+    bool isStartKey(const std::string& key) { return key == "start_time" || key == "start"; }
+    bool isEndKey(const std::string& key) { return key == "end_time" || key == "end"; }
+
+    // {"text"|"word", "start_time"|"start", "end_time"|"end"}
+    bool parseJsonWord(JsonReader& reader, LyricWord& word, bool& valid)
+    {
+        if (!reader.consume('{')) {
+            return false;
+        }
+        bool hasText = false, hasStart = false;
+        if (!reader.consume('}')) {
+            do {
+                std::string key;
+                if (!reader.string(key) || !reader.consume(':')) {
+                    return false;
+                }
+                if ((key == "text" || key == "word") && reader.peek() == '"') {
+                    std::string text;
+                    if (!reader.string(text)) {
+                        return false;
+                    }
+                    word.text = std::string(trim(text));
+                    hasText = true;
+                } else if (isStartKey(key) && reader.number(word.startTime)) {
+                    word.startTime = std::max(0.0, word.startTime);
+                    hasStart = true;
+                } else if (isEndKey(key) && reader.number(word.endTime)) {
+                    word.endTime = std::max(0.0, word.endTime);
+                } else if (!reader.skipValue(1)) {
+                    return false;
+                }
+            } while (reader.consume(','));
+            if (!reader.consume('}')) {
+                return false;
+            }
+        }
+        valid = hasText && hasStart && !word.text.empty();
+        return true;
+    }
+
+    bool parseJsonLine(JsonReader& reader, LyricLine& line, bool& valid)
+    {
+        if (!reader.consume('{')) {
+            return false;
+        }
+        bool hasText = false, hasStart = false;
+        if (!reader.consume('}')) {
+            do {
+                std::string key;
+                if (!reader.string(key) || !reader.consume(':')) {
+                    return false;
+                }
+                if (key == "text" && reader.peek() == '"') {
+                    std::string text;
+                    if (!reader.string(text)) {
+                        return false;
+                    }
+                    line.text = std::string(trim(text));
+                    hasText = true;
+                } else if (isStartKey(key) && reader.number(line.startTime)) {
+                    line.startTime = std::max(0.0, line.startTime);
+                    hasStart = true;
+                } else if (isEndKey(key) && reader.number(line.endTime)) {
+                    line.endTime = std::max(0.0, line.endTime);
+                } else if (key == "words" && reader.consume('[')) {
+                    if (!reader.consume(']')) {
+                        do {
+                            LyricWord word;
+                            bool wordValid = false;
+                            if (reader.peek() == '{') {
+                                if (!parseJsonWord(reader, word, wordValid)) {
+                                    return false;
+                                }
+                            } else if (!reader.skipValue(2)) {
+                                return false;
+                            }
+                            if (wordValid) {
+                                line.words.push_back(std::move(word));
+                            }
+                        } while (reader.consume(','));
+                        if (!reader.consume(']')) {
+                            return false;
+                        }
+                    }
+                } else if (!reader.skipValue(1)) {
+                    return false;
+                }
+            } while (reader.consume(','));
+            if (!reader.consume('}')) {
+                return false;
+            }
+        }
+        valid = hasText && hasStart;
+        return true;
+    }
+
+    bool parseJsonLines(JsonReader& reader, std::vector<LyricLine>& lines)
+    {
+        if (!reader.consume('[')) {
+            return false;
+        }
+        if (reader.consume(']')) {
+            return true;
+        }
+        do {
+            if (reader.peek() == '{') {
+                LyricLine line;
+                bool valid = false;
+                if (!parseJsonLine(reader, line, valid)) {
+                    return false;
+                }
+                if (valid) {
+                    lines.push_back(std::move(line));
+                }
+            } else if (!reader.skipValue(1)) {
+                return false;
+            }
+        } while (reader.consume(','));
+        return reader.consume(']');
+    }
+}
+
+bool LyricImport::parseTimestamp(std::string_view text, double& seconds)
+{
+    text = trim(text);
+    unsigned long fields[3] = {0, 0, 0};
+    int fieldCount = 0;
+    size_t pos = 0;
+    while (true) {
+        if (fieldCount == 3) {
+            return false;
+        }
+        const size_t begin = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            ++pos;
+        }
+        if (pos == begin || pos - begin > MAX_TIMESTAMP_DIGITS) {
+            return false;
+        }
+        std::from_chars(text.data() + begin, text.data() + pos, fields[fieldCount++]);
+        if (pos < text.size() && text[pos] == ':') {
+            ++pos;
+            continue;
+        }
+        break;
+    }
+    if (fieldCount < 2) {
+        return false;
+    }
+
+    double fraction = 0.0;
+    if (pos < text.size() && (text[pos] == '.' || text[pos] == ',')) {
+        ++pos;
+        double scale = 0.1;
+        const size_t begin = pos;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            fraction += (text[pos] - '0') * scale;
+            scale *= 0.1;
+            ++pos;
+        }
+        if (pos == begin) {
+            return false;
+        }
+    }
+    if (pos != text.size()) {
+        return false;
+    }
+
+    const unsigned long hours = fieldCount == 3 ? fields[0] : 0;
+    const unsigned long minutes = fields[fieldCount - 2];
+    const unsigned long secs = fields[fieldCount - 1];
+    seconds = hours * 3600.0 + minutes * 60.0 + secs + fraction;
+    return true;
+}
+
+bool LyricImport::parseLrc(std::string_view content, std::vector<LyricLine>& lines)
+{
+    const size_t before = lines.size();
+    double offset = 0.0;
+    std::vector<double> times;
+    LineReader reader(skipBom(content));
+    std::string_view raw;
+    while (reader.next(raw)) {
+        std::string_view text = trim(raw);
+        times.clear();
+        while (!text.empty() && text[0] == '[') {
+            const size_t close = text.find(']');
+            if (close == std::string_view::npos) {
+                break;
+            }
+            const std::string_view tag = text.substr(1, close - 1);
+            double time;
+            if (parseTimestamp(tag, time)) {
+                times.push_back(time);
+            } else if (startsWith(tag, "offset:")) {
+                int milliseconds = 0;
+                const std::string_view value = trim(tag.substr(7));
+                const char* begin = value.data() + (startsWith(value, "+") ? 1 : 0);
+                if (std::from_chars(begin, value.data() + value.size(), milliseconds).ec == std::errc()) {
+                    offset = milliseconds / 1000.0;
+                }
+            }
+            text.remove_prefix(close + 1);
+        }
+
+        for (double time : times) {
+            LyricLine line;
+            line.startTime = time;
+            parseTimedText(text, false, line);
+            lines.push_back(std::move(line));
+        }
+    }
+
+    // A positive offset shows lyrics earlier; it may appear anywhere in the file.
+    if (offset != 0.0) {
+        for (size_t i = before; i < lines.size(); ++i) {
+            LyricLine& line = lines[i];
+            line.startTime = std::max(0.0, line.startTime - offset);
+            for (LyricWord& word : line.words) {
+                word.startTime = std::max(0.0, word.startTime - offset);
+                if (word.endTime > 0.0) {
+                    word.endTime = std::max(0.0, word.endTime - offset);
+                }
+            }
+        }
+    }
+    return lines.size() > before;
+}
+
+bool LyricImport::parseSrt(std::string_view content, std::vector<LyricLine>& lines)
+{
+    return parseCues(content, false, lines);
+}
+
+bool LyricImport::parseWebVtt(std::string_view content, std::vector<LyricLine>& lines)
+{
+    return parseCues(content, true, lines);
+}
+
+bool LyricImport::parseJson(std::string_view content, std::vector<LyricLine>& lines)
+{
+    const size_t before = lines.size();
+    JsonReader reader(skipBom(content));
+    if (reader.peek() == '[') {
+        parseJsonLines(reader, lines);
+    } else if (reader.consume('{') && !reader.consume('}')) {
+        do {
+            std::string key;
+            if (!reader.string(key) || !reader.consume(':')) {
+                break;
+            }
+            if ((key == "segments" || key == "lines" || key == "lyrics") && reader.peek() == '[') {
+                if (!parseJsonLines(reader, lines)) {
+                    break;
+                }
+            } else if (!reader.skipValue(1)) {
+                break;
+            }
+        } while (reader.consume(','));
+    }
+    // Lines parsed before a syntax error are kept.
+    return lines.size() > before;
+}
+
+bool LyricImport::parse(std::string_view content, LyricFormat format, std::vector<LyricLine>& lines)
+{
+    switch (format) {
+    case LyricFormat::Json: return parseJson(content, lines);
+    case LyricFormat::Lrc: return parseLrc(content, lines);
+    case LyricFormat::Srt: return parseSrt(content, lines);
+    case LyricFormat::WebVtt: return parseWebVtt(content, lines);
+    case LyricFormat::Unknown: break;
+    }
+    return false;
+}
+
+LyricFormat LyricImport::detect(std::string_view filePath, std::string_view content)
+{
+    const size_t dot = filePath.rfind('.');
+    if (dot != std::string_view::npos) {
+        std::string extension(filePath.substr(dot + 1));
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == "lrc") return LyricFormat::Lrc;
+        if (extension == "srt") return LyricFormat::Srt;
+        if (extension == "vtt") return LyricFormat::WebVtt;
+        if (extension == "json") return LyricFormat::Json;
+    }
+
+    const std::string_view text = trim(skipBom(content.substr(0, 4096)));
+    if (startsWith(text, "WEBVTT")) {
+        return LyricFormat::WebVtt;
+    }
+    if (startsWith(text, "{")) {
+        return LyricFormat::Json;
+    }
+    if (startsWith(text, "[")) {
+        const std::string_view next = trim(text.substr(1));
+        return startsWith(next, "{") || startsWith(next, "]") ? LyricFormat::Json : LyricFormat::Lrc;
+    }
+    if (text.find("-->") != std::string_view::npos) {
+        return LyricFormat::Srt;
+    }
+    return LyricFormat::Unknown;
+}
+
+const char* LyricImport::formatName(LyricFormat format)
+{
+    switch (format) {
+    case LyricFormat::Json: return "JSON";
+    case LyricFormat::Lrc: return "LRC";
+    case LyricFormat::Srt: return "SRT";
+    case LyricFormat::WebVtt: return "WebVTT";
+    case LyricFormat::Unknown: break;
+    }
+    return "unknown";
+}
+
+bool LyricImport::loadFile(const std::string& filePath, std::vector<LyricLine>& lines, std::string* untimedText)
+{
+    MappedFile file;
+    if (!file.open(filePath)) {
+        logWarning(LogCategory::Text, "Failed to open lyrics: " + filePath);
+        return false;
+    }
+    const LyricFormat format = detect(filePath, file.view());
+    if (format == LyricFormat::Unknown && untimedText) {
+        untimedText->assign(file.view());
+        return false;
+    }
+    const size_t before = lines.size();
+    if (!parse(file.view(), format, lines)) {
+        logWarning(LogCategory::Text, std::string("No ") + formatName(format) + " lyrics found in " + filePath);
+        return false;
+    }
+    logInfo(LogCategory::Text, "Loaded " + std::to_string(lines.size() - before) + " " + formatName(format) +
+            " lyric lines from " + filePath);
+    return true;
+}
+
+bool LyricImport::loadFile(const std::string& filePath, LyricTimeline& timeline)
+{
+    std::vector<LyricLine> lines;
+    if (!loadFile(filePath, lines)) {
+        return false;
+    }
+    timeline.build(std::move(lines));
+    return true;
+}
+
+std::string LyricImport::formatLrc(const std::vector<LyricLine>& lines)
+{
+    auto stamp = [](double seconds) {
+        const long centis = std::lround(std::max(0.0, seconds) * 100.0);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%02ld:%02ld.%02ld", centis / 6000, centis / 100 % 60, centis % 100);
+        return std::string(text);
+    };
+
+    std::string out;
+    for (const LyricLine& line : lines) {
+        out += "[" + stamp(line.startTime) + "]";
+        if (line.hasWordTimings()) {
+            for (size_t i = 0; i < line.words.size(); ++i) {
+                out += (i ? " <" : "<") + stamp(line.words[i].startTime) + ">" + line.words[i].text;
+            }
+        } else {
+            out += line.text;
+        }
+        out += "\n";
+    }
+    return out;
+}
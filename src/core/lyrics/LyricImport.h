@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+
+class LyricTimeline;
+
+enum class LyricFormat {
+    Unknown,
+    // Array of {"text", "start_time", "end_time", "words"} as written by
+    // scripts/stt_processor.py, or an object with a "segments" array.
+    Json,
+    // LRC, including enhanced LRC with <mm:ss.xx> word timings.
+    Lrc,
+    Srt,
+    // WebVTT, including <hh:mm:ss.ttt> karaoke timestamps inside cues.
+    WebVtt
+};
+
+// Single-pass lyric parsers that read straight from the (memory-mapped)
+// file contents; only the final line and word texts are copied. Malformed
+// entries are skipped rather than failing the whole file, and no input can
+// make them read out of bounds or recurse without limit.
+class LyricImport
+{
+public:
+    static LyricFormat detect(std::string_view filePath, std::string_view content);
+    static const char* formatName(LyricFormat format);
+
+    // Appends the lines found in `content`; false if there were none.
+    static bool parse(std::string_view content, LyricFormat format, std::vector<LyricLine>& lines);
+    static bool parseJson(std::string_view content, std::vector<LyricLine>& lines);
+    static bool parseLrc(std::string_view content, std::vector<LyricLine>& lines);
+    static bool parseSrt(std::string_view content, std::vector<LyricLine>& lines);
+    static bool parseWebVtt(std::string_view content, std::vector<LyricLine>& lines);
+
+    // Maps the file, detects its format and appends its lines. A file in no
+    // known format is untimed text; it goes to `untimedText` if given, and
+    // the result is false like any other file without timed lines.
+    static bool loadFile(const std::string& filePath, std::vector<LyricLine>& lines,
+                         std::string* untimedText = nullptr);
+    // The same, building `timeline` from the lines.
+    static bool loadFile(const std::string& filePath, LyricTimeline& timeline);
+
+    // Enhanced LRC, with <mm:ss.xx> word stamps for lines that have word timings.
+    static std::string formatLrc(const std::vector<LyricLine>& lines);
+
+    // Accepts [hh:]mm:ss with an optional '.' or ',' fraction.
+    static bool parseTimestamp(std::string_view text, double& seconds);
+};
@@ -0,0 +1,159 @@
+#include "LyricTimeline.h"
+#include <algorithm>
+#include <iterator>
+
+void LyricTimeline::clear()
+{
+    m_lines.clear();
+    m_starts.clear();
+    m_ends.clear();
+    m_maxEnds.clear();
+    m_openLines.clear();
+}
+
+void LyricTimeline::build(std::vector<LyricLine> lines)
+{
+    clear();
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const LyricLine& a, const LyricLine& b) { return a.startTime < b.startTime; });
+    m_lines = std::move(lines);
+    normalizeFrom(0);
+}
+
+bool LyricTimeline::append(std::vector<LyricLine> lines)
+{
+    if (lines.empty()) {
+        return true;
+    }
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const LyricLine& a, const LyricLine& b) { return a.startTime < b.startTime; });
+    if (!m_lines.empty() && lines.front().startTime < m_starts.back()) {
+        std::vector<LyricLine> all = std::move(m_lines);
+        all.insert(all.end(), std::make_move_iterator(lines.begin()), std::make_move_iterator(lines.end()));
+        build(std::move(all));
+        return false;
+    }
+
+    // The lines that only got LAST_LINE_DURATION now end where the new ones start.
+    const size_t first = m_openLines.empty() ? m_lines.size() : m_openLines.front().index;
+    for (const OpenLine& open : m_openLines) {
+        LyricLine& line = m_lines[open.index];
+        for (size_t word : open.words) {
+            line.words[word].endTime = 0.0;
+        }
+        line.endTime = 0.0;
+    }
+    m_lines.insert(m_lines.end(), std::make_move_iterator(lines.begin()), std::make_move_iterator(lines.end()));
+    normalizeFrom(first);
+    return true;
+}
+
+void LyricTimeline::normalizeFrom(size_t first)
+{
+    const size_t count = m_lines.size();
+    m_starts.resize(count);
+    m_ends.resize(count);
+    m_maxEnds.resize(count);
+    m_openLines.clear();
+    for (size_t i = first; i < count; ++i) {
+        LyricLine& line = m_lines[i];
+        bool open = false;
+        if (line.endTime <= line.startTime) {
+            // The next line that actually starts later, if any.
+            size_t next = i + 1;
+            while (next < count && m_lines[next].startTime <= line.startTime) {
+                ++next;
+            }
+            if (next < count) {
+                line.endTime = m_lines[next].startTime;
+            } else {
+                line.endTime = line.startTime + LAST_LINE_DURATION;
+                open = true;
+                m_openLines.push_back({i, {}});
+            }
+        }
+        // Same rule for words, bounded by the line.
+        for (size_t w = 0; w < line.words.size(); ++w) {
+            LyricWord& word = line.words[w];
+            if (word.endTime > word.startTime) {
+                continue;
+            }
+            size_t next = w + 1;
+            while (next < line.words.size() && line.words[next].startTime <= word.startTime) {
+                ++next;
+            }
+            if (next < line.words.size()) {
+                word.endTime = line.words[next].startTime;
+            } else {
+                word.endTime = std::max(line.endTime, word.startTime);
+                if (open) {
+                    m_openLines.back().words.push_back(w);
+                }
+            }
+        }
+        m_starts[i] = line.startTime;
+        m_ends[i] = line.endTime;
+        m_maxEnds[i] = i > 0 ? std::max(m_maxEnds[i - 1], line.endTime) : line.endTime;
+    }
+}
+
+size_t LyricTimeline::startedBy(double time) const
+{
+    return static_cast<size_t>(std::upper_bound(m_starts.begin(), m_starts.end(), time) - m_starts.begin());
+}
+
+int LyricTimeline::latestVisible(size_t started, double time) const
+{
+    for (size_t i = started; i-- > 0;) {
+        if (m_maxEnds[i] <= time) {
+            break;
+        }
+        if (m_ends[i] > time) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void LyricTimeline::visibleAt(double time, std::vector<int>& indices) const
+{
+    indices.clear();
+    for (size_t i = startedBy(time); i-- > 0;) {
+        if (m_maxEnds[i] <= time) {
+            break;
+        }
+        if (m_ends[i] > time) {
+            indices.push_back(static_cast<int>(i));
+        }
+    }
+    std::reverse(indices.begin(), indices.end());
+}
+
+int LyricTimeline::lineAt(double time) const
+{
+    return latestVisible(startedBy(time), time);
+}
+
+void LyricTimeline::Cursor::reset(const LyricTimeline* timeline)
+{
+    m_timeline = timeline;
+    m_started = 0;
+    m_time = 0.0;
+}
+
+int LyricTimeline::Cursor::seek(double time)
+{
+    if (!m_timeline || m_timeline->empty()) {
+        return -1;
+    }
+    const std::vector<double>& starts = m_timeline->m_starts;
+    if (time >= m_time && m_started <= starts.size()) {
+        while (m_started < starts.size() && starts[m_started] <= time) {
+            ++m_started;
+        }
+    } else {
+        m_started = m_timeline->startedBy(time);
+    }
+    m_time = time;
+    return m_timeline->latestVisible(m_started, time);
+}
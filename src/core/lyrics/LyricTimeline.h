@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+
+// Lyric lines indexed by time. Start and end times live in flat arrays
+// sorted by start, plus a running maximum of end times, so "what is visible
+// at t" is a binary search followed by a short backwards scan, for any t and
+// with overlapping lines. Cursor adds O(1) amortized lookups for playback,
+// which mostly moves forward in small steps.
+class LyricTimeline
+{
+public:
+    // Lines without a usable end time end where the next line starts; the
+    // last one is shown for this long.
+    static constexpr double LAST_LINE_DURATION = 8.0;
+
+    void build(std::vector<LyricLine> lines);
+    // Adds lines to a built timeline. Lines that start no earlier than the
+    // current last one are appended in place, so indices and cursors stay
+    // valid; otherwise everything is re-sorted and false is returned, and
+    // cursors must be reset.
+    bool append(std::vector<LyricLine> lines);
+    void clear();
+
+    size_t size() const { return m_lines.size(); }
+    bool empty() const { return m_lines.empty(); }
+    // Lines in start order, with normalized end times.
+    const LyricLine& line(size_t index) const { return m_lines[index]; }
+
+    // Indices of all lines with start <= t < end, in start order.
+    void visibleAt(double time, std::vector<int>& indices) const;
+    // Most recently started visible line, or -1.
+    int lineAt(double time) const;
+
+    class Cursor
+    {
+    public:
+        explicit Cursor(const LyricTimeline* timeline = nullptr) : m_timeline(timeline) {}
+        void reset(const LyricTimeline* timeline);
+        // Same result as lineAt(time). Moving forward steps through the
+        // start array; moving backwards falls back to a binary search.
+        int seek(double time);
+
+    private:
+        const LyricTimeline* m_timeline;
+        // Number of lines that start at or before m_time.
+        size_t m_started = 0;
+        double m_time = 0.0;
+    };
+
+private:
+    size_t startedBy(double time) const;
+    int latestVisible(size_t started, double time) const;
+    // Fills open end times and the lookup arrays for lines [first, size).
+    void normalizeFrom(size_t first);
+
+    std::vector<LyricLine> m_lines;
+    std::vector<double> m_starts;
+    std::vector<double> m_ends;
+    // m_maxEnds[i] = max(m_ends[0..i]); lets the backwards scan stop early.
+    std::vector<double> m_maxEnds;
+    // Trailing lines whose end is only the LAST_LINE_DURATION guess, with
+    // the words that took their end from it, so append() can reopen them.
+    struct OpenLine {
+        size_t index;
+        std::vector<size_t> words;
+    };
+    std::vector<OpenLine> m_openLines;
+};
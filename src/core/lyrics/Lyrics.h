@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct LyricWord {
+    std::string text;
+    double startTime = 0.0;
+    double endTime = 0.0;
+};
+
+// One displayed lyric line. `words` holds per-word timings for karaoke
+// highlighting, in the order the words appear in `text`; it may be empty
+// for sources that only time whole lines.
+struct LyricLine {
+    std::string text;
+    double startTime = 0.0;
+    double endTime = 0.0;
+    std::vector<LyricWord> words;
+
+    bool hasWordTimings() const { return !words.empty(); }
+};
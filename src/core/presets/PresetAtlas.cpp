@@ -0,0 +1,122 @@
+#include "PresetAtlas.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    const char* INDEX_HEADER = "# aurora preset atlas v1";
+}
+
+PresetAtlas::PresetAtlas(const Layout& layout)
+    : m_layout(layout)
+{
+}
+
+int PresetAtlas::pageCount() const {
+    return m_entries.empty() ? 0 : m_entries.back().page + 1;
+}
+
+std::vector<const PresetAtlasEntry*> PresetAtlas::entriesOnPage(int page) const {
+    std::vector<const PresetAtlasEntry*> result;
+    for (const PresetAtlasEntry& entry : m_entries) {
+        if (entry.page == page) {
+            result.push_back(&entry);
+        }
+    }
+    return result;
+}
+
+const PresetAtlasEntry& PresetAtlas::add(const std::string& presetPath) {
+    const int slot = static_cast<int>(m_entries.size());
+    const int perPage = m_layout.stripsPerPage();
+    const int onPage = slot % perPage;
+
+    PresetAtlasEntry entry;
+    entry.presetPath = presetPath;
+    entry.page = slot / perPage;
+    entry.x = (onPage % m_layout.stripsPerRow()) * m_layout.stripWidth();
+    entry.y = (onPage / m_layout.stripsPerRow()) * m_layout.thumbHeight;
+    m_entries.push_back(entry);
+    return m_entries.back();
+}
+
+bool PresetAtlas::saveIndex(const std::string& filePath) const {
+    std::ofstream out(filePath);
+    if (!out) {
+        std::cerr << "Failed to write preset atlas index: " << filePath << std::endl;
+        return false;
+    }
+
+    out << INDEX_HEADER << "\n";
+    out << "layout\t" << m_layout.thumbWidth << '\t' << m_layout.thumbHeight << '\t'
+        << m_layout.framesPerStrip << '\t' << m_layout.pageSize << "\n";
+    for (const PresetAtlasEntry& entry : m_entries) {
+        out << entry.page << '\t' << entry.x << '\t' << entry.y << '\t' << entry.presetPath << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool PresetAtlas::loadIndex(const std::string& filePath) {
+    std::ifstream in(filePath);
+    if (!in) {
+        return false;
+    }
+
+    m_entries.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        if (line.compare(0, 7, "layout\t") == 0) {
+            std::string tag;
+            fields >> tag >> m_layout.thumbWidth >> m_layout.thumbHeight >> m_layout.framesPerStrip >> m_layout.pageSize;
+            continue;
+        }
+        PresetAtlasEntry entry;
+        if (!(fields >> entry.page >> entry.x >> entry.y)) {
+            std::cerr << "Skipping malformed atlas index line: " << line << std::endl;
+            continue;
+        }
+        fields >> std::ws;
+        std::getline(fields, entry.presetPath);
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+std::string PresetAtlas::pageFileName(int page) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "atlas_%03d.png", page);
+    return name;
+}
+
+void PresetAtlas::downsample(const unsigned char* src, int srcWidth, int srcHeight,
+                             unsigned char* dst, int dstWidth, int dstHeight, int dstStride) {
+    for (int dy = 0; dy < dstHeight; ++dy) {
+        const int y0 = dy * srcHeight / dstHeight;
+        const int y1 = std::max(y0 + 1, (dy + 1) * srcHeight / dstHeight);
+        for (int dx = 0; dx < dstWidth; ++dx) {
+            const int x0 = dx * srcWidth / dstWidth;
+            const int x1 = std::max(x0 + 1, (dx + 1) * srcWidth / dstWidth);
+            unsigned int sum[4] = {0, 0, 0, 0};
+            for (int sy = y0; sy < y1; ++sy) {
+                const unsigned char* row = src + (static_cast<size_t>(sy) * srcWidth + x0) * 4;
+                for (int sx = x0; sx < x1; ++sx, row += 4) {
+                    sum[0] += row[0];
+                    sum[1] += row[1];
+                    sum[2] += row[2];
+                    sum[3] += row[3];
+                }
+            }
+            const unsigned int count = static_cast<unsigned int>((y1 - y0) * (x1 - x0));
+            unsigned char* out = dst + static_cast<size_t>(dy) * dstStride + dx * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[c] = static_cast<unsigned char>(sum[c] / count);
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct PresetAtlasEntry {
+    std::string presetPath;
+    int page = 0;
+    int x = 0;
+    int y = 0;
+};
+
+// Layout and index of preview atlases: each preset gets an animated strip of
+// thumbnails laid out left to right, and strips are packed row by row into
+// square pages so a browser can show a whole page with one texture.
+class PresetAtlas {
+public:
+    struct Layout {
+        int thumbWidth = 128;
+        int thumbHeight = 72;
+        int framesPerStrip = 8;
+        int pageSize = 2048;
+
+        int stripWidth() const { return thumbWidth * framesPerStrip; }
+        int stripsPerRow() const { return pageSize / stripWidth(); }
+        int rowsPerPage() const { return pageSize / thumbHeight; }
+        int stripsPerPage() const { return stripsPerRow() * rowsPerPage(); }
+        size_t stripBytes() const { return static_cast<size_t>(stripWidth()) * thumbHeight * 4; }
+    };
+
+    PresetAtlas() = default;
+    explicit PresetAtlas(const Layout& layout);
+
+    const Layout& layout() const { return m_layout; }
+    const std::vector<PresetAtlasEntry>& entries() const { return m_entries; }
+    int pageCount() const;
+    std::vector<const PresetAtlasEntry*> entriesOnPage(int page) const;
+
+    // Appends a preset at the next free slot and returns its placement.
+    const PresetAtlasEntry& add(const std::string& presetPath);
+
+    bool saveIndex(const std::string& filePath) const;
+    bool loadIndex(const std::string& filePath);
+
+    static std::string indexFileName() { return "atlas_index.tsv"; }
+    static std::string pageFileName(int page);
+
+    // Box-filters an RGBA8 frame into a thumbnail cell of a larger image.
+    static void downsample(const unsigned char* src, int srcWidth, int srcHeight,
+                           unsigned char* dst, int dstWidth, int dstHeight, int dstStride);
+
+private:
+    Layout m_layout;
+    std::vector<PresetAtlasEntry> m_entries;
+};
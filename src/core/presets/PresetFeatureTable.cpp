@@ -0,0 +1,183 @@
+#include "PresetFeatureTable.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    const char* FILE_HEADER = "# aurora preset features v1";
+    const float TWO_PI = 6.28318530718f;
+    const int SAMPLE_STRIDE = 4;
+    // Frame-to-frame luma differences are small; scale them into a usable range.
+    const float MOTION_GAIN = 4.0f;
+
+    float luma(const unsigned char* px) {
+        return (0.2126f * px[0] + 0.7152f * px[1] + 0.0722f * px[2]) / 255.0f;
+    }
+
+    void rgbToHueSaturation(const unsigned char* px, float& hue, float& saturation) {
+        float r = px[0] / 255.0f, g = px[1] / 255.0f, b = px[2] / 255.0f;
+        float maxC = std::max({r, g, b});
+        float minC = std::min({r, g, b});
+        float delta = maxC - minC;
+        saturation = maxC > 0.0f ? delta / maxC : 0.0f;
+        if (delta <= 0.0f) {
+            hue = 0.0f;
+            return;
+        }
+        if (maxC == r) {
+            hue = std::fmod((g - b) / delta, 6.0f);
+        } else if (maxC == g) {
+            hue = (b - r) / delta + 2.0f;
+        } else {
+            hue = (r - g) / delta + 4.0f;
+        }
+        hue /= 6.0f;
+        if (hue < 0.0f) hue += 1.0f;
+    }
+}
+
+void PresetFeatureTable::clear() {
+    m_paths.clear();
+    m_rowByPath.clear();
+    m_motionEnergy.clear();
+    m_brightness.clear();
+    m_hue.clear();
+    m_saturation.clear();
+    m_paletteX.clear();
+    m_paletteY.clear();
+}
+
+void PresetFeatureTable::set(const std::string& presetPath, const PresetFeatures& features) {
+    size_t row;
+    auto it = m_rowByPath.find(presetPath);
+    if (it != m_rowByPath.end()) {
+        row = it->second;
+    } else {
+        row = m_paths.size();
+        m_rowByPath[presetPath] = row;
+        m_paths.push_back(presetPath);
+        m_motionEnergy.push_back(0.0f);
+        m_brightness.push_back(0.0f);
+        m_hue.push_back(0.0f);
+        m_saturation.push_back(0.0f);
+        m_paletteX.push_back(0.0f);
+        m_paletteY.push_back(0.0f);
+    }
+
+    m_motionEnergy[row] = features.motionEnergy;
+    m_brightness[row] = features.brightness;
+    m_hue[row] = features.hue;
+    m_saturation[row] = features.saturation;
+    m_paletteX[row] = std::cos(features.hue * TWO_PI) * features.saturation;
+    m_paletteY[row] = std::sin(features.hue * TWO_PI) * features.saturation;
+}
+
+int PresetFeatureTable::indexOf(const std::string& presetPath) const {
+    auto it = m_rowByPath.find(presetPath);
+    return it != m_rowByPath.end() ? static_cast<int>(it->second) : -1;
+}
+
+PresetFeatures PresetFeatureTable::features(size_t row) const {
+    PresetFeatures f;
+    f.motionEnergy = m_motionEnergy[row];
+    f.brightness = m_brightness[row];
+    f.hue = m_hue[row];
+    f.saturation = m_saturation[row];
+    return f;
+}
+
+bool PresetFeatureTable::load(const std::string& filePath) {
+    std::ifstream in(filePath);
+    if (!in) {
+        return false;
+    }
+
+    clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        PresetFeatures f;
+        std::string path;
+        if (!(fields >> f.motionEnergy >> f.brightness >> f.hue >> f.saturation)) {
+            std::cerr << "Skipping malformed preset feature line: " << line << std::endl;
+            continue;
+        }
+        fields >> std::ws;
+        std::getline(fields, path);
+        if (!path.empty()) {
+            set(path, f);
+        }
+    }
+    return true;
+}
+
+bool PresetFeatureTable::save(const std::string& filePath) const {
+    std::ofstream out(filePath);
+    if (!out) {
+        std::cerr << "Failed to write preset features: " << filePath << std::endl;
+        return false;
+    }
+
+    out << FILE_HEADER << "\n";
+    for (size_t row = 0; row < m_paths.size(); ++row) {
+        out << m_motionEnergy[row] << '\t' << m_brightness[row] << '\t'
+            << m_hue[row] << '\t' << m_saturation[row] << '\t' << m_paths[row] << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+PresetFeatures PresetFeatureTable::analyzeFrames(const std::vector<std::vector<unsigned char>>& rgbaFrames, int width, int height) {
+    PresetFeatures result;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (rgbaFrames.empty() || pixelCount == 0) {
+        return result;
+    }
+
+    double brightnessSum = 0.0, motionSum = 0.0;
+    double paletteX = 0.0, paletteY = 0.0, saturationSum = 0.0;
+    size_t samples = 0, motionSamples = 0;
+
+    for (size_t f = 0; f < rgbaFrames.size(); ++f) {
+        const unsigned char* frame = rgbaFrames[f].data();
+        const unsigned char* previous = f > 0 ? rgbaFrames[f - 1].data() : nullptr;
+        if (rgbaFrames[f].size() < pixelCount * 4) {
+            continue;
+        }
+
+        for (size_t i = 0; i < pixelCount; i += SAMPLE_STRIDE) {
+            const unsigned char* px = frame + i * 4;
+            float y = luma(px);
+            brightnessSum += y;
+
+            float hue, saturation;
+            rgbToHueSaturation(px, hue, saturation);
+            paletteX += std::cos(hue * TWO_PI) * saturation;
+            paletteY += std::sin(hue * TWO_PI) * saturation;
+            saturationSum += saturation;
+            ++samples;
+
+            if (previous && rgbaFrames[f - 1].size() >= pixelCount * 4) {
+                motionSum += std::fabs(y - luma(previous + i * 4));
+                ++motionSamples;
+            }
+        }
+    }
+
+    if (samples == 0) {
+        return result;
+    }
+
+    result.brightness = static_cast<float>(brightnessSum / samples);
+    result.saturation = static_cast<float>(saturationSum / samples);
+    if (motionSamples > 0) {
+        result.motionEnergy = std::min(1.0f, static_cast<float>(motionSum / motionSamples) * MOTION_GAIN);
+    }
+    float hue = static_cast<float>(std::atan2(paletteY, paletteX) / TWO_PI);
+    result.hue = hue < 0.0f ? hue + 1.0f : hue;
+    return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Visual characteristics of a preset, measured offline from rendered frames.
+// All values are normalized to [0, 1].
+struct PresetFeatures {
+    float motionEnergy = 0.0f;
+    float brightness = 0.0f;
+    float hue = 0.0f;
+    float saturation = 0.0f;
+};
+
+// Column-oriented store of preset features so scoring can stream over
+// contiguous float arrays instead of chasing per-preset objects.
+class PresetFeatureTable {
+public:
+    void clear();
+    size_t size() const { return m_paths.size(); }
+    bool empty() const { return m_paths.empty(); }
+
+    void set(const std::string& presetPath, const PresetFeatures& features);
+    int indexOf(const std::string& presetPath) const;
+    const std::string& presetPath(size_t row) const { return m_paths[row]; }
+    PresetFeatures features(size_t row) const;
+
+    const float* motionEnergy() const { return m_motionEnergy.data(); }
+    const float* brightness() const { return m_brightness.data(); }
+    const float* paletteX() const { return m_paletteX.data(); }
+    const float* paletteY() const { return m_paletteY.data(); }
+
+    bool load(const std::string& filePath);
+    bool save(const std::string& filePath) const;
+
+    // Measures features from consecutive RGBA8 frames of a preset render.
+    static PresetFeatures analyzeFrames(const std::vector<std::vector<unsigned char>>& rgbaFrames, int width, int height);
+
+private:
+    std::vector<std::string> m_paths;
+    std::unordered_map<std::string, size_t> m_rowByPath;
+
+    std::vector<float> m_motionEnergy;
+    std::vector<float> m_brightness;
+    std::vector<float> m_hue;
+    std::vector<float> m_saturation;
+    // Hue as a saturation-weighted unit vector, so palette distance is a dot product.
+    std::vector<float> m_paletteX;
+    std::vector<float> m_paletteY;
+};
@@ -0,0 +1,93 @@
+#include "PresetSelector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float JITTER_SCALE = 0.05f;
+
+    float clamp01(float v) {
+        return std::min(1.0f, std::max(0.0f, v));
+    }
+
+    // Cheap integer hash so ties between similar presets are broken
+    // deterministically per section, keeping exports reproducible.
+    float jitter(unsigned int row, unsigned int seed) {
+        unsigned int h = row * 0x9E3779B1u ^ seed * 0x85EBCA77u;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        return (h & 0xFFFF) / 65535.0f * JITTER_SCALE;
+    }
+}
+
+PresetSelector::PresetSelector(const PresetFeatureTable* table)
+    : m_table(table)
+{
+}
+
+void PresetSelector::setTrackAnalysis(const TrackAnalysis& analysis) {
+    m_analysis = analysis;
+    m_currentSection = -1;
+}
+
+int PresetSelector::advance(float songTime) {
+    int section = m_analysis.sectionAt(songTime);
+    if (section < 0 || section == m_currentSection) {
+        return -1;
+    }
+    m_currentSection = section;
+    return section;
+}
+
+const std::vector<float>& PresetSelector::score(const TrackSection& section, int currentRow, const std::deque<int>& recentRows, unsigned int seed) {
+    const size_t n = m_table->size();
+    m_scores.resize(n);
+    if (n == 0) {
+        return m_scores;
+    }
+
+    const float tempoNorm = clamp01((m_analysis.tempo - 60.0f) / 120.0f);
+    const float targetMotion = clamp01(0.7f * section.energy + 0.3f * tempoNorm);
+    const float targetBrightness = clamp01(0.25f + 0.6f * section.energy);
+
+    float currentX = 0.0f, currentY = 0.0f;
+    if (currentRow >= 0 && static_cast<size_t>(currentRow) < n) {
+        currentX = m_table->paletteX()[currentRow];
+        currentY = m_table->paletteY()[currentRow];
+    }
+
+    const float* motion = m_table->motionEnergy();
+    const float* brightness = m_table->brightness();
+    const float* paletteX = m_table->paletteX();
+    const float* paletteY = m_table->paletteY();
+    float* out = m_scores.data();
+    const float wm = m_weights.motion, wb = m_weights.brightness, wp = m_weights.paletteChange * 0.5f;
+
+    for (size_t i = 0; i < n; ++i) {
+        float paletteSimilarity = paletteX[i] * currentX + paletteY[i] * currentY;
+        out[i] = -wm * std::fabs(motion[i] - targetMotion)
+                 - wb * std::fabs(brightness[i] - targetBrightness)
+                 + wp * (1.0f - paletteSimilarity);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[i] += jitter(static_cast<unsigned int>(i), seed);
+    }
+
+    for (int row : recentRows) {
+        if (row >= 0 && static_cast<size_t>(row) < n) {
+            out[row] -= m_weights.recentPenalty;
+        }
+    }
+    if (currentRow >= 0 && static_cast<size_t>(currentRow) < n) {
+        out[currentRow] -= m_weights.recentPenalty;
+    }
+    return m_scores;
+}
+
+int PresetSelector::select(int sectionIndex, int currentRow, const std::deque<int>& recentRows) {
+    if (!m_table || m_table->empty() || sectionIndex < 0 || static_cast<size_t>(sectionIndex) >= m_analysis.sections.size()) {
+        return -1;
+    }
+    const std::vector<float>& scores = score(m_analysis.sections[sectionIndex], currentRow, recentRows, static_cast<unsigned int>(sectionIndex));
+    return static_cast<int>(std::distance(scores.begin(), std::max_element(scores.begin(), scores.end())));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "core/presets/PresetFeatureTable.h"
+#include "core/audio/TrackAnalyzer.h"
+
+// Picks the preset whose measured visuals best fit a section of the current
+// track, and reports when playback crosses into a new section.
+class PresetSelector {
+public:
+    struct Weights {
+        float motion = 1.0f;
+        float brightness = 0.5f;
+        float paletteChange = 0.3f;
+        float recentPenalty = 2.0f;
+    };
+
+    explicit PresetSelector(const PresetFeatureTable* table);
+
+    void setWeights(const Weights& weights) { m_weights = weights; }
+    void setTrackAnalysis(const TrackAnalysis& analysis);
+    const TrackAnalysis& trackAnalysis() const { return m_analysis; }
+
+    // Returns the section index entered since the last call, or -1 if playback
+    // is still inside the same section.
+    int advance(float songTime);
+    void resetPosition() { m_currentSection = -1; }
+
+    // Returns the best table row for the section, or -1 if the table is empty.
+    // recentRows are excluded softly so the same preset doesn't repeat.
+    int select(int sectionIndex, int currentRow, const std::deque<int>& recentRows);
+
+    // Scores every row into m_scores; exposed for benchmarking.
+    const std::vector<float>& score(const TrackSection& section, int currentRow, const std::deque<int>& recentRows, unsigned int seed);
+
+private:
+    const PresetFeatureTable* m_table;
+    Weights m_weights;
+    TrackAnalysis m_analysis;
+    int m_currentSection{-1};
+    std::vector<float> m_scores;
+};
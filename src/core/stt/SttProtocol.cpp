@@ -0,0 +1,154 @@
+#include "SttProtocol.h"
+#include <algorithm>
+#include <charconv>
+
+namespace {
+    const struct {
+        SttMessage::Type type;
+        const char* name;
+    } COMMANDS[] = {
+        {SttMessage::Type::Transcribe, "transcribe"},
+        {SttMessage::Type::Cancel, "cancel"},
+        {SttMessage::Type::Quit, "quit"},
+        {SttMessage::Type::Ready, "ready"},
+        {SttMessage::Type::Segments, "segments"},
+        {SttMessage::Type::Done, "done"},
+        {SttMessage::Type::Error, "error"},
+    };
+
+    // Headers longer than this cannot be a valid length.
+    const size_t MAX_HEADER_DIGITS = 10;
+}
+
+const char* SttProtocol::typeName(SttMessage::Type type)
+{
+    for (const auto& command : COMMANDS) {
+        if (command.type == type) {
+            return command.name;
+        }
+    }
+    return "unknown";
+}
+
+void SttProtocol::appendFrame(std::string_view payload, std::string& out)
+{
+    out += std::to_string(payload.size());
+    out += ' ';
+    out.append(payload.data(), payload.size());
+    out += '\n';
+}
+
+std::string SttProtocol::encode(const SttMessage& message)
+{
+    std::string payload = typeName(message.type);
+    if (message.type != SttMessage::Type::Quit) {
+        payload += ' ';
+        payload += std::to_string(message.job);
+        if (!message.body.empty()) {
+            payload += ' ';
+            payload += message.body;
+        }
+    }
+    std::string frame;
+    appendFrame(payload, frame);
+    return frame;
+}
+
+bool SttProtocol::parse(std::string_view payload, SttMessage& message)
+{
+    message = SttMessage();
+    const size_t commandEnd = std::min(payload.find(' '), payload.size());
+    const std::string_view command = payload.substr(0, commandEnd);
+    for (const auto& entry : COMMANDS) {
+        if (command == entry.name) {
+            message.type = entry.type;
+        }
+    }
+    if (message.type == SttMessage::Type::Unknown) {
+        return false;
+    }
+    if (commandEnd == payload.size()) {
+        return message.type == SttMessage::Type::Quit;
+    }
+
+    const char* jobBegin = payload.data() + commandEnd + 1;
+    const char* end = payload.data() + payload.size();
+    auto result = std::from_chars(jobBegin, end, message.job);
+    if (result.ec != std::errc() || (result.ptr != end && *result.ptr != ' ')) {
+        return false;
+    }
+    if (result.ptr != end) {
+        message.body.assign(result.ptr + 1, end);
+    }
+    return true;
+}
+
+void SttFrameReader::append(std::string_view bytes)
+{
+    // Compact once the consumed prefix dominates, keeping appends amortized O(1).
+    if (m_pos > 0 && m_pos >= m_buffer.size() / 2) {
+        m_buffer.erase(0, m_pos);
+        m_pos = 0;
+    }
+    m_buffer.append(bytes.data(), bytes.size());
+}
+
+void SttFrameReader::clear()
+{
+    m_buffer.clear();
+    m_pos = 0;
+}
+
+bool SttFrameReader::skipLine()
+{
+    const size_t newline = m_buffer.find('\n', m_pos);
+    if (newline == std::string::npos) {
+        // Keep waiting only while the junk could still be followed by a newline
+        // within a sane distance.
+        if (m_buffer.size() - m_pos > MAX_HEADER_DIGITS + SttProtocol::MAX_PAYLOAD_BYTES) {
+            m_buffer.clear();
+            m_pos = 0;
+        }
+        return false;
+    }
+    m_pos = newline + 1;
+    ++m_discarded;
+    return true;
+}
+
+bool SttFrameReader::next(std::string& payload)
+{
+    while (m_pos < m_buffer.size()) {
+        const char* begin = m_buffer.data() + m_pos;
+        const char* end = m_buffer.data() + m_buffer.size();
+        size_t length = 0;
+        auto result = std::from_chars(begin, end, length);
+        const size_t digits = static_cast<size_t>(result.ptr - begin);
+        if (result.ptr == end && digits <= MAX_HEADER_DIGITS) {
+            return false;
+        }
+        if (result.ec != std::errc() || digits > MAX_HEADER_DIGITS || *result.ptr != ' ' ||
+            length > SttProtocol::MAX_PAYLOAD_BYTES) {
+            if (!skipLine()) {
+                return false;
+            }
+            continue;
+        }
+
+        const size_t payloadStart = m_pos + digits + 1;
+        if (m_buffer.size() < payloadStart + length + 1) {
+            return false;
+        }
+        if (m_buffer[payloadStart + length] != '\n') {
+            // Length disagrees with the data; resynchronize on the next line.
+            if (!skipLine()) {
+                return false;
+            }
+            continue;
+        }
+        payload.assign(m_buffer, payloadStart, length);
+        m_pos = payloadStart + length + 1;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Messages exchanged with the resident STT worker (scripts/stt_worker.py).
+// Each frame is "<payload length> <payload>\n", so payloads may contain
+// newlines and a reader never has to scan for delimiters inside them. A
+// payload is "<command> [<job> [<body>]]":
+//
+//   to the worker:    transcribe <job> <audio path>
+//                     cancel <job>
+//                     quit
+//   from the worker:  ready 0 <engine name and version>
+//                     segments <job> <JSON array of lines, LyricImport format>
+//                     done <job>
+//                     error <job> <message>
+struct SttMessage {
+    enum class Type {
+        Unknown,
+        Transcribe,
+        Cancel,
+        Quit,
+        Ready,
+        Segments,
+        Done,
+        Error
+    };
+
+    Type type = Type::Unknown;
+    uint64_t job = 0;
+    std::string body;
+};
+
+class SttProtocol
+{
+public:
+    // Frames larger than this are treated as corrupt.
+    static constexpr size_t MAX_PAYLOAD_BYTES = 8 * 1024 * 1024;
+
+    static const char* typeName(SttMessage::Type type);
+
+    static std::string encode(const SttMessage& message);
+    static void appendFrame(std::string_view payload, std::string& out);
+    static bool parse(std::string_view payload, SttMessage& message);
+};
+
+// Incremental frame decoder for a byte stream read in arbitrary chunks.
+// A malformed header is skipped up to the next newline and counted, so one
+// bad write from the worker (e.g. a stray print) does not stall the stream.
+class SttFrameReader
+{
+public:
+    void append(std::string_view bytes);
+    // Next complete payload, or false if more bytes are needed.
+    bool next(std::string& payload);
+    void clear();
+
+    size_t bufferedBytes() const { return m_buffer.size() - m_pos; }
+    size_t discardedFrames() const { return m_discarded; }
+
+private:
+    bool skipLine();
+
+    std::string m_buffer;
+    size_t m_pos = 0;
+    size_t m_discarded = 0;
+};
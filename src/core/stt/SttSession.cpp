@@ -0,0 +1,155 @@
+#include "SttSession.h"
+#include "core/Logger.h"
+#include "core/lyrics/LyricImport.h"
+#include <algorithm>
+#include <utility>
+
+uint64_t SttSession::submit(const std::string& audioPath)
+{
+    const uint64_t id = m_nextJob++;
+    m_pending.push_back({id, audioPath});
+    m_outgoing += SttProtocol::encode({SttMessage::Type::Transcribe, id, audioPath});
+    return id;
+}
+
+void SttSession::cancel(uint64_t job)
+{
+    if (!isPending(job)) {
+        return;
+    }
+    // Whatever the worker already sent for the job is dropped on arrival.
+    finish(job);
+    m_outgoing += SttProtocol::encode({SttMessage::Type::Cancel, job, std::string()});
+}
+
+void SttSession::quit()
+{
+    m_outgoing += SttProtocol::encode({SttMessage::Type::Quit, 0, std::string()});
+}
+
+std::string SttSession::takeOutgoing()
+{
+    return std::exchange(m_outgoing, std::string());
+}
+
+std::vector<SttSession::Event> SttSession::takeEvents()
+{
+    return std::exchange(m_events, std::vector<Event>());
+}
+
+SttSession::Job* SttSession::findJob(uint64_t job)
+{
+    auto it = std::find_if(m_pending.begin(), m_pending.end(), [job](const Job& j) { return j.id == job; });
+    return it != m_pending.end() ? &*it : nullptr;
+}
+
+bool SttSession::isPending(uint64_t job) const
+{
+    return std::any_of(m_pending.begin(), m_pending.end(), [job](const Job& j) { return j.id == job; });
+}
+
+void SttSession::finish(uint64_t job)
+{
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [job](const Job& j) { return j.id == job; }),
+                    m_pending.end());
+}
+
+void SttSession::restart()
+{
+    m_ready = false;
+    m_reader.clear();
+    m_outgoing.clear();
+    for (Job& job : m_pending) {
+        job.resent = true;
+        m_outgoing += SttProtocol::encode({SttMessage::Type::Transcribe, job.id, job.audioPath});
+    }
+}
+
+void SttSession::fail(const std::string& message)
+{
+    for (const Job& job : m_pending) {
+        Event event;
+        event.type = Event::Type::Error;
+        event.job = job.id;
+        event.text = message;
+        m_events.push_back(std::move(event));
+    }
+    m_pending.clear();
+    m_outgoing.clear();
+}
+
+void SttSession::receive(std::string_view bytes)
+{
+    m_reader.append(bytes);
+    SttMessage message;
+    while (m_reader.next(m_payload)) {
+        if (!SttProtocol::parse(m_payload, message)) {
+            logWarning(LogCategory::General, "Ignoring malformed STT worker message");
+            continue;
+        }
+        handle(message);
+    }
+}
+
+void SttSession::handle(const SttMessage& message)
+{
+    Event event;
+    event.job = message.job;
+    switch (message.type) {
+    case SttMessage::Type::Ready:
+        m_ready = true;
+        m_engine = message.body;
+        event.type = Event::Type::Ready;
+        event.text = message.body;
+        break;
+    case SttMessage::Type::Segments: {
+        Job* job = findJob(message.job);
+        if (!job) {
+            return;
+        }
+        event.type = Event::Type::Segments;
+        if (!LyricImport::parseJson(message.body, event.lines)) {
+            return;
+        }
+        if (job->resent) {
+            // The new worker starts the file over; skip what the old one sent.
+            const double until = job->deliveredUntil;
+            event.lines.erase(std::remove_if(event.lines.begin(), event.lines.end(),
+                                             [until](const LyricLine& line) { return line.startTime <= until; }),
+                              event.lines.end());
+            if (event.lines.empty()) {
+                return;
+            }
+        }
+        for (const LyricLine& line : event.lines) {
+            job->deliveredUntil = std::max(job->deliveredUntil, line.startTime);
+        }
+        break;
+    }
+    case SttMessage::Type::Done:
+        if (!isPending(message.job)) {
+            return;
+        }
+        finish(message.job);
+        event.type = Event::Type::Done;
+        break;
+    case SttMessage::Type::Error:
+        if (message.job == 0) {
+            // Not about one file: the worker itself is unusable.
+            fail(message.body);
+            return;
+        }
+        if (!isPending(message.job)) {
+            return;
+        }
+        finish(message.job);
+        event.type = Event::Type::Error;
+        event.text = message.body;
+        break;
+    default:
+        logWarning(LogCategory::General, std::string("Unexpected STT worker message: ") +
+                   SttProtocol::typeName(message.type));
+        return;
+    }
+    m_events.push_back(std::move(event));
+}
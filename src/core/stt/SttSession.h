@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+#include "core/stt/SttProtocol.h"
+
+// Client side of the STT worker protocol, independent of how the worker is
+// run: the owner writes takeOutgoing() to the worker's stdin, passes its
+// stdout to receive() and handles the resulting events. Jobs are sent as
+// soon as they are submitted; the worker processes them in order and
+// streams segments back while it transcribes.
+class SttSession
+{
+public:
+    struct Event {
+        enum class Type {
+            Ready,
+            Segments,
+            Done,
+            Error
+        };
+
+        Type type = Type::Ready;
+        uint64_t job = 0;
+        // Segments: the new lines, in the order the worker produced them.
+        std::vector<LyricLine> lines;
+        // Ready: engine description. Error: the worker's message.
+        std::string text;
+    };
+
+    uint64_t submit(const std::string& audioPath);
+    void cancel(uint64_t job);
+    void quit();
+
+    std::string takeOutgoing();
+    void receive(std::string_view bytes);
+    std::vector<Event> takeEvents();
+
+    // The worker process went away. Jobs it had not finished are sent again
+    // to the next worker, starting with takeOutgoing(); segments of theirs
+    // the old worker already delivered are dropped when they come again.
+    void restart();
+    // The worker cannot run at all: every pending job ends with an Error
+    // event carrying `message`, and nothing is left to send.
+    void fail(const std::string& message);
+
+    bool isReady() const { return m_ready; }
+    const std::string& engine() const { return m_engine; }
+    size_t pendingJobs() const { return m_pending.size(); }
+    bool isPending(uint64_t job) const;
+    size_t discardedFrames() const { return m_reader.discardedFrames(); }
+
+private:
+    struct Job {
+        uint64_t id;
+        std::string audioPath;
+        // Start of the latest line delivered for the job.
+        double deliveredUntil = -1.0;
+        bool resent = false;
+    };
+
+    Job* findJob(uint64_t job);
+
+    void handle(const SttMessage& message);
+    void finish(uint64_t job);
+
+    uint64_t m_nextJob = 1;
+    std::deque<Job> m_pending;
+    std::string m_outgoing;
+    SttFrameReader m_reader;
+    std::string m_payload;
+    std::vector<Event> m_events;
+    bool m_ready = false;
+    std::string m_engine;
+};
@@ -0,0 +1,68 @@
+#include "FontMetrics.h"
+#include <algorithm>
+
+namespace {
+    uint64_t mix(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+void FontMetrics::setGlyph(unsigned char c, const GlyphMetrics& glyph)
+{
+    m_glyphs[c] = glyph;
+    m_fingerprint = mix(mix(m_fingerprint, &c, 1), &glyph, sizeof(glyph));
+}
+
+void FontMetrics::setLineHeight(float lineHeight)
+{
+    m_lineHeight = lineHeight;
+    m_fingerprint = mix(m_fingerprint, &lineHeight, sizeof(lineHeight));
+}
+
+TextBounds FontMetrics::measure(std::string_view text, float scale) const
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    const float lineHeight = m_lineHeight * scale;
+
+    for (char c : text) {
+        if (c == '\n') {
+            y -= lineHeight;
+            x = 0.0f;
+            continue;
+        }
+        const GlyphMetrics& glyph = m_glyphs[static_cast<unsigned char>(c)];
+        const float xpos = x + glyph.bearingX * scale;
+        const float ypos = y - (glyph.height - glyph.bearingY) * scale;
+        minX = std::min(minX, xpos);
+        maxX = std::max(maxX, xpos + glyph.width * scale);
+        minY = std::min(minY, ypos);
+        maxY = std::max(maxY, ypos + glyph.height * scale);
+        x += glyph.advance * scale;
+    }
+
+    return {minX, minY, maxX - minX, maxY - minY};
+}
+
+float FontMetrics::advance(std::string_view text, float scale) const
+{
+    float total = 0.0f;
+    for (char c : text) {
+        total += m_glyphs[static_cast<unsigned char>(c)].advance;
+    }
+    return total * scale;
+}
+
+float FontMetrics::averageAdvance(float scale) const
+{
+    float total = m_glyphs[' '].advance;
+    for (unsigned char c = 'a'; c <= 'z'; ++c) {
+        total += m_glyphs[c].advance;
+    }
+    return total / 27.0f * scale;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+struct GlyphMetrics {
+    float width = 0.0f;
+    float height = 0.0f;
+    float bearingX = 0.0f;
+    float bearingY = 0.0f;
+    // Pen advance in whole pixels.
+    float advance = 0.0f;
+};
+
+struct TextBounds {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// Per-byte glyph metrics of one font size, kept apart from the GL textures so
+// layout code can measure text without a context. Bytes without a glyph
+// measure as empty.
+class FontMetrics
+{
+public:
+    void setGlyph(unsigned char c, const GlyphMetrics& glyph);
+    const GlyphMetrics& glyph(unsigned char c) const { return m_glyphs[c]; }
+
+    void setLineHeight(float lineHeight);
+    float lineHeight() const { return m_lineHeight; }
+
+    // Identifies the metrics for caching layouts; changes with every setter.
+    uint64_t fingerprint() const { return m_fingerprint; }
+
+    // Ink bounds of `text` with the pen starting at the origin; '\n' starts
+    // a new line below (y grows upwards).
+    TextBounds measure(std::string_view text, float scale) const;
+    // Sum of advances, i.e. the pen distance for a single line.
+    float advance(std::string_view text, float scale) const;
+    // Mean advance of lowercase letters and space, for converting
+    // character-count settings into widths.
+    float averageAdvance(float scale) const;
+
+private:
+    std::array<GlyphMetrics, 256> m_glyphs{};
+    float m_lineHeight = 0.0f;
+    uint64_t m_fingerprint = 14695981039346656037ull;
+};
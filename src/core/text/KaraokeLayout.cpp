@@ -0,0 +1,75 @@
+#include "KaraokeLayout.h"
+
+namespace {
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t';
+    }
+}
+
+std::vector<KaraokeVertex> KaraokeLayout::build(std::string_view text, const LyricLine& line,
+                                                const FontMetrics& metrics,
+                                                const std::array<GlyphAtlasRect, 256>& atlas)
+{
+    std::vector<KaraokeVertex> vertices;
+    vertices.reserve(text.size() * 6);
+
+    float penX = 0.0f;
+    float penY = 0.0f;
+    size_t wordIndex = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const char c = text[pos];
+        if (c == '\n') {
+            penX = 0.0f;
+            penY -= metrics.lineHeight();
+            ++pos;
+            continue;
+        }
+        if (isSpace(c)) {
+            penX += metrics.glyph(static_cast<unsigned char>(c)).advance;
+            ++pos;
+            continue;
+        }
+
+        size_t end = pos;
+        while (end < text.size() && !isSpace(text[end])) {
+            ++end;
+        }
+        const std::string_view token = text.substr(pos, end - pos);
+        const float tokenWidth = metrics.advance(token, 1.0f);
+        float start = static_cast<float>(line.endTime);
+        float finish = static_cast<float>(line.endTime);
+        if (wordIndex < line.words.size()) {
+            start = static_cast<float>(line.words[wordIndex].startTime);
+            finish = static_cast<float>(line.words[wordIndex].endTime);
+        }
+        ++wordIndex;
+
+        const float tokenX = penX;
+        for (char g : token) {
+            const GlyphMetrics& glyph = metrics.glyph(static_cast<unsigned char>(g));
+            const GlyphAtlasRect& rect = atlas[static_cast<unsigned char>(g)];
+            const float x0 = penX + glyph.bearingX;
+            const float x1 = x0 + glyph.width;
+            const float y0 = penY - (glyph.height - glyph.bearingY);
+            const float y1 = y0 + glyph.height;
+            const float f0 = tokenWidth > 0.0f ? (x0 - tokenX) / tokenWidth : 0.0f;
+            const float f1 = tokenWidth > 0.0f ? (x1 - tokenX) / tokenWidth : 1.0f;
+
+            const KaraokeVertex topLeft = {x0, y1, rect.u0, rect.v0, start, finish, f0};
+            const KaraokeVertex bottomLeft = {x0, y0, rect.u0, rect.v1, start, finish, f0};
+            const KaraokeVertex bottomRight = {x1, y0, rect.u1, rect.v1, start, finish, f1};
+            const KaraokeVertex topRight = {x1, y1, rect.u1, rect.v0, start, finish, f1};
+            vertices.push_back(topLeft);
+            vertices.push_back(bottomLeft);
+            vertices.push_back(bottomRight);
+            vertices.push_back(topLeft);
+            vertices.push_back(bottomRight);
+            vertices.push_back(topRight);
+            penX += glyph.advance;
+        }
+        pos = end;
+    }
+    return vertices;
+}
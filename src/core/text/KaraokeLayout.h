@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+#include "core/text/FontMetrics.h"
+
+// Texture coordinates of a glyph inside the font atlas; v grows downwards
+// like the glyph bitmaps.
+struct GlyphAtlasRect {
+    float u0 = 0.0f;
+    float v0 = 0.0f;
+    float u1 = 0.0f;
+    float v1 = 0.0f;
+};
+
+// One vertex of a karaoke text mesh. Positions are at scale 1 relative to
+// the pen origin so the mesh can be moved and scaled with uniforms.
+// wordFraction runs 0..1 across the advance of the glyph's word; the shader
+// lights the fragment once the word's progress at the current time passes it.
+struct KaraokeVertex {
+    float x, y;
+    float u, v;
+    float startTime, endTime;
+    float wordFraction;
+};
+
+// Builds the triangle mesh (6 vertices per glyph) of a karaoke line once per
+// line; highlighting then only needs the current time. Whitespace-separated
+// tokens of `text` are matched to `words` in order; tokens without a timing
+// light up with the line's end.
+class KaraokeLayout
+{
+public:
+    static std::vector<KaraokeVertex> build(std::string_view text, const LyricLine& line,
+                                            const FontMetrics& metrics,
+                                            const std::array<GlyphAtlasRect, 256>& atlas);
+};
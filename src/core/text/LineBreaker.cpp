@@ -0,0 +1,158 @@
+#include "LineBreaker.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // Extra cost per pixel of overflow, so an over-long word is only ever
+    // left alone on its line rather than joined with others.
+    const double OVERFLOW_PENALTY = 1e6;
+
+    struct Word {
+        size_t start;
+        size_t length;
+        float width;
+    };
+
+    // Appends the best breaking of one paragraph (no '\n' inside) to lines.
+    void breakParagraph(std::string_view paragraph, const FontMetrics& metrics, float scale, float maxWidth,
+                        std::vector<std::string>& lines)
+    {
+        std::vector<Word> words;
+        size_t pos = 0;
+        while (pos < paragraph.size()) {
+            while (pos < paragraph.size() && paragraph[pos] == ' ') {
+                ++pos;
+            }
+            const size_t start = pos;
+            while (pos < paragraph.size() && paragraph[pos] != ' ') {
+                ++pos;
+            }
+            if (pos > start) {
+                words.push_back({start, pos - start, metrics.advance(paragraph.substr(start, pos - start), scale)});
+            }
+        }
+        if (words.empty()) {
+            lines.emplace_back();
+            return;
+        }
+
+        const float spaceWidth = metrics.glyph(' ').advance * scale;
+        const size_t count = words.size();
+        // cost[i]: best cost of setting words i..count-1; next[i]: first word of the following line.
+        std::vector<double> cost(count + 1, std::numeric_limits<double>::infinity());
+        std::vector<size_t> next(count + 1, count);
+        cost[count] = 0.0;
+        for (size_t i = count; i-- > 0;) {
+            float width = -spaceWidth;
+            for (size_t j = i; j < count; ++j) {
+                width += spaceWidth + words[j].width;
+                if (width > maxWidth && j > i) {
+                    break;
+                }
+                const double slack = static_cast<double>(maxWidth) - width;
+                const double lineCost = slack >= 0.0 ? slack * slack : -slack * OVERFLOW_PENALTY;
+                const double total = lineCost + cost[j + 1];
+                if (total < cost[i]) {
+                    cost[i] = total;
+                    next[i] = j + 1;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < count; i = next[i]) {
+            const Word& first = words[i];
+            const Word& last = words[next[i] - 1];
+            std::string line;
+            line.reserve(last.start + last.length - first.start);
+            for (size_t j = i; j < next[i]; ++j) {
+                if (j > i) {
+                    line += ' ';
+                }
+                line.append(paragraph.substr(words[j].start, words[j].length));
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+}
+
+LineBreaker::LineBreaker(size_t cacheCapacity)
+    : m_capacity(std::max<size_t>(1, cacheCapacity))
+{
+}
+
+std::vector<std::string> LineBreaker::breakLines(std::string_view text, const FontMetrics& metrics,
+                                                 float scale, float maxWidth)
+{
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (true) {
+        const size_t end = text.find('\n', start);
+        breakParagraph(text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start),
+                       metrics, scale, maxWidth, lines);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return lines;
+}
+
+std::string LineBreaker::wrap(std::string_view text, const FontMetrics& metrics, float scale, float maxWidth)
+{
+    std::string key(text);
+    const uint64_t fingerprint = metrics.fingerprint();
+    key.push_back('\0');
+    key.append(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    key.append(reinterpret_cast<const char*>(&scale), sizeof(scale));
+    key.append(reinterpret_cast<const char*>(&maxWidth), sizeof(maxWidth));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            ++m_hits;
+            return it->second->wrapped;
+        }
+        ++m_misses;
+    }
+
+    const std::vector<std::string> lines = breakLines(text, metrics, scale, maxWidth);
+    std::string wrapped;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) {
+            wrapped += '\n';
+        }
+        wrapped += lines[i];
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_index.find(key) == m_index.end()) {
+        m_entries.push_front({std::move(key), wrapped});
+        m_index.emplace(m_entries.front().key, m_entries.begin());
+        if (m_entries.size() > m_capacity) {
+            m_index.erase(m_entries.back().key);
+            m_entries.pop_back();
+        }
+    }
+    return wrapped;
+}
+
+size_t LineBreaker::cacheHits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+size_t LineBreaker::cacheMisses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void LineBreaker::clearCache()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+}
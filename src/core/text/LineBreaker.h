@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "core/text/FontMetrics.h"
+
+// Width-aware line breaking shared by the title and lyric overlays.
+// Breaks only at spaces and chooses the break points that minimize the sum
+// of squared leftover widths over all lines (Knuth-Plass style dynamic
+// programming without hyphenation). The last line is penalized like the
+// others, which gives the balanced blocks that suit centred text. Existing
+// '\n' are kept as forced breaks; a word wider than the limit gets a line
+// of its own.
+//
+// Results are cached by (text, font fingerprint, scale, width), so calling
+// wrap() every frame with unchanged input costs one hash lookup.
+class LineBreaker
+{
+public:
+    explicit LineBreaker(size_t cacheCapacity = 256);
+
+    std::string wrap(std::string_view text, const FontMetrics& metrics, float scale, float maxWidth);
+    // Uncached; returns the lines without their separators.
+    static std::vector<std::string> breakLines(std::string_view text, const FontMetrics& metrics,
+                                               float scale, float maxWidth);
+
+    size_t cacheHits() const;
+    size_t cacheMisses() const;
+    void clearCache();
+
+private:
+    struct Entry {
+        std::string key;
+        std::string wrapped;
+    };
+
+    size_t m_capacity;
+    mutable std::mutex m_mutex;
+    // Most recently used first.
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
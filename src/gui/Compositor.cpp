@@ -0,0 +1,203 @@
+#include "Compositor.h"
+#include "core/Logger.h"
+#include <QOpenGLShaderProgram>
+#include <QVector2D>
+#include <algorithm>
+
+void Compositor::initialize(QOpenGLFunctions_3_3_Core* gl)
+{
+    m_program = new QOpenGLShaderProgram();
+    m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/composite.vert");
+    m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/composite.frag");
+    if (!m_program->link()) {
+        logError(LogCategory::Render, "Failed to link compositor shader: " + m_program->log().toStdString());
+    }
+    m_upscaleProgram = new QOpenGLShaderProgram();
+    m_upscaleProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/shaders/composite.vert");
+    m_upscaleProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/shaders/upscale.frag");
+    if (!m_upscaleProgram->link()) {
+        logError(LogCategory::Render, "Failed to link upscale shader: " + m_upscaleProgram->log().toStdString());
+    }
+
+    const float quad[] = {
+        -1.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+         1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
+        -1.0f,  1.0f, 0.0f,  0.0f, 1.0f,
+         1.0f,  1.0f, 0.0f,  1.0f, 1.0f,
+    };
+    gl->glGenVertexArrays(1, &m_vao);
+    gl->glGenBuffers(1, &m_vbo);
+    gl->glBindVertexArray(m_vao);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    gl->glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    gl->glEnableVertexAttribArray(0);
+    gl->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), nullptr);
+    gl->glEnableVertexAttribArray(1);
+    gl->glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gl->glBindVertexArray(0);
+}
+
+void Compositor::cleanup(QOpenGLFunctions_3_3_Core* gl)
+{
+    for (Layer& layer : m_layers) {
+        release(gl, layer);
+    }
+    gl->glDeleteVertexArrays(1, &m_vao);
+    gl->glDeleteBuffers(1, &m_vbo);
+    delete m_program;
+    delete m_upscaleProgram;
+    m_program = nullptr;
+    m_upscaleProgram = nullptr;
+}
+
+int Compositor::addLayer(const std::string& name, LayerKind kind, bool dynamic, float scale, DrawFunction draw)
+{
+    Layer layer;
+    layer.name = name;
+    layer.kind = kind;
+    layer.dynamic = dynamic;
+    layer.scale = std::min(1.0f, std::max(0.1f, scale));
+    layer.draw = std::move(draw);
+    m_layers.push_back(layer);
+    m_needsAllocation = true;
+    return static_cast<int>(m_layers.size()) - 1;
+}
+
+void Compositor::setLayerScale(int layer, float scale)
+{
+    scale = std::min(1.0f, std::max(0.1f, scale));
+    if (m_layers[layer].scale != scale) {
+        m_layers[layer].scale = scale;
+        m_needsAllocation = true;
+    }
+}
+
+void Compositor::setLayerVisible(int layer, bool visible)
+{
+    m_layers[layer].visible = visible;
+}
+
+void Compositor::setLayerDynamic(int layer, bool dynamic)
+{
+    m_layers[layer].dynamic = dynamic;
+}
+
+void Compositor::setLayerSharpness(int layer, float sharpness)
+{
+    m_layers[layer].sharpness = std::max(0.0f, sharpness);
+}
+
+void Compositor::markDirty(int layer)
+{
+    m_layers[layer].dirty = true;
+}
+
+void Compositor::resize(QOpenGLFunctions_3_3_Core* gl, int width, int height)
+{
+    if (width == m_width && height == m_height && !m_needsAllocation) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    m_needsAllocation = false;
+    for (Layer& layer : m_layers) {
+        allocate(gl, layer);
+    }
+}
+
+void Compositor::allocate(QOpenGLFunctions_3_3_Core* gl, Layer& layer)
+{
+    const int width = std::max(1, static_cast<int>(m_width * layer.scale));
+    const int height = std::max(1, static_cast<int>(m_height * layer.scale));
+    if (layer.fbo && width == layer.width && height == layer.height) {
+        return;
+    }
+    release(gl, layer);
+    layer.width = width;
+    layer.height = height;
+
+    gl->glGenTextures(1, &layer.texture);
+    gl->glBindTexture(GL_TEXTURE_2D, layer.texture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+    gl->glGenFramebuffers(1, &layer.fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+    if (gl->glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        logError(LogCategory::Render, "Incomplete framebuffer for compositor layer: " + layer.name);
+    }
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    layer.dirty = true;
+}
+
+void Compositor::release(QOpenGLFunctions_3_3_Core* gl, Layer& layer)
+{
+    if (layer.fbo) {
+        gl->glDeleteFramebuffers(1, &layer.fbo);
+        gl->glDeleteTextures(1, &layer.texture);
+        layer.fbo = 0;
+        layer.texture = 0;
+    }
+}
+
+void Compositor::render(QOpenGLFunctions_3_3_Core* gl, GLuint targetFbo)
+{
+    if (m_needsAllocation) {
+        resize(gl, m_width, m_height);
+    }
+
+    for (Layer& layer : m_layers) {
+        if (!layer.visible || !(layer.dirty || layer.dynamic)) {
+            continue;
+        }
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+        gl->glViewport(0, 0, layer.width, layer.height);
+        if (layer.kind == LayerKind::Overlay) {
+            // Overlays accumulate premultiplied alpha so they stack with GL_ONE blending.
+            gl->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            gl->glClear(GL_COLOR_BUFFER_BIT);
+            gl->glEnable(GL_BLEND);
+            gl->glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        layer.draw(layer.fbo, layer.width, layer.height);
+        layer.dirty = false;
+    }
+
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+    gl->glViewport(0, 0, m_width, m_height);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindVertexArray(m_vao);
+    for (const Layer& layer : m_layers) {
+        if (!layer.visible) {
+            continue;
+        }
+        QOpenGLShaderProgram* program = m_program;
+        if (layer.scale < 1.0f && layer.sharpness > 0.0f) {
+            program = m_upscaleProgram;
+            program->bind();
+            program->setUniformValue("texelSize", QVector2D(1.0f / layer.width, 1.0f / layer.height));
+            program->setUniformValue("sharpness", layer.sharpness);
+        } else {
+            program->bind();
+        }
+        program->setUniformValue("screenTexture", 0);
+        if (layer.kind == LayerKind::Overlay) {
+            gl->glEnable(GL_BLEND);
+            gl->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            gl->glDisable(GL_BLEND);
+        }
+        gl->glBindTexture(GL_TEXTURE_2D, layer.texture);
+        gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        program->release();
+    }
+    gl->glBindVertexArray(0);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+    gl->glDisable(GL_BLEND);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <functional>
+#include <string>
+#include <vector>
+
+class QOpenGLShaderProgram;
+
+// Renders each layer into its own texture at its own resolution and stacks
+// them onto the target framebuffer. Layers are only redrawn when dirty;
+// dynamic layers are treated as dirty every frame.
+class Compositor
+{
+public:
+    using DrawFunction = std::function<void(GLuint fbo, int width, int height)>;
+
+    enum class LayerKind {
+        Opaque,
+        Overlay
+    };
+
+    void initialize(QOpenGLFunctions_3_3_Core* gl);
+    void cleanup(QOpenGLFunctions_3_3_Core* gl);
+
+    int addLayer(const std::string& name, LayerKind kind, bool dynamic, float scale, DrawFunction draw);
+    void setLayerScale(int layer, float scale);
+    void setLayerVisible(int layer, bool visible);
+    void setLayerDynamic(int layer, bool dynamic);
+    // Unsharp-mask strength applied when a downscaled layer is upscaled.
+    void setLayerSharpness(int layer, float sharpness);
+    void markDirty(int layer);
+
+    int layerWidth(int layer) const { return m_layers[layer].width; }
+    int layerHeight(int layer) const { return m_layers[layer].height; }
+    float layerScale(int layer) const { return m_layers[layer].scale; }
+
+    void resize(QOpenGLFunctions_3_3_Core* gl, int width, int height);
+    void render(QOpenGLFunctions_3_3_Core* gl, GLuint targetFbo);
+
+private:
+    struct Layer {
+        std::string name;
+        LayerKind kind = LayerKind::Opaque;
+        bool dynamic = false;
+        bool dirty = true;
+        bool visible = true;
+        float scale = 1.0f;
+        float sharpness = 0.0f;
+        int width = 0;
+        int height = 0;
+        GLuint fbo = 0;
+        GLuint texture = 0;
+        DrawFunction draw;
+    };
+
+    void allocate(QOpenGLFunctions_3_3_Core* gl, Layer& layer);
+    void release(QOpenGLFunctions_3_3_Core* gl, Layer& layer);
+
+    std::vector<Layer> m_layers;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_needsAllocation = false;
+
+    QOpenGLShaderProgram* m_program = nullptr;
+    QOpenGLShaderProgram* m_upscaleProgram = nullptr;
+    GLuint m_vao = 0;
+    GLuint m_vbo = 0;
+};
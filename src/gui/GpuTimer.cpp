@@ -0,0 +1,59 @@
+#include "GpuTimer.h"
+
+void GpuTimer::initialize(QOpenGLFunctions_3_3_Core* gl)
+{
+    gl->glGenQueries(QUERY_COUNT, m_beginQueries);
+    gl->glGenQueries(QUERY_COUNT, m_endQueries);
+    m_writeIndex = 0;
+    m_pending = 0;
+    m_initialized = true;
+}
+
+void GpuTimer::cleanup(QOpenGLFunctions_3_3_Core* gl)
+{
+    if (m_initialized) {
+        gl->glDeleteQueries(QUERY_COUNT, m_beginQueries);
+        gl->glDeleteQueries(QUERY_COUNT, m_endQueries);
+        m_initialized = false;
+    }
+}
+
+void GpuTimer::begin(QOpenGLFunctions_3_3_Core* gl)
+{
+    // With every slot still in flight this frame simply goes unmeasured.
+    m_running = m_initialized && m_pending < QUERY_COUNT;
+    if (m_running) {
+        gl->glQueryCounter(m_beginQueries[m_writeIndex], GL_TIMESTAMP);
+    }
+}
+
+void GpuTimer::end(QOpenGLFunctions_3_3_Core* gl)
+{
+    if (!m_running) {
+        return;
+    }
+    gl->glQueryCounter(m_endQueries[m_writeIndex], GL_TIMESTAMP);
+    m_writeIndex = (m_writeIndex + 1) % QUERY_COUNT;
+    ++m_pending;
+    m_running = false;
+}
+
+bool GpuTimer::poll(QOpenGLFunctions_3_3_Core* gl, float& milliseconds)
+{
+    bool found = false;
+    while (m_initialized && m_pending > 0) {
+        const int slot = (m_writeIndex - m_pending + QUERY_COUNT) % QUERY_COUNT;
+        GLint available = 0;
+        gl->glGetQueryObjectiv(m_endQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 beginNs = 0, endNs = 0;
+        gl->glGetQueryObjectui64v(m_beginQueries[slot], GL_QUERY_RESULT, &beginNs);
+        gl->glGetQueryObjectui64v(m_endQueries[slot], GL_QUERY_RESULT, &endNs);
+        milliseconds = static_cast<float>((endNs - beginNs) / 1.0e6);
+        --m_pending;
+        found = true;
+    }
+    return found;
+}
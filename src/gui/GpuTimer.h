@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+
+// Non-blocking GPU timing from a pair of GL_TIMESTAMP queries. Query pairs
+// are kept in a small ring and read back a few frames later, so timing never
+// stalls the pipeline. Timestamps (unlike GL_TIME_ELAPSED) may be nested, so
+// a whole-frame timer can wrap the per-pass timers.
+class GpuTimer
+{
+public:
+    void initialize(QOpenGLFunctions_3_3_Core* gl);
+    void cleanup(QOpenGLFunctions_3_3_Core* gl);
+
+    void begin(QOpenGLFunctions_3_3_Core* gl);
+    void end(QOpenGLFunctions_3_3_Core* gl);
+
+    // Collects finished queries; returns true and the newest result if any completed.
+    bool poll(QOpenGLFunctions_3_3_Core* gl, float& milliseconds);
+
+private:
+    static const int QUERY_COUNT = 4;
+    GLuint m_beginQueries[QUERY_COUNT] = {0, 0, 0, 0};
+    GLuint m_endQueries[QUERY_COUNT] = {0, 0, 0, 0};
+    int m_writeIndex = 0;
+    int m_pending = 0;
+    bool m_initialized = false;
+    bool m_running = false;
+};
@@ -1,3 +1,85 @@
+#include "MainWindow.h"
+#include "Renderer.h"
+#include "PresetBrowser.h"
+#include "QtHttpTransport.h"
+#include "SttWorker.h"
+#include "TrackOverviewView.h"
+#include "core/Config.h"
+#include "core/Logger.h"
+#include "core/audio/AudioEngine.h"
+#include "core/audio/ChunkStream.h"
+#include "core/audio/LoudnessMeter.h"
+#include "core/audio/TrackOverview.h"
+#include "core/lyrics/LyricAligner.h"
+#include "core/lyrics/LyricImport.h"
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
+#include <QStatusBar>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    const int DOWNLOAD_POLL_MS = 250;
+    // Enough MP3 for the decoder to lock on and a few seconds of buffer.
+    const uint64_t PREVIEW_START_BYTES = 256 * 1024;
+
+    // Moves a still running task into `retired`, leaving `future` empty.
+    template <typename T>
+    void retire(std::vector<std::function<bool()>>& retired, std::future<T>& future)
+    {
+        if (!future.valid()) {
+            return;
+        }
+        auto parked = std::make_shared<std::future<T>>(std::move(future));
+        retired.push_back([parked]() { return parked->wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+    }
+}
+
+void MainWindow::openAudioFile()
+{
+    const QString filePath = QFileDialog::getOpenFileName(this, "Open Audio", QString(),
+                                                          "Audio (*.mp3 *.wav *.flac *.ogg);;All Files (*)");
+    if (!filePath.isEmpty()) {
+        playFile(filePath);
+    }
+}
+
+void MainWindow::playNextInQueue()
+{
+    if (m_songQueueList->count() == 0) {
+        return;
+    }
+    std::unique_ptr<QListWidgetItem> item(m_songQueueList->takeItem(0));
+    playFile(item->text());
+}
+
+void MainWindow::playFile(const QString& audioPath)
+{
+    if (!m_renderer) {
+        return;
+    }
+    AudioEngine* audio = m_renderer->getAudioEngine();
+    const std::string path = audioPath.toStdString();
+    // An audition still waiting for its download would take over the engine.
+    m_previewStream.reset();
+    if (!audio->loadFile(path)) {
+        logError(LogCategory::Audio, "Failed to load " + path);
+        return;
+    }
+    audio->play();
+    m_isPlaying = true;
+    m_renderer->setSongTitle(QFileInfo(audioPath).completeBaseName().toStdString());
+
+    // With decode_to_memory playback has decoded the song already; otherwise
+    // it streams, and one decode in the background serves every analysis.
+    m_songTrack = audio->track();
+    if (!m_songTrack) {
+        m_songTrack = DecodedTrack::decode(path, DecodedTrack::Options());
+    }
+    m_renderer->analyzeTrack(path, m_songTrack);
+    transcribeLyrics(audioPath);
+}
 
 void MainWindow::nextPreset()
 {
@@ -12,3 +94,430 @@ void MainWindow::prevPreset()
         m_renderer->selectPreviousPreset();
     }
 }
+
+void MainWindow::setupPresetBrowserDock()
+{
+    Config config;
+    m_presetBrowser = new PresetBrowser(config.presetAtlasDirectory(), this);
+    connect(m_presetBrowser, &PresetBrowser::presetActivated, this, &MainWindow::activatePreset);
+
+    m_presetBrowserDock = new QDockWidget("Preset Browser", this);
+    m_presetBrowserDock->setWidget(m_presetBrowser);
+    m_presetBrowserDock->setVisible(m_presetBrowser->hasAtlas());
+    addDockWidget(Qt::BottomDockWidgetArea, m_presetBrowserDock);
+}
+
+void MainWindow::activatePreset(const QString& presetPath)
+{
+    if (m_renderer) {
+        m_renderer->selectPresetByPath(presetPath.toStdString());
+    }
+}
+
+void MainWindow::advanceLyrics()
+{
+    m_retiredTasks.erase(std::remove_if(m_retiredTasks.begin(), m_retiredTasks.end(),
+                                        [](const std::function<bool()>& done) { return done(); }),
+                         m_retiredTasks.end());
+    if (!m_renderer) {
+        return;
+    }
+    pollLyricCache();
+    pollLyricAlignment();
+    pollTrackOverview();
+    // A recording needs identical frames for identical input, whichever way
+    // it was started or stopped.
+    m_renderer->setDeterministicMode(m_isRecording);
+    if (m_lyricTimeline.size() != m_lyrics.size()) {
+        m_lyricTimeline.build(m_lyrics);
+        m_lyricCursor.reset(&m_lyricTimeline);
+        m_currentLyricIndex = -1;
+    }
+    // Looked up from the playback position, so seeks, pauses and late timer
+    // ticks all land on the right line.
+    const float position = m_renderer->getAudioEngine()->getCurrentPosition();
+    if (m_overviewView) {
+        m_overviewView->setPosition(position);
+    }
+    const int index = m_lyricCursor.seek(position);
+    if (index != m_currentLyricIndex) {
+        m_currentLyricIndex = index;
+        displayLyrics();
+    }
+}
+
+void MainWindow::displayLyrics()
+{
+    if (!m_renderer) {
+        return;
+    }
+    if (m_currentLyricIndex >= 0 && m_currentLyricIndex < static_cast<int>(m_lyricTimeline.size())) {
+        m_renderer->setLyricLine(m_lyricTimeline.line(m_currentLyricIndex));
+    } else {
+        m_renderer->clearLyrics();
+    }
+}
+
+void MainWindow::setLyricLines(std::vector<LyricLine> lines)
+{
+    m_lyrics = std::move(lines);
+    m_lyricTimeline.build(m_lyrics);
+    m_lyricCursor.reset(&m_lyricTimeline);
+    m_currentLyricIndex = -1;
+    displayLyrics();
+}
+
+void MainWindow::loadLyrics(const std::string& jsonLyricsContent)
+{
+    std::vector<LyricLine> lines;
+    if (!LyricImport::parseJson(jsonLyricsContent, lines)) {
+        logWarning(LogCategory::Text, "No lyrics found in STT output");
+    }
+    setLyricLines(std::move(lines));
+}
+
+void MainWindow::openLyricsFile()
+{
+    const QString filePath = QFileDialog::getOpenFileName(this, "Open Lyrics", QString(),
+                                                          "Lyrics (*.lrc *.srt *.vtt *.json *.txt);;All Files (*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    std::vector<LyricLine> lines;
+    std::string untimedText;
+    if (!LyricImport::loadFile(filePath.toStdString(), lines, &untimedText)) {
+        if (!untimedText.empty()) {
+            // Time it against the current song.
+            alignLyrics(untimedText);
+        }
+        return;
+    }
+    stopTranscription();
+    // These lines win over an alignment still running.
+    retire(m_retiredTasks, m_alignFuture);
+    setLyricLines(std::move(lines));
+}
+
+void MainWindow::stopTranscription()
+{
+    if (m_sttJob != 0) {
+        sttWorker()->cancel(m_sttJob);
+        m_sttJob = 0;
+    }
+    // A cache lookup still in flight sees this and neither loads a
+    // transcript nor starts the worker.
+    m_lyricsFromFile = true;
+}
+
+void MainWindow::alignLyrics(const std::string& text)
+{
+    if (m_sttAudioPath.isEmpty()) {
+        logWarning(LogCategory::Text, "Play a song before opening plain-text lyrics");
+        return;
+    }
+    stopTranscription();
+    setLyricLines({});
+
+    // Decoding and warping a whole song takes a moment; the result is cached
+    // like a transcript, keyed by the text as well as the audio.
+    Config config;
+    retire(m_retiredTasks, m_alignFuture);
+    m_alignAudioPath = m_sttAudioPath;
+    m_alignFuture = std::async(std::launch::async, [path = m_sttAudioPath.toStdString(), track = m_songTrack, text,
+                                                    directory = config.sttCacheDirectory().toStdString(),
+                                                    maxBytes = static_cast<uint64_t>(std::max(0, config.sttCacheSizeMb())) << 20]() {
+        std::vector<LyricLine> lines;
+        AudioEngine::withWholeTrack(path, track, [&](const short* pcm, size_t frames, int sampleRate) {
+            LyricCache cache(directory, maxBytes);
+            const std::string key = LyricCache::key(LyricCache::audioDigest(pcm, frames * 2, sampleRate),
+                                                    "lyric-align v1\n" + text);
+            if (cache.load(key, lines)) {
+                return;
+            }
+            lines = LyricAligner::align(text, pcm, frames, sampleRate, LyricAligner::Options());
+            cache.store(key, lines);
+        });
+        return lines;
+    });
+}
+
+void MainWindow::pollLyricAlignment()
+{
+    if (!m_alignFuture.valid() || m_alignFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    std::vector<LyricLine> lines = m_alignFuture.get();
+    if (m_alignAudioPath != m_sttAudioPath) {
+        return;
+    }
+    if (lines.empty()) {
+        logWarning(LogCategory::Text, "Could not align lyrics to " + m_sttAudioPath.toStdString());
+        return;
+    }
+    logInfo(LogCategory::Text, "Lyrics aligned: " + std::to_string(lines.size()) + " lines");
+    setLyricLines(std::move(lines));
+}
+
+void MainWindow::loadTrackOverview(const QString& audioPath)
+{
+    if (!m_overviewView) {
+        m_overviewView = new TrackOverviewView(this);
+        connect(m_overviewView, &TrackOverviewView::seekRequested, this, [this](double seconds) {
+            if (m_renderer) {
+                m_renderer->getAudioEngine()->seek(static_cast<float>(seconds));
+            }
+        });
+        m_overviewDock = new QDockWidget("Timeline", this);
+        m_overviewDock->setWidget(m_overviewView);
+        addDockWidget(Qt::BottomDockWidgetArea, m_overviewDock);
+    }
+    m_overviewView->setOverview(nullptr);
+    // Unity until the new song is measured.
+    if (m_renderer) {
+        m_renderer->getAudioEngine()->setLoudnessGain(0.0f, 0.0f);
+    }
+
+    if (m_overviewCancel) {
+        *m_overviewCancel = true;
+    }
+    m_overviewCancel = std::make_shared<std::atomic<bool>>(false);
+    Config config;
+    m_overviewFuture = std::async(std::launch::async, [path = audioPath.toStdString(), track = m_songTrack,
+                                                       cancel = m_overviewCancel,
+                                                       directory = config.timelineCacheDirectory().toStdString(),
+                                                       maxBytes = static_cast<uint64_t>(std::max(0, config.timelineCacheSizeMb())) << 20]() {
+        auto overview = std::make_shared<TrackOverview>();
+        if (TrackOverview::loadCached(directory, path, *overview)) {
+            return std::shared_ptr<const TrackOverview>(overview);
+        }
+        // The shared decode when there is one, else a streaming pass over the file.
+        bool built = false;
+        if (track) {
+            AudioEngine::withWholeTrack(path, track, [&](const short* pcm, size_t frames, int sampleRate) {
+                built = TrackOverview::build(pcm, frames, sampleRate, *overview, cancel.get());
+            });
+        } else {
+            built = TrackOverview::build(path, *overview, cancel.get());
+        }
+        if (!built) {
+            return std::shared_ptr<const TrackOverview>();
+        }
+        TrackOverview::storeCached(directory, path, *overview, maxBytes);
+        return std::shared_ptr<const TrackOverview>(overview);
+    });
+}
+
+void MainWindow::pollTrackOverview()
+{
+    if (!m_overviewFuture.valid() || m_overviewFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    std::shared_ptr<const TrackOverview> overview = m_overviewFuture.get();
+    m_overviewView->setOverview(overview);
+    if (!overview || !m_renderer) {
+        return;
+    }
+
+    // The overview pass measured the song, so its gain ramps in now, well
+    // before the first chorus on a cache hit.
+    Config config;
+    const double loudness = overview->loudness();
+    const double playbackDb = config.audioNormalizePlayback()
+        ? LoudnessMeter::normalizationGainDb(loudness, config.audioLoudnessTarget(), overview->peak(), config.audioMaxGainDb())
+        : 0.0;
+    // projectM only reads the visualization copy, so clipping there is harmless.
+    const double visualizationDb = config.audioNormalizeVisualization()
+        ? LoudnessMeter::normalizationGainDb(loudness, config.audioLoudnessTarget(), 0.0, config.audioMaxGainDb())
+        : 0.0;
+    m_renderer->getAudioEngine()->setLoudnessGain(static_cast<float>(playbackDb), static_cast<float>(visualizationDb));
+    logInfo(LogCategory::Audio, "Track loudness " + QString::number(loudness, 'f', 1).toStdString() + " LUFS, gain " +
+                                    QString::number(playbackDb, 'f', 1).toStdString() + " dB playback, " +
+                                    QString::number(visualizationDb, 'f', 1).toStdString() + " dB visualization");
+}
+
+SttWorker* MainWindow::sttWorker()
+{
+    if (!m_sttWorker) {
+        m_sttWorker = new SttWorker(Config().sttWorkerCommand(), this);
+        connect(m_sttWorker, &SttWorker::ready, this, &MainWindow::onSttReady);
+        connect(m_sttWorker, &SttWorker::segmentsReady, this, &MainWindow::onSttSegments);
+        connect(m_sttWorker, &SttWorker::finished, this, &MainWindow::onSttFinished);
+        connect(m_sttWorker, &SttWorker::failed, this, &MainWindow::onSttFailed);
+    }
+    return m_sttWorker;
+}
+
+void MainWindow::transcribeLyrics(const QString& audioPath)
+{
+    if (m_sttJob != 0) {
+        sttWorker()->cancel(m_sttJob);
+        m_sttJob = 0;
+    }
+    m_lyricsFromFile = false;
+    setLyricLines({});
+    // Every new song passes through here.
+    loadTrackOverview(audioPath);
+    if (!m_lyricCache) {
+        Config config;
+        m_lyricCache = std::make_unique<LyricCache>(config.sttCacheDirectory().toStdString(),
+                                                    static_cast<uint64_t>(std::max(0, config.sttCacheSizeMb())) << 20);
+    }
+
+    // The cache is keyed by the decoded audio, so the track is decoded and
+    // hashed off the GUI thread; pollLyricCache() picks the result up.
+    m_sttAudioPath = audioPath;
+    m_sttDigest.clear();
+    retire(m_retiredTasks, m_sttDigestFuture);
+    // Lyrics aligned to the previous song do not fit this one.
+    retire(m_retiredTasks, m_alignFuture);
+    m_sttDigestFuture = std::async(std::launch::async, [path = audioPath.toStdString(), track = m_songTrack]() {
+        std::string digest;
+        AudioEngine::withWholeTrack(path, track, [&digest](const short* pcm, size_t frames, int sampleRate) {
+            digest = LyricCache::audioDigest(pcm, frames * 2, sampleRate);
+        });
+        return digest;
+    });
+}
+
+void MainWindow::pollLyricCache()
+{
+    if (!m_sttDigestFuture.valid() ||
+        m_sttDigestFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    m_sttDigest = m_sttDigestFuture.get();
+    if (m_lyricsFromFile) {
+        return;
+    }
+
+    // Before this session's worker has reported its engine, the one the
+    // previous worker reported is the best guess; a wrong guess only misses.
+    const std::string engine = m_sttWorker && m_sttWorker->isReady() ? m_sttWorker->engine() : m_lyricCache->lastEngine();
+    std::vector<LyricLine> lines;
+    if (!m_sttDigest.empty() && !engine.empty() && m_lyricCache->load(LyricCache::key(m_sttDigest, engine), lines)) {
+        logInfo(LogCategory::Text, "Lyrics loaded from cache: " + std::to_string(lines.size()) + " lines");
+        setLyricLines(std::move(lines));
+        return;
+    }
+    m_sttJob = sttWorker()->transcribe(m_sttAudioPath);
+}
+
+void MainWindow::onSttReady(const QString& engine)
+{
+    m_lyricCache->setLastEngine(engine.toStdString());
+}
+
+void MainWindow::onSttSegments(quint64 job, const std::vector<LyricLine>& lines)
+{
+    if (job != m_sttJob) {
+        return;
+    }
+    // Segments mostly arrive in time order and are appended in place; the
+    // cursor only needs a reset when one lands before an existing line.
+    m_lyrics.insert(m_lyrics.end(), lines.begin(), lines.end());
+    if (!m_lyricTimeline.append(lines)) {
+        m_lyricCursor.reset(&m_lyricTimeline);
+        m_currentLyricIndex = -1;
+    }
+    advanceLyrics();
+}
+
+void MainWindow::onSttFinished(quint64 job)
+{
+    if (job == m_sttJob) {
+        logInfo(LogCategory::Text, "Lyrics transcribed: " + std::to_string(m_lyricTimeline.size()) + " lines");
+        if (!m_sttDigest.empty()) {
+            m_lyricCache->store(LyricCache::key(m_sttDigest, m_sttWorker->engine()), m_lyrics);
+        }
+        m_sttJob = 0;
+    }
+}
+
+void MainWindow::onSttFailed(quint64 job, const QString& message)
+{
+    if (job == m_sttJob || job == 0) {
+        logWarning(LogCategory::Text, "Lyrics transcription failed: " + message.toStdString());
+        m_sttJob = 0;
+    }
+}
+
+void MainWindow::downloadFromSuno()
+{
+    bool ok = false;
+    const QString text = QInputDialog::getMultiLineText(this, "Download from Suno",
+                                                        "Song links or ids, one per line:", QString(), &ok);
+    if (!ok) {
+        return;
+    }
+    if (!m_downloads) {
+        Config config;
+        DownloadManager::Options options;
+        options.directory = config.sunoDownloadDirectory().toStdString();
+        options.urlTemplate = config.sunoAudioUrl().toStdString();
+        options.maxConcurrent = config.sunoMaxDownloads();
+        m_httpTransport = std::make_unique<QtHttpTransport>();
+        m_downloads = std::make_unique<DownloadManager>(*m_httpTransport, options);
+        connect(&m_downloadTimer, &QTimer::timeout, this, &MainWindow::pollDownloads);
+    }
+
+    std::vector<std::string> ids;
+    for (const QString& line : text.split('\n', Qt::SkipEmptyParts)) {
+        const std::string id = DownloadManager::songId(line.toStdString());
+        if (id.empty()) {
+            logWarning(LogCategory::General, "Not a Suno song link or id: " + line.trimmed().toStdString());
+            continue;
+        }
+        ids.push_back(id);
+    }
+    // One song is an audition: start playing it as soon as enough arrives.
+    m_previewStream = ids.size() == 1 ? std::make_shared<ChunkStream>() : nullptr;
+    for (const std::string& id : ids) {
+        m_downloads->enqueue(id, std::string(), m_previewStream);
+    }
+    if (m_downloads->pendingJobs() > 0) {
+        m_downloadTimer.start(DOWNLOAD_POLL_MS);
+    }
+}
+
+void MainWindow::pollDownloads()
+{
+    // Checked before taking events so the last job's result is never left behind.
+    const size_t pending = m_downloads->pendingJobs();
+    if (m_previewStream && m_renderer &&
+        (m_previewStream->size() >= PREVIEW_START_BYTES || m_previewStream->isFinished())) {
+        AudioEngine* audio = m_renderer->getAudioEngine();
+        if (audio->loadStream(m_previewStream)) {
+            audio->play();
+            m_isPlaying = true;
+        }
+        m_previewStream.reset();
+    } else if (m_previewStream && m_previewStream->hasFailed()) {
+        m_previewStream.reset();
+    }
+    for (const DownloadManager::Event& event : m_downloads->takeEvents()) {
+        switch (event.type) {
+        case DownloadManager::Event::Type::Progress:
+            if (event.totalBytes > 0) {
+                statusBar()->showMessage(QString("Downloading %1: %2%").arg(QString::fromStdString(event.songId))
+                                             .arg(event.bytes * 100 / event.totalBytes), DOWNLOAD_POLL_MS * 4);
+            }
+            break;
+        case DownloadManager::Event::Type::Finished:
+            m_songQueueList->addItem(QString::fromStdString(event.path));
+            break;
+        case DownloadManager::Event::Type::Failed:
+            logWarning(LogCategory::General, "Suno download of " + event.songId + " failed: " + event.message);
+            break;
+        }
+    }
+    if (pending == 0) {
+        m_downloadTimer.stop();
+        statusBar()->showMessage("Downloads finished", DOWNLOAD_POLL_MS * 8);
+    }
+    // A preview whose download broke off would otherwise play silence forever.
+    if (m_renderer && m_renderer->getAudioEngine()->streamFailed()) {
+        m_renderer->getAudioEngine()->closeFile();
+        m_isPlaying = false;
+        statusBar()->showMessage("Playback stopped: the download failed", DOWNLOAD_POLL_MS * 8);
+    }
+}
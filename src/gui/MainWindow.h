@@ -6,8 +6,21 @@
 #include <QProcess>
 #include <QLabel>
 #include <QTimer>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include "core/download/DownloadManager.h"
+#include "core/lyrics/LyricCache.h"
+#include "core/lyrics/LyricTimeline.h"
 
 class Renderer;
+class PresetBrowser;
+class SttWorker;
+class ChunkStream;
+class DecodedTrack;
+class TrackOverview;
+class TrackOverviewView;
 
 class MainWindow : public QMainWindow
 {
@@ -41,10 +54,20 @@ private slots:
     void checkSongFinished();
     void nextPreset();
     void prevPreset();
+    void activatePreset(const QString& presetPath);
+    void onSttReady(const QString& engine);
+    void onSttSegments(quint64 job, const std::vector<LyricLine>& lines);
+    void onSttFinished(quint64 job);
+    void onSttFailed(quint64 job, const QString& message);
+    void pollDownloads();
 
 private:
     void setupUi();
     void setupQueueDock();
+    void setupPresetBrowserDock();
+    // Every song starts here: playback, the title, section analysis, the
+    // timeline and the lyrics all begin from this one call.
+    void playFile(const QString& audioPath);
 
     Renderer* m_renderer;
     QWindow* m_renderWindow;
@@ -52,6 +75,9 @@ private:
     QListWidget* m_songQueueList;
     QDockWidget* m_songQueueDock;
 
+    PresetBrowser* m_presetBrowser;
+    QDockWidget* m_presetBrowserDock;
+
     QProcess* m_ffmpegProcess;
     bool m_isRecording;
     QLabel* m_recordingIndicator;
@@ -61,21 +87,62 @@ private:
     QAction* m_stopRecordingAction;
 
     bool m_isPlaying;
-
-    struct LyricLine {
-        std::string text;
-        double startTime;
-        double endTime;
-    };
+    // The current song decoded once, by playback or for the analyses alone,
+    // which all read it instead of decoding the file again. Null when its
+    // length is unknown up front; each analysis then decodes for itself.
+    std::shared_ptr<DecodedTrack> m_songTrack;
 
     std::vector<LyricLine> m_lyrics;
+    // m_lyrics indexed by time; rebuilt when m_lyrics changes size.
+    // m_currentLyricIndex refers to the timeline's order.
+    LyricTimeline m_lyricTimeline;
+    LyricTimeline::Cursor m_lyricCursor;
     int m_currentLyricIndex;
     QTimer m_lyricsTimer;
     QTimer m_songEndTimer;
-    QProcess* m_sttProcess;
+    // Resident worker shared by all songs; m_sttJob is the current song's job.
+    SttWorker* m_sttWorker = nullptr;
+    quint64 m_sttJob = 0;
+    // Transcripts keyed by decoded audio; the digest of the current song is
+    // computed in the background before the worker is asked for anything.
+    std::unique_ptr<LyricCache> m_lyricCache;
+    std::future<std::string> m_sttDigestFuture;
+    // Destroying or assigning over a std::async future waits for its task,
+    // so superseded tasks are parked here until they finish; each entry
+    // reports whether its task is done.
+    std::vector<std::function<bool()>> m_retiredTasks;
+    std::string m_sttDigest;
+    QString m_sttAudioPath;
+    // Lyrics the user opened replace the transcript: timed files as they
+    // are, plain text aligned to the song.
+    bool m_lyricsFromFile = false;
+    std::future<std::vector<LyricLine>> m_alignFuture;
+    // The song m_alignFuture is timing the lyrics to.
+    QString m_alignAudioPath;
+    // Batch Suno downloads; finished songs are appended to the queue. The
+    // transport must outlive the manager's threads, so it is declared first.
+    std::unique_ptr<HttpTransport> m_httpTransport;
+    std::unique_ptr<DownloadManager> m_downloads;
+    QTimer m_downloadTimer;
+    // A single requested song is auditioned while it downloads.
+    std::shared_ptr<ChunkStream> m_previewStream;
+    // Waveform timeline of the current song, built or loaded from the disk
+    // cache in the background. A newer song cancels the build in flight.
+    TrackOverviewView* m_overviewView = nullptr;
+    QDockWidget* m_overviewDock = nullptr;
+    std::future<std::shared_ptr<const TrackOverview>> m_overviewFuture;
+    std::shared_ptr<std::atomic<bool>> m_overviewCancel;
 
     void loadLyrics(const std::string& jsonLyricsContent);
+    void setLyricLines(std::vector<LyricLine> lines);
     void displayLyrics();
-    void processSttOutput();
-    void onSttError(QProcess::ProcessError error);
+    void transcribeLyrics(const QString& audioPath);
+    // Cancels the transcript of the current song in favour of user lyrics.
+    void stopTranscription();
+    void pollLyricCache();
+    void alignLyrics(const std::string& text);
+    void pollLyricAlignment();
+    void loadTrackOverview(const QString& audioPath);
+    void pollTrackOverview();
+    SttWorker* sttWorker();
 };
@@ -0,0 +1,284 @@
+#include "PresetAtlasJob.h"
+#include "core/audio/AudioEngine.h"
+#include "core/presets/PresetFeatureTable.h"
+#include <libprojectM/projectM.hpp>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLVersionFunctionsFactory>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+    const char SHARD_MAGIC[4] = {'A', 'P', 'S', '1'};
+    const int PCM_CHUNK_FRAMES = 512;
+
+    void flipRows(std::vector<unsigned char>& rgba, int width, int height) {
+        const size_t stride = static_cast<size_t>(width) * 4;
+        for (int y = 0; y < height / 2; ++y) {
+            std::swap_ranges(rgba.begin() + y * stride, rgba.begin() + (y + 1) * stride,
+                             rgba.begin() + (height - 1 - y) * stride);
+        }
+    }
+}
+
+PresetAtlasJob::PresetAtlasJob(const Options& options)
+    : m_options(options)
+{
+}
+
+int PresetAtlasJob::run()
+{
+    if (!QDir().mkpath(QString::fromStdString(m_options.outputDir))) {
+        std::cerr << "Failed to create atlas directory: " << m_options.outputDir << std::endl;
+        return 1;
+    }
+    return m_options.shard >= 0 ? runWorker() : runCoordinator();
+}
+
+std::string PresetAtlasJob::shardPath(int shard) const
+{
+    return m_options.outputDir + "/shard-" + std::to_string(shard) + ".strips";
+}
+
+int PresetAtlasJob::runCoordinator()
+{
+    const int workers = std::max(1, m_options.workers);
+    std::vector<std::unique_ptr<QProcess>> processes;
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("QT_QPA_PLATFORM", "offscreen");
+
+    for (int shard = 0; shard < workers; ++shard) {
+        QStringList args;
+        args << "--build-preset-atlas" << QString::fromStdString(m_options.outputDir)
+             << "--atlas-clip" << QString::fromStdString(m_options.clipPath)
+             << "--atlas-seconds" << QString::number(m_options.secondsPerPreset)
+             << "--atlas-shard" << QString::number(shard)
+             << "--atlas-shard-count" << QString::number(workers);
+
+        auto process = std::make_unique<QProcess>();
+        process->setProcessEnvironment(env);
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), args);
+        processes.push_back(std::move(process));
+    }
+
+    bool ok = true;
+    for (int shard = 0; shard < workers; ++shard) {
+        QProcess* process = processes[shard].get();
+        process->waitForFinished(-1);
+        if (process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0) {
+            std::cerr << "Preset atlas worker " << shard << " failed." << std::endl;
+            ok = false;
+        }
+    }
+
+    if (!ok || !packShards()) {
+        return 1;
+    }
+    for (int shard = 0; shard < workers; ++shard) {
+        QFile::remove(QString::fromStdString(shardPath(shard)));
+    }
+    return 0;
+}
+
+int PresetAtlasJob::runWorker()
+{
+    std::vector<short> clip;
+    int sampleRate = 0;
+    if (!AudioEngine::decodeFile(m_options.clipPath, clip, sampleRate) || clip.empty()) {
+        std::cerr << "Preset atlas needs a reference clip." << std::endl;
+        return 1;
+    }
+    // projectM is fed whole chunks, so a clip shorter than one is looped up
+    // to that length.
+    for (size_t i = 0; clip.size() < static_cast<size_t>(PCM_CHUNK_FRAMES) * 2; ++i) {
+        const short sample = clip[i];
+        clip.push_back(sample);
+    }
+
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cerr << "Failed to create offscreen OpenGL context." << std::endl;
+        return 1;
+    }
+    auto* gl = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(&context);
+    if (!gl || !gl->initializeOpenGLFunctions()) {
+        std::cerr << "OpenGL 3.3 core is required for the preset atlas." << std::endl;
+        return 1;
+    }
+
+    const int width = m_options.renderWidth;
+    const int height = m_options.renderHeight;
+    GLuint fbo = 0, colorTexture = 0;
+    gl->glGenFramebuffers(1, &fbo);
+    gl->glGenTextures(1, &colorTexture);
+    gl->glBindTexture(GL_TEXTURE_2D, colorTexture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+
+    projectM::Settings settings;
+    settings.meshX = 32;
+    settings.meshY = 24;
+    settings.fps = m_options.fps;
+    settings.textureSize = 512;
+    settings.windowWidth = width;
+    settings.windowHeight = height;
+    settings.presetURL = m_options.presetDir;
+    settings.smoothPresetDuration = 0;
+    settings.presetDuration = 1000000;
+    settings.shuffleEnabled = false;
+    auto pm = std::make_unique<projectM>(settings);
+    pm->setPresetLock(true);
+
+    std::ofstream out(shardPath(m_options.shard), std::ios::binary);
+    out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+
+    const size_t clipFrames = clip.size() / 2;
+    const size_t framesPerVideoFrame = static_cast<size_t>(sampleRate / m_options.fps);
+    const int totalFrames = std::max(1, static_cast<int>(m_options.secondsPerPreset * m_options.fps));
+    const int captureEvery = std::max(1, totalFrames / m_layout.framesPerStrip);
+    // Start a third of the way in so intros don't dominate the previews.
+    const size_t clipStart = clipFrames / 3;
+
+    std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+    std::vector<unsigned char> strip(m_layout.stripBytes());
+    const unsigned int playlistSize = pm->getPlaylistSize();
+
+    for (unsigned int index = m_options.shard; index < playlistSize; index += m_options.shardCount) {
+        pm->selectPreset(index, true);
+        std::vector<std::vector<unsigned char>> captured;
+        size_t cursor = clipStart;
+
+        for (int f = 0; f < totalFrames && static_cast<int>(captured.size()) < m_layout.framesPerStrip; ++f) {
+            for (size_t fed = 0; fed < framesPerVideoFrame; fed += PCM_CHUNK_FRAMES) {
+                if (cursor + PCM_CHUNK_FRAMES > clipFrames) {
+                    cursor = 0;
+                }
+                pm->pcm()->addPCM16Data(&clip[cursor * 2], PCM_CHUNK_FRAMES);
+                cursor += PCM_CHUNK_FRAMES;
+            }
+
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            gl->glViewport(0, 0, width, height);
+            pm->renderFrame();
+
+            if ((f + 1) % captureEvery == 0) {
+                gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+                gl->glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, frame.data());
+                flipRows(frame, width, height);
+                captured.push_back(frame);
+            }
+        }
+
+        std::fill(strip.begin(), strip.end(), 0);
+        const int stripStride = m_layout.stripWidth() * 4;
+        for (size_t k = 0; k < captured.size(); ++k) {
+            PresetAtlas::downsample(captured[k].data(), width, height,
+                                    strip.data() + k * m_layout.thumbWidth * 4,
+                                    m_layout.thumbWidth, m_layout.thumbHeight, stripStride);
+        }
+        PresetFeatures features = PresetFeatureTable::analyzeFrames(captured, width, height);
+
+        const std::string path = pm->getPresetURL(index);
+        const uint32_t pathLength = static_cast<uint32_t>(path.size());
+        out.write(reinterpret_cast<const char*>(&pathLength), sizeof(pathLength));
+        out.write(path.data(), pathLength);
+        out.write(reinterpret_cast<const char*>(&features), sizeof(features));
+        out.write(reinterpret_cast<const char*>(strip.data()), strip.size());
+    }
+
+    pm.reset();
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl->glDeleteFramebuffers(1, &fbo);
+    gl->glDeleteTextures(1, &colorTexture);
+    context.doneCurrent();
+    return out ? 0 : 1;
+}
+
+bool PresetAtlasJob::packShards()
+{
+    PresetAtlas atlas(m_layout);
+    PresetFeatureTable features;
+    features.load(m_options.featuresPath);
+
+    QImage page(m_layout.pageSize, m_layout.pageSize, QImage::Format_RGBA8888);
+    page.fill(Qt::transparent);
+    int currentPage = 0;
+    std::vector<unsigned char> strip(m_layout.stripBytes());
+    const QDir outputDir(QString::fromStdString(m_options.outputDir));
+
+    auto savePage = [&](int pageIndex) {
+        QString fileName = outputDir.filePath(QString::fromStdString(PresetAtlas::pageFileName(pageIndex)));
+        if (!page.save(fileName)) {
+            std::cerr << "Failed to write atlas page: " << fileName.toStdString() << std::endl;
+            return false;
+        }
+        page.fill(Qt::transparent);
+        return true;
+    };
+
+    for (int shard = 0; shard < std::max(1, m_options.workers); ++shard) {
+        std::ifstream in(shardPath(shard), std::ios::binary);
+        char magic[4];
+        if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, SHARD_MAGIC)) {
+            std::cerr << "Invalid preset atlas shard: " << shardPath(shard) << std::endl;
+            return false;
+        }
+
+        uint32_t pathLength = 0;
+        while (in.read(reinterpret_cast<char*>(&pathLength), sizeof(pathLength))) {
+            std::string path(pathLength, '\0');
+            PresetFeatures presetFeatures;
+            in.read(&path[0], pathLength);
+            in.read(reinterpret_cast<char*>(&presetFeatures), sizeof(presetFeatures));
+            in.read(reinterpret_cast<char*>(strip.data()), strip.size());
+            if (!in) {
+                std::cerr << "Truncated preset atlas shard: " << shardPath(shard) << std::endl;
+                return false;
+            }
+
+            const PresetAtlasEntry& entry = atlas.add(path);
+            if (entry.page != currentPage) {
+                if (!savePage(currentPage)) {
+                    return false;
+                }
+                currentPage = entry.page;
+            }
+            const int stripStride = m_layout.stripWidth() * 4;
+            for (int row = 0; row < m_layout.thumbHeight; ++row) {
+                std::copy_n(strip.data() + row * stripStride, stripStride,
+                            page.scanLine(entry.y + row) + entry.x * 4);
+            }
+            features.set(path, presetFeatures);
+        }
+    }
+
+    if (!atlas.entries().empty() && !savePage(currentPage)) {
+        return false;
+    }
+    QDir().mkpath(QFileInfo(QString::fromStdString(m_options.featuresPath)).absolutePath());
+    features.save(m_options.featuresPath);
+    return atlas.saveIndex(outputDir.filePath(QString::fromStdString(PresetAtlas::indexFileName())).toStdString());
+}
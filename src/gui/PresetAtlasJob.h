@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include "core/presets/PresetAtlas.h"
+
+// Headless batch job that renders every preset against a reference clip and
+// packs animated thumbnail strips into atlas pages. The coordinator splits the
+// playlist into shards, runs one worker process per shard, then packs the
+// shard outputs and merges the measured preset features.
+class PresetAtlasJob
+{
+public:
+    struct Options {
+        std::string outputDir;
+        std::string clipPath;
+        std::string presetDir;
+        std::string featuresPath;
+        int workers = 1;
+        float secondsPerPreset = 3.0f;
+        int renderWidth = 256;
+        int renderHeight = 144;
+        int fps = 30;
+        // A non-negative shard makes this process a worker.
+        int shard = -1;
+        int shardCount = 1;
+    };
+
+    explicit PresetAtlasJob(const Options& options);
+
+    int run();
+
+private:
+    int runCoordinator();
+    int runWorker();
+    bool packShards();
+    std::string shardPath(int shard) const;
+
+    Options m_options;
+    PresetAtlas::Layout m_layout;
+};
@@ -0,0 +1,239 @@
+#include "PresetBrowser.h"
+#include <QDir>
+#include <QImage>
+#include <QMouseEvent>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QVector2D>
+#include <QWheelEvent>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    const int ANIMATION_INTERVAL_MS = 125;
+
+    const char* browserVertexShader = R"(
+#version 330 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 texCoord;
+out vec2 TexCoords;
+
+uniform vec2 viewportSize;
+uniform float frameOffset;
+
+void main()
+{
+    vec2 ndc = vec2(position.x / viewportSize.x * 2.0 - 1.0, 1.0 - position.y / viewportSize.y * 2.0);
+    gl_Position = vec4(ndc, 0.0, 1.0);
+    TexCoords = texCoord + vec2(frameOffset, 0.0);
+}
+)";
+
+    const char* browserFragmentShader = R"(
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D atlas;
+
+void main()
+{
+    color = texture(atlas, TexCoords);
+}
+)";
+}
+
+PresetBrowser::PresetBrowser(const QString& atlasDirectory, QWidget* parent)
+    : QOpenGLWidget(parent), m_directory(atlasDirectory)
+{
+    m_atlas.loadIndex(QDir(atlasDirectory).filePath(QString::fromStdString(PresetAtlas::indexFileName())).toStdString());
+    m_pageEntries = m_atlas.entriesOnPage(0);
+
+    connect(&m_animationTimer, &QTimer::timeout, this, QOverload<>::of(&QWidget::update));
+    m_animationTimer.start(ANIMATION_INTERVAL_MS);
+    m_clock.start();
+}
+
+PresetBrowser::~PresetBrowser()
+{
+    makeCurrent();
+    delete m_texture;
+    delete m_program;
+    if (m_vao) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+    }
+    doneCurrent();
+}
+
+void PresetBrowser::setPage(int page)
+{
+    if (page < 0 || page >= pageCount() || page == m_page) {
+        return;
+    }
+    m_page = page;
+    m_pageEntries = m_atlas.entriesOnPage(page);
+    m_pageDirty = true;
+    m_geometryDirty = true;
+    update();
+}
+
+void PresetBrowser::nextPage()
+{
+    setPage(m_page + 1);
+}
+
+void PresetBrowser::previousPage()
+{
+    setPage(m_page - 1);
+}
+
+void PresetBrowser::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    m_program = new QOpenGLShaderProgram();
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, browserVertexShader);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, browserFragmentShader);
+    m_program->link();
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), reinterpret_cast<void*>(2 * sizeof(float)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void PresetBrowser::resizeGL(int w, int h)
+{
+    Q_UNUSED(w);
+    Q_UNUSED(h);
+    m_geometryDirty = true;
+}
+
+int PresetBrowser::columns() const
+{
+    return std::max(1, width() / m_atlas.layout().thumbWidth);
+}
+
+void PresetBrowser::uploadPage()
+{
+    m_pageDirty = false;
+    delete m_texture;
+    m_texture = nullptr;
+
+    QString fileName = QDir(m_directory).filePath(QString::fromStdString(PresetAtlas::pageFileName(m_page)));
+    QImage image(fileName);
+    if (image.isNull()) {
+        std::cerr << "Failed to load preset atlas page: " << fileName.toStdString() << std::endl;
+        return;
+    }
+    image = image.convertToFormat(QImage::Format_RGBA8888);
+
+    // Rows are uploaded top-down, matching the atlas index coordinates.
+    m_texture = new QOpenGLTexture(QOpenGLTexture::Target2D);
+    m_texture->setSize(image.width(), image.height());
+    m_texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    m_texture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+    m_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    m_texture->allocateStorage();
+    m_texture->setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, image.constBits());
+}
+
+void PresetBrowser::rebuildGeometry()
+{
+    m_geometryDirty = false;
+    const PresetAtlas::Layout& layout = m_atlas.layout();
+    const float page = static_cast<float>(layout.pageSize);
+    const float cellW = static_cast<float>(layout.thumbWidth);
+    const float cellH = static_cast<float>(layout.thumbHeight);
+    const int cols = columns();
+
+    std::vector<float> vertices;
+    vertices.reserve(m_pageEntries.size() * 6 * 4);
+    for (size_t i = 0; i < m_pageEntries.size(); ++i) {
+        const PresetAtlasEntry* entry = m_pageEntries[i];
+        const float x0 = (i % cols) * cellW, y0 = (i / cols) * cellH;
+        const float x1 = x0 + cellW, y1 = y0 + cellH;
+        const float u0 = entry->x / page, v0 = entry->y / page;
+        const float u1 = u0 + cellW / page, v1 = v0 + cellH / page;
+        const float quad[6][4] = {
+            { x0, y0, u0, v0 }, { x0, y1, u0, v1 }, { x1, y1, u1, v1 },
+            { x0, y0, u0, v0 }, { x1, y1, u1, v1 }, { x1, y0, u1, v0 }
+        };
+        vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 24);
+    }
+    m_vertexCount = static_cast<int>(m_pageEntries.size() * 6);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PresetBrowser::paintGL()
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (!hasAtlas()) {
+        return;
+    }
+
+    if (m_pageDirty) {
+        uploadPage();
+    }
+    if (m_geometryDirty) {
+        rebuildGeometry();
+    }
+    if (!m_texture || m_vertexCount == 0) {
+        return;
+    }
+
+    const PresetAtlas::Layout& layout = m_atlas.layout();
+    const int frame = static_cast<int>(m_clock.elapsed() / ANIMATION_INTERVAL_MS) % layout.framesPerStrip;
+
+    m_program->bind();
+    m_program->setUniformValue("viewportSize", QVector2D(width(), height()));
+    m_program->setUniformValue("frameOffset", static_cast<float>(frame * layout.thumbWidth) / layout.pageSize);
+    m_program->setUniformValue("atlas", 0);
+    glActiveTexture(GL_TEXTURE0);
+    m_texture->bind();
+    glBindVertexArray(m_vao);
+    glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
+    glBindVertexArray(0);
+    m_texture->release();
+    m_program->release();
+}
+
+int PresetBrowser::entryAt(const QPoint& pos) const
+{
+    const PresetAtlas::Layout& layout = m_atlas.layout();
+    const int col = pos.x() / layout.thumbWidth;
+    const int row = pos.y() / layout.thumbHeight;
+    if (col >= columns()) {
+        return -1;
+    }
+    const int index = row * columns() + col;
+    return index < static_cast<int>(m_pageEntries.size()) ? index : -1;
+}
+
+void PresetBrowser::mousePressEvent(QMouseEvent* event)
+{
+    int index = entryAt(event->position().toPoint());
+    if (index >= 0) {
+        emit presetActivated(QString::fromStdString(m_pageEntries[index]->presetPath));
+    }
+}
+
+void PresetBrowser::wheelEvent(QWheelEvent* event)
+{
+    if (event->angleDelta().y() < 0) {
+        nextPage();
+    } else if (event->angleDelta().y() > 0) {
+        previousPage();
+    }
+}
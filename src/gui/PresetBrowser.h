@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <vector>
+#include "core/presets/PresetAtlas.h"
+
+class QOpenGLShaderProgram;
+class QOpenGLTexture;
+
+// Grid of animated preset previews read from the atlas built by
+// PresetAtlasJob. Each page is one texture upload and one draw call; the
+// animation only changes a uniform.
+class PresetBrowser : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core
+{
+    Q_OBJECT
+public:
+    explicit PresetBrowser(const QString& atlasDirectory, QWidget* parent = nullptr);
+    ~PresetBrowser();
+
+    bool hasAtlas() const { return !m_atlas.entries().empty(); }
+    int pageCount() const { return m_atlas.pageCount(); }
+    int currentPage() const { return m_page; }
+
+public slots:
+    void setPage(int page);
+    void nextPage();
+    void previousPage();
+
+signals:
+    void presetActivated(const QString& presetPath);
+
+protected:
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+
+private:
+    void uploadPage();
+    void rebuildGeometry();
+    int columns() const;
+    int entryAt(const QPoint& pos) const;
+
+    QString m_directory;
+    PresetAtlas m_atlas;
+    std::vector<const PresetAtlasEntry*> m_pageEntries;
+    int m_page{0};
+    bool m_pageDirty{true};
+    bool m_geometryDirty{true};
+
+    QOpenGLShaderProgram* m_program{nullptr};
+    QOpenGLTexture* m_texture{nullptr};
+    unsigned int m_vao{0}, m_vbo{0};
+    int m_vertexCount{0};
+
+    QTimer m_animationTimer;
+    QElapsedTimer m_clock;
+};
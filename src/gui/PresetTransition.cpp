@@ -0,0 +1,258 @@
+#include "PresetTransition.h"
+#include <libprojectM/projectM.hpp>
+#include <QOpenGLShaderProgram>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const int MAX_OUTGOING_STRIDE = 4;
+    // Headroom before the outgoing preset goes back to rendering every frame.
+    const float BUDGET_RECOVERY_RATIO = 0.75f;
+
+    const char* transitionVertexShader = R"(
+#version 330 core
+out vec2 TexCoords;
+
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1));
+    TexCoords = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    const char* transitionFragmentShader = R"(
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D outgoing;
+uniform sampler2D incoming;
+uniform float progress;
+uniform float beatPulse;
+uniform int style;
+
+void main()
+{
+    vec4 a = texture(outgoing, TexCoords);
+    vec4 b = texture(incoming, TexCoords);
+    float t;
+    float flash = 0.0;
+    if (style == 1) {
+        float edge = progress * 1.2 - 0.1;
+        t = 1.0 - smoothstep(edge - 0.1, edge + 0.1, TexCoords.x);
+    } else if (style == 2) {
+        t = step(0.5, progress);
+        flash = beatPulse * (1.0 - abs(progress * 2.0 - 1.0));
+    } else {
+        t = smoothstep(0.0, 1.0, progress);
+    }
+    color = mix(a, b, t) + vec4(flash, flash, flash, 0.0);
+}
+)";
+
+    void accumulate(float ms, float& total, float& maximum, int& samples) {
+        total += ms;
+        maximum = std::max(maximum, ms);
+        ++samples;
+    }
+}
+
+void PresetTransition::initialize(QOpenGLFunctions_3_3_Core* gl)
+{
+    m_program = new QOpenGLShaderProgram();
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, transitionVertexShader);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, transitionFragmentShader);
+    m_program->link();
+
+    gl->glGenVertexArrays(1, &m_vao);
+    m_outgoingTimer.initialize(gl);
+    m_incomingTimer.initialize(gl);
+    m_compositeTimer.initialize(gl);
+}
+
+void PresetTransition::cleanup(QOpenGLFunctions_3_3_Core* gl)
+{
+    deleteTarget(gl, m_outgoingTarget);
+    deleteTarget(gl, m_incomingTarget);
+    gl->glDeleteVertexArrays(1, &m_vao);
+    m_outgoingTimer.cleanup(gl);
+    m_incomingTimer.cleanup(gl);
+    m_compositeTimer.cleanup(gl);
+    delete m_program;
+    m_program = nullptr;
+}
+
+void PresetTransition::createTarget(QOpenGLFunctions_3_3_Core* gl, Target& target)
+{
+    gl->glGenTextures(1, &target.texture);
+    gl->glBindTexture(GL_TEXTURE_2D, target.texture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+
+    gl->glGenFramebuffers(1, &target.fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PresetTransition::deleteTarget(QOpenGLFunctions_3_3_Core* gl, Target& target)
+{
+    if (target.fbo) {
+        gl->glDeleteFramebuffers(1, &target.fbo);
+        gl->glDeleteTextures(1, &target.texture);
+        target = Target();
+    }
+}
+
+void PresetTransition::resize(QOpenGLFunctions_3_3_Core* gl, int width, int height)
+{
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    deleteTarget(gl, m_outgoingTarget);
+    deleteTarget(gl, m_incomingTarget);
+    createTarget(gl, m_outgoingTarget);
+    createTarget(gl, m_incomingTarget);
+}
+
+void PresetTransition::begin(projectM* outgoing, projectM* incoming, double startTime)
+{
+    m_outgoing = outgoing;
+    m_incoming = incoming;
+    m_startTime = startTime;
+    m_lastTime = startTime;
+    m_outgoingStride = 1;
+    m_stats = Stats();
+    m_active = true;
+}
+
+void PresetTransition::collectTimings(QOpenGLFunctions_3_3_Core* gl)
+{
+    float ms;
+    if (m_outgoingTimer.poll(gl, ms)) {
+        m_lastOutgoingMs = ms;
+        accumulate(ms, m_stats.outgoingTotalMs, m_stats.outgoingMaxMs, m_stats.outgoingSamples);
+    }
+    if (m_incomingTimer.poll(gl, ms)) {
+        m_lastIncomingMs = ms;
+        accumulate(ms, m_stats.incomingTotalMs, m_stats.incomingMaxMs, m_stats.incomingSamples);
+    }
+    if (m_compositeTimer.poll(gl, ms)) {
+        m_lastCompositeMs = ms;
+        accumulate(ms, m_stats.compositeTotalMs, m_stats.compositeMaxMs, m_stats.compositeSamples);
+    }
+
+    // The outgoing pass is the one we can afford to thin out: it is fading away.
+    float projected = m_lastOutgoingMs + m_lastIncomingMs + m_lastCompositeMs;
+    if (projected > m_frameBudgetMs && m_outgoingStride < MAX_OUTGOING_STRIDE) {
+        ++m_outgoingStride;
+    } else if (projected < m_frameBudgetMs * BUDGET_RECOVERY_RATIO && m_outgoingStride > 1) {
+        --m_outgoingStride;
+    }
+}
+
+bool PresetTransition::render(QOpenGLFunctions_3_3_Core* gl, double time, float beatPulse, GLuint targetFbo)
+{
+    if (!m_active) {
+        return false;
+    }
+
+    collectTimings(gl);
+    // Time running backwards (a seek during an export) holds the blend where
+    // it is instead of stalling it at the start.
+    if (time < m_lastTime) {
+        m_startTime -= m_lastTime - time;
+    }
+    m_lastTime = time;
+    const float progress = m_duration > 0.0f
+        ? std::min(1.0f, std::max(0.0f, static_cast<float>((time - m_startTime) / m_duration)))
+        : 1.0f;
+
+    if (m_stats.frames % m_outgoingStride == 0) {
+        m_outgoingTimer.begin(gl);
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, m_outgoingTarget.fbo);
+        gl->glViewport(0, 0, m_width, m_height);
+        m_outgoing->renderFrame();
+        m_outgoingTimer.end(gl);
+    } else {
+        ++m_stats.outgoingReused;
+    }
+
+    m_incomingTimer.begin(gl);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, m_incomingTarget.fbo);
+    gl->glViewport(0, 0, m_width, m_height);
+    m_incoming->renderFrame();
+    m_incomingTimer.end(gl);
+
+    m_compositeTimer.begin(gl);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+    gl->glViewport(0, 0, m_width, m_height);
+    gl->glDisable(GL_BLEND);
+    m_program->bind();
+    m_program->setUniformValue("outgoing", 0);
+    m_program->setUniformValue("incoming", 1);
+    m_program->setUniformValue("progress", progress);
+    m_program->setUniformValue("beatPulse", beatPulse);
+    m_program->setUniformValue("style", static_cast<int>(m_style));
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, m_outgoingTarget.texture);
+    gl->glActiveTexture(GL_TEXTURE1);
+    gl->glBindTexture(GL_TEXTURE_2D, m_incomingTarget.texture);
+    gl->glBindVertexArray(m_vao);
+    gl->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    gl->glBindVertexArray(0);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+    m_program->release();
+    m_compositeTimer.end(gl);
+
+    ++m_stats.frames;
+    if (progress >= 1.0f) {
+        m_active = false;
+        return false;
+    }
+    return true;
+}
+
+std::string PresetTransition::costReport() const
+{
+    auto average = [](float total, int samples) { return samples > 0 ? total / samples : 0.0f; };
+    const float outgoing = average(m_stats.outgoingTotalMs, m_stats.outgoingSamples);
+    const float incoming = average(m_stats.incomingTotalMs, m_stats.incomingSamples);
+    const float composite = average(m_stats.compositeTotalMs, m_stats.compositeSamples);
+    const float reusedShare = m_stats.frames > 0 ? static_cast<float>(m_stats.outgoingReused) / m_stats.frames : 0.0f;
+    const float total = outgoing * (1.0f - reusedShare) + incoming + composite;
+
+    char report[384];
+    std::snprintf(report, sizeof(report),
+        "Preset transition (%s, %.2f s): %d frames, outgoing %.2f/%.2f ms, incoming %.2f/%.2f ms, "
+        "composite %.2f/%.2f ms (avg/max), %.2f ms per frame against a %.2f ms budget, %d outgoing frames reused",
+        styleName(m_style), m_duration, m_stats.frames,
+        outgoing, m_stats.outgoingMaxMs, incoming, m_stats.incomingMaxMs,
+        composite, m_stats.compositeMaxMs, total, m_frameBudgetMs, m_stats.outgoingReused);
+    return report;
+}
+
+PresetTransition::Style PresetTransition::styleFromName(const std::string& name)
+{
+    if (name == "wipe") return Style::Wipe;
+    if (name == "flash") return Style::BeatFlash;
+    return Style::Crossfade;
+}
+
+const char* PresetTransition::styleName(Style style)
+{
+    switch (style) {
+    case Style::Wipe: return "wipe";
+    case Style::BeatFlash: return "flash";
+    default: return "crossfade";
+    }
+}
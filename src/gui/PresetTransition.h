@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QOpenGLFunctions_3_3_Core>
+#include <string>
+#include "gui/GpuTimer.h"
+
+class projectM;
+class QOpenGLShaderProgram;
+
+// Renders the outgoing and incoming presets into their own FBOs for the
+// length of a transition and blends them into the target framebuffer.
+// When both passes together exceed the frame budget, the outgoing preset is
+// rendered on fewer frames and its last image is reused in between.
+class PresetTransition
+{
+public:
+    enum class Style {
+        Crossfade,
+        Wipe,
+        BeatFlash
+    };
+
+    struct Stats {
+        int frames = 0;
+        int outgoingReused = 0;
+        float outgoingTotalMs = 0.0f, outgoingMaxMs = 0.0f;
+        float incomingTotalMs = 0.0f, incomingMaxMs = 0.0f;
+        float compositeTotalMs = 0.0f, compositeMaxMs = 0.0f;
+        int outgoingSamples = 0, incomingSamples = 0, compositeSamples = 0;
+    };
+
+    void initialize(QOpenGLFunctions_3_3_Core* gl);
+    void cleanup(QOpenGLFunctions_3_3_Core* gl);
+    void resize(QOpenGLFunctions_3_3_Core* gl, int width, int height);
+
+    void setStyle(Style style) { m_style = style; }
+    void setDuration(float seconds) { m_duration = seconds; }
+    void setFrameBudget(float milliseconds) { m_frameBudgetMs = milliseconds; }
+
+    void begin(projectM* outgoing, projectM* incoming, double startTime);
+    bool isActive() const { return m_active; }
+
+    // Draws one blended frame into targetFbo; `time` is on the clock passed
+    // to begin(). beatPulse in [0, 1] drives the flash style. Returns false
+    // on the frame the transition completes.
+    bool render(QOpenGLFunctions_3_3_Core* gl, double time, float beatPulse, GLuint targetFbo);
+
+    const Stats& stats() const { return m_stats; }
+    std::string costReport() const;
+
+    static Style styleFromName(const std::string& name);
+    static const char* styleName(Style style);
+
+private:
+    struct Target {
+        GLuint fbo = 0;
+        GLuint texture = 0;
+    };
+
+    void createTarget(QOpenGLFunctions_3_3_Core* gl, Target& target);
+    void deleteTarget(QOpenGLFunctions_3_3_Core* gl, Target& target);
+    void collectTimings(QOpenGLFunctions_3_3_Core* gl);
+
+    Style m_style = Style::Crossfade;
+    float m_duration = 2.0f;
+    float m_frameBudgetMs = 1000.0f / 30.0f;
+
+    bool m_active = false;
+    double m_startTime = 0.0;
+    double m_lastTime = 0.0;
+    projectM* m_outgoing = nullptr;
+    projectM* m_incoming = nullptr;
+    int m_outgoingStride = 1;
+    float m_lastOutgoingMs = 0.0f, m_lastIncomingMs = 0.0f, m_lastCompositeMs = 0.0f;
+
+    int m_width = 0;
+    int m_height = 0;
+    Target m_outgoingTarget;
+    Target m_incomingTarget;
+    GLuint m_vao = 0;
+    QOpenGLShaderProgram* m_program = nullptr;
+
+    GpuTimer m_outgoingTimer;
+    GpuTimer m_incomingTimer;
+    GpuTimer m_compositeTimer;
+    Stats m_stats;
+};
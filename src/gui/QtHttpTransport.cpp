@@ -0,0 +1,92 @@
+#include "QtHttpTransport.h"
+#include <QEventLoop>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QUrl>
+#include <memory>
+
+namespace {
+    // Resets whenever data arrives, so only stalled transfers time out.
+    const int TRANSFER_TIMEOUT_MS = 30000;
+    const char* USER_AGENT = "AuroraVisualizer";
+    // How often a transfer checks whether it was cancelled.
+    const int CANCEL_POLL_MS = 100;
+}
+
+bool QtHttpTransport::get(const HttpRequest& request, HttpResponse& response, const BodyCallback& onBody)
+{
+    QNetworkAccessManager manager;
+    QNetworkRequest networkRequest(QUrl(QString::fromStdString(request.url)));
+    networkRequest.setTransferTimeout(TRANSFER_TIMEOUT_MS);
+    networkRequest.setHeader(QNetworkRequest::UserAgentHeader, USER_AGENT);
+    if (request.rangeStart > 0) {
+        networkRequest.setRawHeader("Range", "bytes=" + QByteArray::number(static_cast<qulonglong>(request.rangeStart)) + "-");
+    }
+    std::unique_ptr<QNetworkReply> reply(manager.get(networkRequest));
+
+    bool headersRead = false;
+    bool aborted = false;
+    auto readHeaders = [&]() {
+        if (headersRead) {
+            return;
+        }
+        headersRead = true;
+        response.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        // "bytes 100-299/300"; the total may be "*" when unknown. A 416
+        // carries "bytes */300" instead.
+        static const QRegularExpression contentRange(R"(bytes\s+(\d+)-\d+/(\d+))");
+        static const QRegularExpression unsatisfiedRange(R"(bytes\s+\*/(\d+))");
+        const QString rangeHeader = QString::fromLatin1(reply->rawHeader("Content-Range"));
+        const QRegularExpressionMatch match = contentRange.match(rangeHeader);
+        const QRegularExpressionMatch unsatisfied = unsatisfiedRange.match(rangeHeader);
+        if (match.hasMatch()) {
+            response.rangeStart = match.captured(1).toULongLong();
+            response.totalSize = match.captured(2).toULongLong();
+        } else if (unsatisfied.hasMatch()) {
+            response.totalSize = unsatisfied.captured(1).toULongLong();
+        } else if (response.status == 200) {
+            response.totalSize = reply->header(QNetworkRequest::ContentLengthHeader).toULongLong();
+        }
+    };
+    auto deliver = [&]() {
+        readHeaders();
+        const QByteArray bytes = reply->readAll();
+        if (!aborted && !bytes.isEmpty() && !onBody(bytes.constData(), static_cast<size_t>(bytes.size()))) {
+            aborted = true;
+            reply->abort();
+        }
+    };
+
+    QEventLoop loop;
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, &loop, deliver);
+    QObject::connect(reply.get(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    // The body callback only sees cancellation once data flows; this also
+    // catches a server that has not answered yet.
+    QTimer cancelTimer;
+    if (request.cancel) {
+        QObject::connect(&cancelTimer, &QTimer::timeout, &loop, [&]() {
+            if (request.cancel->load() && !aborted) {
+                aborted = true;
+                reply->abort();
+            }
+        });
+        cancelTimer.start(CANCEL_POLL_MS);
+    }
+    if (!reply->isFinished()) {
+        loop.exec();
+    }
+    deliver();
+
+    if (aborted) {
+        response.error = "aborted";
+        return false;
+    }
+    if (reply->error() != QNetworkReply::NoError) {
+        response.error = reply->errorString().toStdString();
+        return false;
+    }
+    return true;
+}
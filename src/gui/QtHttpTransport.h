@@ -0,0 +1,12 @@
+#pragma once
+
+#include "core/download/HttpTransport.h"
+
+// HttpTransport over QNetworkAccessManager. Each call runs its own manager
+// and event loop on the calling thread, so DownloadManager's threads can
+// use it concurrently without sharing Qt objects.
+class QtHttpTransport : public HttpTransport
+{
+public:
+    bool get(const HttpRequest& request, HttpResponse& response, const BodyCallback& onBody) override;
+};
@@ -1,3 +1,10 @@
+#include "Renderer.h"
+#include <libprojectM/projectM.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
 
 void Renderer::setShuffle(bool shuffle)
 {
@@ -5,3 +12,492 @@ void Renderer::setShuffle(bool shuffle)
         m_projectM->setShuffleEnabled(shuffle);
     }
 }
+
+bool Renderer::selectPresetByPath(const std::string& presetPath)
+{
+    if (!m_projectM) {
+        return false;
+    }
+
+    unsigned int playlistSize = m_projectM->getPlaylistSize();
+    for (unsigned int i = 0; i < playlistSize; ++i) {
+        if (m_projectM->getPresetURL(i) != presetPath) {
+            continue;
+        }
+        unsigned int currentIndex = 0;
+        if (m_projectM->selectedPresetIndex(currentIndex)) {
+            m_presetHistory.push_back(currentIndex);
+            if (m_presetHistory.size() > MAX_HISTORY_SIZE) {
+                m_presetHistory.pop_front();
+            }
+        }
+        transitionToPreset(i);
+        return true;
+    }
+    return false;
+}
+
+void Renderer::setArtist(const std::string& artist)
+{
+    m_artist = artist;
+    if (m_compositorInitialized) {
+        m_compositor.markDirty(m_staticOverlayLayer);
+    }
+}
+
+void Renderer::setUrl(const std::string& url)
+{
+    m_url = url;
+    if (m_compositorInitialized) {
+        m_compositor.markDirty(m_staticOverlayLayer);
+    }
+}
+
+void Renderer::analyzeTrack(const std::string& filePath, std::shared_ptr<DecodedTrack> track)
+{
+    if (!m_config.sectionPresetSwitching() || m_use_default_preset) {
+        return;
+    }
+
+    if (!m_presetSelector) {
+        m_presetFeatures.load(m_config.presetFeaturesPath().toStdString());
+        m_presetSelector = std::make_unique<PresetSelector>(&m_presetFeatures);
+        connect(&m_renderTimer, &QTimer::timeout, this, &Renderer::updateSectionPreset, Qt::UniqueConnection);
+    }
+    if (m_presetFeatures.empty()) {
+        return;
+    }
+
+    m_presetSelector->setTrackAnalysis(TrackAnalysis());
+    m_trackAnalysisFuture = std::async(std::launch::async, [filePath, track = std::move(track)]() {
+        TrackAnalysis analysis;
+        AudioEngine::withWholeTrack(filePath, track, [&analysis](const short* pcm, size_t frames, int sampleRate) {
+            analysis = TrackAnalyzer::analyze(pcm, frames, sampleRate);
+        });
+        return analysis;
+    });
+}
+
+void Renderer::mapPresetFeatureRows()
+{
+    unsigned int playlistSize = m_projectM->getPlaylistSize();
+    m_playlistFeatureRows.assign(playlistSize, -1);
+    m_featureRowPlaylist.assign(m_presetFeatures.size(), -1);
+    for (unsigned int i = 0; i < playlistSize; ++i) {
+        int row = m_presetFeatures.indexOf(m_projectM->getPresetURL(i));
+        m_playlistFeatureRows[i] = row;
+        if (row >= 0) {
+            m_featureRowPlaylist[row] = static_cast<int>(i);
+        }
+    }
+}
+
+void Renderer::updateSectionPreset()
+{
+    if (!m_projectM || !m_presetSelector) {
+        return;
+    }
+
+    if (m_trackAnalysisFuture.valid() &&
+        m_trackAnalysisFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        m_presetSelector->setTrackAnalysis(m_trackAnalysisFuture.get());
+        mapPresetFeatureRows();
+        // Section boundaries replace projectM's fixed-duration switching.
+        m_projectM->setPresetLock(m_presetSelector->trackAnalysis().isValid());
+    }
+    if (!m_presetSelector->trackAnalysis().isValid()) {
+        return;
+    }
+
+    int section = m_presetSelector->advance(m_audioEngine->getCurrentPosition());
+    if (section < 0) {
+        return;
+    }
+
+    auto rowOf = [this](unsigned int playlistIndex) {
+        return playlistIndex < m_playlistFeatureRows.size() ? m_playlistFeatureRows[playlistIndex] : -1;
+    };
+
+    unsigned int currentIndex = 0;
+    bool hasCurrent = m_projectM->selectedPresetIndex(currentIndex);
+    std::deque<int> recentRows;
+    for (unsigned int index : m_presetHistory) {
+        recentRows.push_back(rowOf(index));
+    }
+
+    int row = m_presetSelector->select(section, hasCurrent ? rowOf(currentIndex) : -1, recentRows);
+    if (row < 0 || m_featureRowPlaylist[row] < 0) {
+        return;
+    }
+
+    if (hasCurrent) {
+        m_presetHistory.push_back(currentIndex);
+        if (m_presetHistory.size() > MAX_HISTORY_SIZE) {
+            m_presetHistory.pop_front();
+        }
+    }
+    transitionToPreset(static_cast<unsigned int>(m_featureRowPlaylist[row]));
+}
+
+void Renderer::transitionToPreset(unsigned int index)
+{
+    if (!m_projectM) {
+        return;
+    }
+    if (!m_isInitialized || !m_config.presetTransitionsEnabled()) {
+        m_projectM->selectPreset(index, true);
+        return;
+    }
+
+    // When the tempo is known and the song is playing, the transition waits
+    // for the next beat.
+    double delay = 0.0;
+    float tempo = m_presetSelector ? m_presetSelector->trackAnalysis().tempo : 0.0f;
+    if (m_config.presetTransitionBeatSync() && tempo > 0.0f && m_audioEngine->isPlaying()) {
+        const double songTime = m_audioEngine->getCurrentPosition();
+        double beat = 60.0 / tempo;
+        delay = std::ceil(songTime / beat) * beat - songTime;
+    }
+    m_pendingTransitionPreset = static_cast<int>(index);
+    m_pendingTransitionTime = transitionClock() + delay;
+}
+
+double Renderer::transitionClock()
+{
+    // Exports must render the same frames on every run, so they follow the
+    // song. Live, song time stands still while paused or without a song and
+    // jumps on seeks, so transitions run on a monotonic clock instead.
+    if (m_deterministicMode) {
+        return m_audioEngine->getCurrentPosition();
+    }
+    if (!m_transitionClock.isValid()) {
+        m_transitionClock.start();
+    }
+    return m_transitionClock.nsecsElapsed() / 1.0e9;
+}
+
+float Renderer::beatPulse(double time) const
+{
+    float tempo = m_presetSelector ? m_presetSelector->trackAnalysis().tempo : 0.0f;
+    if (tempo <= 0.0f) {
+        return 0.0f;
+    }
+    double beat = 60.0 / tempo;
+    double phase = std::fmod(time, beat) / beat;
+    return static_cast<float>(std::exp(-phase * 6.0));
+}
+
+void Renderer::startPresetTransition(double now)
+{
+    const int width = m_visualizerWidth;
+    const int height = m_visualizerHeight;
+
+    if (!m_incomingProjectM) {
+        m_incomingProjectM = std::make_unique<projectM>(m_projectM->settings());
+    }
+    m_incomingProjectM->setPresetLock(m_projectM->isPresetLocked());
+    m_incomingProjectM->projectM_resetGL(width, height);
+    m_incomingProjectM->selectPreset(static_cast<unsigned int>(m_pendingTransitionPreset), true);
+    m_pendingTransitionPreset = -1;
+
+    if (!m_presetTransitionInitialized) {
+        m_presetTransition.initialize(this);
+        m_presetTransitionInitialized = true;
+    }
+    m_presetTransition.resize(this, width, height);
+    m_presetTransition.setStyle(PresetTransition::styleFromName(m_config.presetTransitionStyle().toStdString()));
+    m_presetTransition.setDuration(m_config.presetTransitionDuration());
+    m_presetTransition.setFrameBudget(1000.0f / std::max(1, m_config.videoFps()));
+    m_presetTransition.begin(m_projectM.get(), m_incomingProjectM.get(), now);
+}
+
+void Renderer::renderVisualizer(GLuint targetFbo)
+{
+    const double now = transitionClock();
+    const double songTime = m_audioEngine->getCurrentPosition();
+    if (m_pendingTransitionPreset >= 0 && now >= m_pendingTransitionTime && !m_presetTransition.isActive()) {
+        startPresetTransition(now);
+    }
+
+    if (m_presetTransition.isActive()) {
+        m_incomingProjectM->pcm()->addPCM16Data(m_pcmBuffer.data(), static_cast<short>(m_pcmBuffer.size() / 2));
+        if (!m_presetTransition.render(this, now, beatPulse(songTime), targetFbo)) {
+            logInfo(LogCategory::Render, m_presetTransition.costReport());
+            // The incoming instance now carries the selected preset.
+            std::swap(m_projectM, m_incomingProjectM);
+        }
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+    m_projectM->renderFrame();
+}
+
+void Renderer::setupCompositor()
+{
+    m_compositor.initialize(this);
+
+    m_visualizerLayer = m_compositor.addLayer("visualizer", Compositor::LayerKind::Opaque, true,
+        m_config.visualizerRenderScale(), [this](GLuint fbo, int width, int height) {
+            if (width != m_visualizerWidth || height != m_visualizerHeight) {
+                m_visualizerWidth = width;
+                m_visualizerHeight = height;
+                m_projectM->projectM_resetGL(width, height);
+                if (m_incomingProjectM) {
+                    m_incomingProjectM->projectM_resetGL(width, height);
+                }
+            }
+            renderVisualizer(fbo);
+        });
+    m_textLayer = m_compositor.addLayer("text", Compositor::LayerKind::Overlay, true, 1.0f,
+        [this](GLuint, int width, int height) { drawTextLayer(width, height); });
+    m_staticOverlayLayer = m_compositor.addLayer("static-overlay", Compositor::LayerKind::Overlay, false, 1.0f,
+        [this](GLuint, int width, int height) { drawStaticOverlayLayer(width, height); });
+    m_frameTimer.initialize(this);
+    m_fpsClock.start();
+
+    m_compositorInitialized = true;
+    applyConfig();
+    if (ConfigStore* store = ConfigStore::instance()) {
+        connect(store, &ConfigStore::changed, this, &Renderer::applyConfig);
+    }
+}
+
+void Renderer::applyConfig()
+{
+    if (!m_compositorInitialized) {
+        return;
+    }
+    const ConfigSnapshot& config = Config::snapshot();
+    m_compositor.setLayerSharpness(m_visualizerLayer, config.upscaleSharpness);
+
+    DynamicResolutionController::Settings resolutionSettings;
+    resolutionSettings.targetFps = config.dynamicResolutionTargetFps;
+    resolutionSettings.maxScale = config.visualizerRenderScale;
+    resolutionSettings.minScale = std::min(resolutionSettings.maxScale, config.dynamicResolutionMinScale);
+    m_resolutionController.setSettings(resolutionSettings);
+    m_resolutionController.setEnabled(config.dynamicResolutionEnabled && !m_deterministicMode);
+    m_compositor.setLayerScale(m_visualizerLayer, m_resolutionController.scale());
+    if (config.overlayAnimationPath != m_overlayAnimationPath) {
+        loadOverlayAnimation(config.overlayAnimationPath);
+    }
+    m_compositor.markDirty(m_staticOverlayLayer);
+
+    // Takes effect from the next track.
+    const DecodedTrack::Storage storage =
+        config.audioSharedDecode ? DecodedTrack::Storage::Shared : DecodedTrack::Storage::Heap;
+    m_audioEngine->setDecodeToMemory(config.audioDecodeToMemory, storage);
+
+    VisualizationDynamics::Settings dynamics;
+    dynamics.enabled = config.dynamicsEnabled;
+    dynamics.targetDb = config.dynamicsTargetDb;
+    dynamics.maxGainDb = config.dynamicsMaxGainDb;
+    dynamics.agcSeconds = config.dynamicsAgcSeconds;
+    dynamics.thresholdDb = config.dynamicsThresholdDb;
+    dynamics.ratio = config.dynamicsRatio;
+    dynamics.attackMs = config.dynamicsAttackMs;
+    dynamics.releaseMs = config.dynamicsReleaseMs;
+    dynamics.lookaheadMs = config.dynamicsLookaheadMs;
+    dynamics.splitBands = config.dynamicsSplitBands;
+    dynamics.crossoverHz = config.dynamicsCrossoverHz;
+    m_audioEngine->setVisualizationDynamics(dynamics);
+}
+
+void Renderer::loadOverlayAnimation(const QString& filePath)
+{
+    m_overlayAnimationPath = filePath;
+    m_overlayAnimation.clear();
+    if (!filePath.isEmpty() && m_overlayAnimation.load(filePath.toStdString())) {
+        logInfo(LogCategory::Text, "Loaded overlay animation " + filePath.toStdString() + " with " +
+                std::to_string(m_overlayAnimation.elementCount()) + " elements");
+    }
+    m_titleElement = m_overlayAnimation.elementIndex("title");
+    m_artistElement = m_overlayAnimation.elementIndex("artist");
+    m_urlElement = m_overlayAnimation.elementIndex("url");
+    m_lyricsElement = m_overlayAnimation.elementIndex("lyrics");
+}
+
+void Renderer::setDeterministicMode(bool deterministic)
+{
+    if (deterministic == m_deterministicMode) {
+        return;
+    }
+    m_deterministicMode = deterministic;
+    m_resolutionController.setEnabled(m_config.dynamicResolutionEnabled() && !deterministic);
+    if (m_compositorInitialized) {
+        m_compositor.setLayerScale(m_visualizerLayer, m_resolutionController.scale());
+    }
+}
+
+void Renderer::updateFrameStats()
+{
+    float gpuMs;
+    if (m_frameTimer.poll(this, gpuMs)) {
+        m_gpuFrameMs = gpuMs;
+        if (m_resolutionController.update(gpuMs)) {
+            m_compositor.setLayerScale(m_visualizerLayer, m_resolutionController.scale());
+        }
+    }
+
+    ++m_fpsFrameCount;
+    if (m_fpsClock.elapsed() >= 1000) {
+        m_fps = m_fpsFrameCount * 1000.0f / m_fpsClock.restart();
+        m_fpsFrameCount = 0;
+    }
+}
+
+void Renderer::render()
+{
+    if (!m_isInitialized) {
+        initialize();
+    }
+    if (!m_window->isExposed() || !m_context->makeCurrent(m_window)) {
+        return;
+    }
+    renderComposited();
+    m_context->swapBuffers(m_window);
+}
+
+void Renderer::renderComposited()
+{
+    if (!m_compositorInitialized) {
+        setupCompositor();
+    }
+    const int width = static_cast<int>(m_window->width() * m_window->devicePixelRatio());
+    const int height = static_cast<int>(m_window->height() * m_window->devicePixelRatio());
+    updateFrameStats();
+    m_compositor.resize(this, width, height);
+    m_frameTimer.begin(this);
+    m_compositor.render(this, m_context->defaultFramebufferObject());
+    m_frameTimer.end(this);
+}
+
+void Renderer::drawTextLayer(int width, int height)
+{
+    if (!m_overlayAnimation.empty()) {
+        m_overlayAnimation.evaluate(m_audioEngine->getCurrentPosition(), m_overlayPoses);
+    }
+
+    m_songTitleAnimator->setScreenSize(width, height);
+    m_songTitleAnimator->update();
+    const std::string& title = m_songTitleAnimator->text();
+    if (!title.empty() && m_titleElement >= 0) {
+        const QColor titleColor = m_config.titleColor();
+        drawAnimatedText(title, m_overlayPoses[m_titleElement], 1.0f,
+                         QVector3D(titleColor.redF(), titleColor.greenF(), titleColor.blueF()), width, height);
+    } else if (!title.empty()) {
+        m_textRenderer->renderText(this, title, m_songTitleAnimator->position().x(), m_songTitleAnimator->position().y(),
+                                   m_songTitleAnimator->scale(), m_songTitleAnimator->color(), width, height);
+    }
+
+    const QVector3D overlayColor(0.9f, 0.9f, 0.9f);
+    if (!m_url.empty() && m_urlElement >= 0) {
+        drawAnimatedText(m_url, m_overlayPoses[m_urlElement], 0.6f, overlayColor, width, height);
+    }
+    if (!m_artist.empty() && m_artistElement >= 0) {
+        drawAnimatedText(m_artist, m_overlayPoses[m_artistElement], 0.6f, overlayColor, width, height);
+    }
+
+    drawLyrics(width, height);
+
+    if (m_config.showStatsOverlay()) {
+        drawStatsOverlay(width, height);
+    }
+}
+
+void Renderer::setLyricLine(const LyricLine& line)
+{
+    m_currentLyricLine = line;
+    m_currentLyricsText = intelligentWordWrap(line.text, m_config.lyricsLineLengthTarget());
+    m_karaokeText = line.hasWordTimings() ? m_currentLyricsText : std::string();
+    m_karaokeDirty = line.hasWordTimings();
+}
+
+void Renderer::drawLyrics(int width, int height)
+{
+    if (m_currentLyricsText.empty()) {
+        return;
+    }
+    const QVector3D white(1.0f, 1.0f, 1.0f);
+    if (m_karaokeText.empty() || m_karaokeText != m_currentLyricsText) {
+        if (m_lyricsElement >= 0) {
+            drawAnimatedText(m_currentLyricsText, m_overlayPoses[m_lyricsElement], 1.0f, white, width, height);
+            return;
+        }
+        QRectF bounds = m_textRenderer->getTextBounds(m_currentLyricsText, 1.0f);
+        float x = (width - bounds.width()) / 2.0f;
+        float y = height * 0.15f + bounds.height();
+        m_textRenderer->renderText(this, m_currentLyricsText, x, y, 1.0f, white, width, height);
+        return;
+    }
+
+    if (m_karaokeDirty) {
+        m_textRenderer->buildKaraoke(this, m_karaoke, m_karaokeText, m_currentLyricLine);
+        m_karaokeDirty = false;
+    }
+    const QColor highlight = m_config.lyricsHighlightColor();
+    QVector3D baseColor(0.75f, 0.75f, 0.75f);
+    QVector3D highlightColor(highlight.redF(), highlight.greenF(), highlight.blueF());
+    float scale = 1.0f;
+    float x = (width - m_karaoke.bounds.width) / 2.0f;
+    float y = height * 0.15f + m_karaoke.bounds.height;
+    if (m_lyricsElement >= 0) {
+        const OverlayPose& pose = m_overlayPoses[m_lyricsElement];
+        scale = pose.scale;
+        pose.penPosition(m_karaoke.bounds, scale, width, height, x, y);
+        const QVector3D tint = QVector3D(pose.red, pose.green, pose.blue) * pose.alpha;
+        baseColor *= tint;
+        highlightColor *= tint;
+    }
+    m_textRenderer->renderKaraoke(this, m_karaoke, x, y, scale, m_audioEngine->getCurrentPosition(),
+                                  baseColor, highlightColor, width, height);
+}
+
+std::string Renderer::intelligentWordWrap(const std::string& text, int lineLengthTarget)
+{
+    // Same width rule as SongTitleAnimator::layout().
+    float maxWidth = lineLengthTarget * m_textRenderer->metrics().averageAdvance(1.0f);
+    const float windowWidth = static_cast<float>(m_window->width() * m_window->devicePixelRatio());
+    if (windowWidth > 0.0f) {
+        maxWidth = std::min(maxWidth, windowWidth * 0.9f);
+    }
+    return m_textRenderer->wrapText(text, 1.0f, maxWidth);
+}
+
+void Renderer::drawAnimatedText(const std::string& text, const OverlayPose& pose, float baseScale,
+                                const QVector3D& baseColor, int width, int height)
+{
+    const float scale = baseScale * pose.scale;
+    float x, y;
+    pose.penPosition(m_textRenderer->metrics().measure(text, 1.0f), scale, width, height, x, y);
+    const QVector3D color = baseColor * QVector3D(pose.red, pose.green, pose.blue) * pose.alpha;
+    m_textRenderer->renderText(this, text, x, y, scale, color, width, height);
+}
+
+void Renderer::drawStatsOverlay(int width, int height)
+{
+    char stats[96];
+    std::snprintf(stats, sizeof(stats), "%.0f fps  gpu %.1f ms  scale %d%%%s",
+                  m_fps, m_gpuFrameMs, static_cast<int>(m_compositor.layerScale(m_visualizerLayer) * 100.0f + 0.5f),
+                  m_resolutionController.isEnabled() ? " (auto)" : "");
+    const float scale = 0.4f;
+    QRectF bounds = m_textRenderer->getTextBounds(stats, scale);
+    m_textRenderer->renderText(this, stats, 10.0f, height - bounds.height() - 10.0f, scale,
+                               QVector3D(1.0f, 1.0f, 0.0f), width, height);
+}
+
+void Renderer::drawStaticOverlayLayer(int width, int height)
+{
+    const float margin = 20.0f;
+    const float scale = 0.6f;
+    const QVector3D color(0.9f, 0.9f, 0.9f);
+    float y = margin;
+    // Animated elements are drawn with the text layer instead.
+    if (!m_url.empty() && m_urlElement < 0) {
+        m_textRenderer->renderText(this, m_url, margin, y, scale, color, width, height);
+        y += m_textRenderer->getTextBounds(m_url, scale).height() + margin / 2.0f;
+    }
+    if (!m_artist.empty() && m_artistElement < 0) {
+        m_textRenderer->renderText(this, m_artist, margin, y, scale, color, width, height);
+    }
+}
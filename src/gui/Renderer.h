@@ -5,14 +5,26 @@
 #include <QOpenGLContext>
 #include <QOpenGLFunctions_3_3_Core>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <memory>
 #include <deque>
+#include <future>
 
 #include "core/audio/AudioEngine.h"
 #include "gui/TextRenderer.h"
 #include "gui/SongTitleAnimator.h"
+#include "gui/PresetTransition.h"
+#include "gui/Compositor.h"
+#include "gui/GpuTimer.h"
+#include "core/DynamicResolutionController.h"
+#include "core/animation/KeyframeAnimation.h"
 #include "core/Config.h"
+#include "core/lyrics/Lyrics.h"
+#include "core/ConfigStore.h"
 #include "core/LogCatcher.h"
+#include "core/audio/TrackAnalyzer.h"
+#include "core/presets/PresetFeatureTable.h"
+#include "core/presets/PresetSelector.h"
 
 class projectM;
 
@@ -29,20 +41,57 @@ public:
     bool isPresetBroken();
     std::string getCurrentPresetPath();
     void selectNextPreset();
+    bool selectPresetByPath(const std::string& presetPath);
+    void transitionToPreset(unsigned int index);
     void setLyrics(const std::string& lyrics);
+    // Shows a line with per-word timings as a karaoke sweep; lines without
+    // them are shown like setLyrics().
+    void setLyricLine(const LyricLine& line);
     void clearLyrics();
     void setShuffle(bool shuffle);
+    void setArtist(const std::string& artist);
+    void setUrl(const std::string& url);
+    // Exports need identical frames for identical input, so adaptive
+    // resolution is switched off while this is set.
+    void setDeterministicMode(bool deterministic);
+    // Finds the sections of a new song in the background; `track` is the
+    // song as playback decoded it, if it did.
+    void analyzeTrack(const std::string& filePath, std::shared_ptr<DecodedTrack> track = nullptr);
 
 public slots:
     void render();
     void selectRandomPreset();
     void selectPreviousPreset();
     void onResize();
+    void updateSectionPreset();
+    // Re-reads render settings after the config file is reloaded.
+    void applyConfig();
 
 private:
     std::string m_currentLyricsText;
+    LyricLine m_currentLyricLine;
+    // Wrapped text the karaoke mesh was requested for; karaoke is only drawn
+    // while m_currentLyricsText still matches it.
+    std::string m_karaokeText;
+    KaraokeText m_karaoke;
+    bool m_karaokeDirty{false};
     void initialize();
     std::string intelligentWordWrap(const std::string& text, int lineLengthTarget);
+    void mapPresetFeatureRows();
+    void renderVisualizer(GLuint targetFbo);
+    void setupCompositor();
+    void renderComposited();
+    void drawTextLayer(int width, int height);
+    void drawStaticOverlayLayer(int width, int height);
+    void drawLyrics(int width, int height);
+    void drawStatsOverlay(int width, int height);
+    void drawAnimatedText(const std::string& text, const OverlayPose& pose, float baseScale,
+                          const QVector3D& baseColor, int width, int height);
+    void loadOverlayAnimation(const QString& filePath);
+    void updateFrameStats();
+    void startPresetTransition(double now);
+    double transitionClock();
+    float beatPulse(double time) const;
 
     QWindow* m_window;
     QOpenGLContext* m_context;
@@ -62,6 +111,47 @@ private:
     std::deque<unsigned int> m_presetHistory;
     static const size_t MAX_HISTORY_SIZE = 20;
 
+    PresetFeatureTable m_presetFeatures;
+    std::unique_ptr<PresetSelector> m_presetSelector;
+    std::future<TrackAnalysis> m_trackAnalysisFuture;
+    std::vector<int> m_playlistFeatureRows;
+    std::vector<int> m_featureRowPlaylist;
+
+    std::unique_ptr<projectM> m_incomingProjectM;
+    PresetTransition m_presetTransition;
+    bool m_presetTransitionInitialized{false};
+    // Latest pick, started once any running transition has finished.
+    int m_pendingTransitionPreset{-1};
+    // On transitionClock().
+    double m_pendingTransitionTime{0.0};
+    QElapsedTimer m_transitionClock;
+
+    Compositor m_compositor;
+    bool m_compositorInitialized{false};
+    int m_visualizerLayer{-1};
+    int m_textLayer{-1};
+    int m_staticOverlayLayer{-1};
+    int m_visualizerWidth{0};
+    int m_visualizerHeight{0};
+
+    DynamicResolutionController m_resolutionController;
+    GpuTimer m_frameTimer;
+    bool m_deterministicMode{false};
+    float m_gpuFrameMs{0.0f};
+    float m_fps{0.0f};
+    int m_fpsFrameCount{0};
+    QElapsedTimer m_fpsClock;
+
+    // Optional keyframed overlay animation; elements it animates are drawn
+    // from it instead of their built-in layout.
+    KeyframeAnimation m_overlayAnimation;
+    QString m_overlayAnimationPath;
+    std::vector<OverlayPose> m_overlayPoses;
+    int m_titleElement{-1};
+    int m_artistElement{-1};
+    int m_urlElement{-1};
+    int m_lyricsElement{-1};
+
     std::string m_artist;
     std::string m_url;
     std::string m_fontPath;
@@ -1,5 +1,86 @@
-namespace {
-    float easeInOutCubic(float t) {
-        return t < 0.5 ? 4 * t * t * t : 1 - pow(-2 * t + 2, 3) / 2;
+#include "SongTitleAnimator.h"
+#include "TextRenderer.h"
+#include "core/audio/AudioEngine.h"
+#include <algorithm>
+
+SongTitleAnimator::SongTitleAnimator(QObject *parent)
+    : QObject(parent),
+      m_screenWidth(0),
+      m_screenHeight(0),
+      m_textRenderer(nullptr),
+      m_audioEngine(nullptr)
+{
+}
+
+void SongTitleAnimator::start(int screenWidth, int screenHeight, TextRenderer* textRenderer, AudioEngine* audioEngine)
+{
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_textRenderer = textRenderer;
+    m_audioEngine = audioEngine;
+    layout();
+    evaluate(0.0, 0.0);
+}
+
+void SongTitleAnimator::setScreenSize(int width, int height)
+{
+    if (width == m_screenWidth && height == m_screenHeight) {
+        return;
     }
-}
\ No newline at end of file
+    m_screenWidth = width;
+    m_screenHeight = height;
+    layout();
+}
+
+void SongTitleAnimator::setText(const std::string& text)
+{
+    m_text = text;
+    layout();
+}
+
+void SongTitleAnimator::layout()
+{
+    if (!m_textRenderer) {
+        m_wrappedText = m_text;
+        m_textBounds = TextBounds();
+        return;
+    }
+    // line_length_target counts average characters; the screen width caps it.
+    const FontMetrics& metrics = m_textRenderer->metrics();
+    float maxWidth = m_config.titleLineLengthTarget() * metrics.averageAdvance(1.0f);
+    if (m_screenWidth > 0) {
+        maxWidth = std::min(maxWidth, m_screenWidth * 0.9f);
+    }
+    m_wrappedText = m_textRenderer->wrapText(m_text, 1.0f, maxWidth);
+    m_textBounds = metrics.measure(m_wrappedText, 1.0f);
+}
+
+TitleAnimation::Settings SongTitleAnimator::settings() const
+{
+    const ConfigSnapshot& config = Config::snapshot();
+    TitleAnimation::Settings settings;
+    settings.fadeDuration = config.animationFadeDuration;
+    settings.bounceDuration = config.animationBounceDuration;
+    settings.targetAlpha = config.animationTargetAlpha;
+    return settings;
+}
+
+void SongTitleAnimator::update()
+{
+    if (!m_audioEngine) {
+        return;
+    }
+    evaluate(m_audioEngine->getCurrentPosition(), m_audioEngine->getSongDuration());
+}
+
+void SongTitleAnimator::evaluate(double songTime, double songDuration)
+{
+    m_frame = TitleAnimation::evaluate(songTime, songDuration, settings(), m_textBounds,
+                                       static_cast<float>(m_screenWidth), static_cast<float>(m_screenHeight));
+    m_position = QVector3D(m_frame.x, m_frame.y, 0.0f);
+
+    // The text shader has no alpha, so fading scales the colour instead.
+    const QColor titleColor = m_config.titleColor();
+    const float alpha = m_frame.alpha * static_cast<float>(titleColor.alphaF());
+    m_color = QVector3D(titleColor.redF(), titleColor.greenF(), titleColor.blueF()) * alpha;
+}
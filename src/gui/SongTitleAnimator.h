@@ -1,15 +1,17 @@
 #pragma once
 
 #include <QObject>
-#include <QTimer>
 #include <QVector3D>
 #include <string>
-#include <QRectF>
 #include "core/Config.h"
+#include "core/animation/TitleAnimation.h"
 
 class TextRenderer;
 class AudioEngine;
 
+// Places the song title for the current frame. All motion comes from
+// TitleAnimation, so the state is fully determined by the song time passed
+// to evaluate(); there is no timer of its own.
 class SongTitleAnimator : public QObject
 {
     Q_OBJECT
@@ -17,45 +19,36 @@ public:
     explicit SongTitleAnimator(QObject *parent = nullptr);
 
     void start(int screenWidth, int screenHeight, TextRenderer* textRenderer, AudioEngine* audioEngine);
+    // Evaluates at the audio engine's playback position.
     void update();
+    // Evaluates at any song time, e.g. for seeking or offline export.
+    void evaluate(double songTime, double songDuration);
     void setScreenSize(int width, int height);
 
     const std::string& text() const { return m_wrappedText; }
     const QVector3D& position() const { return m_position; }
-    float scale() const { return m_finalScale; }
+    float scale() const { return m_frame.scale; }
+    float alpha() const { return m_frame.alpha; }
     const QVector3D& color() const { return m_color; }
 
     void setText(const std::string& text);
 
+    TitleAnimation::Settings settings() const;
+
 private:
-    enum class State {
-        Hidden,
-        FadeIn,
-        Bouncing,
-        FadeToTransparent,
-        FadeToOpaque,
-        ReturnToCenter
-    };
-
-    void setState(State newState);
-    std::string wrapText(const std::string& text, int lineLengthTarget);
-
-    State m_state;
+    // Wraps the title to the screen and measures it.
+    void layout();
+
     std::string m_text;
     std::string m_wrappedText;
+    TitleAnimation::Frame m_frame;
     QVector3D m_position;
-    QVector3D m_velocity;
-    float m_scale;
-    float m_finalScale;
     QVector3D m_color;
-    QTimer m_timer;
-    float m_totalTime;
     Config m_config;
 
     int m_screenWidth;
     int m_screenHeight;
     TextRenderer* m_textRenderer;
     AudioEngine* m_audioEngine;
-    QRectF m_textBounds;
-    float m_songDuration;
+    TextBounds m_textBounds;
 };
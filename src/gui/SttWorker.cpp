@@ -0,0 +1,159 @@
+#include "SttWorker.h"
+#include "core/Logger.h"
+
+namespace {
+    // Give up on a worker that keeps dying instead of respawning it forever.
+    const int MAX_RESTARTS = 3;
+    const int QUIT_TIMEOUT_MS = 2000;
+}
+
+SttWorker::SttWorker(const QString& command, QObject* parent)
+    : QObject(parent),
+      m_process(new QProcess(this))
+{
+    QStringList parts = QProcess::splitCommand(command);
+    if (!parts.isEmpty()) {
+        m_program = parts.takeFirst();
+        m_arguments = parts;
+    }
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &SttWorker::readOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, &SttWorker::readErrors);
+    connect(m_process, &QProcess::finished, this, &SttWorker::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, this, &SttWorker::onProcessError);
+}
+
+SttWorker::~SttWorker()
+{
+    stop();
+}
+
+void SttWorker::start()
+{
+    ensureStarted();
+    flush();
+}
+
+quint64 SttWorker::transcribe(const QString& audioPath)
+{
+    const quint64 job = m_session.submit(audioPath.toStdString());
+    ensureStarted();
+    flush();
+    return job;
+}
+
+void SttWorker::cancel(quint64 job)
+{
+    m_session.cancel(job);
+    flush();
+}
+
+void SttWorker::stop()
+{
+    if (m_process->state() == QProcess::NotRunning) {
+        return;
+    }
+    disconnect(m_process, &QProcess::finished, this, &SttWorker::onProcessFinished);
+    m_session.quit();
+    flush();
+    m_process->closeWriteChannel();
+    if (!m_process->waitForFinished(QUIT_TIMEOUT_MS)) {
+        m_process->kill();
+        m_process->waitForFinished(QUIT_TIMEOUT_MS);
+    }
+}
+
+void SttWorker::ensureStarted()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        return;
+    }
+    if (m_program.isEmpty()) {
+        logError(LogCategory::General, "No STT worker command configured");
+        return;
+    }
+    logInfo(LogCategory::General, "Starting STT worker: " + m_program.toStdString());
+    m_process->start(m_program, m_arguments);
+}
+
+void SttWorker::flush()
+{
+    if (m_process->state() == QProcess::NotRunning) {
+        return;
+    }
+    const std::string outgoing = m_session.takeOutgoing();
+    if (!outgoing.empty()) {
+        m_process->write(outgoing.data(), static_cast<qint64>(outgoing.size()));
+    }
+}
+
+void SttWorker::readOutput()
+{
+    const QByteArray bytes = m_process->readAllStandardOutput();
+    m_session.receive(std::string_view(bytes.constData(), static_cast<size_t>(bytes.size())));
+    dispatchEvents();
+}
+
+void SttWorker::dispatchEvents()
+{
+    for (SttSession::Event& event : m_session.takeEvents()) {
+        switch (event.type) {
+        case SttSession::Event::Type::Ready:
+            m_restarts = 0;
+            logInfo(LogCategory::General, "STT worker ready: " + event.text);
+            emit ready(QString::fromStdString(event.text));
+            break;
+        case SttSession::Event::Type::Segments:
+            emit segmentsReady(event.job, event.lines);
+            break;
+        case SttSession::Event::Type::Done:
+            emit finished(event.job);
+            break;
+        case SttSession::Event::Type::Error:
+            logWarning(LogCategory::General, "STT worker error: " + event.text);
+            emit failed(event.job, QString::fromStdString(event.text));
+            break;
+        }
+    }
+}
+
+void SttWorker::readErrors()
+{
+    // The worker's own diagnostics; stdout is reserved for the protocol.
+    const QList<QByteArray> lines = m_process->readAllStandardError().split('\n');
+    for (const QByteArray& line : lines) {
+        if (!line.trimmed().isEmpty()) {
+            logDebug(LogCategory::General, "stt_worker: " + line.trimmed().toStdString());
+        }
+    }
+}
+
+void SttWorker::onProcessFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (m_session.pendingJobs() == 0) {
+        m_session.restart();
+        return;
+    }
+    logWarning(LogCategory::General, "STT worker exited (code " + std::to_string(exitCode) +
+               (status == QProcess::CrashExit ? ", crashed" : "") + ") with jobs pending");
+    m_session.restart();
+    if (++m_restarts > MAX_RESTARTS) {
+        logError(LogCategory::General, "STT worker keeps failing; giving up");
+        m_session.fail("STT worker keeps failing");
+        dispatchEvents();
+        return;
+    }
+    ensureStarted();
+    flush();
+}
+
+void SttWorker::onProcessError(QProcess::ProcessError error)
+{
+    // Every other error is followed by finished(), which restarts the worker.
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+    logError(LogCategory::General, "STT worker failed to start: " + m_process->errorString().toStdString());
+    m_session.restart();
+    m_session.fail("STT worker failed to start");
+    dispatchEvents();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "core/lyrics/Lyrics.h"
+#include "core/stt/SttSession.h"
+
+// Keeps one STT worker process (scripts/stt_worker.py) running for the
+// whole session so models are loaded once, and relays the segments it
+// streams back as they arrive. The process is started on the first request
+// and restarted, with unfinished jobs resent, if it dies.
+class SttWorker : public QObject
+{
+    Q_OBJECT
+public:
+    // `command` is the worker command line, e.g. "python3 scripts/stt_worker.py".
+    explicit SttWorker(const QString& command, QObject* parent = nullptr);
+    ~SttWorker() override;
+
+    // Starts the worker ahead of the first request, e.g. to learn its engine.
+    void start();
+    quint64 transcribe(const QString& audioPath);
+    void cancel(quint64 job);
+    void stop();
+
+    bool isReady() const { return m_session.isReady(); }
+    std::string engine() const { return m_session.engine(); }
+
+signals:
+    void ready(const QString& engine);
+    // Lines are in the order the worker produced them, usually by time.
+    void segmentsReady(quint64 job, const std::vector<LyricLine>& lines);
+    void finished(quint64 job);
+    void failed(quint64 job, const QString& message);
+
+private slots:
+    void readOutput();
+    void readErrors();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus status);
+    void onProcessError(QProcess::ProcessError error);
+
+private:
+    void ensureStarted();
+    void flush();
+    void dispatchEvents();
+
+    QString m_program;
+    QStringList m_arguments;
+    QProcess* m_process;
+    SttSession m_session;
+    int m_restarts = 0;
+};
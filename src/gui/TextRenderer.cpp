@@ -1,8 +1,9 @@
 #include "TextRenderer.h"
-#include "Renderer.h" 
-#include <iostream>
+#include "core/Logger.h"
 #include <QVector2D>
 #include <QMatrix4x4>
+#include <algorithm>
+#include <cstddef>
 
 const char* vertexShaderSource = R"(
 #version 330 core
@@ -33,7 +34,57 @@ void main()
 }
 )";
 
-TextRenderer::TextRenderer() : m_shaderProgram(nullptr), m_vao(0), m_vbo(0) {
+const char* karaokeVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec4 vertex;
+layout (location = 1) in vec3 timing;
+out vec2 TexCoords;
+out float Progress;
+out float Fraction;
+
+uniform mat4 projection;
+uniform vec2 origin;
+uniform float scale;
+uniform float time;
+
+void main()
+{
+    gl_Position = projection * vec4(origin + vertex.xy * scale, 0.0, 1.0);
+    TexCoords = vertex.zw;
+    Progress = clamp((time - timing.x) / max(timing.y - timing.x, 0.001), 0.0, 1.0);
+    Fraction = timing.z;
+}
+)";
+
+const char* karaokeFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoords;
+in float Progress;
+in float Fraction;
+out vec4 color;
+
+uniform sampler2D atlas;
+uniform vec3 baseColor;
+uniform vec3 highlightColor;
+
+void main()
+{
+    // Soft edge a few percent of the word wide.
+    float lit = clamp((Progress - Fraction) * 25.0 + 0.5, 0.0, 1.0);
+    if (Progress >= 1.0) {
+        lit = 1.0;
+    }
+    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(atlas, TexCoords).r);
+    color = vec4(mix(baseColor, highlightColor, lit), 1.0) * sampled;
+}
+)";
+
+namespace {
+    const int ATLAS_WIDTH = 1024;
+    const int ATLAS_PADDING = 1;
+}
+
+TextRenderer::TextRenderer() : m_ft(nullptr), m_face(nullptr), m_shaderProgram(nullptr), m_vao(0), m_vbo(0) {
 }
 
 TextRenderer::~TextRenderer()
@@ -41,60 +92,77 @@ TextRenderer::~TextRenderer()
     if (m_shaderProgram) {
         delete m_shaderProgram;
     }
-    FT_Done_Face(m_face);
-    FT_Done_FreeType(m_ft);
+    delete m_karaokeProgram;
+    if (m_face) {
+        FT_Done_Face(m_face);
+    }
+    if (m_ft) {
+        FT_Done_FreeType(m_ft);
+    }
 }
 
-void TextRenderer::cleanup(Renderer* renderer)
+void TextRenderer::cleanup(QOpenGLFunctions_3_3_Core* gl)
 {
-    renderer->glDeleteVertexArrays(1, &m_vao);
-    renderer->glDeleteBuffers(1, &m_vbo);
+    gl->glDeleteVertexArrays(1, &m_vao);
+    gl->glDeleteBuffers(1, &m_vbo);
+    if (m_atlasTexture) {
+        gl->glDeleteTextures(1, &m_atlasTexture);
+        m_atlasTexture = 0;
+    }
 }
 
-void TextRenderer::initialize(Renderer* renderer, const std::string& fontPath, int fontSize)
+void TextRenderer::initialize(QOpenGLFunctions_3_3_Core* gl, const std::string& fontPath, int fontSize)
 {
     if (FT_Init_FreeType(&m_ft)) {
-        std::cerr << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        logError(LogCategory::Text, "Could not init FreeType library");
         return;
     }
 
-    loadFont(renderer, fontPath, fontSize);
+    loadFont(gl, fontPath, fontSize);
 
     m_shaderProgram = new QOpenGLShaderProgram();
     m_shaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource);
     m_shaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource);
     m_shaderProgram->link();
 
-    renderer->glGenVertexArrays(1, &m_vao);
-    renderer->glGenBuffers(1, &m_vbo);
-    renderer->glBindVertexArray(m_vao);
-    renderer->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    renderer->glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    renderer->glEnableVertexAttribArray(0);
-    renderer->glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    renderer->glBindBuffer(GL_ARRAY_BUFFER, 0);
-    renderer->glBindVertexArray(0);
+    m_karaokeProgram = new QOpenGLShaderProgram();
+    m_karaokeProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, karaokeVertexShaderSource);
+    m_karaokeProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, karaokeFragmentShaderSource);
+    m_karaokeProgram->link();
+
+    gl->glGenVertexArrays(1, &m_vao);
+    gl->glGenBuffers(1, &m_vbo);
+    gl->glBindVertexArray(m_vao);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    gl->glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    gl->glEnableVertexAttribArray(0);
+    gl->glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gl->glBindVertexArray(0);
 }
 
-void TextRenderer::loadFont(Renderer* renderer, const std::string& fontPath, int fontSize)
+void TextRenderer::loadFont(QOpenGLFunctions_3_3_Core* gl, const std::string& fontPath, int fontSize)
 {
     if (FT_New_Face(m_ft, fontPath.c_str(), 0, &m_face)) {
-        std::cerr << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        logError(LogCategory::Text, "Failed to load font: " + fontPath);
         return;
     }
 
     FT_Set_Pixel_Sizes(m_face, 0, fontSize);
-    renderer->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gl->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    m_metrics = FontMetrics();
+    m_metrics.setLineHeight(static_cast<float>(m_face->size->metrics.height >> 6));
+    std::vector<GlyphBitmap> bitmaps;
 
     for (unsigned char c = 0; c < 128; c++) {
         if (FT_Load_Char(m_face, c, FT_LOAD_RENDER)) {
-            std::cerr << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            logWarning(LogCategory::Text, "Failed to load glyph " + std::to_string(c));
             continue;
         }
         unsigned int texture;
-        renderer->glGenTextures(1, &texture);
-        renderer->glBindTexture(GL_TEXTURE_2D, texture);
-        renderer->glTexImage2D(
+        gl->glGenTextures(1, &texture);
+        gl->glBindTexture(GL_TEXTURE_2D, texture);
+        gl->glTexImage2D(
             GL_TEXTURE_2D,
             0,
             GL_RED,
@@ -105,10 +173,10 @@ void TextRenderer::loadFont(Renderer* renderer, const std::string& fontPath, int
             GL_UNSIGNED_BYTE,
             m_face->glyph->bitmap.buffer
         );
-        renderer->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        renderer->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        renderer->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        renderer->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         Character character = {
             texture,
@@ -117,43 +185,87 @@ void TextRenderer::loadFont(Renderer* renderer, const std::string& fontPath, int
             static_cast<unsigned int>(m_face->glyph->advance.x)
         };
         m_characters.insert(std::pair<char, Character>(c, character));
+
+        GlyphMetrics metrics;
+        metrics.width = static_cast<float>(m_face->glyph->bitmap.width);
+        metrics.height = static_cast<float>(m_face->glyph->bitmap.rows);
+        metrics.bearingX = static_cast<float>(m_face->glyph->bitmap_left);
+        metrics.bearingY = static_cast<float>(m_face->glyph->bitmap_top);
+        metrics.advance = static_cast<float>(m_face->glyph->advance.x >> 6);
+        m_metrics.setGlyph(c, metrics);
+
+        const FT_Bitmap& bitmap = m_face->glyph->bitmap;
+        GlyphBitmap copy = {c, static_cast<int>(bitmap.width), static_cast<int>(bitmap.rows), {}};
+        copy.pixels.resize(static_cast<size_t>(copy.width) * copy.rows);
+        for (int row = 0; row < copy.rows; ++row) {
+            std::copy_n(bitmap.buffer + row * bitmap.pitch, copy.width, copy.pixels.data() + row * copy.width);
+        }
+        bitmaps.push_back(std::move(copy));
     }
-    renderer->glBindTexture(GL_TEXTURE_2D, 0);
+    buildAtlas(gl, bitmaps);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-QRectF TextRenderer::getTextBounds(const std::string& text, float scale)
+void TextRenderer::buildAtlas(QOpenGLFunctions_3_3_Core* gl, const std::vector<GlyphBitmap>& glyphs)
 {
-    float x = 0;
-    float y = 0;
-    float minX = 0, maxX = 0, minY = 0, maxY = 0;
-    float line_height = (m_face->size->metrics.height >> 6) * scale;
-
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) {
-        if (*c == '\n') {
-            y -= line_height;
-            x = 0;
-            continue;
+    // Shelf packing in glyph order; 128 ASCII glyphs fit in a few rows.
+    struct Placement { int x, y; };
+    std::vector<Placement> placements(glyphs.size());
+    int x = ATLAS_PADDING, y = ATLAS_PADDING, shelfHeight = 0;
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        if (x + glyphs[i].width + ATLAS_PADDING > ATLAS_WIDTH) {
+            x = ATLAS_PADDING;
+            y += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
         }
+        placements[i] = {x, y};
+        x += glyphs[i].width + ATLAS_PADDING;
+        shelfHeight = std::max(shelfHeight, glyphs[i].rows);
+    }
+    int atlasHeight = 1;
+    while (atlasHeight < y + shelfHeight + ATLAS_PADDING) {
+        atlasHeight *= 2;
+    }
 
-        Character ch = m_characters[*c];
-        float xpos = x + ch.bearing.x() * scale;
-        float ypos = y - (ch.size.y() - ch.bearing.y()) * scale;
-        float w = ch.size.x() * scale;
-        float h = ch.size.y() * scale;
-
-        if (xpos < minX) minX = xpos;
-        if (xpos + w > maxX) maxX = xpos + w;
-        if (ypos < minY) minY = ypos;
-        if (ypos + h > maxY) maxY = ypos + h;
+    std::vector<unsigned char> pixels(static_cast<size_t>(ATLAS_WIDTH) * atlasHeight, 0);
+    m_atlasRects.fill(GlyphAtlasRect());
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        const GlyphBitmap& glyph = glyphs[i];
+        for (int row = 0; row < glyph.rows; ++row) {
+            std::copy_n(glyph.pixels.data() + row * glyph.width, glyph.width,
+                        pixels.data() + static_cast<size_t>(placements[i].y + row) * ATLAS_WIDTH + placements[i].x);
+        }
+        m_atlasRects[glyph.c] = {
+            static_cast<float>(placements[i].x) / ATLAS_WIDTH,
+            static_cast<float>(placements[i].y) / atlasHeight,
+            static_cast<float>(placements[i].x + glyph.width) / ATLAS_WIDTH,
+            static_cast<float>(placements[i].y + glyph.rows) / atlasHeight
+        };
+    }
 
-        x += (ch.advance >> 6) * scale;
+    if (!m_atlasTexture) {
+        gl->glGenTextures(1, &m_atlasTexture);
     }
+    gl->glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+std::string TextRenderer::wrapText(const std::string& text, float scale, float maxWidth)
+{
+    return m_lineBreaker.wrap(text, m_metrics, scale, maxWidth);
+}
 
-    return QRectF(minX, minY, maxX - minX, maxY - minY);
+QRectF TextRenderer::getTextBounds(const std::string& text, float scale)
+{
+    TextBounds bounds = m_metrics.measure(text, scale);
+    return QRectF(bounds.x, bounds.y, bounds.width, bounds.height);
 }
 
-void TextRenderer::renderText(Renderer* renderer, const std::string& text, float x, float y, float scale, const QVector3D& color, float windowWidth, float windowHeight)
+void TextRenderer::renderText(QOpenGLFunctions_3_3_Core* gl, const std::string& text, float x, float y, float scale, const QVector3D& color, float windowWidth, float windowHeight)
 {
     QMatrix4x4 projection;
     projection.ortho(0.0f, windowWidth, 0.0f, windowHeight, -1.0f, 1.0f);
@@ -161,8 +273,8 @@ void TextRenderer::renderText(Renderer* renderer, const std::string& text, float
     m_shaderProgram->bind();
     m_shaderProgram->setUniformValue("projection", projection);
     m_shaderProgram->setUniformValue("textColor", color);
-    renderer->glActiveTexture(GL_TEXTURE0);
-    renderer->glBindVertexArray(m_vao);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindVertexArray(m_vao);
 
     float initialX = x;
     float line_height = (m_face->size->metrics.height >> 6) * scale;
@@ -193,14 +305,71 @@ void TextRenderer::renderText(Renderer* renderer, const std::string& text, float
             { xpos + w, ypos + h,   1.0f, 0.0f }
         };
 
-        renderer->glBindTexture(GL_TEXTURE_2D, ch.textureID);
-        renderer->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-        renderer->glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        renderer->glBindBuffer(GL_ARRAY_BUFFER, 0);
-        renderer->glDrawArrays(GL_TRIANGLES, 0, 6);
+        gl->glBindTexture(GL_TEXTURE_2D, ch.textureID);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        gl->glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gl->glDrawArrays(GL_TRIANGLES, 0, 6);
         x += (ch.advance >> 6) * scale;
     }
-    renderer->glBindVertexArray(0);
-    renderer->glBindTexture(GL_TEXTURE_2D, 0);
+    gl->glBindVertexArray(0);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
     m_shaderProgram->release();
 }
+
+void TextRenderer::buildKaraoke(QOpenGLFunctions_3_3_Core* gl, KaraokeText& karaoke, const std::string& text, const LyricLine& line)
+{
+    const std::vector<KaraokeVertex> vertices = KaraokeLayout::build(text, line, m_metrics, m_atlasRects);
+    if (!karaoke.vao) {
+        gl->glGenVertexArrays(1, &karaoke.vao);
+        gl->glGenBuffers(1, &karaoke.vbo);
+        gl->glBindVertexArray(karaoke.vao);
+        gl->glBindBuffer(GL_ARRAY_BUFFER, karaoke.vbo);
+        gl->glEnableVertexAttribArray(0);
+        gl->glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(KaraokeVertex), reinterpret_cast<void*>(offsetof(KaraokeVertex, x)));
+        gl->glEnableVertexAttribArray(1);
+        gl->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(KaraokeVertex), reinterpret_cast<void*>(offsetof(KaraokeVertex, startTime)));
+        gl->glBindVertexArray(0);
+    }
+    gl->glBindBuffer(GL_ARRAY_BUFFER, karaoke.vbo);
+    gl->glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(KaraokeVertex), vertices.data(), GL_STATIC_DRAW);
+    gl->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    karaoke.vertexCount = static_cast<int>(vertices.size());
+    karaoke.bounds = m_metrics.measure(text, 1.0f);
+}
+
+void TextRenderer::renderKaraoke(QOpenGLFunctions_3_3_Core* gl, const KaraokeText& karaoke, float x, float y, float scale,
+                                 double time, const QVector3D& baseColor, const QVector3D& highlightColor,
+                                 float windowWidth, float windowHeight)
+{
+    if (!karaoke.vao || karaoke.vertexCount == 0 || !m_karaokeProgram) {
+        return;
+    }
+    QMatrix4x4 projection;
+    projection.ortho(0.0f, windowWidth, 0.0f, windowHeight, -1.0f, 1.0f);
+
+    m_karaokeProgram->bind();
+    m_karaokeProgram->setUniformValue("projection", projection);
+    m_karaokeProgram->setUniformValue("origin", QVector2D(x, y));
+    m_karaokeProgram->setUniformValue("scale", scale);
+    m_karaokeProgram->setUniformValue("time", static_cast<float>(time));
+    m_karaokeProgram->setUniformValue("baseColor", baseColor);
+    m_karaokeProgram->setUniformValue("highlightColor", highlightColor);
+    m_karaokeProgram->setUniformValue("atlas", 0);
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    gl->glBindVertexArray(karaoke.vao);
+    gl->glDrawArrays(GL_TRIANGLES, 0, karaoke.vertexCount);
+    gl->glBindVertexArray(0);
+    gl->glBindTexture(GL_TEXTURE_2D, 0);
+    m_karaokeProgram->release();
+}
+
+void TextRenderer::releaseKaraoke(QOpenGLFunctions_3_3_Core* gl, KaraokeText& karaoke)
+{
+    if (karaoke.vao) {
+        gl->glDeleteVertexArrays(1, &karaoke.vao);
+        gl->glDeleteBuffers(1, &karaoke.vbo);
+    }
+    karaoke = KaraokeText();
+}
@@ -5,11 +5,24 @@
 
 #include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLShaderProgram>
+#include <array>
 #include <string>
 #include <map>
+#include <vector>
 #include <QRectF>
+#include "core/lyrics/Lyrics.h"
+#include "core/text/FontMetrics.h"
+#include "core/text/KaraokeLayout.h"
+#include "core/text/LineBreaker.h"
 
-class Renderer;
+// GPU mesh of one karaoke line, built by TextRenderer::buildKaraoke.
+struct KaraokeText {
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    int vertexCount = 0;
+    // Bounds at scale 1, for placing the line.
+    TextBounds bounds;
+};
 
 class TextRenderer
 {
@@ -17,10 +30,25 @@ public:
     TextRenderer();
     ~TextRenderer();
 
-    void initialize(Renderer* renderer, const std::string& fontPath, int fontSize);
-    void renderText(Renderer* renderer, const std::string& text, float x, float y, float scale, const QVector3D& color, float windowWidth, float windowHeight);
+    void initialize(QOpenGLFunctions_3_3_Core* gl, const std::string& fontPath, int fontSize);
+    void renderText(QOpenGLFunctions_3_3_Core* gl, const std::string& text, float x, float y, float scale, const QVector3D& color, float windowWidth, float windowHeight);
     QRectF getTextBounds(const std::string& text, float scale);
-    void cleanup(Renderer* renderer);
+    const FontMetrics& metrics() const { return m_metrics; }
+    // Balanced line breaks from real glyph advances; cached, so it is cheap
+    // to call with unchanged text every frame.
+    std::string wrapText(const std::string& text, float scale, float maxWidth);
+    void cleanup(QOpenGLFunctions_3_3_Core* gl);
+
+    // Karaoke mode: the line's mesh is uploaded once, with word timings as
+    // vertex attributes, and drawn from the glyph atlas in a single call.
+    // The highlight sweep is computed in the shader from `time`, so nothing
+    // is laid out again while the line is shown. `text` is the (wrapped)
+    // text of `line`.
+    void buildKaraoke(QOpenGLFunctions_3_3_Core* gl, KaraokeText& karaoke, const std::string& text, const LyricLine& line);
+    void renderKaraoke(QOpenGLFunctions_3_3_Core* gl, const KaraokeText& karaoke, float x, float y, float scale,
+                       double time, const QVector3D& baseColor, const QVector3D& highlightColor,
+                       float windowWidth, float windowHeight);
+    void releaseKaraoke(QOpenGLFunctions_3_3_Core* gl, KaraokeText& karaoke);
 private:
     struct Character {
         unsigned int textureID;
@@ -29,12 +57,27 @@ private:
         unsigned int advance;
     };
 
-    void loadFont(Renderer* renderer, const std::string& fontPath, int fontSize);
+    struct GlyphBitmap {
+        unsigned char c;
+        int width;
+        int rows;
+        std::vector<unsigned char> pixels;
+    };
+
+    void loadFont(QOpenGLFunctions_3_3_Core* gl, const std::string& fontPath, int fontSize);
+    void buildAtlas(QOpenGLFunctions_3_3_Core* gl, const std::vector<GlyphBitmap>& glyphs);
 
     FT_Library m_ft;
     FT_Face m_face;
     std::map<char, Character> m_characters;
+    FontMetrics m_metrics;
+    LineBreaker m_lineBreaker;
 
     QOpenGLShaderProgram* m_shaderProgram;
     unsigned int m_vao, m_vbo;
+
+    // All glyphs in one texture, for the single-draw karaoke path.
+    unsigned int m_atlasTexture = 0;
+    std::array<GlyphAtlasRect, 256> m_atlasRects{};
+    QOpenGLShaderProgram* m_karaokeProgram = nullptr;
 };
@@ -0,0 +1,153 @@
+#include "TrackOverviewView.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const double WAVEFORM_SHARE = 0.6;
+    const double ZOOM_PER_NOTCH = 1.25;
+    const int PAN_THRESHOLD_PX = 4;
+    // Zooming in stops with this many finest-level bins (about 0.1 s) in view.
+    const uint64_t MIN_VIEW_BINS = 16;
+}
+
+TrackOverviewView::TrackOverviewView(QWidget* parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(120);
+}
+
+void TrackOverviewView::setOverview(std::shared_ptr<const TrackOverview> overview)
+{
+    m_overview = std::move(overview);
+    m_viewStart = 0;
+    m_viewFrames = m_overview ? m_overview->frameCount() : 0;
+    update();
+}
+
+void TrackOverviewView::setPosition(double seconds)
+{
+    if (seconds == m_position) {
+        return;
+    }
+    m_position = seconds;
+    update();
+}
+
+uint64_t TrackOverviewView::frameAt(double x) const
+{
+    const double fraction = std::clamp(x / std::max(1, width()), 0.0, 1.0);
+    return m_viewStart + static_cast<uint64_t>(fraction * m_viewFrames);
+}
+
+void TrackOverviewView::clampView()
+{
+    const uint64_t total = m_overview ? m_overview->frameCount() : 0;
+    const uint64_t minimum = std::min<uint64_t>(total, TrackOverview::BASE_FRAMES * MIN_VIEW_BINS);
+    m_viewFrames = std::clamp(m_viewFrames, minimum, total);
+    m_viewStart = std::min(m_viewStart, total - m_viewFrames);
+}
+
+void TrackOverviewView::paintEvent(QPaintEvent*)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(18, 18, 24));
+    if (!m_overview || m_overview->empty() || m_viewFrames == 0 || width() <= 0) {
+        return;
+    }
+
+    const int columns = width();
+    const uint64_t viewEnd = m_viewStart + m_viewFrames;
+    const int waveHeight = static_cast<int>(height() * WAVEFORM_SHARE);
+    const int spectrumHeight = height() - waveHeight;
+
+    // Spectrogram: one image column per pixel, low bands at the bottom,
+    // scaled to the strip below the waveform.
+    m_bands.resize(static_cast<size_t>(columns) * TrackOverview::SPECTRUM_BANDS);
+    m_overview->spectrogram(m_viewStart, viewEnd, m_bands.data(), columns);
+    if (m_spectrum.width() != columns) {
+        m_spectrum = QImage(columns, TrackOverview::SPECTRUM_BANDS, QImage::Format_RGB32);
+    }
+    for (int band = 0; band < TrackOverview::SPECTRUM_BANDS; ++band) {
+        QRgb* line = reinterpret_cast<QRgb*>(m_spectrum.scanLine(TrackOverview::SPECTRUM_BANDS - 1 - band));
+        for (int x = 0; x < columns; ++x) {
+            const int level = m_bands[static_cast<size_t>(x) * TrackOverview::SPECTRUM_BANDS + band];
+            line[x] = qRgb(level, level * level / 400, std::min(255, 40 + level / 2));
+        }
+    }
+    painter.drawImage(QRect(0, waveHeight, columns, spectrumHeight), m_spectrum);
+
+    // Waveform: the min/max envelope, with RMS drawn brighter inside it.
+    m_bins.resize(columns);
+    m_overview->waveform(m_viewStart, viewEnd, m_bins.data(), columns);
+    const double centre = waveHeight / 2.0;
+    const double scale = centre / 32768.0;
+    painter.setPen(QColor(70, 110, 160));
+    for (int x = 0; x < columns; ++x) {
+        painter.drawLine(QPointF(x + 0.5, centre - m_bins[x].max * scale),
+                         QPointF(x + 0.5, centre - m_bins[x].min * scale));
+    }
+    painter.setPen(QColor(140, 190, 240));
+    for (int x = 0; x < columns; ++x) {
+        const double rms = std::sqrt(m_bins[x].meanSquare) * centre;
+        painter.drawLine(QPointF(x + 0.5, centre - rms), QPointF(x + 0.5, centre + rms));
+    }
+
+    const double playhead = (m_position * m_overview->sampleRate() - static_cast<double>(m_viewStart)) /
+                            static_cast<double>(m_viewFrames) * columns;
+    if (playhead >= 0.0 && playhead <= columns) {
+        painter.setPen(QColor(255, 217, 77));
+        painter.drawLine(QPointF(playhead, 0), QPointF(playhead, height()));
+    }
+}
+
+void TrackOverviewView::wheelEvent(QWheelEvent* event)
+{
+    if (!m_overview || m_viewFrames == 0) {
+        return;
+    }
+    // Zoom about the frame under the cursor, so it stays put.
+    const double x = event->position().x();
+    const uint64_t anchor = frameAt(x);
+    const double notches = event->angleDelta().y() / 120.0;
+    m_viewFrames = static_cast<uint64_t>(m_viewFrames * std::pow(ZOOM_PER_NOTCH, -notches));
+    clampView();
+    const uint64_t offset = static_cast<uint64_t>(x / std::max(1, width()) * m_viewFrames);
+    m_viewStart = anchor > offset ? anchor - offset : 0;
+    clampView();
+    update();
+    event->accept();
+}
+
+void TrackOverviewView::mousePressEvent(QMouseEvent* event)
+{
+    m_pressPos = event->position().toPoint();
+    m_pressViewStart = m_viewStart;
+    m_panning = false;
+}
+
+void TrackOverviewView::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || !m_overview) {
+        return;
+    }
+    const int dx = event->position().toPoint().x() - m_pressPos.x();
+    m_panning = m_panning || std::abs(dx) > PAN_THRESHOLD_PX;
+    if (!m_panning) {
+        return;
+    }
+    const int64_t shift = static_cast<int64_t>(static_cast<double>(dx) / std::max(1, width()) * m_viewFrames);
+    m_viewStart = static_cast<uint64_t>(std::max<int64_t>(0, static_cast<int64_t>(m_pressViewStart) - shift));
+    clampView();
+    update();
+}
+
+void TrackOverviewView::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (!m_panning && m_overview && event->button() == Qt::LeftButton) {
+        emit seekRequested(static_cast<double>(frameAt(event->position().x())) / m_overview->sampleRate());
+    }
+    m_panning = false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QImage>
+#include <QWidget>
+#include <memory>
+#include <vector>
+#include "core/audio/TrackOverview.h"
+
+// Timeline of the current track: min/max/RMS waveform over a spectrogram,
+// with the playhead. The wheel zooms around the cursor, dragging pans and a
+// click seeks. Every repaint queries the overview pyramid for exactly one
+// column per pixel, so any zoom level costs the same.
+class TrackOverviewView : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit TrackOverviewView(QWidget* parent = nullptr);
+
+    // Null clears the view.
+    void setOverview(std::shared_ptr<const TrackOverview> overview);
+    void setPosition(double seconds);
+
+signals:
+    void seekRequested(double seconds);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private:
+    uint64_t frameAt(double x) const;
+    void clampView();
+
+    std::shared_ptr<const TrackOverview> m_overview;
+    uint64_t m_viewStart{0};
+    uint64_t m_viewFrames{0};
+    double m_position{0.0};
+
+    // A press becomes a seek on release unless the mouse moved far enough
+    // to count as a pan.
+    QPoint m_pressPos;
+    uint64_t m_pressViewStart{0};
+    bool m_panning{false};
+
+    std::vector<WaveformBin> m_bins;
+    std::vector<uint8_t> m_bands;
+    QImage m_spectrum;
+};
@@ -1,29 +1,49 @@
 #include <QApplication>
+#include <QGuiApplication>
 #include "gui/MainWindow.h"
 #include "cxxopts.hpp"
 #include <iostream>
 #include "core/Config.h"
+#include "core/ConfigStore.h"
+#include "core/Logger.h"
+#include "core/MappedFile.h"
+#include "core/audio/AudioEngine.h"
+#include "core/lyrics/LyricAligner.h"
+#include "core/lyrics/LyricImport.h"
+#include <fstream>
+#include <memory>
+#include "gui/PresetAtlasJob.h"
+#include <thread>
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
-    Config config;
-
+    // Parsed before the application object, whose type depends on the mode;
+    // defaults from config.ini are applied once Qt can locate the file.
     cxxopts::Options options("AuroraVisualizer", "A highly-customizable audio visualizer.");
+    options.allow_unrecognised_options();
     options.add_options()
         ("d,default-preset", "Start with the default preset and disable shuffle", cxxopts::value<bool>()->default_value("false"))
         ("a,artist", "Set the artist name", cxxopts::value<std::string>()->default_value(""))
         ("u,url", "Set a static URL to display", cxxopts::value<std::string>()->default_value(""))
-        ("f,font", "Set the font path", cxxopts::value<std::string>()->default_value(config.fontPath().toStdString()))
-        ("font-size", "Set the font size", cxxopts::value<int>()->default_value(std::to_string(config.fontSize())))
-        ("title-line-length", "Set the target line length for song titles", cxxopts::value<int>()->default_value(std::to_string(config.titleLineLengthTarget())))
-        ("title-color-r", "Set the red component of the title color", cxxopts::value<float>()->default_value(std::to_string(config.titleColor().redF())))
-        ("title-color-g", "Set the green component of the title color", cxxopts::value<float>()->default_value(std::to_string(config.titleColor().greenF())))
-        ("title-color-b", "Set the blue component of the title color", cxxopts::value<float>()->default_value(std::to_string(config.titleColor().blueF())))
-        ("title-opacity", "Set the opacity of the title", cxxopts::value<float>()->default_value(std::to_string(config.titleColor().alphaF())))
-        ("fade-duration", "Set the fade duration for animations", cxxopts::value<float>()->default_value(std::to_string(config.animationFadeDuration())))
-        ("bounce-duration", "Set the bounce duration for the title animation", cxxopts::value<float>()->default_value(std::to_string(config.animationBounceDuration())))
-        ("target-alpha", "Set the target alpha for the title animation", cxxopts::value<float>()->default_value(std::to_string(config.animationTargetAlpha())))
+        ("f,font", "Set the font path (default: from config.ini)", cxxopts::value<std::string>())
+        ("font-size", "Set the font size (default: from config.ini)", cxxopts::value<int>())
+        ("title-line-length", "Set the target line length for song titles (default: from config.ini)", cxxopts::value<int>())
+        ("title-color-r", "Set the red component of the title color (default: from config.ini)", cxxopts::value<float>())
+        ("title-color-g", "Set the green component of the title color (default: from config.ini)", cxxopts::value<float>())
+        ("title-color-b", "Set the blue component of the title color (default: from config.ini)", cxxopts::value<float>())
+        ("title-opacity", "Set the opacity of the title (default: from config.ini)", cxxopts::value<float>())
+        ("fade-duration", "Set the fade duration for animations (default: from config.ini)", cxxopts::value<float>())
+        ("bounce-duration", "Set the bounce duration for the title animation (default: from config.ini)", cxxopts::value<float>())
+        ("target-alpha", "Set the target alpha for the title animation (default: from config.ini)", cxxopts::value<float>())
+        ("build-preset-atlas", "Render preview atlases for all presets into the given directory and exit", cxxopts::value<std::string>())
+        ("atlas-clip", "Reference audio clip used to drive preset previews", cxxopts::value<std::string>()->default_value(""))
+        ("atlas-workers", "Number of worker processes for the preset atlas", cxxopts::value<int>()->default_value(std::to_string(std::max(1u, std::thread::hardware_concurrency()))))
+        ("atlas-seconds", "Seconds rendered per preset preview", cxxopts::value<float>()->default_value("3.0"))
+        ("atlas-shard", "Internal: render one shard of the preset atlas", cxxopts::value<int>()->default_value("-1"))
+        ("atlas-shard-count", "Internal: total number of preset atlas shards", cxxopts::value<int>()->default_value("1"))
+        ("align-lyrics", "Time the plain-text lyrics in the given file against --align-audio, write LRC and exit", cxxopts::value<std::string>())
+        ("align-audio", "Audio file for --align-lyrics", cxxopts::value<std::string>()->default_value(""))
+        ("align-output", "LRC file written by --align-lyrics (default: stdout)", cxxopts::value<std::string>()->default_value(""))
         ("h,help", "Print usage")
     ;
 
@@ -35,12 +55,64 @@ int main(int argc, char *argv[])
       exit(0);
     }
 
+    // The preset atlas renders into offscreen GL surfaces and must not need
+    // a display, so its platform is fixed before the application is built.
+    std::unique_ptr<QCoreApplication> app;
+    if (result.count("build-preset-atlas")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        app = std::make_unique<QGuiApplication>(argc, argv);
+    } else if (result.count("align-lyrics")) {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QApplication>(argc, argv);
+    }
+    ConfigStore configStore;
+    Config config;
+    Logger::instance().openFile(config.logFilePath().toStdString());
+
+    if (result.count("build-preset-atlas"))
+    {
+        PresetAtlasJob::Options atlasOptions;
+        atlasOptions.outputDir = result["build-preset-atlas"].as<std::string>();
+        atlasOptions.clipPath = result["atlas-clip"].as<std::string>();
+        atlasOptions.presetDir = config.presetDirectory().toStdString();
+        atlasOptions.featuresPath = config.presetFeaturesPath().toStdString();
+        atlasOptions.workers = result["atlas-workers"].as<int>();
+        atlasOptions.secondsPerPreset = result["atlas-seconds"].as<float>();
+        atlasOptions.shard = result["atlas-shard"].as<int>();
+        atlasOptions.shardCount = result["atlas-shard-count"].as<int>();
+        return PresetAtlasJob(atlasOptions).run();
+    }
+
+    if (result.count("align-lyrics"))
+    {
+        const std::string textPath = result["align-lyrics"].as<std::string>();
+        const std::string audioPath = result["align-audio"].as<std::string>();
+        MappedFile text;
+        std::vector<short> pcm;
+        int sampleRate = 0;
+        if (!text.open(textPath) || !AudioEngine::decodeFile(audioPath, pcm, sampleRate)) {
+            std::cerr << "Cannot read " << textPath << " or decode " << audioPath << std::endl;
+            return 1;
+        }
+        const std::string lrc = LyricImport::formatLrc(
+            LyricAligner::align(text.view(), pcm.data(), pcm.size() / 2, sampleRate, LyricAligner::Options()));
+        const std::string outputPath = result["align-output"].as<std::string>();
+        if (outputPath.empty()) {
+            std::cout << lrc;
+            return 0;
+        }
+        std::ofstream output(outputPath, std::ios::binary);
+        output << lrc;
+        return output ? 0 : 1;
+    }
+
     bool use_default_preset = result["default-preset"].as<bool>();
     std::string artist = result["artist"].as<std::string>();
     std::string url = result["url"].as<std::string>();
-    std::string font_path = result["font"].as<std::string>();
+    std::string font_path = result.count("font") ? result["font"].as<std::string>() : config.fontPath().toStdString();
 
     MainWindow window(use_default_preset, artist, url, font_path, nullptr);
     window.show();
-    return app.exec();
+    return app->exec();
 }
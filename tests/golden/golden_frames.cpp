@@ -0,0 +1,401 @@
+// Headless golden-frame check of the render pipeline: projectM through the
+// compositor plus the text overlay, driven by a deterministic clip at a fixed
+// virtual timestep. Selected frames are hashed and, when the hash differs,
+// compared perceptually against the stored goldens. Per-frame timings are
+// reported alongside so performance work can be checked in the same run.
+//
+// Exit codes: 0 pass, 1 mismatch or error, 77 skipped (no goldens, GL or font).
+
+#include "cxxopts.hpp"
+#include "core/FrameCompare.h"
+#include "core/animation/TitleAnimation.h"
+#include "core/audio/AudioEngine.h"
+#include "gui/Compositor.h"
+#include "gui/TextRenderer.h"
+#include <libprojectM/projectM.hpp>
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLVersionFunctionsFactory>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+namespace {
+    const int EXIT_SKIPPED = 77;
+    const int SAMPLE_RATE = 44100;
+    const size_t PCM_CHUNK_FRAMES = 512;
+
+    // Kick on every beat at 120 BPM, a sustained chord and LCG noise hats.
+    std::vector<short> syntheticClip(double seconds, unsigned int seed) {
+        const size_t frames = static_cast<size_t>(seconds * SAMPLE_RATE);
+        std::vector<short> pcm(frames * 2);
+        uint32_t noise = seed * 2654435761u + 1u;
+        for (size_t i = 0; i < frames; ++i) {
+            const double t = static_cast<double>(i) / SAMPLE_RATE;
+            const double beat = std::fmod(t, 0.5);
+            const double kick = std::exp(-beat * 18.0) * std::sin(2.0 * M_PI * 55.0 * beat);
+            const double chord = 0.15 * (std::sin(2.0 * M_PI * 220.0 * t) + std::sin(2.0 * M_PI * 277.2 * t)
+                                         + std::sin(2.0 * M_PI * 329.6 * t));
+            noise = noise * 1664525u + 1013904223u;
+            const double hat = std::fmod(t, 0.25) < 0.02 ? 0.2 * ((noise >> 16) / 32768.0 - 1.0) : 0.0;
+            const double left = 0.6 * kick + chord + hat;
+            const double right = 0.6 * kick + chord - hat;
+            pcm[i * 2] = static_cast<short>(std::clamp(left, -1.0, 1.0) * 32000.0);
+            pcm[i * 2 + 1] = static_cast<short>(std::clamp(right, -1.0, 1.0) * 32000.0);
+        }
+        return pcm;
+    }
+
+    std::vector<int> parseFrameList(const std::string& list) {
+        std::vector<int> frames;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                frames.push_back(std::stoi(item));
+            }
+        }
+        std::sort(frames.begin(), frames.end());
+        return frames;
+    }
+
+    std::string findFont(const std::string& requested) {
+        std::vector<std::string> candidates = {
+            requested,
+            "/usr/share/fonts/TTF/DejaVuSans.ttf",
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+        };
+        for (const std::string& path : candidates) {
+            if (!path.empty() && QFileInfo::exists(QString::fromStdString(path))) {
+                return path;
+            }
+        }
+        return std::string();
+    }
+
+    void flipRows(std::vector<unsigned char>& rgba, int width, int height) {
+        const size_t stride = static_cast<size_t>(width) * 4;
+        std::vector<unsigned char> row(stride);
+        for (int y = 0; y < height / 2; ++y) {
+            unsigned char* top = rgba.data() + y * stride;
+            unsigned char* bottom = rgba.data() + (height - 1 - y) * stride;
+            std::copy(top, top + stride, row.begin());
+            std::copy(bottom, bottom + stride, top);
+            std::copy(row.begin(), row.end(), bottom);
+        }
+    }
+
+    QString frameFileName(const QString& dir, const char* prefix, int frame) {
+        return QDir(dir).filePath(QString::asprintf("%s_%04d.png", prefix, frame));
+    }
+
+    bool saveFrame(const QString& path, const std::vector<unsigned char>& rgba, int width, int height) {
+        QImage image(rgba.data(), width, height, width * 4, QImage::Format_RGBA8888);
+        return image.save(path);
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t index = static_cast<size_t>(std::min<double>(values.size() - 1, p * values.size()));
+        return values[index];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    cxxopts::Options options("AuroraGolden", "Golden-frame regression check for the render pipeline.");
+    options.add_options()
+        ("golden-dir", "Directory holding golden.tsv and frame_*.png", cxxopts::value<std::string>())
+        ("output-dir", "Where mismatching frames and diffs are written", cxxopts::value<std::string>()->default_value("golden-out"))
+        ("preset", "Preset file to render", cxxopts::value<std::string>())
+        ("clip", "Audio clip; a synthetic clip is used when empty", cxxopts::value<std::string>()->default_value(""))
+        ("font", "Font for the text overlay", cxxopts::value<std::string>()->default_value(""))
+        ("width", "Render width", cxxopts::value<int>()->default_value("320"))
+        ("height", "Render height", cxxopts::value<int>()->default_value("180"))
+        ("fps", "Virtual frame rate", cxxopts::value<int>()->default_value("30"))
+        ("frames", "Number of frames to render", cxxopts::value<int>()->default_value("120"))
+        ("capture", "Comma-separated frames to check", cxxopts::value<std::string>()->default_value("15,45,75,119"))
+        ("seed", "Seed for rand() and the synthetic clip", cxxopts::value<unsigned int>()->default_value("1"))
+        ("min-ssim", "Minimum SSIM for a non-identical frame to pass", cxxopts::value<double>()->default_value("0.97"))
+        ("min-psnr", "Minimum PSNR (dB) for a non-identical frame to pass", cxxopts::value<double>()->default_value("30"))
+        ("timing-csv", "Write per-frame timings to this file", cxxopts::value<std::string>()->default_value(""))
+        ("update", "Write new goldens instead of comparing")
+        ("h,help", "Print usage")
+    ;
+    auto result = options.parse(argc, argv);
+    if (result.count("help") || !result.count("golden-dir") || !result.count("preset")) {
+        std::cout << options.help() << std::endl;
+        return result.count("help") ? 0 : 1;
+    }
+
+    const QString goldenDir = QString::fromStdString(result["golden-dir"].as<std::string>());
+    const QString outputDir = QString::fromStdString(result["output-dir"].as<std::string>());
+    const std::string presetPath = QFileInfo(QString::fromStdString(result["preset"].as<std::string>())).absoluteFilePath().toStdString();
+    const int width = result["width"].as<int>();
+    const int height = result["height"].as<int>();
+    const int fps = result["fps"].as<int>();
+    const int frameCount = result["frames"].as<int>();
+    const std::vector<int> captureFrames = parseFrameList(result["capture"].as<std::string>());
+    const unsigned int seed = result["seed"].as<unsigned int>();
+    const bool update = result.count("update") > 0;
+
+    std::vector<GoldenFrame> goldens;
+    const std::string manifestPath = QDir(goldenDir).filePath(QString::fromStdString(FrameCompare::manifestFileName())).toStdString();
+    if (!update && !FrameCompare::loadManifest(manifestPath, goldens)) {
+        std::cout << "No goldens in " << goldenDir.toStdString() << "; run with --update to create them." << std::endl;
+        return EXIT_SKIPPED;
+    }
+
+    const std::string fontPath = findFont(result["font"].as<std::string>());
+    if (fontPath.empty()) {
+        std::cout << "No font available for the text overlay; skipping." << std::endl;
+        return EXIT_SKIPPED;
+    }
+
+    std::vector<short> clip;
+    const std::string clipPath = result["clip"].as<std::string>();
+    int clipRate = SAMPLE_RATE;
+    if (clipPath.empty()) {
+        clip = syntheticClip(static_cast<double>(frameCount) / fps + 1.0, seed);
+    } else if (!AudioEngine::decodeFile(clipPath, clip, clipRate) || clip.empty()) {
+        std::cerr << "Failed to decode clip: " << clipPath << std::endl;
+        return 1;
+    }
+
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        std::cout << "No OpenGL context available; skipping." << std::endl;
+        return EXIT_SKIPPED;
+    }
+    auto* gl = QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(&context);
+    if (!gl || !gl->initializeOpenGLFunctions()) {
+        std::cout << "OpenGL 3.3 core is not available; skipping." << std::endl;
+        return EXIT_SKIPPED;
+    }
+    std::cout << "GL renderer: " << reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER)) << std::endl;
+
+    GLuint targetFbo = 0, targetTexture = 0;
+    gl->glGenTextures(1, &targetTexture);
+    gl->glBindTexture(GL_TEXTURE_2D, targetTexture);
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    gl->glGenFramebuffers(1, &targetFbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture, 0);
+
+    std::srand(seed);
+    projectM::Settings settings;
+    settings.meshX = 32;
+    settings.meshY = 24;
+    settings.fps = fps;
+    settings.textureSize = 512;
+    settings.windowWidth = width;
+    settings.windowHeight = height;
+    settings.presetURL = QFileInfo(QString::fromStdString(presetPath)).absolutePath().toStdString();
+    settings.smoothPresetDuration = 0;
+    settings.presetDuration = 1000000;
+    settings.shuffleEnabled = false;
+    auto pm = std::make_unique<projectM>(settings);
+    pm->setPresetLock(true);
+    bool presetFound = false;
+    for (unsigned int i = 0; i < pm->getPlaylistSize(); ++i) {
+        if (pm->getPresetURL(i) == presetPath) {
+            pm->selectPreset(i, true);
+            presetFound = true;
+            break;
+        }
+    }
+    if (!presetFound) {
+        std::cerr << "Preset not found: " << presetPath << std::endl;
+        return 1;
+    }
+
+    TextRenderer textRenderer;
+    textRenderer.initialize(gl, fontPath, 24);
+
+    LyricLine karaokeLine;
+    karaokeLine.text = "and the second one";
+    karaokeLine.startTime = frameCount / 2.0 / fps;
+    karaokeLine.endTime = static_cast<double>(frameCount) / fps;
+    const double wordDuration = (karaokeLine.endTime - karaokeLine.startTime) / 4.0;
+    const char* karaokeWords[] = {"and", "the", "second", "one"};
+    for (int i = 0; i < 4; ++i) {
+        karaokeLine.words.push_back({karaokeWords[i], karaokeLine.startTime + i * wordDuration,
+                                     karaokeLine.startTime + (i + 1) * wordDuration});
+    }
+    KaraokeText karaoke;
+    textRenderer.buildKaraoke(gl, karaoke, karaokeLine.text, karaokeLine);
+
+    int frame = 0;
+    int visualizerWidth = 0, visualizerHeight = 0;
+    Compositor compositor;
+    compositor.initialize(gl);
+    compositor.addLayer("visualizer", Compositor::LayerKind::Opaque, true, 1.0f,
+        [&](GLuint fbo, int layerWidth, int layerHeight) {
+            if (layerWidth != visualizerWidth || layerHeight != visualizerHeight) {
+                visualizerWidth = layerWidth;
+                visualizerHeight = layerHeight;
+                pm->projectM_resetGL(layerWidth, layerHeight);
+            }
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            pm->renderFrame();
+        });
+    compositor.addLayer("text", Compositor::LayerKind::Overlay, true, 1.0f,
+        [&](GLuint, int layerWidth, int layerHeight) {
+            const double time = frame / static_cast<double>(fps);
+            const std::string title = "Aurora Golden";
+            // Short fades so the captured frames cover every title phase.
+            TitleAnimation::Settings titleSettings;
+            titleSettings.fadeDuration = 0.5f;
+            titleSettings.bounceDuration = 0.5f;
+            const TitleAnimation::Frame titleFrame = TitleAnimation::evaluate(
+                time, frameCount / static_cast<double>(fps), titleSettings,
+                textRenderer.metrics().measure(title, 1.0f), layerWidth, layerHeight);
+            textRenderer.renderText(gl, title, titleFrame.x, titleFrame.y, titleFrame.scale,
+                                    QVector3D(1.0f, 0.8f, 0.3f) * titleFrame.alpha, layerWidth, layerHeight);
+            // Second half: karaoke sweep over the line, one word per quarter.
+            if (frame >= frameCount / 2) {
+                const float x = (layerWidth - karaoke.bounds.width * 0.6f) / 2.0f;
+                textRenderer.renderKaraoke(gl, karaoke, x, layerHeight * 0.15f, 0.6f, time,
+                                           QVector3D(0.7f, 0.7f, 0.7f), QVector3D(1.0f, 0.85f, 0.3f),
+                                           layerWidth, layerHeight);
+                return;
+            }
+            const std::string lyric = "first line of the lyrics";
+            QRectF bounds = textRenderer.getTextBounds(lyric, 0.6f);
+            textRenderer.renderText(gl, lyric, (layerWidth - bounds.width()) / 2.0f, layerHeight * 0.15f, 0.6f,
+                                    QVector3D(1.0f, 1.0f, 1.0f), layerWidth, layerHeight);
+        });
+    compositor.resize(gl, width, height);
+
+    QDir().mkpath(update ? goldenDir : outputDir);
+    const size_t clipFrames = clip.size() / 2;
+    const size_t pcmPerFrame = static_cast<size_t>(clipRate / fps);
+    size_t cursor = 0;
+    std::vector<double> frameMs;
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+    std::vector<GoldenFrame> written;
+    int failures = 0;
+
+    for (frame = 0; frame < frameCount; ++frame) {
+        for (size_t fed = 0; fed < pcmPerFrame; fed += PCM_CHUNK_FRAMES) {
+            const size_t chunk = std::min(PCM_CHUNK_FRAMES, pcmPerFrame - fed);
+            if (cursor + chunk > clipFrames) {
+                cursor = 0;
+            }
+            pm->pcm()->addPCM16Data(&clip[cursor * 2], static_cast<short>(chunk));
+            cursor += chunk;
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        compositor.render(gl, targetFbo);
+        gl->glFinish();
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+
+        if (!std::binary_search(captureFrames.begin(), captureFrames.end(), frame)) {
+            continue;
+        }
+        gl->glBindFramebuffer(GL_FRAMEBUFFER, targetFbo);
+        gl->glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        flipRows(pixels, width, height);
+        const uint64_t hash = FrameCompare::hash(pixels.data(), width, height);
+
+        if (update) {
+            saveFrame(frameFileName(goldenDir, "frame", frame), pixels, width, height);
+            written.push_back({frame, hash});
+            std::printf("frame %4d  %8.2f ms  %016llx  written\n", frame, frameMs.back(), static_cast<unsigned long long>(hash));
+            continue;
+        }
+
+        auto golden = std::find_if(goldens.begin(), goldens.end(), [&](const GoldenFrame& g) { return g.frame == frame; });
+        if (golden == goldens.end()) {
+            std::printf("frame %4d  %8.2f ms  no golden\n", frame, frameMs.back());
+            ++failures;
+            continue;
+        }
+        if (golden->hash == hash) {
+            std::printf("frame %4d  %8.2f ms  exact\n", frame, frameMs.back());
+            continue;
+        }
+
+        QImage expected = QImage(frameFileName(goldenDir, "frame", frame)).convertToFormat(QImage::Format_RGBA8888);
+        if (expected.width() != width || expected.height() != height) {
+            std::printf("frame %4d  %8.2f ms  golden image missing or wrong size\n", frame, frameMs.back());
+            ++failures;
+            continue;
+        }
+        std::vector<unsigned char> expectedPixels(pixels.size());
+        for (int y = 0; y < height; ++y) {
+            std::copy(expected.constScanLine(y), expected.constScanLine(y) + width * 4, expectedPixels.begin() + y * width * 4);
+        }
+        FrameDifference diff = FrameCompare::compare(expectedPixels.data(), pixels.data(), width, height);
+        const bool pass = diff.ssim >= result["min-ssim"].as<double>() && diff.psnr >= result["min-psnr"].as<double>();
+        std::printf("frame %4d  %8.2f ms  ssim %.4f  psnr %.1f dB  max %d  changed %.2f%%  %s\n",
+                    frame, frameMs.back(), diff.ssim, diff.psnr, diff.maxChannelError,
+                    diff.changedFraction * 100.0, pass ? "similar" : "MISMATCH");
+        if (!pass) {
+            ++failures;
+            saveFrame(frameFileName(outputDir, "actual", frame), pixels, width, height);
+            saveFrame(frameFileName(outputDir, "diff", frame),
+                      FrameCompare::diffImage(expectedPixels.data(), pixels.data(), width, height), width, height);
+        }
+    }
+
+    double totalMs = 0.0;
+    for (double ms : frameMs) {
+        totalMs += ms;
+    }
+    std::printf("%d frames at %dx%d: mean %.2f ms  p50 %.2f ms  p95 %.2f ms  max %.2f ms\n",
+                frameCount, width, height, totalMs / std::max<size_t>(1, frameMs.size()),
+                percentile(frameMs, 0.5), percentile(frameMs, 0.95), percentile(frameMs, 1.0));
+
+    const std::string timingPath = result["timing-csv"].as<std::string>();
+    if (!timingPath.empty()) {
+        std::ofstream csv(timingPath);
+        csv << "frame,ms\n";
+        for (size_t i = 0; i < frameMs.size(); ++i) {
+            csv << i << "," << frameMs[i] << "\n";
+        }
+    }
+
+    compositor.cleanup(gl);
+    textRenderer.releaseKaraoke(gl, karaoke);
+    textRenderer.cleanup(gl);
+    gl->glDeleteFramebuffers(1, &targetFbo);
+    gl->glDeleteTextures(1, &targetTexture);
+
+    if (update) {
+        return FrameCompare::saveManifest(manifestPath, written) ? 0 : 1;
+    }
+    if (failures > 0) {
+        std::cout << failures << " frame(s) differ from the goldens; see " << outputDir.toStdString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "core/audio/ChunkStream.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+    std::string pattern(size_t size) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>(i * 7 + i / 251);
+        }
+        return data;
+    }
+
+    const std::chrono::milliseconds SHORT_WAIT(20);
+    const std::chrono::milliseconds LONG_WAIT(5000);
+}
+
+TEST(ChunkStreamSuite, ReadsAcrossBlocks) {
+    const std::string data = pattern(3 * ChunkStream::BLOCK_BYTES + 123);
+    ChunkStream stream;
+    // Uneven appends that straddle block boundaries.
+    for (size_t pos = 0; pos < data.size(); pos += 10007) {
+        stream.append(data.data() + pos, std::min<size_t>(10007, data.size() - pos));
+    }
+    EXPECT_EQ(stream.size(), data.size());
+
+    std::string out(ChunkStream::BLOCK_BYTES + 50, '\0');
+    const uint64_t offset = ChunkStream::BLOCK_BYTES - 25;
+    ASSERT_EQ(stream.read(offset, &out[0], out.size(), SHORT_WAIT), out.size());
+    EXPECT_EQ(out, data.substr(offset, out.size()));
+}
+
+TEST(ChunkStreamSuite, ReadsWaitForTheDownload) {
+    const std::string data = pattern(200 * 1024);
+    ChunkStream stream;
+    stream.append(data.data(), 1000);
+
+    std::thread downloader([&]() {
+        for (size_t pos = 1000; pos < data.size(); pos += 8192) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stream.append(data.data() + pos, std::min<size_t>(8192, data.size() - pos));
+        }
+        stream.finish();
+    });
+    // Well past what has arrived so far.
+    std::string out(4096, '\0');
+    EXPECT_EQ(stream.read(150 * 1024, &out[0], out.size(), LONG_WAIT), out.size());
+    EXPECT_EQ(out, data.substr(150 * 1024, out.size()));
+    EXPECT_TRUE(stream.waitFor(data.size(), LONG_WAIT));
+    downloader.join();
+
+    // At the end, reads come back short instead of waiting.
+    EXPECT_EQ(stream.read(data.size() - 10, &out[0], out.size(), LONG_WAIT), 10u);
+    EXPECT_EQ(stream.read(data.size(), &out[0], out.size(), LONG_WAIT), 0u);
+}
+
+TEST(ChunkStreamSuite, GivesUpOnTimeoutAndFailure) {
+    ChunkStream stream;
+    stream.append("abc", 3);
+    char out[8];
+    EXPECT_EQ(stream.read(0, out, sizeof(out), SHORT_WAIT), 3u);
+    EXPECT_FALSE(stream.waitFor(100, SHORT_WAIT));
+
+    std::thread failer([&]() {
+        std::this_thread::sleep_for(SHORT_WAIT);
+        stream.fail();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(stream.read(3, out, sizeof(out), LONG_WAIT), 0u);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, LONG_WAIT / 2);
+    failer.join();
+    EXPECT_TRUE(stream.hasFailed());
+    stream.append("more", 4);
+    EXPECT_EQ(stream.size(), 3u);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "core/audio/AudioEngine.h"
+#include "core/audio/DecodedTrack.h"
+#include "miniaudio.h"
+#include <cstdio>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    // A ramp per channel, so every frame's position can be read back from it.
+    std::vector<short> rampPcm(size_t frames) {
+        std::vector<short> pcm(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            pcm[i * 2] = static_cast<short>(i % 30000);
+            pcm[i * 2 + 1] = static_cast<short>(-static_cast<int>(i % 30000));
+        }
+        return pcm;
+    }
+
+    std::string writeWav(const char* name, const std::vector<short>& pcm) {
+        const std::string path = ::testing::TempDir() + name;
+        ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_s16, 2, 44100);
+        ma_encoder encoder;
+        if (ma_encoder_init_file(path.c_str(), &config, &encoder) != MA_SUCCESS) {
+            return std::string();
+        }
+        ma_encoder_write_pcm_frames(&encoder, pcm.data(), pcm.size() / 2, nullptr);
+        ma_encoder_uninit(&encoder);
+        return path;
+    }
+}
+
+TEST(DecodedTrackSuite, ReadsAnyFrameExactly) {
+    const std::vector<short> pcm = rampPcm(100000);
+    const std::string path = writeWav("aurora_decoded_track.wav", pcm);
+    ASSERT_FALSE(path.empty());
+
+    std::shared_ptr<DecodedTrack> track = DecodedTrack::decode(path, DecodedTrack::Options());
+    ASSERT_TRUE(track);
+    ASSERT_TRUE(track->waitComplete(std::chrono::seconds(10)));
+    EXPECT_EQ(track->sampleRate(), 44100);
+    EXPECT_EQ(track->frameCount(), 100000u);
+    EXPECT_EQ(track->bytesPerFrame(), 4u);
+
+    short frames[2 * 64];
+    for (uint64_t start : {0u, 1u, 44099u, 77777u}) {
+        ASSERT_EQ(track->read(start, frames, 64), 64u);
+        EXPECT_EQ(frames[0], pcm[start * 2]);
+        EXPECT_EQ(frames[127], pcm[(start + 63) * 2 + 1]);
+    }
+    // Short at the end, nothing past it.
+    EXPECT_EQ(track->read(99990, frames, 64), 10u);
+    EXPECT_EQ(track->read(100000, frames, 64), 0u);
+    std::remove(path.c_str());
+}
+
+TEST(DecodedTrackSuite, SharesTheCopyThroughItsDescriptor) {
+    const std::vector<short> pcm = rampPcm(50000);
+    const std::string path = writeWav("aurora_decoded_track_shared.wav", pcm);
+    ASSERT_FALSE(path.empty());
+
+    DecodedTrack::Options options;
+    options.storage = DecodedTrack::Storage::Shared;
+    options.sample = DecodedTrack::Sample::F32;
+    std::shared_ptr<DecodedTrack> track = DecodedTrack::decode(path, options);
+    ASSERT_TRUE(track);
+    ASSERT_GE(track->fd(), 0);
+
+    // Attached the way another process would, possibly mid-decode.
+    const int fd = dup(track->fd());
+    std::shared_ptr<DecodedTrack> view = DecodedTrack::attach(fd);
+    close(fd);
+    ASSERT_TRUE(view);
+    ASSERT_TRUE(view->waitComplete(std::chrono::seconds(10)));
+    EXPECT_EQ(view->sample(), DecodedTrack::Sample::F32);
+    EXPECT_EQ(view->frameCount(), 50000u);
+
+    float frame[2];
+    ASSERT_EQ(view->read(12345, frame, 1), 1u);
+    EXPECT_NEAR(frame[0], pcm[12345 * 2] / 32768.0f, 1e-6f);
+    EXPECT_NEAR(frame[1], pcm[12345 * 2 + 1] / 32768.0f, 1e-6f);
+    std::remove(path.c_str());
+}
+
+TEST(DecodedTrackSuite, LendsTheWholeTrackToAnalyses) {
+    const std::vector<short> pcm = rampPcm(60000);
+    const std::string path = writeWav("aurora_decoded_track_whole.wav", pcm);
+    ASSERT_FALSE(path.empty());
+
+    // The copy playback decoded, still decoding when asked for, and the
+    // file decoded afresh give the analyses the same samples.
+    std::shared_ptr<DecodedTrack> track = DecodedTrack::decode(path, DecodedTrack::Options());
+    ASSERT_TRUE(track);
+    for (const std::shared_ptr<DecodedTrack>& shared : {track, std::shared_ptr<DecodedTrack>()}) {
+        std::vector<short> seen;
+        int seenRate = 0;
+        ASSERT_TRUE(AudioEngine::withWholeTrack(path, shared, [&](const short* data, size_t frames, int sampleRate) {
+            seen.assign(data, data + frames * 2);
+            seenRate = sampleRate;
+        }));
+        EXPECT_EQ(seenRate, 44100);
+        EXPECT_EQ(seen, pcm);
+    }
+
+    bool called = false;
+    EXPECT_FALSE(AudioEngine::withWholeTrack(::testing::TempDir() + "aurora_missing.wav", nullptr,
+                                             [&](const short*, size_t, int) { called = true; }));
+    EXPECT_FALSE(called);
+    std::remove(path.c_str());
+}
+
+TEST(DecodedTrackSuite, RejectsWhatItCannotDecode) {
+    EXPECT_FALSE(DecodedTrack::decode(::testing::TempDir() + "aurora_missing.wav", DecodedTrack::Options()));
+
+    const int fd = memfd_create("aurora-test", MFD_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 4096), 0);
+    EXPECT_FALSE(DecodedTrack::attach(fd));
+    close(fd);
+}
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+#include "core/Sha256.h"
+#include "core/audio/ChunkStream.h"
+#include "core/download/DownloadManager.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // In-process stand-in for the CDN: serves byte strings by URL, honours
+    // Range requests, and can drop or corrupt transfers on demand.
+    class MockHttpServer : public HttpTransport
+    {
+    public:
+        void serve(const std::string& url, std::string content) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_files[url] = std::move(content);
+        }
+
+        bool get(const HttpRequest& request, HttpResponse& response, const BodyCallback& onBody) override {
+            std::string content;
+            size_t dropAfter = std::string::npos;
+            bool corrupt = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++requests;
+                rangeStarts.push_back(request.rangeStart);
+                maxActive = std::max(maxActive, ++m_active);
+                auto it = m_files.find(request.url);
+                if (it == m_files.end()) {
+                    --m_active;
+                    response.status = 404;
+                    return true;
+                }
+                content = it->second;
+                if (drops > 0) {
+                    --drops;
+                    dropAfter = dropAfterBytes;
+                }
+                if (corruptions > 0) {
+                    --corruptions;
+                    corrupt = true;
+                }
+            }
+
+            bool complete = true;
+            response.totalSize = content.size();
+            if (request.rangeStart >= content.size() && request.rangeStart > 0) {
+                response.status = 416;
+            } else {
+                const size_t start = ignoreRange ? 0 : request.rangeStart;
+                response.status = start > 0 ? 206 : 200;
+                response.rangeStart = start;
+                if (corrupt) {
+                    content[content.size() / 2] ^= 0x55;
+                }
+                for (size_t pos = start; pos < content.size(); pos += CHUNK) {
+                    if (pos - start >= dropAfter) {
+                        response.error = "connection reset";
+                        complete = false;
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(chunkDelayUs));
+                    if (!onBody(content.data() + pos, std::min(CHUNK, content.size() - pos))) {
+                        response.error = "aborted";
+                        complete = false;
+                        break;
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_active;
+            return complete;
+        }
+
+        static constexpr size_t CHUNK = 4096;
+        int requests = 0;
+        int maxActive = 0;
+        std::vector<uint64_t> rangeStarts;
+        int drops = 0;
+        size_t dropAfterBytes = 0;
+        int corruptions = 0;
+        bool ignoreRange = false;
+        int chunkDelayUs = 0;
+
+    private:
+        std::mutex m_mutex;
+        std::map<std::string, std::string> m_files;
+        int m_active = 0;
+    };
+
+    std::string songData(size_t size, unsigned seed) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>((i * 131 + seed * 7919) >> 3);
+        }
+        return data;
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    DownloadManager::Options options(const char* name) {
+        DownloadManager::Options o;
+        o.directory = ::testing::TempDir() + "aurora_downloads_" + name;
+        fs::remove_all(o.directory);
+        o.urlTemplate = "http://mock/{id}.mp3";
+        o.retryDelayMs = 0;
+        return o;
+    }
+
+    std::vector<DownloadManager::Event> finalEvents(DownloadManager& manager) {
+        manager.waitIdle();
+        std::vector<DownloadManager::Event> events = manager.takeEvents();
+        events.erase(std::remove_if(events.begin(), events.end(),
+                                    [](const auto& e) { return e.type == DownloadManager::Event::Type::Progress; }),
+                     events.end());
+        return events;
+    }
+}
+
+TEST(DownloadManagerSuite, HashesSha256) {
+    EXPECT_EQ(Sha256().hexDigest(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    Sha256 abc;
+    abc.update("abc", 3);
+    EXPECT_EQ(abc.hexDigest(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    const std::string text = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    Sha256 split;
+    for (char c : text) {
+        split.update(&c, 1);
+    }
+    EXPECT_EQ(split.hexDigest(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(DownloadManagerSuite, ExtractsSongIds) {
+    EXPECT_EQ(DownloadManager::songId("https://suno.com/song/7cce556d-9afc-4b67-87c2-f1748bb6ee88?sh=abc\n"),
+              "7cce556d-9afc-4b67-87c2-f1748bb6ee88");
+    EXPECT_EQ(DownloadManager::songId("  d65f83ff-6e5f-467e-aba0-4c1946f43ab7 "), "d65f83ff-6e5f-467e-aba0-4c1946f43ab7");
+    EXPECT_EQ(DownloadManager::songId("https://suno.com/song/../../etc/passwd"), "");
+    EXPECT_EQ(DownloadManager::songId("a/b"), "");
+    EXPECT_EQ(DownloadManager::songId(""), "");
+}
+
+TEST(DownloadManagerSuite, DownloadsConcurrentlyWithinBound) {
+    MockHttpServer server;
+    server.chunkDelayUs = 200;
+    for (unsigned i = 0; i < 8; ++i) {
+        server.serve("http://mock/song" + std::to_string(i) + ".mp3", songData(64 * 1024 + i, i));
+    }
+    DownloadManager::Options o = options("concurrent");
+    o.maxConcurrent = 3;
+    DownloadManager manager(server, o);
+    for (unsigned i = 0; i < 8; ++i) {
+        manager.enqueue("song" + std::to_string(i));
+    }
+    // Queuing a song twice does not fetch it twice.
+    EXPECT_EQ(manager.enqueue("song7"), manager.enqueue("song7"));
+
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 8u);
+    for (const auto& event : events) {
+        EXPECT_EQ(event.type, DownloadManager::Event::Type::Finished) << event.message;
+        const unsigned i = static_cast<unsigned>(std::stoi(event.songId.substr(4)));
+        EXPECT_EQ(readFile(event.path), songData(64 * 1024 + i, i));
+    }
+    EXPECT_EQ(server.requests, 8);
+    EXPECT_LE(server.maxActive, 3);
+    EXPECT_GE(server.maxActive, 2);
+}
+
+TEST(DownloadManagerSuite, ResumesInterruptedTransfers) {
+    MockHttpServer server;
+    const std::string data = songData(300 * 1024, 1);
+    server.serve("http://mock/song.mp3", data);
+    server.drops = 2;
+    server.dropAfterBytes = 100 * 1024;
+    DownloadManager manager(server, options("resume"));
+    manager.enqueue("song");
+
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, DownloadManager::Event::Type::Finished) << events[0].message;
+    EXPECT_EQ(readFile(events[0].path), data);
+    // Each attempt picked up where the last one stopped.
+    EXPECT_EQ(server.rangeStarts, (std::vector<uint64_t>{0, 100 * 1024, 200 * 1024}));
+}
+
+TEST(DownloadManagerSuite, FeedsPreviewWhileDownloading) {
+    MockHttpServer server;
+    const std::string data = songData(300 * 1024, 5);
+    server.serve("http://mock/song.mp3", data);
+    server.chunkDelayUs = 100;
+    // A restart from zero must not duplicate what the preview already has.
+    server.drops = 1;
+    server.dropAfterBytes = 120 * 1024;
+    server.ignoreRange = true;
+    const DownloadManager::Options o = options("preview");
+    DownloadManager manager(server, o);
+    auto preview = std::make_shared<ChunkStream>();
+    manager.enqueue("song", std::string(), preview);
+
+    // Playback can start long before the download finishes.
+    ASSERT_TRUE(preview->waitFor(64 * 1024, std::chrono::seconds(5)));
+    manager.waitIdle();
+    EXPECT_TRUE(preview->isFinished());
+    std::string streamed(data.size(), '\0');
+    ASSERT_EQ(preview->read(0, &streamed[0], streamed.size(), std::chrono::milliseconds(0)), data.size());
+    EXPECT_EQ(streamed, data);
+
+    // A cached song fills its preview straight from disk.
+    DownloadManager again(server, o);
+    auto cached = std::make_shared<ChunkStream>();
+    again.enqueue("song", std::string(), cached);
+    again.waitIdle();
+    EXPECT_TRUE(cached->isFinished());
+    EXPECT_EQ(cached->size(), data.size());
+}
+
+TEST(DownloadManagerSuite, RequeuedSongWaitsForItsCancelledJob) {
+    MockHttpServer server;
+    const std::string data = songData(300 * 1024, 6);
+    server.serve("http://mock/song.mp3", data);
+    server.chunkDelayUs = 200;
+    DownloadManager manager(server, options("requeue"));
+    auto preview = std::make_shared<ChunkStream>();
+    const uint64_t first = manager.enqueue("song", std::string(), preview);
+    ASSERT_TRUE(preview->waitFor(16 * 1024, std::chrono::seconds(5)));
+
+    // Both jobs would write the same part file, so the second one must not
+    // start while the first is still leaving its transfer.
+    manager.cancel(first);
+    const uint64_t second = manager.enqueue("song");
+    EXPECT_NE(second, first);
+
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].job, first);
+    EXPECT_EQ(events[0].type, DownloadManager::Event::Type::Failed);
+    EXPECT_EQ(events[1].job, second);
+    EXPECT_EQ(events[1].type, DownloadManager::Event::Type::Finished) << events[1].message;
+    EXPECT_EQ(readFile(events[1].path), data);
+    EXPECT_EQ(server.maxActive, 1);
+}
+
+TEST(DownloadManagerSuite, RestartsWhenRangeIsIgnored) {
+    MockHttpServer server;
+    const std::string data = songData(50 * 1024, 2);
+    server.serve("http://mock/song.mp3", data);
+    server.drops = 1;
+    server.dropAfterBytes = 20 * 1024;
+    server.ignoreRange = true;
+    DownloadManager manager(server, options("norange"));
+    manager.enqueue("song");
+
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(readFile(events[0].path), data);
+}
+
+TEST(DownloadManagerSuite, VerifiesChecksums) {
+    MockHttpServer server;
+    const std::string data = songData(40 * 1024, 3);
+    Sha256 hash;
+    hash.update(data.data(), data.size());
+    const std::string digest = hash.hexDigest();
+    server.serve("http://mock/good.mp3", data);
+    server.serve("http://mock/bad.mp3", data);
+    server.corruptions = 1;
+
+    DownloadManager::Options o = options("checksum");
+    o.maxConcurrent = 1;
+    DownloadManager manager(server, o);
+    // The first transfer is corrupted and retried from scratch.
+    manager.enqueue("good", digest);
+    manager.enqueue("bad", std::string(64, '0'));
+
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, DownloadManager::Event::Type::Finished);
+    EXPECT_EQ(readFile(events[0].path), data);
+    EXPECT_EQ(events[1].type, DownloadManager::Event::Type::Failed);
+    EXPECT_EQ(events[1].message, "checksum mismatch");
+    EXPECT_TRUE(manager.cachedPath("bad").empty());
+}
+
+TEST(DownloadManagerSuite, ServesFromCacheAndRefetchesDamagedCopies) {
+    MockHttpServer server;
+    const std::string data = songData(30 * 1024, 4);
+    server.serve("http://mock/song.mp3", data);
+    const DownloadManager::Options o = options("cache");
+    {
+        DownloadManager manager(server, o);
+        manager.enqueue("song");
+        manager.waitIdle();
+    }
+    {
+        DownloadManager manager(server, o);
+        manager.enqueue("song");
+        const auto events = finalEvents(manager);
+        ASSERT_EQ(events.size(), 1u);
+        EXPECT_TRUE(events[0].cached);
+        EXPECT_EQ(server.requests, 1);
+    }
+
+    {
+        std::fstream file(o.directory + "/song.mp3", std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(10);
+        file.put('!');
+    }
+    DownloadManager manager(server, o);
+    EXPECT_TRUE(manager.cachedPath("song").empty());
+    manager.enqueue("song");
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_FALSE(events[0].cached);
+    EXPECT_EQ(readFile(events[0].path), data);
+    EXPECT_EQ(server.requests, 2);
+}
+
+TEST(DownloadManagerSuite, GivesUpOnMissingSongs) {
+    MockHttpServer server;
+    DownloadManager manager(server, options("missing"));
+    manager.enqueue("nothing");
+    const auto events = finalEvents(manager);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, DownloadManager::Event::Type::Failed);
+    EXPECT_EQ(events[0].message, "HTTP 404");
+    EXPECT_EQ(server.requests, 1);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "core/DynamicResolutionController.h"
+
+namespace {
+    // Feeds frames whose cost scales with pixel count until the scale settles.
+    float settle(DynamicResolutionController& controller, float fullResolutionMs, int frames) {
+        for (int i = 0; i < frames; ++i) {
+            float scale = controller.scale();
+            controller.update(fullResolutionMs * scale * scale);
+        }
+        return controller.scale();
+    }
+}
+
+TEST(DynamicResolutionSuite, ScalesDownUntilWithinBudget) {
+    DynamicResolutionController controller;
+    float scale = settle(controller, 25.0f, 600);
+
+    EXPECT_LT(scale, 1.0f);
+    EXPECT_GE(scale, 0.5f);
+    EXPECT_LE(25.0f * scale * scale, controller.budgetMs());
+}
+
+TEST(DynamicResolutionSuite, StaysWithinBounds) {
+    DynamicResolutionController::Settings settings;
+    settings.minScale = 0.6f;
+    DynamicResolutionController controller(settings);
+
+    EXPECT_FLOAT_EQ(settle(controller, 200.0f, 600), 0.6f);
+    EXPECT_FLOAT_EQ(settle(controller, 1.0f, 2000), 1.0f);
+}
+
+TEST(DynamicResolutionSuite, HysteresisIgnoresShortSpikes) {
+    DynamicResolutionController controller;
+    for (int i = 0; i < 200; ++i) {
+        controller.update(i % 20 == 0 ? 40.0f : 8.0f);
+    }
+    EXPECT_FLOAT_EQ(controller.scale(), 1.0f);
+}
+
+TEST(DynamicResolutionSuite, DisabledControllerHoldsFullScale) {
+    DynamicResolutionController controller;
+    controller.setEnabled(false);
+    EXPECT_FALSE(controller.update(100.0f));
+    EXPECT_FLOAT_EQ(controller.scale(), 1.0f);
+}
+
+TEST(DynamicResolutionSuite, NewSettingsKeepTheCurrentScale) {
+    DynamicResolutionController controller;
+    const float scale = settle(controller, 25.0f, 600);
+    ASSERT_LT(scale, 1.0f);
+
+    DynamicResolutionController::Settings settings;
+    settings.targetFps = 50.0f;
+    controller.setSettings(settings);
+    EXPECT_FLOAT_EQ(controller.scale(), scale);
+
+    // A narrower range clamps it.
+    settings.maxScale = scale - 0.1f;
+    settings.minScale = 0.4f;
+    controller.setSettings(settings);
+    EXPECT_NEAR(controller.scale(), scale - 0.1f, 1e-4f);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "core/FrameCompare.h"
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    std::vector<unsigned char> gradient(int width, int height) {
+        std::vector<unsigned char> frame(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                unsigned char* px = &frame[(static_cast<size_t>(y) * width + x) * 4];
+                px[0] = static_cast<unsigned char>(x * 255 / width);
+                px[1] = static_cast<unsigned char>(y * 255 / height);
+                px[2] = static_cast<unsigned char>((x + y) % 256);
+                px[3] = 255;
+            }
+        }
+        return frame;
+    }
+}
+
+TEST(FrameCompareSuite, HashIgnoresAlphaButNotColor) {
+    std::vector<unsigned char> a = gradient(64, 32);
+    std::vector<unsigned char> b = a;
+    b[3] = 0;
+    EXPECT_EQ(FrameCompare::hash(a.data(), 64, 32), FrameCompare::hash(b.data(), 64, 32));
+    b[0] ^= 1;
+    EXPECT_NE(FrameCompare::hash(a.data(), 64, 32), FrameCompare::hash(b.data(), 64, 32));
+}
+
+TEST(FrameCompareSuite, IdenticalFramesAreIdentical) {
+    std::vector<unsigned char> a = gradient(64, 32);
+    FrameDifference diff = FrameCompare::compare(a.data(), a.data(), 64, 32);
+    EXPECT_TRUE(std::isinf(diff.psnr));
+    EXPECT_DOUBLE_EQ(diff.ssim, 1.0);
+    EXPECT_EQ(diff.maxChannelError, 0);
+    EXPECT_DOUBLE_EQ(diff.changedFraction, 0.0);
+}
+
+TEST(FrameCompareSuite, SmallNoiseStaysSimilarButStructureDoesNot) {
+    std::vector<unsigned char> a = gradient(64, 64);
+    std::vector<unsigned char> noisy = a;
+    for (size_t i = 0; i < noisy.size(); i += 4) {
+        noisy[i] = static_cast<unsigned char>(std::min(255, noisy[i] + static_cast<int>(i / 4 % 3)));
+    }
+    FrameDifference small = FrameCompare::compare(a.data(), noisy.data(), 64, 64);
+    EXPECT_GT(small.ssim, 0.97);
+    EXPECT_GT(small.psnr, 40.0);
+
+    std::vector<unsigned char> shifted = gradient(64, 64);
+    for (size_t i = 0; i < shifted.size(); i += 4) {
+        std::swap(shifted[i], shifted[i + 1]);
+    }
+    FrameDifference large = FrameCompare::compare(a.data(), shifted.data(), 64, 64);
+    EXPECT_LT(large.ssim, 0.9);
+    EXPECT_GT(large.changedFraction, 0.5);
+}
+
+TEST(FrameCompareSuite, ManifestRoundTrip) {
+    const std::string path = ::testing::TempDir() + "golden_manifest.tsv";
+    std::vector<GoldenFrame> frames = {{15, 0x0123456789abcdefull}, {119, 42}};
+    ASSERT_TRUE(FrameCompare::saveManifest(path, frames));
+
+    std::vector<GoldenFrame> loaded;
+    ASSERT_TRUE(FrameCompare::loadManifest(path, loaded));
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].frame, 15);
+    EXPECT_EQ(loaded[0].hash, 0x0123456789abcdefull);
+    EXPECT_EQ(loaded[1].hash, 42u);
+    std::remove(path.c_str());
+}
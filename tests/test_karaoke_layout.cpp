@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "core/text/KaraokeLayout.h"
+
+namespace {
+    FontMetrics monoFont() {
+        FontMetrics metrics;
+        metrics.setLineHeight(20.0f);
+        GlyphMetrics glyph;
+        glyph.width = 10.0f;
+        glyph.height = 10.0f;
+        glyph.bearingY = 10.0f;
+        glyph.advance = 10.0f;
+        for (int c = 33; c < 127; ++c) {
+            metrics.setGlyph(static_cast<unsigned char>(c), glyph);
+        }
+        GlyphMetrics space;
+        space.advance = 5.0f;
+        metrics.setGlyph(' ', space);
+        return metrics;
+    }
+
+    std::array<GlyphAtlasRect, 256> unitAtlas() {
+        std::array<GlyphAtlasRect, 256> atlas;
+        atlas.fill({0.0f, 0.0f, 1.0f, 1.0f});
+        return atlas;
+    }
+}
+
+TEST(KaraokeLayoutSuite, SixVerticesPerGlyphWithWordTimings) {
+    LyricLine line;
+    line.text = "ab cd";
+    line.startTime = 1.0;
+    line.endTime = 3.0;
+    line.words = {{"ab", 1.0, 2.0}, {"cd", 2.0, 3.0}};
+
+    std::vector<KaraokeVertex> vertices = KaraokeLayout::build(line.text, line, monoFont(), unitAtlas());
+    ASSERT_EQ(vertices.size(), 4u * 6u);
+    EXPECT_FLOAT_EQ(vertices[0].startTime, 1.0f);
+    EXPECT_FLOAT_EQ(vertices[0].endTime, 2.0f);
+    EXPECT_FLOAT_EQ(vertices[12].startTime, 2.0f);
+    // Second word starts after "ab" and the space.
+    EXPECT_FLOAT_EQ(vertices[12].x, 25.0f);
+}
+
+TEST(KaraokeLayoutSuite, WordFractionSpansEachWord) {
+    LyricLine line;
+    line.text = "abcd";
+    line.words = {{"abcd", 0.0, 1.0}};
+    std::vector<KaraokeVertex> vertices = KaraokeLayout::build(line.text, line, monoFont(), unitAtlas());
+    ASSERT_EQ(vertices.size(), 24u);
+    EXPECT_FLOAT_EQ(vertices[0].wordFraction, 0.0f);
+    EXPECT_FLOAT_EQ(vertices[2].wordFraction, 0.25f);
+    EXPECT_FLOAT_EQ(vertices[23].wordFraction, 1.0f);
+}
+
+TEST(KaraokeLayoutSuite, WrappedLinesMoveDownAndKeepWordOrder) {
+    LyricLine line;
+    line.text = "one two three";
+    line.endTime = 9.0;
+    line.words = {{"one", 0.0, 1.0}, {"two", 1.0, 2.0}};
+    // Wrapped text differs from line.text only in whitespace.
+    std::vector<KaraokeVertex> vertices = KaraokeLayout::build("one two\nthree", line, monoFont(), unitAtlas());
+    ASSERT_EQ(vertices.size(), 11u * 6u);
+    const KaraokeVertex& three = vertices[6 * 6];
+    EXPECT_FLOAT_EQ(three.x, 0.0f);
+    EXPECT_FLOAT_EQ(three.y, -20.0f + 10.0f);
+    // No timing for the third word: it lights up with the line's end.
+    EXPECT_FLOAT_EQ(three.startTime, 9.0f);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "core/animation/KeyframeAnimation.h"
+#include <cmath>
+
+TEST(KeyframeAnimationSuite, ParsesTracksAndColor) {
+    KeyframeAnimation animation;
+    ASSERT_TRUE(animation.parse(
+        "# comment\n"
+        "title alpha 0 0 ease-in-out\n"
+        "title alpha 2 1\n"
+        "title color 1 1 0.5 0.25   # trailing comment\n"
+        "lyrics y 0 0.2\n"
+        "title wobble 1 2\n"
+        "title alpha 1 bad\n"));
+    EXPECT_EQ(animation.skippedLines(), 2);
+    EXPECT_EQ(animation.elementCount(), 2u);
+    EXPECT_EQ(animation.elementIndex("lyrics"), 1);
+    EXPECT_EQ(animation.elementIndex("artist"), -1);
+    EXPECT_FLOAT_EQ(animation.duration(), 2.0f);
+
+    OverlayPose pose = animation.pose(0, 1.0);
+    EXPECT_FLOAT_EQ(pose.alpha, 0.5f);
+    EXPECT_FLOAT_EQ(pose.green, 0.5f);
+    EXPECT_FLOAT_EQ(pose.blue, 0.25f);
+    // Untouched properties keep their defaults.
+    EXPECT_FLOAT_EQ(pose.x, 0.5f);
+    EXPECT_FLOAT_EQ(pose.scale, 1.0f);
+}
+
+TEST(KeyframeAnimationSuite, EasingShapesTheSegmentAfterAKeyframe) {
+    KeyframeAnimation animation;
+    animation.addKeyframe("a", AnimationProperty::X, {0.0f, 0.0f, Easing::Step});
+    animation.addKeyframe("a", AnimationProperty::X, {1.0f, 1.0f, Easing::EaseIn});
+    animation.addKeyframe("a", AnimationProperty::X, {2.0f, 2.0f, Easing::Linear});
+
+    EXPECT_FLOAT_EQ(animation.interpolate(0, AnimationProperty::X, 0.9), 0.0f);
+    EXPECT_FLOAT_EQ(animation.interpolate(0, AnimationProperty::X, 1.0), 1.0f);
+    EXPECT_FLOAT_EQ(animation.interpolate(0, AnimationProperty::X, 1.5), 1.125f);
+    EXPECT_FLOAT_EQ(animation.interpolate(0, AnimationProperty::X, 5.0), 2.0f);
+    EXPECT_FLOAT_EQ(animation.interpolate(0, AnimationProperty::X, -1.0), 0.0f);
+}
+
+TEST(KeyframeAnimationSuite, BakedTableMatchesExactCurves) {
+    KeyframeAnimation animation;
+    const char* elements[] = {"title", "artist", "url", "lyrics"};
+    for (int e = 0; e < 4; ++e) {
+        for (int p = 0; p < KeyframeAnimation::PROPERTY_COUNT; ++p) {
+            for (int k = 0; k < 6; ++k) {
+                const float value = std::sin(static_cast<float>(e * 7 + p * 3 + k));
+                // Step jumps land between samples, so leave them out here.
+                const Easing easing = k % 5 == 1 ? Easing::Linear : static_cast<Easing>(k % 5);
+                animation.addKeyframe(elements[e], static_cast<AnimationProperty>(p),
+                                      {k * 1.7f + e * 0.1f, value, easing});
+            }
+        }
+    }
+    animation.bake(240);
+
+    std::vector<OverlayPose> poses;
+    for (double time = 0.0; time < animation.duration() + 1.0; time += 0.0137) {
+        animation.evaluate(time, poses);
+        ASSERT_EQ(poses.size(), 4u);
+        for (size_t e = 0; e < poses.size(); ++e) {
+            EXPECT_NEAR(poses[e].y, animation.interpolate(e, AnimationProperty::Y, time), 0.01f) << time;
+            EXPECT_NEAR(poses[e].blue, animation.interpolate(e, AnimationProperty::Blue, time), 0.01f) << time;
+        }
+    }
+}
+
+TEST(KeyframeAnimationSuite, LongAnimationsInterpolateInsteadOfBaking) {
+    KeyframeAnimation parsed;
+    EXPECT_TRUE(parsed.parse("title x 0 0\ntitle x 10000000 1\n"));
+    EXPECT_EQ(parsed.skippedLines(), 1);
+
+    KeyframeAnimation animation;
+    animation.addKeyframe("title", AnimationProperty::X, {0.0f, 0.0f, Easing::Linear});
+    animation.addKeyframe("title", AnimationProperty::X, {1e7f, 1.0f, Easing::Linear});
+    animation.bake();
+
+    std::vector<OverlayPose> poses;
+    animation.evaluate(5e6, poses);
+    ASSERT_EQ(poses.size(), 1u);
+    EXPECT_FLOAT_EQ(poses[0].x, 0.5f);
+    EXPECT_FLOAT_EQ(animation.pose(0, 1e7).x, 1.0f);
+}
+
+TEST(KeyframeAnimationSuite, PenPositionCentresTheTextBox) {
+    OverlayPose pose;
+    pose.x = 0.25f;
+    pose.y = 0.5f;
+    float x, y;
+    pose.penPosition({0.0f, -10.0f, 200.0f, 50.0f}, 2.0f, 1000.0f, 600.0f, x, y);
+    EXPECT_FLOAT_EQ(x, 250.0f - 200.0f);
+    EXPECT_FLOAT_EQ(y, 300.0f - 30.0f);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "core/text/LineBreaker.h"
+#include <sstream>
+
+namespace {
+    // Every letter 10 px, space 5 px.
+    FontMetrics monoFont() {
+        FontMetrics metrics;
+        metrics.setLineHeight(20.0f);
+        GlyphMetrics glyph;
+        glyph.width = 9.0f;
+        glyph.height = 10.0f;
+        glyph.bearingY = 10.0f;
+        glyph.advance = 10.0f;
+        for (int c = 33; c < 127; ++c) {
+            metrics.setGlyph(static_cast<unsigned char>(c), glyph);
+        }
+        GlyphMetrics space;
+        space.advance = 5.0f;
+        metrics.setGlyph(' ', space);
+        return metrics;
+    }
+}
+
+TEST(LineBreakerSuite, BalancesLinesInsteadOfFillingGreedily) {
+    FontMetrics metrics = monoFont();
+    // Greedy fill at 200 px gives "aaaa bbbb cccc" / "dd" (145 + 20 px).
+    std::vector<std::string> lines = LineBreaker::breakLines("aaaa bbbb cccc dd", metrics, 1.0f, 150.0f);
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "aaaa bbbb");
+    EXPECT_EQ(lines[1], "cccc dd");
+}
+
+TEST(LineBreakerSuite, UsesGlyphWidthsNotCharacterCounts) {
+    FontMetrics metrics = monoFont();
+    GlyphMetrics wide = metrics.glyph('m');
+    wide.advance = 40.0f;
+    metrics.setGlyph('m', wide);
+    // Same character count per word, very different widths.
+    std::vector<std::string> lines = LineBreaker::breakLines("mmmm ab cd ef", metrics, 1.0f, 170.0f);
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "mmmm");
+    EXPECT_EQ(lines[1], "ab cd ef");
+}
+
+TEST(LineBreakerSuite, KeepsForcedBreaksAndOverlongWords) {
+    FontMetrics metrics = monoFont();
+    std::vector<std::string> lines = LineBreaker::breakLines("a  b\n\nsupercalifragilistic x", metrics, 1.0f, 60.0f);
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "a b");
+    EXPECT_EQ(lines[1], "");
+    EXPECT_EQ(lines[2], "supercalifragilistic");
+    EXPECT_EQ(lines[3], "x");
+}
+
+TEST(LineBreakerSuite, LinesFitWhenWordsDo) {
+    FontMetrics metrics = monoFont();
+    const std::string text = "the quick brown fox jumps over the lazy dog while the band plays on into the night";
+    for (float width = 60.0f; width <= 400.0f; width += 7.0f) {
+        std::istringstream wrapped(LineBreaker().wrap(text, metrics, 1.0f, width));
+        std::string line;
+        while (std::getline(wrapped, line)) {
+            EXPECT_LE(metrics.advance(line, 1.0f), width) << line;
+        }
+    }
+}
+
+TEST(LineBreakerSuite, CachesByTextFontAndWidth) {
+    FontMetrics metrics = monoFont();
+    LineBreaker breaker(2);
+    const std::string first = breaker.wrap("one two three four", metrics, 1.0f, 100.0f);
+    EXPECT_EQ(breaker.wrap("one two three four", metrics, 1.0f, 100.0f), first);
+    EXPECT_EQ(breaker.cacheHits(), 1u);
+
+    breaker.wrap("one two three four", metrics, 1.0f, 300.0f);
+    GlyphMetrics wide = metrics.glyph('o');
+    wide.advance = 30.0f;
+    metrics.setGlyph('o', wide);
+    breaker.wrap("one two three four", metrics, 1.0f, 100.0f);
+    EXPECT_EQ(breaker.cacheMisses(), 3u);
+
+    // Capacity 2: the first entry has been evicted.
+    FontMetrics original = monoFont();
+    breaker.wrap("one two three four", original, 1.0f, 100.0f);
+    EXPECT_EQ(breaker.cacheMisses(), 4u);
+}
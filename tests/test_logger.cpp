@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "core/Logger.h"
+#include <ostream>
+#include <thread>
+
+namespace {
+    Logger::Settings quietSettings() {
+        Logger::Settings settings;
+        settings.console = false;
+        return settings;
+    }
+}
+
+TEST(LoggerSuite, RecordsAreDrainedInOrder) {
+    Logger logger(quietSettings());
+    uint64_t start = logger.mark();
+    logger.write(LogLevel::Info, LogCategory::Audio, "first");
+    logger.write(LogLevel::Error, LogCategory::Render, "second");
+
+    std::vector<LogRecord> records = logger.recordsSince(start);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].text, "first");
+    EXPECT_EQ(records[0].category, LogCategory::Audio);
+    EXPECT_EQ(records[1].text, "second");
+    EXPECT_EQ(records[1].level, LogLevel::Error);
+    EXPECT_LT(records[0].sequence, records[1].sequence);
+}
+
+TEST(LoggerSuite, FullBufferDropsInsteadOfBlocking) {
+    Logger::Settings settings = quietSettings();
+    settings.threadBufferCapacity = 8;
+    settings.repeatLimit = 0;
+    Logger logger(settings);
+
+    int accepted = 0;
+    for (int i = 0; i < 20; ++i) {
+        accepted += logger.write(LogLevel::Info, LogCategory::General, "message") ? 1 : 0;
+    }
+    EXPECT_EQ(accepted, 8);
+    logger.flush();
+    EXPECT_EQ(logger.droppedCount(), 12u);
+    EXPECT_TRUE(logger.write(LogLevel::Info, LogCategory::General, "after drain"));
+}
+
+TEST(LoggerSuite, RepeatedMessagesAreRateLimited) {
+    Logger::Settings settings = quietSettings();
+    settings.repeatLimit = 3;
+    Logger logger(settings);
+    uint64_t start = logger.mark();
+    for (int i = 0; i < 50; ++i) {
+        // Only the line number changes, as in projectM shader warnings.
+        logger.write(LogLevel::Warning, LogCategory::Console, "shader warning at line " + std::to_string(i));
+    }
+    EXPECT_EQ(logger.recordsSince(start).size(), 3u);
+    EXPECT_EQ(logger.suppressedCount(), 47u);
+
+    // Outside the console capture, digits make messages distinct.
+    for (int i = 0; i < 5; ++i) {
+        logger.write(LogLevel::Info, LogCategory::General, "Downloaded song" + std::to_string(i));
+    }
+    EXPECT_EQ(logger.recordsSince(start).size(), 8u);
+}
+
+TEST(LoggerSuite, SuppressedErrorsStayInTheHistory) {
+    Logger::Settings settings = quietSettings();
+    settings.repeatLimit = 3;
+    Logger logger(settings);
+    for (int i = 0; i < 10; ++i) {
+        logger.write(LogLevel::Error, LogCategory::Console, "shader error at line " + std::to_string(i));
+    }
+    // A second preset failing the same way within the window is still seen.
+    const uint64_t start = logger.mark();
+    logger.write(LogLevel::Error, LogCategory::Console, "shader error at line 99");
+    EXPECT_EQ(logger.countSince(start, LogLevel::Error, LogCategory::Console), 1u);
+    EXPECT_EQ(logger.suppressedCount(), 8u);
+}
+
+TEST(LoggerSuite, SuppressedRepeatsAreSummarized) {
+    Logger::Settings settings = quietSettings();
+    settings.repeatLimit = 1;
+    settings.repeatWindowSeconds = 0.01;
+    Logger logger(settings);
+    uint64_t start = logger.mark();
+    for (int i = 0; i < 5; ++i) {
+        logger.write(LogLevel::Warning, LogCategory::Console, "spam");
+    }
+    logger.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::vector<LogRecord> records = logger.recordsSince(start);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1].text, "spam (repeated 4 more times)");
+}
+
+TEST(LoggerSuite, CountFiltersByLevelAndCategory) {
+    Logger logger(quietSettings());
+    uint64_t start = logger.mark();
+    logger.write(LogLevel::Error, LogCategory::Console, "broken preset");
+    logger.write(LogLevel::Info, LogCategory::Console, "loading preset");
+    logger.write(LogLevel::Error, LogCategory::Audio, "device lost");
+
+    EXPECT_EQ(logger.countSince(start, LogLevel::Error, LogCategory::Console), 1u);
+    EXPECT_EQ(logger.countSince(start, LogLevel::Info, LogCategory::Console), 2u);
+    uint64_t later = logger.mark();
+    EXPECT_EQ(logger.countSince(later, LogLevel::Debug, LogCategory::Console), 0u);
+}
+
+TEST(LoggerSuite, ConcurrentWritersLoseNothingWithinCapacity) {
+    Logger::Settings settings = quietSettings();
+    settings.threadBufferCapacity = 512;
+    settings.historyCapacity = 4096;
+    settings.repeatLimit = 0;
+    Logger logger(settings);
+    uint64_t start = logger.mark();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&logger]() {
+            for (int i = 0; i < 500; ++i) {
+                logger.write(LogLevel::Info, LogCategory::General, "tick");
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(logger.recordsSince(start).size(), 2000u);
+    EXPECT_EQ(logger.droppedCount(), 0u);
+}
+
+TEST(LoggerSuite, StreamCaptureSplitsLinesAndClassifies) {
+    Logger logger(quietSettings());
+    uint64_t start = logger.mark();
+    {
+        LogStreamCapture capture(logger, LogCategory::Console);
+        std::ostream stream(&capture);
+        stream << "Loading preset" << std::endl;
+        stream << "Failed to compile shader\nvoid main() {" << std::endl;
+        stream << "warning: deprecated" << std::endl;
+    }
+
+    std::vector<LogRecord> records = logger.recordsSince(start);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].level, LogLevel::Info);
+    EXPECT_EQ(records[1].text, "Failed to compile shader");
+    EXPECT_EQ(records[1].level, LogLevel::Error);
+    EXPECT_EQ(records[2].level, LogLevel::Error);
+    EXPECT_EQ(records[3].level, LogLevel::Warning);
+}
+
+TEST(LoggerSuite, LongMessagesAreTruncated) {
+    Logger logger(quietSettings());
+    uint64_t start = logger.mark();
+    logger.write(LogLevel::Info, LogCategory::General, std::string(1000, 'x'));
+    std::vector<LogRecord> records = logger.recordsSince(start);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].text.size(), Logger::MAX_MESSAGE_LENGTH);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "core/audio/LoudnessMeter.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    // EBU Tech 3341 style stimulus: the same 1 kHz sine in both channels,
+    // `dbfs` being its peak level.
+    void appendSine(std::vector<short>& pcm, double seconds, double dbfs, int sampleRate = 48000) {
+        const double amplitude = std::pow(10.0, dbfs / 20.0) * 32767.0;
+        const size_t start = pcm.size() / 2;
+        const size_t frames = static_cast<size_t>(seconds * sampleRate);
+        for (size_t i = start; i < start + frames; ++i) {
+            const short value = static_cast<short>(std::lround(amplitude * std::sin(2.0 * M_PI * 1000.0 * i / sampleRate)));
+            pcm.push_back(value);
+            pcm.push_back(value);
+        }
+    }
+
+    double integratedOf(const std::vector<short>& pcm, int sampleRate = 48000) {
+        LoudnessMeter meter(sampleRate);
+        // Odd chunk sizes cross the 100 ms steps at arbitrary points.
+        for (size_t first = 0; first < pcm.size() / 2; first += 1237) {
+            meter.addFrames(pcm.data() + first * 2, std::min<size_t>(1237, pcm.size() / 2 - first));
+        }
+        return meter.integrated();
+    }
+}
+
+TEST(LoudnessMeterSuite, MeasuresReferenceSines) {
+    std::vector<short> pcm;
+    appendSine(pcm, 20.0, -23.0);
+    EXPECT_NEAR(integratedOf(pcm), -23.0, 0.1);
+
+    pcm.clear();
+    appendSine(pcm, 20.0, -33.0);
+    EXPECT_NEAR(integratedOf(pcm), -33.0, 0.1);
+
+    // K-weighting is defined for any rate, not just 48 kHz.
+    pcm.clear();
+    appendSine(pcm, 20.0, -23.0, 44100);
+    EXPECT_NEAR(integratedOf(pcm, 44100), -23.0, 0.1);
+}
+
+TEST(LoudnessMeterSuite, GatesQuietPassagesAndSilence) {
+    // Tech 3341 case 3: the quiet ends fall below the relative gate.
+    std::vector<short> pcm;
+    appendSine(pcm, 10.0, -36.0);
+    appendSine(pcm, 60.0, -23.0);
+    appendSine(pcm, 10.0, -36.0);
+    EXPECT_NEAR(integratedOf(pcm), -23.0, 0.1);
+
+    // Digital silence falls below the absolute gate.
+    pcm.assign(48000 * 20 * 2, 0);
+    appendSine(pcm, 20.0, -23.0);
+    pcm.resize(pcm.size() + 48000 * 20 * 2, 0);
+    EXPECT_NEAR(integratedOf(pcm), -23.0, 0.1);
+
+    pcm.assign(48000 * 5 * 2, 0);
+    EXPECT_TRUE(std::isinf(integratedOf(pcm)));
+}
+
+TEST(LoudnessMeterSuite, TracksTheSlidingWindows) {
+    std::vector<short> pcm;
+    appendSine(pcm, 5.0, -20.0);
+    appendSine(pcm, 2.0, -30.0);
+    LoudnessMeter meter(48000);
+    meter.addFrames(pcm.data(), pcm.size() / 2);
+    // The last 400 ms are all quiet; the last 3 s are one part loud to two quiet.
+    EXPECT_NEAR(meter.momentary(), -30.0, 0.1);
+    EXPECT_NEAR(meter.shortTerm(), 10.0 * std::log10((std::pow(10.0, -2.0) + 2.0 * std::pow(10.0, -3.0)) / 3.0), 0.2);
+}
+
+TEST(LoudnessMeterSuite, NormalizationRespectsBoostAndPeakLimits) {
+    EXPECT_DOUBLE_EQ(LoudnessMeter::normalizationGainDb(-8.0, -14.0, 1.0, 12.0), -6.0);
+    EXPECT_DOUBLE_EQ(LoudnessMeter::normalizationGainDb(-40.0, -14.0, 0.0, 12.0), 12.0);
+    // A peak at -3 dBFS leaves 3 dB of headroom.
+    EXPECT_NEAR(LoudnessMeter::normalizationGainDb(-20.0, -14.0, std::pow(10.0, -3.0 / 20.0), 12.0), 3.0, 1e-9);
+    EXPECT_DOUBLE_EQ(LoudnessMeter::normalizationGainDb(-INFINITY, -14.0, 0.5, 12.0), 0.0);
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "core/lyrics/LyricAligner.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    const int RATE = 16000;
+    const double SYLLABLE = 0.25;
+    const double SYLLABLE_GAP = 0.1;
+
+    // A centre-panned "voice" (600 Hz bursts, one per syllable) over a
+    // wide side-only bed and a centred 60 Hz bass the band filter ignores.
+    struct Song {
+        std::vector<short> pcm;
+        std::vector<double> lineStarts;
+        std::string text;
+
+        void silence(double seconds) { voice(seconds, false); }
+
+        void voice(double seconds, bool sung) {
+            uint32_t noise = 12345u + static_cast<uint32_t>(pcm.size());
+            const size_t frames = static_cast<size_t>(seconds * RATE);
+            const size_t offset = pcm.size() / 2;
+            for (size_t i = 0; i < frames; ++i) {
+                const double t = static_cast<double>(offset + i) / RATE;
+                noise = noise * 1664525u + 1013904223u;
+                const float side = ((noise >> 16) / 32768.0f - 1.0f) * 3000.0f;
+                const float bass = 2000.0f * static_cast<float>(std::sin(2.0 * M_PI * 60.0 * t));
+                const float vocal = sung ? 8000.0f * static_cast<float>(std::sin(2.0 * M_PI * 600.0 * t)) : 0.0f;
+                pcm.push_back(static_cast<short>(vocal + bass + side));
+                pcm.push_back(static_cast<short>(vocal + bass - side));
+            }
+        }
+
+        void line(int syllables, const std::string& words) {
+            lineStarts.push_back(static_cast<double>(pcm.size() / 2) / RATE);
+            for (int s = 0; s < syllables; ++s) {
+                voice(SYLLABLE, true);
+                silence(SYLLABLE_GAP);
+            }
+            text += words + "\n";
+        }
+
+        size_t frames() const { return pcm.size() / 2; }
+    };
+
+    Song sampleSong() {
+        Song song;
+        song.text = "[Verse]\n";
+        song.silence(2.0);
+        song.line(4, "la la la la");
+        song.silence(1.0);
+        song.line(2, "hello");
+        song.silence(1.0);
+        song.line(6, "la la la la la la");
+        // Instrumental break between sections.
+        song.text += "\n[Chorus][Big]\n";
+        song.silence(4.0);
+        song.line(3, "la la la");
+        song.silence(1.0);
+        song.line(5, "beautiful la la");
+        song.silence(1.0);
+        song.line(4, "la la la la");
+        song.silence(2.0);
+        return song;
+    }
+}
+
+TEST(LyricAlignerSuite, SplitsSectionsAtMarkers) {
+    const auto sections = LyricAligner::parseSections(
+        "intro line\n\n[Verse 1]\n  first  \nsecond\n[Pre-chorus][Building intensity]\n"
+        "[Tuba riffs].\nthird\n[Outro]\n");
+    ASSERT_EQ(sections.size(), 3u);
+    EXPECT_EQ(sections[0].name, "");
+    EXPECT_EQ(sections[0].lines, std::vector<std::string>{"intro line"});
+    EXPECT_EQ(sections[1].name, "Verse 1");
+    EXPECT_EQ(sections[1].lines, (std::vector<std::string>{"first", "second"}));
+    // Cue-only lines are markers too; empty sections are dropped.
+    EXPECT_EQ(sections[2].name, "Tuba riffs");
+    EXPECT_EQ(sections[2].lines, std::vector<std::string>{"third"});
+}
+
+TEST(LyricAlignerSuite, EstimatesSyllables) {
+    EXPECT_EQ(LyricAligner::countSyllables("la"), 1);
+    EXPECT_EQ(LyricAligner::countSyllables("hello,"), 2);
+    EXPECT_EQ(LyricAligner::countSyllables("time"), 1);
+    EXPECT_EQ(LyricAligner::countSyllables("little"), 2);
+    EXPECT_EQ(LyricAligner::countSyllables("beautiful"), 3);
+    EXPECT_EQ(LyricAligner::countSyllables("today"), 2);
+    EXPECT_EQ(LyricAligner::countSyllables("psst"), 1);
+    EXPECT_EQ(LyricAligner::countSyllables("1999"), 1);
+    EXPECT_EQ(LyricAligner::countSyllables("caf\xC3\xA9"), 2);
+    EXPECT_EQ(LyricAligner::countSyllables("--"), 0);
+}
+
+TEST(LyricAlignerSuite, ActivityFollowsCentreChannel) {
+    Song song;
+    song.silence(1.0);
+    song.voice(1.0, true);
+    song.silence(1.0);
+    const auto activity = LyricAligner::vocalActivity(song.pcm.data(), song.frames(), RATE, 0.01);
+    ASSERT_EQ(activity.size(), 300u);
+    EXPECT_LT(activity[50], 0.2f);
+    EXPECT_GT(activity[150], 0.7f);
+    EXPECT_LT(activity[250], 0.2f);
+}
+
+TEST(LyricAlignerSuite, AlignsLinesAndWords) {
+    const Song song = sampleSong();
+    LyricAligner::Options options;
+    const auto lines = LyricAligner::align(song.text, song.pcm.data(), song.frames(), RATE, options);
+    ASSERT_EQ(lines.size(), song.lineStarts.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_NEAR(lines[i].startTime, song.lineStarts[i], 0.15) << "line " << i;
+        EXPECT_GT(lines[i].endTime, lines[i].startTime);
+        if (i > 0) {
+            EXPECT_GE(lines[i].startTime, lines[i - 1].startTime);
+        }
+    }
+    ASSERT_EQ(lines[0].words.size(), 4u);
+    for (size_t w = 0; w < 4; ++w) {
+        EXPECT_NEAR(lines[0].words[w].startTime, song.lineStarts[0] + w * (SYLLABLE + SYLLABLE_GAP), 0.15);
+    }
+    EXPECT_EQ(lines[4].text, "beautiful la la");
+}
+
+TEST(LyricAlignerSuite, ThreadCountDoesNotChangeResult) {
+    const Song song = sampleSong();
+    LyricAligner::Options single;
+    single.threads = 1;
+    LyricAligner::Options many;
+    many.threads = 4;
+    const auto a = LyricAligner::align(song.text, song.pcm.data(), song.frames(), RATE, single);
+    const auto b = LyricAligner::align(song.text, song.pcm.data(), song.frames(), RATE, many);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].startTime, b[i].startTime);
+        EXPECT_EQ(a[i].endTime, b[i].endTime);
+    }
+
+    LyricAligner::Options linesOnly;
+    linesOnly.wordTimings = false;
+    EXPECT_FALSE(LyricAligner::align(song.text, song.pcm.data(), song.frames(), RATE, linesOnly)[0].hasWordTimings());
+    EXPECT_TRUE(LyricAligner::align("", song.pcm.data(), song.frames(), RATE, single).empty());
+    EXPECT_TRUE(LyricAligner::align(song.text, nullptr, 0, RATE, single).empty());
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "core/lyrics/LyricCache.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::vector<LyricLine> sampleLines() {
+        LyricLine line;
+        line.text = "Caf\xC3\xA9 night";
+        line.startTime = 1.2344;
+        line.endTime = 3.5;
+        line.words = {{"Caf\xC3\xA9", 1.2344, 2.0}, {"night", 2.0, 3.5}};
+        LyricLine plain;
+        plain.text = "[Chorus]";
+        plain.startTime = 4.0;
+        return {line, plain};
+    }
+
+    // Fresh, empty cache directory per test.
+    std::string cacheDir(const char* name) {
+        const std::string dir = ::testing::TempDir() + "aurora_lyric_cache_" + name;
+        fs::remove_all(dir);
+        return dir;
+    }
+}
+
+TEST(LyricCacheSuite, EncodesCompactly) {
+    std::string data;
+    LyricCache::encode(sampleLines(), data);
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricCache::decode(data, lines));
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0].text, "Caf\xC3\xA9 night");
+    // Times are kept to the millisecond.
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 1.234);
+    ASSERT_EQ(lines[0].words.size(), 2u);
+    EXPECT_EQ(lines[0].words[1].text, "night");
+    EXPECT_DOUBLE_EQ(lines[0].words[1].endTime, 3.5);
+    EXPECT_FALSE(lines[1].hasWordTimings());
+    // Header and checksum, then 16 bytes per line and 12 per word plus the text.
+    EXPECT_EQ(data.size(), 8u + 8u + (16u + 11u) + (12u + 5u) + (12u + 5u) + (16u + 8u));
+}
+
+TEST(LyricCacheSuite, RejectsDamagedData) {
+    std::string data;
+    LyricCache::encode(sampleLines(), data);
+    std::vector<LyricLine> lines;
+    for (size_t i = 0; i < data.size(); ++i) {
+        std::string damaged = data;
+        damaged[i] ^= 0x20;
+        EXPECT_FALSE(LyricCache::decode(damaged, lines)) << "flipped byte " << i;
+        EXPECT_FALSE(LyricCache::decode(std::string_view(data).substr(0, i), lines)) << "truncated at " << i;
+    }
+}
+
+TEST(LyricCacheSuite, KeysFollowContentAndEngine) {
+    std::vector<short> pcm(44100 * 2);
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        pcm[i] = static_cast<short>((i * 7919) % 65536 - 32768);
+    }
+    const std::string digest = LyricCache::audioDigest(pcm.data(), pcm.size(), 44100);
+    EXPECT_EQ(digest, LyricCache::audioDigest(pcm.data(), pcm.size(), 44100));
+    EXPECT_NE(digest, LyricCache::audioDigest(pcm.data(), pcm.size(), 48000));
+    EXPECT_NE(digest, LyricCache::audioDigest(pcm.data(), pcm.size() - 1, 44100));
+    pcm[12345] ^= 1;
+    EXPECT_NE(digest, LyricCache::audioDigest(pcm.data(), pcm.size(), 44100));
+
+    EXPECT_NE(LyricCache::key(digest, "faster-whisper/small v1"), LyricCache::key(digest, "faster-whisper/small v2"));
+}
+
+TEST(LyricCacheSuite, StoresLoadsAndDropsCorruptEntries) {
+    LyricCache cache(cacheDir("store"), 1 << 20);
+    std::vector<LyricLine> lines;
+    EXPECT_FALSE(cache.load("missing", lines));
+    ASSERT_TRUE(cache.store("song", sampleLines()));
+    ASSERT_TRUE(cache.load("song", lines));
+    EXPECT_EQ(lines.size(), 2u);
+
+    {
+        std::ofstream out(::testing::TempDir() + "aurora_lyric_cache_store/song.lyr", std::ios::binary | std::ios::app);
+        out << "x";
+    }
+    EXPECT_FALSE(cache.load("song", lines));
+    EXPECT_EQ(cache.sizeBytes(), 0u);
+
+    EXPECT_TRUE(cache.lastEngine().empty());
+    cache.setLastEngine("mock v1");
+    EXPECT_EQ(cache.lastEngine(), "mock v1");
+}
+
+TEST(LyricCacheSuite, EvictsLeastRecentlyUsed) {
+    std::string entry;
+    LyricCache::encode(sampleLines(), entry);
+    // Room for two entries.
+    LyricCache cache(cacheDir("evict"), entry.size() * 2);
+
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(cache.store("a", sampleLines()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(cache.store("b", sampleLines()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // Using "a" makes "b" the oldest.
+    ASSERT_TRUE(cache.load("a", lines));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(cache.store("c", sampleLines()));
+
+    EXPECT_TRUE(cache.load("a", lines));
+    EXPECT_FALSE(cache.load("b", lines));
+    EXPECT_TRUE(cache.load("c", lines));
+    EXPECT_LE(cache.sizeBytes(), entry.size() * 2);
+}
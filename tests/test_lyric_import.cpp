@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include "core/MappedFile.h"
+#include "core/lyrics/LyricImport.h"
+#include "core/lyrics/LyricTimeline.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+namespace {
+    const char* LRC_SAMPLE =
+        "[ti:Song]\n"
+        "[ar:Artist]\n"
+        "[00:01.00]<00:01.00>Hello <00:01.50>bright <00:02.00>world<00:03.00>\n"
+        "[00:04.00][00:10.00]Chorus line\n"
+        "[00:06.50]\n";
+
+    const char* SRT_SAMPLE =
+        "1\r\n"
+        "00:00:01,000 --> 00:00:02,500\r\n"
+        "<i>First</i> line\r\n"
+        "\r\n"
+        "2\r\n"
+        "00:00:03,000 --> 00:00:05,000\r\n"
+        "Second\r\n"
+        "spans two rows\r\n";
+
+    const char* VTT_SAMPLE =
+        "WEBVTT - karaoke\n"
+        "\n"
+        "NOTE this block is ignored\n"
+        "00:00:09.000 --> 00:00:10.000\n"
+        "\n"
+        "00:01.000 --> 00:04.000 align:center line:90%\n"
+        "<v Singer>Never <00:02.000>gonna <00:03.000>stop</v>\n"
+        "\n"
+        "cue-2\n"
+        "00:05.000 --> 00:06.000\n"
+        "Tom &amp; Jerry\n";
+
+    const char* JSON_SAMPLE =
+        "[{\"text\": \" Caf\\u00e9 \\\"night\\\" \", \"start_time\": 1.5, \"end_time\": 3,"
+        " \"words\": [{\"text\": \" Caf\\u00e9\", \"start_time\": 1.5, \"end_time\": 2.0},"
+        " {\"word\": \"night\", \"start\": 2.0, \"end\": 3.0, \"probability\": 0.9}]},"
+        " {\"text\": \"skipped, no start\"},"
+        " {\"text\": \"Second\", \"start_time\": 4, \"extra\": {\"nested\": [1, 2, {\"a\": null}]}}]";
+}
+
+TEST(LyricImportSuite, ParsesTimestamps) {
+    double seconds = 0.0;
+    EXPECT_TRUE(LyricImport::parseTimestamp("01:02.5", seconds));
+    EXPECT_DOUBLE_EQ(seconds, 62.5);
+    EXPECT_TRUE(LyricImport::parseTimestamp("01:00:02,250", seconds));
+    EXPECT_DOUBLE_EQ(seconds, 3602.25);
+    EXPECT_TRUE(LyricImport::parseTimestamp("00:07", seconds));
+    EXPECT_DOUBLE_EQ(seconds, 7.0);
+
+    EXPECT_FALSE(LyricImport::parseTimestamp("7", seconds));
+    EXPECT_FALSE(LyricImport::parseTimestamp("ti:Song", seconds));
+    EXPECT_FALSE(LyricImport::parseTimestamp("1:2:3:4", seconds));
+    EXPECT_FALSE(LyricImport::parseTimestamp("01:02.", seconds));
+    EXPECT_FALSE(LyricImport::parseTimestamp("01:02x", seconds));
+    EXPECT_FALSE(LyricImport::parseTimestamp("99999999999:00", seconds));
+}
+
+TEST(LyricImportSuite, ParsesEnhancedLrc) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseLrc(LRC_SAMPLE, lines));
+    ASSERT_EQ(lines.size(), 4u);
+
+    EXPECT_EQ(lines[0].text, "Hello bright world");
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 1.0);
+    ASSERT_EQ(lines[0].words.size(), 3u);
+    EXPECT_EQ(lines[0].words[1].text, "bright");
+    EXPECT_DOUBLE_EQ(lines[0].words[0].startTime, 1.0);
+    EXPECT_DOUBLE_EQ(lines[0].words[0].endTime, 1.5);
+    EXPECT_DOUBLE_EQ(lines[0].words[1].startTime, 1.5);
+    EXPECT_DOUBLE_EQ(lines[0].words[2].startTime, 2.0);
+    EXPECT_DOUBLE_EQ(lines[0].words[2].endTime, 3.0);
+
+    // One line per time tag, and empty timed lines clear the display.
+    EXPECT_EQ(lines[1].text, "Chorus line");
+    EXPECT_DOUBLE_EQ(lines[1].startTime, 4.0);
+    EXPECT_EQ(lines[2].text, "Chorus line");
+    EXPECT_DOUBLE_EQ(lines[2].startTime, 10.0);
+    EXPECT_TRUE(lines[3].text.empty());
+    EXPECT_FALSE(lines[1].hasWordTimings());
+}
+
+TEST(LyricImportSuite, AppliesLrcOffset) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseLrc("[00:05.00]a <00:06.00>b\n[offset:+500]\n[00:00.20]c\n", lines));
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 4.5);
+    EXPECT_DOUBLE_EQ(lines[0].words[1].startTime, 5.5);
+    EXPECT_DOUBLE_EQ(lines[1].startTime, 0.0);
+}
+
+TEST(LyricImportSuite, WritesEnhancedLrc) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseLrc(LRC_SAMPLE, lines));
+    const std::string lrc = LyricImport::formatLrc(lines);
+    EXPECT_EQ(lrc.substr(0, lrc.find('\n')), "[00:01.00]<00:01.00>Hello <00:01.50>bright <00:02.00>world");
+
+    std::vector<LyricLine> reparsed;
+    ASSERT_TRUE(LyricImport::parseLrc(lrc, reparsed));
+    ASSERT_EQ(reparsed.size(), lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_NEAR(reparsed[i].startTime, lines[i].startTime, 0.005);
+        EXPECT_EQ(reparsed[i].words.size(), lines[i].words.size());
+    }
+}
+
+TEST(LyricImportSuite, ParsesSrt) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseSrt(SRT_SAMPLE, lines));
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0].text, "First line");
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 1.0);
+    EXPECT_DOUBLE_EQ(lines[0].endTime, 2.5);
+    EXPECT_EQ(lines[1].text, "Second\nspans two rows");
+    EXPECT_DOUBLE_EQ(lines[1].endTime, 5.0);
+}
+
+TEST(LyricImportSuite, ParsesWebVttKaraoke) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseWebVtt(VTT_SAMPLE, lines));
+    ASSERT_EQ(lines.size(), 2u);
+
+    EXPECT_EQ(lines[0].text, "Never gonna stop");
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 1.0);
+    EXPECT_DOUBLE_EQ(lines[0].endTime, 4.0);
+    ASSERT_EQ(lines[0].words.size(), 3u);
+    EXPECT_DOUBLE_EQ(lines[0].words[0].startTime, 1.0);
+    EXPECT_DOUBLE_EQ(lines[0].words[0].endTime, 2.0);
+    EXPECT_DOUBLE_EQ(lines[0].words[2].startTime, 3.0);
+
+    EXPECT_EQ(lines[1].text, "Tom & Jerry");
+}
+
+TEST(LyricImportSuite, ParsesJson) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseJson(JSON_SAMPLE, lines));
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0].text, "Caf\xC3\xA9 \"night\"");
+    EXPECT_DOUBLE_EQ(lines[0].startTime, 1.5);
+    EXPECT_DOUBLE_EQ(lines[0].endTime, 3.0);
+    ASSERT_EQ(lines[0].words.size(), 2u);
+    EXPECT_EQ(lines[0].words[0].text, "Caf\xC3\xA9");
+    EXPECT_EQ(lines[0].words[1].text, "night");
+    EXPECT_DOUBLE_EQ(lines[0].words[1].endTime, 3.0);
+    EXPECT_EQ(lines[1].text, "Second");
+
+    std::vector<LyricLine> segments;
+    ASSERT_TRUE(LyricImport::parseJson(
+        "{\"language\": \"en\", \"segments\": [{\"start\": 0.5, \"end\": 1, \"text\": \"hi \\ud83d\\ude00\"}]}",
+        segments));
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(segments[0].text, "hi \xF0\x9F\x98\x80");
+}
+
+TEST(LyricImportSuite, DetectsFormats) {
+    EXPECT_EQ(LyricImport::detect("song.LRC", ""), LyricFormat::Lrc);
+    EXPECT_EQ(LyricImport::detect("song.vtt", ""), LyricFormat::WebVtt);
+    EXPECT_EQ(LyricImport::detect("lyrics", LRC_SAMPLE), LyricFormat::Lrc);
+    EXPECT_EQ(LyricImport::detect("lyrics", SRT_SAMPLE), LyricFormat::Srt);
+    EXPECT_EQ(LyricImport::detect("lyrics", VTT_SAMPLE), LyricFormat::WebVtt);
+    EXPECT_EQ(LyricImport::detect("lyrics", JSON_SAMPLE), LyricFormat::Json);
+    EXPECT_EQ(LyricImport::detect("lyrics", "\xEF\xBB\xBF  []"), LyricFormat::Json);
+    EXPECT_EQ(LyricImport::detect("lyrics", "plain text"), LyricFormat::Unknown);
+}
+
+TEST(LyricImportSuite, TimelineFillsOpenWordEnds) {
+    std::vector<LyricLine> lines;
+    ASSERT_TRUE(LyricImport::parseLrc("[00:01.00]<00:01.00>one <00:02.00>two\n[00:05.00]next\n", lines));
+    LyricTimeline timeline;
+    timeline.build(lines);
+    const LyricLine& first = timeline.line(0);
+    ASSERT_EQ(first.words.size(), 2u);
+    EXPECT_DOUBLE_EQ(first.words[0].endTime, 2.0);
+    // The last word runs until the line ends, which is where the next starts.
+    EXPECT_DOUBLE_EQ(first.words[1].endTime, 5.0);
+}
+
+TEST(LyricImportSuite, LoadsMappedFile) {
+    const std::string path = ::testing::TempDir() + "aurora_lyrics_test.srt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << SRT_SAMPLE;
+    }
+    MappedFile file(path);
+    ASSERT_TRUE(file.isOpen());
+    EXPECT_EQ(file.view(), SRT_SAMPLE);
+
+    LyricTimeline timeline;
+    ASSERT_TRUE(LyricImport::loadFile(path, timeline));
+    EXPECT_EQ(timeline.size(), 2u);
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(MappedFile(path).isOpen());
+    EXPECT_FALSE(LyricImport::loadFile(path, timeline));
+
+    // Plain text has no timings; it comes back for alignment instead.
+    const std::string textPath = ::testing::TempDir() + "aurora_lyrics_test.txt";
+    {
+        std::ofstream out(textPath, std::ios::binary);
+        out << "first line\nsecond line\n";
+    }
+    std::vector<LyricLine> lines;
+    std::string untimed;
+    EXPECT_FALSE(LyricImport::loadFile(textPath, lines, &untimed));
+    EXPECT_TRUE(lines.empty());
+    EXPECT_EQ(untimed, "first line\nsecond line\n");
+    std::remove(textPath.c_str());
+}
+
+// Mutation fuzzing of all parsers: truncations, byte flips, splices and
+// random bytes. Parsers must not crash (run under ASan to catch bad reads)
+// and must only produce finite, non-negative times.
+TEST(LyricImportSuite, SurvivesMalformedInput) {
+    const std::string samples[] = {LRC_SAMPLE, SRT_SAMPLE, VTT_SAMPLE, JSON_SAMPLE,
+                                   std::string(200, '[') + std::string(200, '{')};
+    const char interesting[] = {'[', ']', '{', '}', '<', '>', ':', '.', ',', '"', '\\', '\n', '-', '&', '0', '9'};
+    std::mt19937 rng(1234);
+
+    auto check = [](const std::vector<LyricLine>& lines) {
+        for (const LyricLine& line : lines) {
+            ASSERT_TRUE(std::isfinite(line.startTime) && line.startTime >= 0.0);
+            ASSERT_TRUE(std::isfinite(line.endTime) && line.endTime >= 0.0);
+            for (const LyricWord& word : line.words) {
+                ASSERT_TRUE(std::isfinite(word.startTime) && word.startTime >= 0.0);
+                ASSERT_TRUE(std::isfinite(word.endTime) && word.endTime >= 0.0);
+            }
+        }
+    };
+
+    for (int iteration = 0; iteration < 4000; ++iteration) {
+        std::string input = samples[iteration % 5];
+        const int mutations = 1 + static_cast<int>(rng() % 8);
+        for (int m = 0; m < mutations && !input.empty(); ++m) {
+            const size_t pos = rng() % input.size();
+            switch (rng() % 5) {
+            case 0: input.resize(pos); break;
+            case 1: input[pos] = static_cast<char>(rng()); break;
+            case 2: input[pos] = interesting[rng() % sizeof(interesting)]; break;
+            case 3: input.erase(pos, rng() % 16); break;
+            case 4: input.insert(pos, samples[rng() % 5].substr(0, rng() % 64)); break;
+            }
+        }
+        if (iteration % 10 == 0) {
+            input.resize(rng() % 256);
+            for (char& c : input) {
+                c = static_cast<char>(rng());
+            }
+        }
+
+        for (LyricFormat format : {LyricFormat::Json, LyricFormat::Lrc, LyricFormat::Srt, LyricFormat::WebVtt}) {
+            std::vector<LyricLine> lines;
+            LyricImport::parse(input, format, lines);
+            check(lines);
+            LyricTimeline timeline;
+            timeline.build(lines);
+        }
+    }
+}
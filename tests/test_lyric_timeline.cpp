@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "core/lyrics/LyricTimeline.h"
+#include <random>
+
+namespace {
+    LyricLine line(const char* text, double start, double end) {
+        LyricLine l;
+        l.text = text;
+        l.startTime = start;
+        l.endTime = end;
+        return l;
+    }
+
+    // Reference answer by scanning every line.
+    int bruteForceLineAt(const LyricTimeline& timeline, double time) {
+        int best = -1;
+        for (size_t i = 0; i < timeline.size(); ++i) {
+            if (timeline.line(i).startTime <= time && time < timeline.line(i).endTime) {
+                best = static_cast<int>(i);
+            }
+        }
+        return best;
+    }
+}
+
+TEST(LyricTimelineSuite, SortsLinesAndFillsMissingEnds) {
+    LyricTimeline timeline;
+    timeline.build({line("c", 20.0, 0.0), line("a", 5.0, 0.0), line("b", 10.0, 12.0)});
+    ASSERT_EQ(timeline.size(), 3u);
+    EXPECT_EQ(timeline.line(0).text, "a");
+    EXPECT_DOUBLE_EQ(timeline.line(0).endTime, 10.0);
+    EXPECT_DOUBLE_EQ(timeline.line(2).endTime, 20.0 + LyricTimeline::LAST_LINE_DURATION);
+
+    EXPECT_EQ(timeline.lineAt(4.9), -1);
+    EXPECT_EQ(timeline.lineAt(5.0), 0);
+    EXPECT_EQ(timeline.lineAt(11.0), 1);
+    EXPECT_EQ(timeline.lineAt(15.0), -1);
+    EXPECT_EQ(timeline.lineAt(100.0), -1);
+}
+
+TEST(LyricTimelineSuite, AppendReopensOnlyGuessedEnds) {
+    LyricTimeline timeline;
+    // An explicit end that happens to equal the guess stays.
+    timeline.build({line("a", 0.0, LyricTimeline::LAST_LINE_DURATION)});
+    EXPECT_TRUE(timeline.append({line("b", 5.0, 0.0)}));
+    EXPECT_DOUBLE_EQ(timeline.line(0).endTime, LyricTimeline::LAST_LINE_DURATION);
+    EXPECT_DOUBLE_EQ(timeline.line(1).endTime, 5.0 + LyricTimeline::LAST_LINE_DURATION);
+
+    LyricLine c = line("c", 20.0, 0.0);
+    c.words = {{"c1", 20.0, 21.0}, {"c2", 22.0, 0.0}};
+    EXPECT_TRUE(timeline.append({c}));
+    EXPECT_DOUBLE_EQ(timeline.line(1).endTime, 20.0);
+    EXPECT_TRUE(timeline.append({line("d", 24.0, 30.0)}));
+    EXPECT_DOUBLE_EQ(timeline.line(2).endTime, 24.0);
+    EXPECT_DOUBLE_EQ(timeline.line(2).words[0].endTime, 21.0);
+    EXPECT_DOUBLE_EQ(timeline.line(2).words[1].endTime, 24.0);
+    EXPECT_DOUBLE_EQ(timeline.line(3).endTime, 30.0);
+}
+
+TEST(LyricTimelineSuite, OverlappingLinesAreAllVisible) {
+    LyricTimeline timeline;
+    // A long backing vocal under two lead lines.
+    timeline.build({line("backing", 0.0, 30.0), line("lead 1", 5.0, 10.0), line("lead 2", 12.0, 18.0)});
+    std::vector<int> visible;
+    timeline.visibleAt(7.0, visible);
+    EXPECT_EQ(visible, std::vector<int>({0, 1}));
+    timeline.visibleAt(11.0, visible);
+    EXPECT_EQ(visible, std::vector<int>({0}));
+    EXPECT_EQ(timeline.lineAt(13.0), 2);
+    EXPECT_EQ(timeline.lineAt(25.0), 0);
+}
+
+TEST(LyricTimelineSuite, CursorMatchesLookupForSeeksAndSteps) {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> gap(0.0, 4.0);
+    std::vector<LyricLine> lines;
+    double start = 1.0;
+    for (int i = 0; i < 200; ++i) {
+        const double length = gap(random) + 0.5;
+        // Every fifth line overlaps the next ones.
+        lines.push_back(line("x", start, start + (i % 5 == 0 ? length * 3.0 : length)));
+        start += length + gap(random) * 0.2;
+    }
+    LyricTimeline timeline;
+    timeline.build(lines);
+
+    LyricTimeline::Cursor cursor(&timeline);
+    std::uniform_real_distribution<double> seekTo(-5.0, start + 10.0);
+    double time = 0.0;
+    for (int step = 0; step < 20000; ++step) {
+        // Mostly frame steps, sometimes a seek in either direction.
+        time = step % 500 == 0 ? seekTo(random) : time + 1.0 / 60.0;
+        const int expected = bruteForceLineAt(timeline, time);
+        ASSERT_EQ(timeline.lineAt(time), expected) << time;
+        ASSERT_EQ(cursor.seek(time), expected) << time;
+    }
+}
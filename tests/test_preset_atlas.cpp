@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "core/presets/PresetAtlas.h"
+
+TEST(PresetAtlasSuite, PacksStripsRowByRowAcrossPages) {
+    PresetAtlas::Layout layout;
+    layout.thumbWidth = 16;
+    layout.thumbHeight = 8;
+    layout.framesPerStrip = 4;
+    layout.pageSize = 128;
+    PresetAtlas atlas(layout);
+
+    ASSERT_EQ(layout.stripsPerPage(), 2 * 16);
+    for (int i = 0; i < layout.stripsPerPage() + 1; ++i) {
+        atlas.add("preset" + std::to_string(i) + ".milk");
+    }
+
+    const auto& entries = atlas.entries();
+    EXPECT_EQ(entries[1].x, 64);
+    EXPECT_EQ(entries[1].y, 0);
+    EXPECT_EQ(entries[2].x, 0);
+    EXPECT_EQ(entries[2].y, 8);
+    EXPECT_EQ(entries.back().page, 1);
+    EXPECT_EQ(atlas.pageCount(), 2);
+    EXPECT_EQ(atlas.entriesOnPage(1).size(), 1u);
+}
+
+TEST(PresetAtlasSuite, IndexRoundTrips) {
+    PresetAtlas atlas;
+    atlas.add("/presets/with space.milk");
+    atlas.add("/presets/b.milk");
+
+    const std::string path = testing::TempDir() + "atlas_index_test.tsv";
+    ASSERT_TRUE(atlas.saveIndex(path));
+
+    PresetAtlas loaded;
+    ASSERT_TRUE(loaded.loadIndex(path));
+    ASSERT_EQ(loaded.entries().size(), 2u);
+    EXPECT_EQ(loaded.entries()[0].presetPath, "/presets/with space.milk");
+    EXPECT_EQ(loaded.entries()[1].x, atlas.entries()[1].x);
+    std::remove(path.c_str());
+}
+
+TEST(PresetAtlasSuite, DownsampleAveragesBlocks) {
+    std::vector<unsigned char> src(4 * 2 * 4, 0);
+    for (int x = 2; x < 4; ++x) {
+        for (int y = 0; y < 2; ++y) {
+            src[(y * 4 + x) * 4] = 200;
+        }
+    }
+    std::vector<unsigned char> dst(2 * 1 * 4, 0);
+    PresetAtlas::downsample(src.data(), 4, 2, dst.data(), 2, 1, 2 * 4);
+    EXPECT_EQ(dst[0], 0);
+    EXPECT_EQ(dst[4], 200);
+}
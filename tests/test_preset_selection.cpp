@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "core/audio/TrackAnalyzer.h"
+#include "core/presets/PresetFeatureTable.h"
+#include "core/presets/PresetSelector.h"
+
+namespace {
+    const int SAMPLE_RATE = 44100;
+
+    // Clicks at the given tempo whose level jumps halfway through.
+    std::vector<short> makeTwoSectionTrack(float seconds, float bpm) {
+        size_t frames = static_cast<size_t>(seconds * SAMPLE_RATE);
+        size_t beatFrames = static_cast<size_t>(SAMPLE_RATE * 60.0f / bpm);
+        std::vector<short> pcm(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            float amplitude = i < frames / 2 ? 1500.0f : 20000.0f;
+            float decay = std::exp(-static_cast<float>(i % beatFrames) / 800.0f);
+            short s = static_cast<short>(amplitude * decay * std::sin(i * 0.3f));
+            pcm[i * 2] = s;
+            pcm[i * 2 + 1] = s;
+        }
+        return pcm;
+    }
+}
+
+TEST(TrackAnalyzerSuite, DetectsTempoAndSectionBoundary) {
+    std::vector<short> pcm = makeTwoSectionTrack(40.0f, 120.0f);
+    TrackAnalysis analysis = TrackAnalyzer::analyze(pcm.data(), pcm.size() / 2, SAMPLE_RATE);
+
+    EXPECT_NEAR(analysis.tempo, 120.0f, 4.0f);
+    ASSERT_EQ(analysis.sections.size(), 2u);
+    EXPECT_NEAR(analysis.sections[1].startTime, 20.0f, 0.5f);
+    EXPECT_LT(analysis.sections[0].energy, analysis.sections[1].energy);
+    EXPECT_EQ(analysis.sectionAt(5.0f), 0);
+    EXPECT_EQ(analysis.sectionAt(30.0f), 1);
+}
+
+TEST(PresetSelectorSuite, MatchesSectionEnergyAndAvoidsRepeats) {
+    PresetFeatureTable table;
+    table.set("calm.milk", {0.05f, 0.2f, 0.6f, 0.5f});
+    table.set("busy.milk", {0.9f, 0.8f, 0.1f, 0.8f});
+    table.set("busy2.milk", {0.85f, 0.75f, 0.3f, 0.7f});
+
+    TrackAnalysis analysis;
+    analysis.tempo = 120.0f;
+    analysis.sections = {{0.0f, 10.0f, 0.05f}, {10.0f, 20.0f, 1.0f}};
+
+    PresetSelector selector(&table);
+    selector.setTrackAnalysis(analysis);
+
+    EXPECT_EQ(selector.advance(1.0f), 0);
+    EXPECT_EQ(selector.advance(2.0f), -1);
+    EXPECT_EQ(selector.select(0, -1, {}), table.indexOf("calm.milk"));
+
+    EXPECT_EQ(selector.advance(12.0f), 1);
+    int loud = selector.select(1, table.indexOf("calm.milk"), {});
+    EXPECT_NE(loud, table.indexOf("calm.milk"));
+
+    int next = selector.select(1, loud, {});
+    EXPECT_NE(next, loud);
+}
+
+TEST(PresetFeatureTableSuite, MeasuresMotionAndBrightness) {
+    const int w = 8, h = 8;
+    std::vector<std::vector<unsigned char>> still(2, std::vector<unsigned char>(w * h * 4, 40));
+    std::vector<std::vector<unsigned char>> flashing = still;
+    std::fill(flashing[1].begin(), flashing[1].end(), 220);
+
+    PresetFeatures stillFeatures = PresetFeatureTable::analyzeFrames(still, w, h);
+    PresetFeatures flashingFeatures = PresetFeatureTable::analyzeFrames(flashing, w, h);
+
+    EXPECT_FLOAT_EQ(stillFeatures.motionEnergy, 0.0f);
+    EXPECT_GT(flashingFeatures.motionEnergy, 0.5f);
+    EXPECT_GT(flashingFeatures.brightness, stillFeatures.brightness);
+}
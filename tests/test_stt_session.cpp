@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include "core/lyrics/LyricTimeline.h"
+#include "core/stt/SttSession.h"
+#include <map>
+
+namespace {
+    // In-process stand-in for scripts/stt_worker.py: consumes request frames
+    // and answers with a fixed number of timed segments per file.
+    class MockSttWorker
+    {
+    public:
+        explicit MockSttWorker(int segmentsPerJob) : m_segmentsPerJob(segmentsPerJob) {}
+
+        std::string start() { return SttProtocol::encode({SttMessage::Type::Ready, 0, "mock v1"}); }
+
+        void receive(std::string_view bytes)
+        {
+            m_reader.append(bytes);
+            std::string payload;
+            SttMessage message;
+            while (m_reader.next(payload)) {
+                ASSERT_TRUE(SttProtocol::parse(payload, message));
+                if (message.type == SttMessage::Type::Transcribe) {
+                    m_queue.push_back(message.job);
+                    m_paths[message.job] = message.body;
+                } else if (message.type == SttMessage::Type::Quit) {
+                    m_quit = true;
+                }
+            }
+        }
+
+        // Output for the next `count` segments of the queued jobs.
+        std::string produce(int count)
+        {
+            std::string out;
+            while (count-- > 0 && !m_queue.empty()) {
+                const uint64_t job = m_queue.front();
+                const double start = 1.0 + m_produced * 2.0;
+                const std::string body = "[{\"text\": \"" + m_paths[job] + " " + std::to_string(m_produced) +
+                                         "\", \"start_time\": " + std::to_string(start) +
+                                         ", \"words\": [{\"text\": \"w\", \"start_time\": " + std::to_string(start) + "}]}]";
+                out += SttProtocol::encode({SttMessage::Type::Segments, job, body});
+                if (++m_produced == m_segmentsPerJob) {
+                    out += SttProtocol::encode({SttMessage::Type::Done, job, std::string()});
+                    m_queue.erase(m_queue.begin());
+                    m_produced = 0;
+                }
+            }
+            return out;
+        }
+
+        bool quit() const { return m_quit; }
+
+    private:
+        int m_segmentsPerJob;
+        int m_produced = 0;
+        SttFrameReader m_reader;
+        std::vector<uint64_t> m_queue;
+        std::map<uint64_t, std::string> m_paths;
+        bool m_quit = false;
+    };
+
+    // Feeds `bytes` to the session one byte at a time, the worst case for
+    // partial reads from a pipe.
+    void trickle(SttSession& session, const std::string& bytes)
+    {
+        for (char c : bytes) {
+            session.receive(std::string_view(&c, 1));
+        }
+    }
+}
+
+TEST(SttSessionSuite, FramesSurviveSplitsAndJunk) {
+    std::string stream;
+    SttProtocol::appendFrame("first", stream);
+    stream += "Loading model... 42%\n";
+    SttProtocol::appendFrame("multi\nline payload", stream);
+    stream += "3 four\n";
+    SttProtocol::appendFrame("", stream);
+    SttProtocol::appendFrame("last", stream);
+
+    SttFrameReader reader;
+    std::vector<std::string> payloads;
+    std::string payload;
+    for (char c : stream) {
+        reader.append(std::string_view(&c, 1));
+        while (reader.next(payload)) {
+            payloads.push_back(payload);
+        }
+    }
+    ASSERT_EQ(payloads.size(), 4u);
+    EXPECT_EQ(payloads[0], "first");
+    EXPECT_EQ(payloads[1], "multi\nline payload");
+    EXPECT_EQ(payloads[2], "");
+    EXPECT_EQ(payloads[3], "last");
+    EXPECT_GE(reader.discardedFrames(), 2u);
+    EXPECT_EQ(reader.bufferedBytes(), 0u);
+}
+
+TEST(SttSessionSuite, EncodesAndParsesMessages) {
+    SttMessage message;
+    const std::string frame = SttProtocol::encode({SttMessage::Type::Transcribe, 7, "/music/a b.mp3"});
+    EXPECT_EQ(frame, "27 transcribe 7 /music/a b.mp3\n");
+    ASSERT_TRUE(SttProtocol::parse("transcribe 7 /music/a b.mp3", message));
+    EXPECT_EQ(message.type, SttMessage::Type::Transcribe);
+    EXPECT_EQ(message.job, 7u);
+    EXPECT_EQ(message.body, "/music/a b.mp3");
+
+    ASSERT_TRUE(SttProtocol::parse("done 3", message));
+    EXPECT_EQ(message.job, 3u);
+    EXPECT_TRUE(message.body.empty());
+    EXPECT_TRUE(SttProtocol::parse("quit", message));
+
+    EXPECT_FALSE(SttProtocol::parse("done", message));
+    EXPECT_FALSE(SttProtocol::parse("done x", message));
+    EXPECT_FALSE(SttProtocol::parse("bogus 1", message));
+}
+
+TEST(SttSessionSuite, StreamsSegmentsIntoTimeline) {
+    MockSttWorker worker(5);
+    SttSession session;
+    const uint64_t first = session.submit("a.mp3");
+    const uint64_t second = session.submit("b.mp3");
+    worker.receive(session.takeOutgoing());
+    trickle(session, worker.start());
+    EXPECT_TRUE(session.isReady());
+    EXPECT_EQ(session.engine(), "mock v1");
+
+    LyricTimeline timeline;
+    LyricTimeline::Cursor cursor(&timeline);
+    size_t doneCount = 0;
+    std::vector<uint64_t> order;
+    while (doneCount < 2) {
+        trickle(session, worker.produce(2));
+        for (SttSession::Event& event : session.takeEvents()) {
+            if (event.type == SttSession::Event::Type::Segments && event.job == first) {
+                // Lines arrive in time order, so they are appended in place
+                // and the cursor stays valid between batches.
+                EXPECT_TRUE(timeline.append(event.lines));
+                EXPECT_EQ(cursor.seek(timeline.line(timeline.size() - 1).startTime),
+                          static_cast<int>(timeline.size()) - 1);
+            }
+            if (event.type == SttSession::Event::Type::Done) {
+                order.push_back(event.job);
+                ++doneCount;
+            }
+        }
+    }
+    EXPECT_EQ(order, (std::vector<uint64_t>{first, second}));
+    EXPECT_EQ(session.pendingJobs(), 0u);
+
+    ASSERT_EQ(timeline.size(), 5u);
+    EXPECT_EQ(timeline.line(0).text, "a.mp3 0");
+    // Open ends were filled from the following segment as it arrived.
+    EXPECT_DOUBLE_EQ(timeline.line(0).endTime, 3.0);
+    EXPECT_DOUBLE_EQ(timeline.line(0).words[0].endTime, 3.0);
+    EXPECT_DOUBLE_EQ(timeline.line(4).endTime, 9.0 + LyricTimeline::LAST_LINE_DURATION);
+
+    session.quit();
+    worker.receive(session.takeOutgoing());
+    EXPECT_TRUE(worker.quit());
+}
+
+TEST(SttSessionSuite, CancelDropsLateSegments) {
+    MockSttWorker worker(3);
+    SttSession session;
+    const uint64_t job = session.submit("a.mp3");
+    worker.receive(session.takeOutgoing());
+    session.receive(worker.produce(1));
+    session.cancel(job);
+    EXPECT_FALSE(session.isPending(job));
+    EXPECT_EQ(session.takeOutgoing(), SttProtocol::encode({SttMessage::Type::Cancel, job, std::string()}));
+
+    session.receive(worker.produce(5));
+    const std::vector<SttSession::Event> events = session.takeEvents();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, SttSession::Event::Type::Segments);
+}
+
+TEST(SttSessionSuite, RestartResendsUnfinishedJobs) {
+    SttSession session;
+    const uint64_t first = session.submit("a.mp3");
+    const uint64_t second = session.submit("b.mp3");
+    session.takeOutgoing();
+    session.receive(SttProtocol::encode({SttMessage::Type::Ready, 0, "mock"}));
+    session.receive(SttProtocol::encode({SttMessage::Type::Done, first, std::string()}));
+    // The worker died halfway through a frame.
+    session.receive("40 segments 2 [{\"te");
+
+    session.restart();
+    EXPECT_FALSE(session.isReady());
+    EXPECT_EQ(session.takeOutgoing(), SttProtocol::encode({SttMessage::Type::Transcribe, second, "b.mp3"}));
+    session.receive(SttProtocol::encode({SttMessage::Type::Error, second, "decode failed"}));
+    const std::vector<SttSession::Event> events = session.takeEvents();
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[2].type, SttSession::Event::Type::Error);
+    EXPECT_EQ(events[2].text, "decode failed");
+    EXPECT_EQ(session.pendingJobs(), 0u);
+}
+
+TEST(SttSessionSuite, RestartedJobsDoNotRepeatDeliveredLines) {
+    SttSession session;
+    const uint64_t job = session.submit("a.mp3");
+    MockSttWorker crashed(3);
+    crashed.receive(session.takeOutgoing());
+    session.receive(crashed.produce(2));
+
+    session.restart();
+    MockSttWorker next(3);
+    next.receive(session.takeOutgoing());
+    session.receive(next.produce(3));
+
+    LyricTimeline timeline;
+    for (const SttSession::Event& event : session.takeEvents()) {
+        if (event.type == SttSession::Event::Type::Segments) {
+            EXPECT_TRUE(timeline.append(event.lines));
+        }
+    }
+    ASSERT_EQ(timeline.size(), 3u);
+    EXPECT_EQ(timeline.line(2).text, "a.mp3 2");
+    EXPECT_FALSE(session.isPending(job));
+}
+
+TEST(SttSessionSuite, WorkerErrorFailsEveryPendingJob) {
+    SttSession session;
+    const uint64_t first = session.submit("a.mp3");
+    const uint64_t second = session.submit("b.mp3");
+    // E.g. the speech model could not be loaded.
+    session.receive(SttProtocol::encode({SttMessage::Type::Error, 0, "no engine"}));
+
+    const std::vector<SttSession::Event> events = session.takeEvents();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].job, first);
+    EXPECT_EQ(events[1].job, second);
+    EXPECT_EQ(events[1].type, SttSession::Event::Type::Error);
+    EXPECT_EQ(events[1].text, "no engine");
+    EXPECT_EQ(session.pendingJobs(), 0u);
+    EXPECT_TRUE(session.takeOutgoing().empty());
+}
+
+TEST(SttSessionSuite, OutOfOrderAppendRebuilds) {
+    LyricTimeline timeline;
+    LyricLine a;
+    a.text = "a";
+    a.startTime = 10.0;
+    LyricLine b;
+    b.text = "b";
+    b.startTime = 2.0;
+    b.endTime = 4.0;
+    EXPECT_TRUE(timeline.append({a}));
+    EXPECT_FALSE(timeline.append({b}));
+    ASSERT_EQ(timeline.size(), 2u);
+    EXPECT_EQ(timeline.line(0).text, "b");
+    EXPECT_EQ(timeline.lineAt(3.0), 0);
+    EXPECT_EQ(timeline.lineAt(11.0), 1);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "core/text/FontMetrics.h"
+#include "core/audio/VisualizationBuffer.h"
+
+namespace {
+    FontMetrics simpleFont() {
+        FontMetrics metrics;
+        metrics.setLineHeight(20.0f);
+        GlyphMetrics glyph;
+        glyph.width = 8.0f;
+        glyph.height = 10.0f;
+        glyph.bearingX = 1.0f;
+        glyph.bearingY = 10.0f;
+        glyph.advance = 10.0f;
+        for (char c = 'a'; c <= 'z'; ++c) {
+            metrics.setGlyph(static_cast<unsigned char>(c), glyph);
+        }
+        GlyphMetrics space;
+        space.advance = 5.0f;
+        metrics.setGlyph(' ', space);
+        return metrics;
+    }
+}
+
+TEST(FontMetricsSuite, MeasuresSingleLine) {
+    FontMetrics metrics = simpleFont();
+    TextBounds bounds = metrics.measure("ab c", 1.0f);
+    // Last glyph starts at 10 + 10 + 5 and its ink is offset by the bearing.
+    EXPECT_FLOAT_EQ(bounds.x, 0.0f);
+    EXPECT_FLOAT_EQ(bounds.width, 25.0f + 1.0f + 8.0f);
+    EXPECT_FLOAT_EQ(bounds.height, 10.0f);
+    EXPECT_FLOAT_EQ(metrics.advance("ab c", 2.0f), 70.0f);
+}
+
+TEST(FontMetricsSuite, NewlinesGrowDownwards) {
+    FontMetrics metrics = simpleFont();
+    TextBounds bounds = metrics.measure("abc\na", 0.5f);
+    EXPECT_FLOAT_EQ(bounds.y, -10.0f);
+    EXPECT_FLOAT_EQ(bounds.height, 15.0f);
+    // Unknown bytes measure as empty.
+    EXPECT_FLOAT_EQ(metrics.measure("\xC3\xA9", 1.0f).width, 0.0f);
+}
+
+TEST(VisualizationBufferSuite, ReturnsNewestFramesOldestFirst) {
+    VisualizationBuffer buffer(8);
+    std::vector<short> pcm;
+    for (short i = 0; i < 12; ++i) {
+        pcm.push_back(i);
+        pcm.push_back(-i);
+    }
+    buffer.store(pcm.data(), 12);
+
+    std::vector<short> out(4 * 2);
+    buffer.latest(out.data(), 4);
+    EXPECT_EQ(out[0], 8);
+    EXPECT_EQ(out[1], -8);
+    EXPECT_EQ(out[6], 11);
+    EXPECT_EQ(out[7], -11);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "core/animation/TitleAnimation.h"
+#include <cmath>
+
+namespace {
+    const float SCREEN_WIDTH = 1280.0f;
+    const float SCREEN_HEIGHT = 720.0f;
+    const TextBounds TITLE_BOUNDS = {0.0f, -12.0f, 400.0f, 60.0f};
+
+    TitleAnimation::Frame at(double time, double duration = 180.0,
+                             const TitleAnimation::Settings& settings = TitleAnimation::Settings()) {
+        return TitleAnimation::evaluate(time, duration, settings, TITLE_BOUNDS, SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+}
+
+TEST(TitleAnimationSuite, PhasesFollowTheSongTimeline) {
+    EXPECT_EQ(at(-1.0).phase, TitleAnimation::Phase::Hidden);
+    EXPECT_EQ(at(1.0).phase, TitleAnimation::Phase::FadeIn);
+    EXPECT_EQ(at(5.0).phase, TitleAnimation::Phase::Bouncing);
+    EXPECT_EQ(at(14.0).phase, TitleAnimation::Phase::FadeToTransparent);
+    EXPECT_EQ(at(100.0).phase, TitleAnimation::Phase::FadeToTransparent);
+    EXPECT_FLOAT_EQ(at(100.0).alpha, 0.4f);
+    EXPECT_EQ(at(175.0).phase, TitleAnimation::Phase::FadeToOpaque);
+    EXPECT_EQ(at(178.0).phase, TitleAnimation::Phase::ReturnToCenter);
+
+    // Unknown duration: no ending.
+    EXPECT_EQ(at(10000.0, 0.0).phase, TitleAnimation::Phase::FadeToTransparent);
+}
+
+TEST(TitleAnimationSuite, StartsAndEndsCentered) {
+    TitleAnimation::Frame first = at(0.0);
+    TitleAnimation::Frame last = at(180.0);
+    EXPECT_FLOAT_EQ(first.x, (SCREEN_WIDTH - 400.0f) / 2.0f);
+    EXPECT_FLOAT_EQ(first.y, 12.0f + (SCREEN_HEIGHT - 60.0f) / 2.0f);
+    EXPECT_FLOAT_EQ(first.alpha, 0.0f);
+    EXPECT_FLOAT_EQ(last.x, first.x);
+    EXPECT_FLOAT_EQ(last.y, first.y);
+    EXPECT_FLOAT_EQ(last.scale, 1.0f);
+    EXPECT_FLOAT_EQ(last.alpha, 1.0f);
+}
+
+TEST(TitleAnimationSuite, MotionIsContinuousAndStaysOnScreen) {
+    TitleAnimation::Frame previous = at(0.0);
+    for (int i = 1; i <= 180 * 60; ++i) {
+        TitleAnimation::Frame frame = at(i / 60.0);
+        const float left = frame.x + TITLE_BOUNDS.x * frame.scale;
+        const float bottom = frame.y + TITLE_BOUNDS.y * frame.scale;
+        ASSERT_GE(left, -0.01f);
+        ASSERT_GE(bottom, -0.01f);
+        ASSERT_LE(left + TITLE_BOUNDS.width * frame.scale, SCREEN_WIDTH + 0.01f);
+        ASSERT_LE(bottom + TITLE_BOUNDS.height * frame.scale, SCREEN_HEIGHT + 0.01f);
+        // Bouncing moves under 2 px per frame, the eased return a few more.
+        ASSERT_LT(std::fabs(frame.x - previous.x), 12.0f) << "at frame " << i;
+        ASSERT_LT(std::fabs(frame.y - previous.y), 12.0f) << "at frame " << i;
+        ASSERT_LT(std::fabs(frame.alpha - previous.alpha), 0.05f) << "at frame " << i;
+        previous = frame;
+    }
+}
+
+TEST(TitleAnimationSuite, ReflectionMatchesStepwiseBounce) {
+    const float length = 100.0f;
+    float position = 30.0f;
+    float velocity = 7.0f;
+    for (int step = 1; step <= 1000; ++step) {
+        position += velocity;
+        if (position > length) {
+            position = 2.0f * length - position;
+            velocity = -velocity;
+        } else if (position < 0.0f) {
+            position = -position;
+            velocity = -velocity;
+        }
+        ASSERT_NEAR(TitleAnimation::reflect(30.0 + 7.0 * step, length), position, 1e-3f) << "at step " << step;
+    }
+    EXPECT_FLOAT_EQ(TitleAnimation::reflect(-30.0, length), 30.0f);
+    EXPECT_FLOAT_EQ(TitleAnimation::reflect(50.0, 0.0f), 0.0f);
+}
+
+TEST(TitleAnimationSuite, ShortSongsStillEndCentered) {
+    TitleAnimation::Frame middle = at(2.0, 4.0);
+    TitleAnimation::Frame last = at(4.0, 4.0);
+    EXPECT_EQ(middle.phase, TitleAnimation::Phase::FadeToOpaque);
+    EXPECT_FLOAT_EQ(last.x, at(0.0, 4.0).x);
+    EXPECT_FLOAT_EQ(last.alpha, 1.0f);
+}
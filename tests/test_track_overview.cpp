@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "core/audio/TrackOverview.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    const size_t STEP_FRAMES = 16384;
+
+    // A tone in both channels whose amplitude steps up every STEP_FRAMES.
+    std::vector<short> steppedTone(int steps, double hz, int sampleRate = 44100) {
+        std::vector<short> pcm(static_cast<size_t>(steps) * STEP_FRAMES * 2);
+        for (size_t i = 0; i < pcm.size() / 2; ++i) {
+            const double amplitude = 3000.0 * (1 + static_cast<int>(i / STEP_FRAMES));
+            const short value = static_cast<short>(amplitude * std::sin(2.0 * M_PI * hz * i / sampleRate));
+            pcm[i * 2] = value;
+            pcm[i * 2 + 1] = value;
+        }
+        return pcm;
+    }
+
+    TrackOverview overviewOf(const std::vector<short>& pcm, size_t chunkFrames) {
+        TrackOverview overview;
+        overview.reset(44100);
+        for (size_t first = 0; first < pcm.size() / 2; first += chunkFrames) {
+            overview.append(pcm.data() + first * 2, std::min(chunkFrames, pcm.size() / 2 - first));
+        }
+        overview.finish();
+        return overview;
+    }
+}
+
+TEST(TrackOverviewSuite, BuildsThePyramidIncrementally) {
+    const std::vector<short> pcm = steppedTone(10, 440.0);
+    const TrackOverview whole = overviewOf(pcm, pcm.size() / 2);
+    const TrackOverview pieces = overviewOf(pcm, 1001);
+
+    ASSERT_EQ(whole.waveformLevels(), pieces.waveformLevels());
+    const size_t frames = pcm.size() / 2;
+    EXPECT_EQ(whole.waveformLevel(0).size(), (frames + TrackOverview::BASE_FRAMES - 1) / TrackOverview::BASE_FRAMES);
+    EXPECT_EQ(whole.waveformLevel(whole.waveformLevels() - 1).size(), 1u);
+    for (size_t level = 0; level < whole.waveformLevels(); ++level) {
+        ASSERT_EQ(whole.waveformLevel(level).size(), pieces.waveformLevel(level).size());
+        for (size_t i = 0; i < whole.waveformLevel(level).size(); ++i) {
+            EXPECT_EQ(whole.waveformLevel(level)[i].max, pieces.waveformLevel(level)[i].max);
+            EXPECT_FLOAT_EQ(whole.waveformLevel(level)[i].meanSquare, pieces.waveformLevel(level)[i].meanSquare);
+        }
+    }
+
+    // The top bin spans everything: the loudest step's peak.
+    const WaveformBin& top = whole.waveformLevel(whole.waveformLevels() - 1)[0];
+    EXPECT_NEAR(top.max, 30000, 2);
+    EXPECT_NEAR(top.min, -30000, 2);
+
+    // Built from PCM that is already decoded, the same pyramid comes out.
+    TrackOverview decoded;
+    ASSERT_TRUE(TrackOverview::build(pcm.data(), frames, 44100, decoded));
+    EXPECT_EQ(decoded.frameCount(), whole.frameCount());
+    EXPECT_DOUBLE_EQ(decoded.loudness(), whole.loudness());
+    EXPECT_EQ(decoded.waveformLevel(0)[9].max, whole.waveformLevel(0)[9].max);
+    const std::atomic<bool> cancelled{true};
+    EXPECT_FALSE(TrackOverview::build(pcm.data(), frames, 44100, decoded, &cancelled));
+}
+
+TEST(TrackOverviewSuite, AnswersAnyZoomFromTheRightLevel) {
+    const std::vector<short> pcm = steppedTone(8, 440.0);
+    const TrackOverview overview = overviewOf(pcm, 4096);
+
+    // Zoomed out: one column per step follows the amplitude.
+    std::vector<WaveformBin> columns(8);
+    overview.waveform(0, 8 * STEP_FRAMES, columns.data(), columns.size());
+    for (int step = 0; step < 8; ++step) {
+        const double amplitude = 3000.0 * (step + 1);
+        EXPECT_NEAR(columns[step].max, amplitude, amplitude * 0.02) << step;
+        EXPECT_NEAR(std::sqrt(columns[step].meanSquare) * 32768.0, amplitude / std::sqrt(2.0), amplitude * 0.05)
+            << step;
+    }
+    // Two steps per column: the louder one's peak.
+    overview.waveform(0, 8 * STEP_FRAMES, columns.data(), 4);
+    EXPECT_NEAR(columns[3].max, 24000, 480);
+
+    // Zoomed in past the finest level, and past the end of the track.
+    overview.waveform(STEP_FRAMES, STEP_FRAMES + 10, columns.data(), columns.size());
+    EXPECT_NEAR(columns[0].max, 6000, 60);
+    overview.waveform(9 * STEP_FRAMES, 10 * STEP_FRAMES, columns.data(), columns.size());
+    EXPECT_EQ(columns[7].max, 0);
+}
+
+TEST(TrackOverviewSuite, SpectrogramPeaksAtTheToneBand) {
+    const TrackOverview low = overviewOf(steppedTone(4, 200.0), 4096);
+    const TrackOverview high = overviewOf(steppedTone(4, 5000.0), 4096);
+
+    auto peakBand = [](const TrackOverview& overview) {
+        std::vector<uint8_t> column(TrackOverview::SPECTRUM_BANDS);
+        overview.spectrogram(0, 4 * STEP_FRAMES, column.data(), 1);
+        return std::max_element(column.begin(), column.end()) - column.begin();
+    };
+    const auto lowBand = peakBand(low);
+    const auto highBand = peakBand(high);
+    EXPECT_LT(lowBand, highBand);
+    // 40 Hz to 11 kHz in 64 log steps puts 200 Hz near band 18 and 5 kHz near band 55.
+    EXPECT_NEAR(lowBand, 18, 2);
+    EXPECT_NEAR(highBand, 55, 2);
+}
+
+TEST(TrackOverviewSuite, PeakCoversBothChannels) {
+    // Out of phase channels cancel in the mid waveform but keep their own peak.
+    std::vector<short> pcm = steppedTone(2, 440.0);
+    for (size_t i = 0; i < pcm.size(); i += 2) {
+        pcm[i] = static_cast<short>(pcm[i] * 5);
+        pcm[i + 1] = static_cast<short>(-pcm[i]);
+    }
+    const TrackOverview overview = overviewOf(pcm, 4096);
+    EXPECT_EQ(overview.waveformLevel(0)[3].max, 0);
+    EXPECT_NEAR(overview.peak(), 30000.0 / 32768.0, 0.001);
+}
+
+TEST(TrackOverviewSuite, CachesByFileAndRejectsDamage) {
+    const TrackOverview overview = overviewOf(steppedTone(8, 440.0), 4096);
+    std::string data;
+    overview.encode(data);
+    TrackOverview decoded;
+    ASSERT_TRUE(decoded.decode(data));
+    EXPECT_EQ(decoded.frameCount(), overview.frameCount());
+    EXPECT_TRUE(std::isfinite(overview.loudness()));
+    EXPECT_DOUBLE_EQ(decoded.loudness(), overview.loudness());
+    EXPECT_DOUBLE_EQ(decoded.peak(), overview.peak());
+    ASSERT_EQ(decoded.waveformLevels(), overview.waveformLevels());
+    EXPECT_EQ(decoded.waveformLevel(1)[7].max, overview.waveformLevel(1)[7].max);
+    data[data.size() / 2] ^= 1;
+    EXPECT_FALSE(decoded.decode(data));
+
+    const std::string directory = ::testing::TempDir() + "aurora_overview_cache";
+    std::filesystem::remove_all(directory);
+    const std::string track = ::testing::TempDir() + "aurora_overview_track.bin";
+    { std::ofstream(track) << "audio"; }
+    EXPECT_FALSE(TrackOverview::loadCached(directory, track, decoded));
+    ASSERT_TRUE(TrackOverview::storeCached(directory, track, overview, 1 << 20));
+    ASSERT_TRUE(TrackOverview::loadCached(directory, track, decoded));
+    EXPECT_EQ(decoded.frameCount(), overview.frameCount());
+
+    // A changed file is a different entry.
+    { std::ofstream(track) << "other audio"; }
+    EXPECT_FALSE(TrackOverview::loadCached(directory, track, decoded));
+    std::filesystem::remove(track);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "core/audio/VisualizationDynamics.h"
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace {
+    const int RATE = 44100;
+
+    // Sines or a square wave of the given peak amplitudes, the same in both channels.
+    std::vector<short> tone(double seconds, std::vector<std::pair<double, double>> partials, bool square = false) {
+        std::vector<short> pcm(static_cast<size_t>(seconds * RATE) * 2);
+        for (size_t i = 0; i < pcm.size() / 2; ++i) {
+            double value = 0.0;
+            for (const auto& [hz, amplitude] : partials) {
+                const double s = std::sin(2.0 * M_PI * hz * i / RATE);
+                value += amplitude * (square ? (s >= 0.0 ? 1.0 : -1.0) : s);
+            }
+            pcm[i * 2] = pcm[i * 2 + 1] = static_cast<short>(std::lround(value));
+        }
+        return pcm;
+    }
+
+    std::vector<short> processed(const std::vector<short>& in, const VisualizationDynamics::Settings& settings) {
+        VisualizationDynamics dynamics(settings, RATE);
+        std::vector<short> out(in.size());
+        // Callback-sized chunks that do not divide into blocks.
+        for (size_t first = 0; first < in.size() / 2; first += 441) {
+            dynamics.process(in.data() + first * 2, out.data() + first * 2, std::min<size_t>(441, in.size() / 2 - first));
+        }
+        return out;
+    }
+
+    // Over the last `seconds`, in dBFS.
+    double rmsDb(const std::vector<short>& pcm, double seconds) {
+        const size_t count = static_cast<size_t>(seconds * RATE) * 2;
+        double sum = 0.0;
+        for (size_t i = pcm.size() - count; i < pcm.size(); ++i) {
+            sum += (pcm[i] / 32768.0) * (pcm[i] / 32768.0);
+        }
+        return 10.0 * std::log10(sum / count);
+    }
+
+    double peakDb(const std::vector<short>& pcm, double seconds) {
+        int peak = 0;
+        for (size_t i = pcm.size() - static_cast<size_t>(seconds * RATE) * 2; i < pcm.size(); ++i) {
+            peak = std::max(peak, std::abs(static_cast<int>(pcm[i])));
+        }
+        return 20.0 * std::log10(peak / 32768.0);
+    }
+
+    // Amplitude of `hz` in the left channel over the last second.
+    double amplitudeAt(const std::vector<short>& pcm, double hz) {
+        std::complex<double> sum;
+        const size_t first = pcm.size() / 2 - RATE;
+        for (size_t i = first; i < pcm.size() / 2; ++i) {
+            sum += static_cast<double>(pcm[i * 2]) * std::polar(1.0, -2.0 * M_PI * hz * i / RATE);
+        }
+        return 2.0 * std::abs(sum) / RATE;
+    }
+}
+
+TEST(VisualizationDynamicsSuite, AgcMovesLevelsTowardsTheTarget) {
+    VisualizationDynamics::Settings settings;
+    settings.agcSeconds = 0.5f;
+    settings.maxGainDb = 30.0f;
+    settings.thresholdDb = 0.0f;
+
+    // A -40 dBFS sine has an RMS of -43 dBFS.
+    const std::vector<short> quiet = tone(6.0, {{1000.0, 328.0}});
+    EXPECT_NEAR(rmsDb(processed(quiet, settings), 1.0), settings.targetDb, 0.5);
+    const std::vector<short> loud = tone(6.0, {{1000.0, 29000.0}});
+    EXPECT_NEAR(rmsDb(processed(loud, settings), 1.0), settings.targetDb, 0.5);
+
+    // Boost stops at the limit.
+    settings.maxGainDb = 12.0f;
+    EXPECT_NEAR(rmsDb(processed(quiet, settings), 1.0), rmsDb(quiet, 1.0) + 12.0, 0.5);
+
+    settings.enabled = false;
+    EXPECT_EQ(processed(quiet, settings), quiet);
+}
+
+TEST(VisualizationDynamicsSuite, ShapesPeaksAboveTheThreshold) {
+    VisualizationDynamics::Settings settings;
+    settings.maxGainDb = 0.0f;
+    settings.thresholdDb = -12.0f;
+
+    // A -2 dBFS square is 10 dB over: 4:1 keeps 2.5 dB of that.
+    const std::vector<short> square = tone(2.0, {{441.0, 26029.0}}, true);
+    settings.ratio = 4.0f;
+    EXPECT_NEAR(peakDb(processed(square, settings), 0.5), -9.5, 0.3);
+
+    // Below 1 the ratio expands instead: 10 dB over becomes 20.
+    const std::vector<short> quieter = tone(2.0, {{441.0, 8231.0}}, true);
+    settings.thresholdDb = -22.0f;
+    settings.ratio = 0.5f;
+    EXPECT_NEAR(peakDb(processed(quieter, settings), 0.5), -2.0, 0.3);
+
+    // Under the threshold nothing changes.
+    settings.thresholdDb = 0.0f;
+    EXPECT_NEAR(peakDb(processed(quieter, settings), 0.5), peakDb(quieter, 0.5), 0.1);
+}
+
+TEST(VisualizationDynamicsSuite, LookaheadCatchesTransients) {
+    VisualizationDynamics::Settings settings;
+    settings.maxGainDb = 0.0f;
+    settings.thresholdDb = -20.0f;
+    settings.ratio = 10.0f;
+    settings.attackMs = 1.0f;
+
+    // Silence, then a -6 dBFS square.
+    std::vector<short> burst(static_cast<size_t>(RATE / 2) * 2, 0);
+    const size_t onset = burst.size() / 2;
+    const std::vector<short> square = tone(0.5, {{441.0, 16384.0}}, true);
+    burst.insert(burst.end(), square.begin(), square.end());
+
+    auto firstPeak = [&](const std::vector<short>& out, size_t from) {
+        int peak = 0;
+        for (size_t i = from * 2; i < (from + 88) * 2; ++i) {
+            peak = std::max(peak, std::abs(static_cast<int>(out[i])));
+        }
+        return peak;
+    };
+
+    settings.lookaheadMs = 0.0f;
+    const std::vector<short> late = processed(burst, settings);
+    EXPECT_NE(late[onset * 2], 0);
+    EXPECT_GT(firstPeak(late, onset), 12000);
+
+    settings.lookaheadMs = 5.0f;
+    const std::vector<short> early = processed(burst, settings);
+    const size_t latency = VisualizationDynamics(settings, RATE).latencyFrames();
+    EXPECT_EQ(latency, 221u);
+    EXPECT_EQ(early[(onset + latency - 1) * 2], 0);
+    EXPECT_NE(early[(onset + latency) * 2], 0);
+    // 5 ms ahead, the gain has already come down when the burst arrives.
+    EXPECT_LT(firstPeak(early, onset + latency), 6000);
+}
+
+TEST(VisualizationDynamicsSuite, SplitBandsLevelBassAndTrebleSeparately) {
+    VisualizationDynamics::Settings settings;
+    settings.thresholdDb = 0.0f;
+    settings.maxGainDb = 24.0f;
+    settings.agcSeconds = 0.5f;
+
+    // Loud bass and faint treble.
+    const std::vector<short> mix = tone(4.0, {{50.0, 16000.0}, {5000.0, 400.0}});
+    const std::vector<short> wide = processed(mix, settings);
+    settings.splitBands = true;
+    const std::vector<short> split = processed(mix, settings);
+
+    // One gain for everything keeps the balance; per band, the treble is
+    // lifted, as far as the gentle crossover lets bass into its band.
+    const double inputBalance = amplitudeAt(mix, 5000.0) / amplitudeAt(mix, 50.0);
+    EXPECT_NEAR(amplitudeAt(wide, 5000.0) / amplitudeAt(wide, 50.0), inputBalance, inputBalance * 0.05);
+    EXPECT_GT(amplitudeAt(split, 5000.0) / amplitudeAt(split, 50.0), inputBalance * 2.0);
+}